@@ -44,6 +44,7 @@
 #include "network/networkedge.h"
 
 #include <iostream>
+#include <algorithm>
 
 
 //*************************************************************************************************************
@@ -51,6 +52,9 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QVector>
+#include <QtConcurrent>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -74,6 +78,108 @@ using namespace Eigen;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace
+{
+
+const int CROSSCORR_TILE_SIZE = 32;     /**< Rows per tile of the pairwise cross correlation. */
+
+//=============================================================================================================
+/**
+* A block of rows to be transformed to the frequency domain by one thread.
+*/
+struct SpectraBlock
+{
+    int iRowStart;                      /**< First row of the block. */
+    int iFFTSize;                       /**< The FFT length. */
+    const MatrixXd* pMatData;           /**< The input data. */
+    MatrixXcd* pMatSpectra;             /**< Output half spectra (rows x iFFTSize/2+1). */
+};
+
+
+//=============================================================================================================
+/**
+* Zero pads and transforms the rows of a block.
+*/
+void transformBlock(SpectraBlock& block)
+{
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    const MatrixXd& matData = *block.pMatData;
+    int iRowEnd = std::min(block.iRowStart + CROSSCORR_TILE_SIZE, (int)matData.rows());
+
+    RowVectorXd rowPadded = RowVectorXd::Zero(block.iFFTSize);
+    VectorXcd vecFreq(block.iFFTSize/2+1);
+
+    for(int i = block.iRowStart; i < iRowEnd; ++i) {
+        rowPadded.head(matData.cols()) = matData.row(i);
+        fft.fwd(vecFreq.data(), rowPadded.data(), block.iFFTSize);
+        block.pMatSpectra->row(i) = vecFreq.transpose();
+    }
+}
+
+
+//=============================================================================================================
+/**
+* A tile of row pairs of the all-pairs cross correlation, processed by one thread.
+*/
+struct CrossCorrTile
+{
+    int iRowStart;                      /**< First row i of the tile. */
+    int iColStart;                      /**< First row j of the tile. */
+    int iFFTSize;                       /**< The FFT length. */
+    int iMaxLag;                        /**< Maximal lag in samples (N-1). */
+    const MatrixXcd* pMatSpectra;       /**< Half spectra of all rows (rows x iFFTSize/2+1). */
+    MatrixXd* pMatPeakValue;            /**< Output peak values. */
+    MatrixXi* pMatPeakLag;              /**< Output peak lags. */
+};
+
+
+//=============================================================================================================
+/**
+* Cross correlates all row pairs (i,j) with j >= i of a tile and stores the peak value and lag.
+*/
+void crossCorrelateTile(CrossCorrTile& tile)
+{
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    const MatrixXcd& matSpectra = *tile.pMatSpectra;
+    int iNumRows = matSpectra.rows();
+    int iRowEnd = std::min(tile.iRowStart + CROSSCORR_TILE_SIZE, iNumRows);
+    int iColEnd = std::min(tile.iColStart + CROSSCORR_TILE_SIZE, iNumRows);
+
+    VectorXcd vecProduct(matSpectra.cols());
+    VectorXd vecCorr(tile.iFFTSize);
+
+    for(int i = tile.iRowStart; i < iRowEnd; ++i) {
+        for(int j = std::max(i, tile.iColStart); j < iColEnd; ++j) {
+            vecProduct = matSpectra.row(i).transpose().cwiseProduct(matSpectra.row(j).transpose().conjugate());
+            fft.inv(vecCorr.data(), vecProduct.data(), tile.iFFTSize);
+
+            //Search valid lags only: 0..maxlag at the front, -maxlag..-1 at the end
+            int iIdx = 0;
+            double dMax = vecCorr.head(tile.iMaxLag + 1).maxCoeff(&iIdx);
+            int iLag = iIdx;
+
+            if(tile.iMaxLag > 0) {
+                double dMaxNeg = vecCorr.tail(tile.iMaxLag).maxCoeff(&iIdx);
+                if(dMaxNeg > dMax) {
+                    dMax = dMaxNeg;
+                    iLag = iIdx - tile.iMaxLag;
+                }
+            }
+
+            (*tile.pMatPeakValue)(i,j) = dMax;
+            (*tile.pMatPeakValue)(j,i) = dMax;
+            (*tile.pMatPeakLag)(i,j) = iLag;
+            (*tile.pMatPeakLag)(j,i) = -iLag;
+        }
+    }
+}
+
+} // NAMESPACE
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -105,11 +211,13 @@ Network::SPtr ConnectivityMeasures::crossCorrelation(const MatrixXd& matData, co
     }
 
     //Create edges
+    MatrixXd matPeakValue;
+    MatrixXi matPeakLag;
+    crossCorrelation(matData, matPeakValue, matPeakLag);
+
     for(int i = 0; i < matData.rows(); ++i) {
         for(int j = i; j < matData.rows(); ++j) {
-            QPair<int,double> crossCorrPair = eigenCrossCorrelation(matData.row(i), matData.row(j));
-
-            QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork->getNodes()[i], finalNetwork->getNodes()[j], crossCorrPair.second));
+            QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork->getNodes()[i], finalNetwork->getNodes()[j], matPeakValue(i,j)));
 
             *finalNetwork->getNodes()[i] << pEdge;
             *finalNetwork << pEdge;
@@ -127,22 +235,68 @@ Network::SPtr ConnectivityMeasures::crossCorrelation(const MatrixXd& matData, co
 
 Eigen::MatrixXd ConnectivityMeasures::crossCorrelation(const MatrixXd& matData)
 {
-    MatrixXd matDist = MatrixXd::Zero(matData.rows(), matData.rows());
+    MatrixXd matPeakValue;
+    MatrixXi matPeakLag;
+    crossCorrelation(matData, matPeakValue, matPeakLag);
 
-    for(int i = 0; i < matDist.rows(); ++i) {
-        QPair<int,double> crossCorrPair = eigenCrossCorrelation(matData.row(i), matData.row(i));
+    MatrixXd matDist = matPeakValue.triangularView<Upper>();
 
-        double dScaling = crossCorrPair.second;
+    matDist /= matDist.maxCoeff();
 
-        for(int j = i; j < matDist.rows(); ++j) {
-            QPair<int,double> crossCorrPair = eigenCrossCorrelation(matData.row(i), matData.row(j));
-            matDist(i,j) = crossCorrPair.second/* / dScaling*/;
-        }
+    return matDist;
+}
+
+
+//*************************************************************************************************************
+
+void ConnectivityMeasures::crossCorrelation(const MatrixXd& matData, MatrixXd& matPeakValue, MatrixXi& matPeakLag)
+{
+    int iNumRows = matData.rows();
+    int N = matData.cols();
+
+    matPeakValue = MatrixXd::Zero(iNumRows, iNumRows);
+    matPeakLag = MatrixXi::Zero(iNumRows, iNumRows);
+
+    if(iNumRows == 0 || N == 0) {
+        return;
     }
 
-    matDist /= matDist.maxCoeff();
+    //Compute the FFT size as the "next power of 2" of 2N-1, so the circular correlation holds all lags
+    int b = ceil(log2(2.0 * N - 1));
+    int fftsize = pow(2,b);
 
-    return matDist;
+    //Transform every row once
+    MatrixXcd matSpectra(iNumRows, fftsize/2+1);
+
+    QVector<SpectraBlock> vecBlocks;
+    for(int i = 0; i < iNumRows; i += CROSSCORR_TILE_SIZE) {
+        SpectraBlock block;
+        block.iRowStart = i;
+        block.iFFTSize = fftsize;
+        block.pMatData = &matData;
+        block.pMatSpectra = &matSpectra;
+        vecBlocks.append(block);
+    }
+
+    QtConcurrent::blockingMap(vecBlocks, transformBlock);
+
+    //Pairwise products and inverse transforms in tiles of the upper triangle
+    QVector<CrossCorrTile> vecTiles;
+    for(int i = 0; i < iNumRows; i += CROSSCORR_TILE_SIZE) {
+        for(int j = i; j < iNumRows; j += CROSSCORR_TILE_SIZE) {
+            CrossCorrTile tile;
+            tile.iRowStart = i;
+            tile.iColStart = j;
+            tile.iFFTSize = fftsize;
+            tile.iMaxLag = N - 1;
+            tile.pMatSpectra = &matSpectra;
+            tile.pMatPeakValue = &matPeakValue;
+            tile.pMatPeakLag = &matPeakLag;
+            vecTiles.append(tile);
+        }
+    }
+
+    QtConcurrent::blockingMap(vecTiles, crossCorrelateTile);
 }
 
 
@@ -175,7 +329,7 @@ QPair<int,double> ConnectivityMeasures::eigenCrossCorrelation(const RowVectorXd&
     fft.fwd(freqvec2, xCorrInputVecSecond);
 
     //Create conjugate complex
-    freqvec2.conjugate();
+    freqvec2 = freqvec2.conjugate();
 
     //Main step of cross corr
     for (int i = 0; i < fftsize; i++) {
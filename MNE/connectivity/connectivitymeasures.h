@@ -124,6 +124,19 @@ public:
     */
     static Eigen::MatrixXd crossCorrelation(const Eigen::MatrixXd& matData);
 
+    //=========================================================================================================
+    /**
+    * Calculates the cross correlation peaks between all pairs of rows of the data matrix. Every row is
+    * transformed only once, the pairwise spectra products and inverse transforms are computed in parallel
+    * tiles of row pairs.
+    *
+    * @param[in] matData        The input data (rows = channels/sources, cols = samples).
+    * @param[out] matPeakValue  The maximum of the cross correlation of row i and row j (symmetric).
+    * @param[out] matPeakLag    The lag in samples at which the maximum occurs. A positive lag k means row i
+    *                           follows row j by k samples (matPeakLag(j,i) = -matPeakLag(i,j)).
+    */
+    static void crossCorrelation(const Eigen::MatrixXd& matData, Eigen::MatrixXd& matPeakValue, Eigen::MatrixXi& matPeakLag);
+
 protected:
     static QPair<int,double> eigenCrossCorrelation(const Eigen::RowVectorXd &xCorrInputVecFirst, const Eigen::RowVectorXd &xCorrInputVecSecond);
     //std::pair<double, double> eigenCrossCorrelation(std::vector<double>& xCorrInputVecFirs, std::vector<double>& xCorrInputVecSecond);
@@ -47,7 +47,7 @@
 
 using namespace DISPLIB;
 
-TFplot::TFplot(MatrixXd tf_matrix, qreal sample_rate, qreal lower_frq, qreal upper_frq, ColorMaps cmap = Jet)
+TFplot::TFplot(MatrixXd tf_matrix, qreal sample_rate, qreal lower_frq, qreal upper_frq, ColorMaps cmap, qint32 hop_size)
 {
     qreal max_frq = sample_rate/2.0;
     qreal frq_per_px = max_frq/tf_matrix.rows();
@@ -77,20 +77,20 @@ TFplot::TFplot(MatrixXd tf_matrix, qreal sample_rate, qreal lower_frq, qreal upp
 
     //zoomed_tf_matrix = tf_matrix.block(tf_matrix.rows() - upper_px, 0, upper_px-lower_px, tf_matrix.cols());
 
-    calc_plot(zoomed_tf_matrix, sample_rate, cmap, lower_frq, upper_frq);
+    calc_plot(zoomed_tf_matrix, sample_rate, hop_size, cmap, lower_frq, upper_frq);
 
 }
 
 //-----------------------------------------------------------------------------------------------------------------
 
-TFplot::TFplot(MatrixXd tf_matrix, qreal sample_rate, ColorMaps cmap = Jet)
+TFplot::TFplot(MatrixXd tf_matrix, qreal sample_rate, ColorMaps cmap, qint32 hop_size)
 {   
-    calc_plot(tf_matrix, sample_rate, cmap, 0, 0);
+    calc_plot(tf_matrix, sample_rate, hop_size, cmap, 0, 0);
 }
 
 //-----------------------------------------------------------------------------------------------------------------
 
-void TFplot::calc_plot(MatrixXd tf_matrix, qreal sample_rate, ColorMaps cmap, qreal lower_frq = 0, qreal upper_frq = 0)
+void TFplot::calc_plot(MatrixXd tf_matrix, qreal sample_rate, qint32 hop_size, ColorMaps cmap, qreal lower_frq = 0, qreal upper_frq = 0)
 {
     //normalisation of the tf-matrix
     qreal norm1 = tf_matrix.maxCoeff();
@@ -189,7 +189,7 @@ void TFplot::calc_plot(MatrixXd tf_matrix, qreal sample_rate, ColorMaps cmap, qr
     QList<QGraphicsItem *> x_axis_values;
     QList<QGraphicsItem *> x_axis_lines;
 
-    qreal scaleXText = (tf_matrix.rows() - 1) /  sample_rate / 20.0;                       // divide signallength
+    qreal scaleXText = (tf_matrix.cols() - 1) * hop_size /  sample_rate / 20.0;            // divide signallength, one column every hop_size samples
 
     for(qint32 j = 0; j < 21; j++)
     {
@@ -105,9 +105,10 @@ public:
     *  @param[in] lower_frq         lower bound frequency, that should be plotted
     *  @param[in] upper_frq         upper bound frequency, that should be plotted
     *  @param[in] cmap              colormap used to plot the spectrogram
+    *  @param[in] hop_size          number of samples between two columns of the spectrogram
     *
     */
-    TFplot(MatrixXd tf_matrix, qreal sample_rate, qreal lower_frq, qreal upper_frq, ColorMaps cmap);
+    TFplot(MatrixXd tf_matrix, qreal sample_rate, qreal lower_frq, qreal upper_frq, ColorMaps cmap, qint32 hop_size = 1);
 
     //=========================================================================================================
     /**
@@ -122,9 +123,10 @@ public:
     *  @param[in] tf_matrix         given spectrogram
     *  @param[in] sample_rate       given sample rate of signal related to th spectrogram
     *  @param[in] cmap              colormap used to plot the spectrogram
+    *  @param[in] hop_size          number of samples between two columns of the spectrogram
     *
     */
-    TFplot(MatrixXd tf_matrix, qreal sample_rate, ColorMaps cmap);
+    TFplot(MatrixXd tf_matrix, qreal sample_rate, ColorMaps cmap, qint32 hop_size = 1);
 
 
 private:
@@ -139,12 +141,13 @@ private:
     *
     *  @param[in] tf_matrix         given spectrogram
     *  @param[in] sample_rate       given sample rate of signal related to th spectrogram
+    *  @param[in] hop_size          number of samples between two columns of the spectrogram
     *  @param[in] cmap              colormap used to plot the spectrogram
     *  @param[in] lower_frq         lower bound frequency, that should be plotted
     *  @param[in] upper_frq         upper bound frequency, that should be plotted
     *
     */
-    void calc_plot(MatrixXd tf_matrix, qreal sample_rate, ColorMaps cmap, qreal lower_frq, qreal upper_frq);
+    void calc_plot(MatrixXd tf_matrix, qreal sample_rate, qint32 hop_size, ColorMaps cmap, qreal lower_frq, qreal upper_frq);
 
 protected:
      virtual void resizeEvent(QResizeEvent *event);
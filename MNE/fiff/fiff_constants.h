@@ -617,6 +617,18 @@ namespace FIFFLIB
 //
 #define FIFF_MNE_RT_COMMAND         3700              /**< Fiff Real-Time Command */
 #define FIFF_MNE_RT_CLIENT_ID       3701              /**< Fiff Real-Time mne_t_server client id */
+#define FIFF_MNE_RT_DATA_FORMAT     3702              /**< Fiff Real-Time data port transport format acknowledged by mne_rt_server */
+#define FIFF_MNE_RT_DATA_BUFFER     3703              /**< Fiff Real-Time packed data buffer, see FIFFV_MNE_RT_DATA_FORMAT_* */
+
+//
+// Real-Time data port transport formats. Packed buffers carry a little endian header
+// (format, nchan, nsamp), the per channel scales of the integer formats and the samples in
+// channel fastest order.
+//
+#define FIFFV_MNE_RT_DATA_FORMAT_FIFF       0         /**< Big endian float FIFF_DATA_BUFFER tags (default) */
+#define FIFFV_MNE_RT_DATA_FORMAT_FLOAT32    1         /**< Little endian float32 samples */
+#define FIFFV_MNE_RT_DATA_FORMAT_INT16      2         /**< Little endian int16 samples with a float32 scale per channel */
+#define FIFFV_MNE_RT_DATA_FORMAT_INT24      3         /**< Little endian int24 samples with a float32 scale per channel */
 
 //
 // 3710... Real-Time Blocks
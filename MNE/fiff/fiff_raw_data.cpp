@@ -42,6 +42,16 @@
 #include "fiff_tag.h"
 #include "fiff_stream.h"
 #include "cstdlib"
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QtEndian>
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -51,6 +61,91 @@
 using namespace FIFFLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Decodes a single big endian fif sample to double.
+*/
+template<typename T>
+inline double decodeSample(const uchar* p_pSrc);
+
+template<>
+inline double decodeSample<fiff_dau_pack16_t>(const uchar* p_pSrc)
+{
+    return (double)qFromBigEndian<qint16>(p_pSrc);
+}
+
+template<>
+inline double decodeSample<fiff_int_t>(const uchar* p_pSrc)
+{
+    return (double)qFromBigEndian<qint32>(p_pSrc);
+}
+
+template<>
+inline double decodeSample<fiff_float_t>(const uchar* p_pSrc)
+{
+    quint32 t_iVal = qFromBigEndian<quint32>(p_pSrc);
+    float t_fVal;
+    memcpy(&t_fVal, &t_iVal, sizeof(float));
+    return (double)t_fVal;
+}
+
+//=============================================================================================================
+/**
+* Decodes the samples [first_pick, first_pick + picksamp) of a memory mapped raw buffer. Calibration and channel
+* selection are applied in the same pass. The result is written to the columns [dest, dest + picksamp) of data.
+*/
+template<typename T>
+void decodeCalibrated(const uchar* p_pBuffer, qint32 nchan, qint32 first_pick, qint32 picksamp, const RowVectorXd& cals, const RowVectorXi& sel, MatrixXd& data, qint32 dest)
+{
+    const qint32 nrows = sel.size() > 0 ? sel.size() : nchan;
+    for(qint32 c = 0; c < picksamp; ++c)
+    {
+        const uchar* t_pSample = p_pBuffer + (qint64)(first_pick + c) * nchan * sizeof(T);
+        double* t_pDest = data.col(dest + c).data();
+        if(sel.size() > 0)
+            for(qint32 r = 0; r < nrows; ++r)
+                t_pDest[r] = cals[sel[r]] * decodeSample<T>(t_pSample + sel[r] * sizeof(T));
+        else
+            for(qint32 r = 0; r < nrows; ++r)
+                t_pDest[r] = cals[r] * decodeSample<T>(t_pSample + r * sizeof(T));
+    }
+}
+
+//=============================================================================================================
+/**
+* Decodes all channels of the samples [first_pick, first_pick + picksamp) of a memory mapped raw buffer to raw.
+*/
+template<typename T>
+void decodeRaw(const uchar* p_pBuffer, qint32 nchan, qint32 first_pick, qint32 picksamp, MatrixXd& raw)
+{
+    raw.resize(nchan, picksamp);
+    const uchar* t_pSample = p_pBuffer + (qint64)first_pick * nchan * sizeof(T);
+    double* t_pDest = raw.data();
+    for(qint64 i = 0; i < (qint64)nchan * picksamp; ++i)
+        t_pDest[i] = decodeSample<T>(t_pSample + i * sizeof(T));
+}
+
+//=============================================================================================================
+/**
+* Compares two matrices including their dimensions.
+*/
+template<typename Derived>
+inline bool isEqual(const MatrixBase<Derived>& p_matA, const MatrixBase<Derived>& p_matB)
+{
+    return p_matA.rows() == p_matB.rows() && p_matA.cols() == p_matB.cols() && p_matA == p_matB;
+}
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -59,6 +154,9 @@ using namespace FIFFLIB;
 FiffRawData::FiffRawData()
 : first_samp(-1)
 , last_samp(-1)
+, m_pMappedData(NULL)
+, m_iMappedSize(0)
+, m_bMultValid(false)
 {
 
 }
@@ -69,6 +167,9 @@ FiffRawData::FiffRawData()
 FiffRawData::FiffRawData(QIODevice &p_IODevice)
 : first_samp(-1)
 , last_samp(-1)
+, m_pMappedData(NULL)
+, m_iMappedSize(0)
+, m_bMultValid(false)
 {
     //setup FiffRawData object
     if(!FiffStream::setup_read_raw(p_IODevice, *this))
@@ -91,6 +192,9 @@ FiffRawData::FiffRawData(const FiffRawData &p_FiffRawData)
 , rawdir(p_FiffRawData.rawdir)
 , proj(p_FiffRawData.proj)
 , comp(p_FiffRawData.comp)
+, m_pMappedData(NULL)
+, m_iMappedSize(0)
+, m_bMultValid(false)
 {
 
 }
@@ -98,9 +202,30 @@ FiffRawData::FiffRawData(const FiffRawData &p_FiffRawData)
 
 //*************************************************************************************************************
 
-FiffRawData::~FiffRawData()
+FiffRawData& FiffRawData::operator=(const FiffRawData &rhs)
 {
+    if(this != &rhs)
+    {
+        unmap();
+        file = rhs.file;
+        info = rhs.info;
+        first_samp = rhs.first_samp;
+        last_samp = rhs.last_samp;
+        cals = rhs.cals;
+        rawdir = rhs.rawdir;
+        proj = rhs.proj;
+        comp = rhs.comp;
+        m_bMultValid = false;
+    }
+    return *this;
+}
 
+
+//*************************************************************************************************************
+
+FiffRawData::~FiffRawData()
+{
+    unmap();
 }
 
 
@@ -108,6 +233,7 @@ FiffRawData::~FiffRawData()
 
 void FiffRawData::clear()
 {
+    unmap();
     info.clear();
     first_samp = -1;
     last_samp = -1;
@@ -115,6 +241,8 @@ void FiffRawData::clear()
     rawdir.clear();
     proj = MatrixXd();
     comp.clear();
+    m_bMultValid = false;
+    m_matSparseMult = SparseMatrix<double>();
 }
 
 
@@ -162,31 +290,16 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
     cal.setFromTriplets(tripletList.begin(), tripletList.end());
 //    cal.makeCompressed();
 
-    MatrixXd mult_full;
-    //
     if (sel.size() == 0)
     {
         data = MatrixXd(nchan, to-from+1);
 //            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
-        {
-            if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
-            else
-                mult_full = this->proj*this->comp.data->data*cal;
-        }
     }
     else
     {
         data = MatrixXd(sel.size(),to-from+1);
 //            data->setZero();
 
-        MatrixXd selVect(sel.size(), nchan);
-
-        selVect.setZero();
-
         if (!projAvailable && this->comp.kind == -1)
         {
             tripletList.clear();
@@ -196,47 +309,12 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
             cal = SparseMatrix<double>(sel.size(), sel.size());
             cal.setFromTriplets(tripletList.begin(), tripletList.end());
         }
-        else
-        {
-            if (!projAvailable)
-            {
-                qDebug() << "This has to be debugged! #1";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
-                mult_full = selVect*cal;
-            }
-            else if (this->comp.kind == -1)
-            {
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*cal;
-            }
-            else
-            {
-                qDebug() << "This has to be debugged! #3";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*this->comp.data->data*cal;
-            }
-        }
     }
 
     //
-    // Make mult sparse
+    // Compensation, projection, calibration and selection combined; only rebuilt when one of them changed
     //
-    tripletList.clear();
-    tripletList.reserve(mult_full.rows()*mult_full.cols());
-    for(i = 0; i < mult_full.rows(); ++i)
-        for(k = 0; k < mult_full.cols(); ++k)
-            if(mult_full(i,k) != 0)
-                tripletList.push_back(T(i, k, mult_full(i,k)));
-
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
-    if(tripletList.size() > 0)
-        mult.setFromTriplets(tripletList.begin(), tripletList.end());
-//    mult.makeCompressed();
+    const SparseMatrix<double>& mult = this->combinedOperator(sel);
 
     //
 
@@ -479,31 +557,16 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix
     cal.setFromTriplets(tripletList.begin(), tripletList.end());
 //    cal.makeCompressed();
 
-    MatrixXd mult_full;
-    //
     if (sel.size() == 0)
     {
         data = MatrixXd(nchan, to-from+1);
 //            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
-        {
-            if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
-            else
-                mult_full = this->proj*this->comp.data->data*cal;
-        }
     }
     else
     {
         data = MatrixXd(sel.size(),to-from+1);
 //            data->setZero();
 
-        MatrixXd selVect(sel.size(), nchan);
-
-        selVect.setZero();
-
         if (!projAvailable && this->comp.kind == -1)
         {
             tripletList.clear();
@@ -513,47 +576,12 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix
             cal = SparseMatrix<double>(sel.size(), sel.size());
             cal.setFromTriplets(tripletList.begin(), tripletList.end());
         }
-        else
-        {
-            if (!projAvailable)
-            {
-                qDebug() << "This has to be debugged! #1";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
-                mult_full = selVect*cal;
-            }
-            else if (this->comp.kind == -1)
-            {
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*cal;
-            }
-            else
-            {
-                qDebug() << "This has to be debugged! #3";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*this->comp.data->data*cal;
-            }
-        }
     }
 
     //
-    // Make mult sparse
+    // Compensation, projection, calibration and selection combined; only rebuilt when one of them changed
     //
-    tripletList.clear();
-    tripletList.reserve(mult_full.rows()*mult_full.cols());
-    for(i = 0; i < mult_full.rows(); ++i)
-        for(k = 0; k < mult_full.cols(); ++k)
-            if(mult_full(i,k) != 0)
-                tripletList.push_back(T(i, k, mult_full(i,k)));
-
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
-    if(tripletList.size() > 0)
-        mult.setFromTriplets(tripletList.begin(), tripletList.end());
-//    mult.makeCompressed();
+    const SparseMatrix<double>& mult = this->combinedOperator(sel);
 
     //
 
@@ -756,6 +784,262 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix
 }
 
 
+//*************************************************************************************************************
+
+bool FiffRawData::read_raw_segment_mapped(MatrixXd& data, MatrixXd& times, fiff_int_t from, fiff_int_t to, const RowVectorXi& sel)
+{
+    const uchar* t_pFile = this->map();
+    if(!t_pFile)
+        return this->read_raw_segment(data, times, from, to, sel);
+
+    if(from == -1)
+        from = this->first_samp;
+    if(to == -1)
+        to = this->last_samp;
+    //
+    //  Initial checks
+    //
+    if(from < this->first_samp)
+        from = this->first_samp;
+    if(to > this->last_samp)
+        to = this->last_samp;
+    //
+    if(from > to)
+    {
+        printf("No data in this range\n");
+        return false;
+    }
+
+    qint32 nchan = this->info.nchan;
+    qint32 nrows = sel.size() > 0 ? sel.size() : nchan;
+    qint32 i;
+
+    //
+    //  Compensation and projection are combined with the calibration and the selection into one cached operator;
+    //  without them calibration and selection are applied while decoding.
+    //
+    const SparseMatrix<double>& mult = this->combinedOperator(sel);
+
+    data.resize(nrows, to-from+1);
+
+    MatrixXd raw;
+    qint32 dest = 0;
+    for(qint32 k = 0; k < this->rawdir.size(); ++k)
+    {
+        const FiffRawDir& thisRawDir = this->rawdir[k];
+        //
+        //  Do we need this buffer
+        //
+        if(thisRawDir.last < from)
+            continue;
+
+        qint32 first_pick = from > thisRawDir.first ? from - thisRawDir.first : 0;
+        qint32 last_pick = (to < thisRawDir.last ? to : thisRawDir.last) - thisRawDir.first;
+        qint32 picksamp = last_pick - first_pick + 1;
+
+        if(picksamp > 0)
+        {
+            if(thisRawDir.ent.kind == -1)
+            {
+                //
+                //  Skip is translated to zeros
+                //
+                data.block(0, dest, nrows, picksamp).setZero();
+            }
+            else
+            {
+                qint64 t_iDataPos = (qint64)thisRawDir.ent.pos + FIFFC_DATA_OFFSET;
+                if(thisRawDir.ent.pos < 0 || t_iDataPos + thisRawDir.ent.size > m_iMappedSize)
+                {
+                    printf("Raw buffer %d exceeds the mapped file.\n", k);
+                    return false;
+                }
+                const uchar* t_pBuffer = t_pFile + t_iDataPos;
+
+                if(mult.cols() == 0)
+                {
+                    if(thisRawDir.ent.type == FIFFT_DAU_PACK16)
+                        decodeCalibrated<fiff_dau_pack16_t>(t_pBuffer, nchan, first_pick, picksamp, this->cals, sel, data, dest);
+                    else if(thisRawDir.ent.type == FIFFT_INT)
+                        decodeCalibrated<fiff_int_t>(t_pBuffer, nchan, first_pick, picksamp, this->cals, sel, data, dest);
+                    else if(thisRawDir.ent.type == FIFFT_FLOAT)
+                        decodeCalibrated<fiff_float_t>(t_pBuffer, nchan, first_pick, picksamp, this->cals, sel, data, dest);
+                    else
+                    {
+                        printf("Data Storage Format not known jet [1]!! Type: %d\n", thisRawDir.ent.type);
+                        return false;
+                    }
+                }
+                else
+                {
+                    if(thisRawDir.ent.type == FIFFT_DAU_PACK16)
+                        decodeRaw<fiff_dau_pack16_t>(t_pBuffer, nchan, first_pick, picksamp, raw);
+                    else if(thisRawDir.ent.type == FIFFT_INT)
+                        decodeRaw<fiff_int_t>(t_pBuffer, nchan, first_pick, picksamp, raw);
+                    else if(thisRawDir.ent.type == FIFFT_FLOAT)
+                        decodeRaw<fiff_float_t>(t_pBuffer, nchan, first_pick, picksamp, raw);
+                    else
+                    {
+                        printf("Data Storage Format not known jet [3]!! Type: %d\n", thisRawDir.ent.type);
+                        return false;
+                    }
+
+                    data.block(0, dest, nrows, picksamp) = mult * raw;
+                }
+            }
+
+            dest += picksamp;
+        }
+        //
+        //  Done?
+        //
+        if(thisRawDir.last >= to)
+            break;
+    }
+
+    times = MatrixXd(1, to-from+1);
+
+    for (i = 0; i < times.cols(); ++i)
+        times(0, i) = ((float)(from+i)) / this->info.sfreq;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+const SparseMatrix<double>& FiffRawData::combinedOperator(const RowVectorXi& sel)
+{
+    const FiffCtfComp& t_comp = this->comp;     //const access does not detach the shared compensation data
+
+    bool projAvailable = this->proj.size() > 0;
+    bool compAvailable = t_comp.kind != -1;
+
+    //
+    //  Reuse the operator until a setter changed one of its factors or another selection is read
+    //
+    if(m_bMultValid && isEqual(m_vecMultSel, sel))
+        return m_matSparseMult;
+
+    m_vecMultSel = sel;
+    m_bMultValid = true;
+
+    if(!projAvailable && !compAvailable)
+    {
+        m_matSparseMult = SparseMatrix<double>();
+        return m_matSparseMult;
+    }
+
+    //
+    //  The selection only picks rows of the leftmost factor, the calibration only scales columns
+    //
+    const MatrixXd& matLeft = projAvailable ? this->proj : t_comp.data->data;
+    if(sel.size() > 0)
+    {
+        MatrixXd matLeftSel(sel.size(), matLeft.cols());
+        for(qint32 i = 0; i < sel.size(); ++i)
+            matLeftSel.row(i) = matLeft.row(sel[i]);
+        m_matSparseMult = matLeftSel.sparseView();
+    }
+    else
+        m_matSparseMult = matLeft.sparseView();
+
+    //
+    //  The compensator is mostly identity, multiply sparse
+    //
+    if(projAvailable && compAvailable)
+    {
+        SparseMatrix<double> matSparseComp = t_comp.data->data.sparseView();
+        m_matSparseMult = m_matSparseMult * matSparseComp;
+    }
+
+    m_matSparseMult = m_matSparseMult * this->cals.asDiagonal();
+    m_matSparseMult.makeCompressed();
+
+    return m_matSparseMult;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawData::setProj(const MatrixXd& p_matProj)
+{
+    proj = p_matProj;
+    m_bMultValid = false;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawData::setComp(const FiffCtfComp& p_comp)
+{
+    comp = p_comp;
+    m_bMultValid = false;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawData::setCals(const RowVectorXd& p_vecCals)
+{
+    cals = p_vecCals;
+    m_bMultValid = false;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawData::unmap()
+{
+    if(m_pMappedData)
+    {
+        QFile* t_pFile = !this->file.isNull() ? qobject_cast<QFile*>(this->file->device()) : NULL;
+        if(t_pFile && t_pFile->isOpen())
+            t_pFile->unmap(m_pMappedData);
+        m_pMappedData = NULL;
+        m_iMappedSize = 0;
+    }
+}
+
+
+//*************************************************************************************************************
+
+const uchar* FiffRawData::map()
+{
+    if(this->file.isNull())
+        return NULL;
+
+    QFile* t_pFile = qobject_cast<QFile*>(this->file->device());
+    if(!t_pFile)
+        return NULL;
+
+    //
+    //  QFile releases all its mappings when it is closed
+    //
+    if(m_pMappedData && !t_pFile->isOpen())
+    {
+        m_pMappedData = NULL;
+        m_iMappedSize = 0;
+    }
+
+    if(!m_pMappedData)
+    {
+        if(!t_pFile->isOpen() && !t_pFile->open(QIODevice::ReadOnly))
+        {
+            printf("Cannot open file %s\n", this->info.filename.toUtf8().constData());
+            return NULL;
+        }
+
+        m_iMappedSize = t_pFile->size();
+        m_pMappedData = t_pFile->map(0, m_iMappedSize);
+        if(!m_pMappedData)
+            m_iMappedSize = 0;
+    }
+
+    return m_pMappedData;
+}
+
+
 //*************************************************************************************************************
 
 bool FiffRawData::read_raw_segment_times(MatrixXd& data, MatrixXd& times, float from, float to, const RowVectorXi& sel)
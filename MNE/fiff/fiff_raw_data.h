@@ -118,6 +118,16 @@ public:
     */
     FiffRawData(QIODevice &p_IODevice);
 
+    //=========================================================================================================
+    /**
+    * Assignment operator. The memory mapping is not shared, it is created again on demand.
+    *
+    * @param[in] rhs    FIFF raw measurement which should be assigned
+    *
+    * @return this raw data
+    */
+    FiffRawData& operator=(const FiffRawData &rhs);
+
     //=========================================================================================================
     /**
     * Destroys the FiffInfo.
@@ -190,15 +200,92 @@ public:
     */
     bool read_raw_segment_times(MatrixXd& data, MatrixXd& times, float from, float to, const RowVectorXi& sel = defaultRowVectorXi);
 
+    //=========================================================================================================
+    /**
+    * Memory mapped variant of read_raw_segment. The underlying fif file is mapped once and the raw buffers
+    * listed in rawdir are decoded straight from the mapping without creating intermediate FiffTag objects.
+    * Only the samples which fall into the requested range are decoded. Calibration and channel selection are
+    * fused into the decoding pass, compensation and projection are applied as one product per buffer.
+    * Falls back to read_raw_segment if the IO device can not be mapped (e.g. it is not a QFile).
+    *
+    * @param[out] data      returns the data matrix (channels x samples)
+    * @param[out] times     returns the time values corresponding to the samples
+    * @param[in] from       first sample to include. If omitted, defaults to the first sample in data (optional)
+    * @param[in] to         last sample to include. If omitted, defaults to the last sample in data (optional)
+    * @param[in] sel        channel selection vector (optional)
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_raw_segment_mapped(MatrixXd& data, MatrixXd& times, fiff_int_t from = -1, fiff_int_t to = -1, const RowVectorXi& sel = defaultRowVectorXi);
+
+    //=========================================================================================================
+    /**
+    * Releases the memory mapping created by read_raw_segment_mapped. The mapping is created again on demand.
+    */
+    void unmap();
+
+    //=========================================================================================================
+    /**
+    * Sets the SSP operator. proj, comp and cals can be assigned directly before the first segment is read,
+    * later changes have to go through setProj, setComp and setCals so that the cached combined operator is rebuilt.
+    *
+    * @param[in] p_matProj  the SSP operator, empty to disable the projection
+    */
+    void setProj(const MatrixXd& p_matProj);
+
+    //=========================================================================================================
+    /**
+    * Sets the compensator, see setProj.
+    *
+    * @param[in] p_comp     the compensator, kind -1 to disable the compensation
+    */
+    void setComp(const FiffCtfComp& p_comp);
+
+    //=========================================================================================================
+    /**
+    * Sets the calibration, see setProj.
+    *
+    * @param[in] p_vecCals  the calibration factor of each channel
+    */
+    void setCals(const RowVectorXd& p_vecCals);
+
 public:
     FiffStream::SPtr file;      /**< replaces fid */
     FiffInfo info;              /**< Fiff measurement information */
     fiff_int_t first_samp;      /**< Do we have a skip ToDo... */
     fiff_int_t last_samp;       /**< Do we have a skip ToDo... */
-    RowVectorXd cals;           /**< Calibration matrix: ToDo Check if RowVectorXd is enough */
+    RowVectorXd cals;           /**< Calibration matrix, see setCals: ToDo Check if RowVectorXd is enough */
     QList<FiffRawDir> rawdir;   /**< Special fiff diretory entry for raw data. */
-    MatrixXd proj;              /**< SSP operator to apply to the data. */
-    FiffCtfComp comp;           /**< Compensator. */
+    MatrixXd proj;              /**< SSP operator to apply to the data, see setProj. */
+    FiffCtfComp comp;           /**< Compensator, see setComp. */
+
+private:
+    //=========================================================================================================
+    /**
+    * Maps the fif file which is attached to this raw data, when not already done.
+    *
+    * @return pointer to the first byte of the mapped file, NULL if the device can not be mapped
+    */
+    const uchar* map();
+
+    //=========================================================================================================
+    /**
+    * Returns the operator which combines compensation, projection, calibration and channel selection
+    * (proj * comp * cals, rows picked by sel). It is built sparse and cached, it is only rebuilt after setProj,
+    * setComp or setCals was called or when sel differs from the selection it was built with.
+    *
+    * @param[in] sel    channel selection vector, empty for all channels
+    *
+    * @return the combined operator, with zero columns if neither projection nor compensation are active
+    */
+    const SparseMatrix<double>& combinedOperator(const RowVectorXi& sel);
+
+    uchar*  m_pMappedData;      /**< Start of the memory mapped fif file, NULL if not mapped. */
+    qint64  m_iMappedSize;      /**< Size of the memory mapped region in bytes. */
+
+    bool                    m_bMultValid;       /**< Whether m_matSparseMult is up to date, reset by the setters. */
+    SparseMatrix<double>    m_matSparseMult;    /**< The cached combined operator. */
+    RowVectorXi             m_vecMultSel;       /**< The selection m_matSparseMult was built with. */
 };
 
 } // NAMESPACE
@@ -76,6 +76,7 @@
 //=============================================================================================================
 
 #include <QFile>
+#include <QtEndian>
 
 
 //*************************************************************************************************************
@@ -2485,17 +2486,9 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const RowVectorXd& cals)
         return false;
     }
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(cals.cols());
-    for(qint32 i = 0; i < cals.cols(); ++i)
-        tripletList.push_back(T(i, i, 1.0/cals[i]));
+    m_vecRawScale = cals.transpose().cwiseInverse();
 
-    SparseMatrix<double> inv_calsMat(cals.cols(), cals.cols());
-    inv_calsMat.setFromTriplets(tripletList.begin(), tripletList.end());
-
-    MatrixXf tmp = (inv_calsMat*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    this->write_raw_data_buffer(buf, m_vecRawScale.data());
     return true;
 }
 
@@ -2509,13 +2502,15 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const SparseMatrix<double
         return false;
     }
 
-    SparseMatrix<double> inv_mult(mult.rows(), mult.cols());
-    for (int k=0; k<inv_mult.outerSize(); ++k)
-      for (SparseMatrix<double>::InnerIterator it(mult,k); it; ++it)
-        inv_mult.coeffRef(it.row(),it.col()) = 1/it.value();
+    //Same sparsity pattern as mult, only the stored values are inverted
+    SparseMatrix<double> inv_mult(mult);
+    inv_mult.makeCompressed();
+    double* t_pValues = inv_mult.valuePtr();
+    for (int k = 0; k < inv_mult.nonZeros(); ++k)
+        t_pValues[k] = 1/t_pValues[k];
 
-    MatrixXf tmp = (inv_mult*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    MatrixXd tmp = inv_mult*buf;
+    this->write_raw_data_buffer(tmp, NULL);
     return true;
 }
 
@@ -2524,12 +2519,53 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const SparseMatrix<double
 
 bool FiffStream::write_raw_buffer(const MatrixXd& buf)
 {
-    MatrixXf tmp = buf.cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    this->write_raw_data_buffer(buf, NULL);
     return true;
 }
 
 
+//*************************************************************************************************************
+
+void FiffStream::write_raw_data_buffer(const MatrixXd& buf, const double* pScale)
+{
+    qint32 nrows = buf.rows();
+    qint32 nel = buf.rows()*buf.cols();
+    qint32 datasize = nel * 4;
+
+    *this << (qint32)FIFF_DATA_BUFFER;
+    *this << (qint32)FIFFT_FLOAT;
+    *this << (qint32)datasize;
+    *this << (qint32)FIFFV_NEXT_SEQ;
+
+    if(m_baRawStaging.size() < datasize)
+        m_baRawStaging.resize(datasize);
+
+    //
+    // Scale, convert and swap in one pass; the buffer is stored column by column, the channel index runs fastest
+    //
+    uchar* t_pDest = reinterpret_cast<uchar*>(m_baRawStaging.data());
+    bool bBigEndian = this->byteOrder() == QDataStream::BigEndian;
+
+    quint32 t_iValue;
+    float t_fValue;
+    for(qint32 c = 0; c < buf.cols(); ++c)
+    {
+        const double* t_pSrc = buf.col(c).data();
+        for(qint32 r = 0; r < nrows; ++r, t_pDest += 4)
+        {
+            t_fValue = pScale ? (float)(t_pSrc[r]*pScale[r]) : (float)t_pSrc[r];
+            memcpy(&t_iValue, &t_fValue, sizeof(float));
+            if(bBigEndian)
+                qToBigEndian<quint32>(t_iValue, t_pDest);
+            else
+                qToLittleEndian<quint32>(t_iValue, t_pDest);
+        }
+    }
+
+    this->writeRawData(m_baRawStaging.constData(), datasize);
+}
+
+
 //*************************************************************************************************************
 
 void FiffStream::write_string(fiff_int_t kind, const QString& data)
@@ -675,6 +675,21 @@ public:
     * @param[in] data       The string data to write
     */
     void write_rt_command(fiff_int_t command, const QString& data);
+
+private:
+    //=========================================================================================================
+    /**
+    * Writes a FIFF_DATA_BUFFER tag in one go. The samples are scaled, converted to float and swapped to the
+    * stream byte order in a single pass into a reusable staging buffer, which is then written with one
+    * writeRawData call.
+    *
+    * @param[in] buf        the buffer to write (channels x samples)
+    * @param[in] pScale     per channel scaling factors (buf.rows() elements), NULL if no scaling should be applied
+    */
+    void write_raw_data_buffer(const MatrixXd& buf, const double* pScale);
+
+    QByteArray  m_baRawStaging;     /**< Staging buffer of write_raw_data_buffer, reused across raw buffers. */
+    VectorXd    m_vecRawScale;      /**< Inverse calibrations of the last written raw buffer. */
 };
 
 } // NAMESPACE
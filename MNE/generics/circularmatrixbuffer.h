@@ -52,6 +52,7 @@
 //=============================================================================================================
 
 #include <typeinfo>
+#include <cstring>
 
 
 //*************************************************************************************************************
@@ -68,7 +69,10 @@
 //=============================================================================================================
 
 #include <QPair>
-#include <QSemaphore>
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
 #include <QSharedPointer>
 
 
@@ -91,7 +95,11 @@ using namespace Eigen;
 
 //=============================================================================================================
 /**
-* Circular Matrix buffer provides a template for thread safe circular matrix buffers.
+* Circular Matrix buffer provides a template for thread safe circular matrix buffers. The buffer is a lock-free
+* single producer/single consumer ring: one thread pushes, one thread pops. The read and write positions are
+* atomic matrix counters which wrap around at twice the capacity, so the slot sequence stays continuous for any
+* capacity. Every matrix occupies one contiguous slot and is copied with a single memcpy. A thread only blocks
+* (spin first, then wait condition) when the buffer is full (push) or empty (pop).
 *
 * @brief The circular matrix buffer
 */
@@ -121,7 +129,7 @@ public:
 
     //=========================================================================================================
     /**
-    * Adds a whole matrix at the end buffer.
+    * Adds a whole matrix at the end buffer. Blocks while the buffer is full. Must only be called by the producer thread.
     *
     * @param [in] pMatrix pointer to a Matrix which should be apend to the end.
     */
@@ -129,7 +137,8 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns the first matrix (first in first out).
+    * Returns the first matrix (first in first out). Blocks while the buffer is empty. Must only be called by the
+    * consumer thread.
     *
     * @return the first matrix
     */
@@ -137,7 +146,19 @@ public:
 
     //=========================================================================================================
     /**
-    * Clears the buffer.
+    * Copies the first matrix (first in first out) into preallocated storage. The matrix is only resized when it
+    * does not match the buffer dimensions. Blocks while the buffer is empty. Must only be called by the consumer
+    * thread.
+    *
+    * @param [out] matrix   the matrix to write the first matrix to.
+    */
+    inline void popInto(Matrix<_Tp, Dynamic, Dynamic>& matrix);
+
+    //=========================================================================================================
+    /**
+    * Clears the buffer by dropping all matrices which are currently stored. May be called from any thread while the
+    * producer and the consumer are running: it advances the read counter just like the consumer does, and a pop
+    * which overlaps with clear() discards its copy and waits for the next matrix.
     */
     void clear();
 
@@ -159,6 +180,12 @@ public:
     */
     inline quint32 cols() const;
 
+    //=========================================================================================================
+    /**
+    * Number of matrices which are currently stored in the buffer.
+    */
+    inline quint32 count() const;
+
     //=========================================================================================================
     /**
     * Pauses the buffer. Skpis any incoming matrices and only pops zero matrices.
@@ -167,37 +194,85 @@ public:
 
     //=========================================================================================================
     /**
-    * Releases the circular buffer from the acquire statement in the pop() function.
-    * @param [out] bool returns true if resources were freed so that the aquire statement in the pop function can release, otherwise false.
+    * Releases the circular buffer from the blocking wait in the pop() function. A pop on an empty buffer returns a
+    * zero matrix instead of waiting, until new data is pushed.
+    * @param [out] bool returns true if the buffer is empty, i.e. pop would block, otherwise false.
     */
     inline bool releaseFromPop();
 
     //=========================================================================================================
     /**
-    * Releases the circular buffer from the acquire statement in the push() function.
-    * @param [out] bool returns true if resources were freed so that the aquire statement in the push function can release, otherwise false.
+    * Releases the circular buffer from the blocking wait in the push() function. A push on a full buffer drops its
+    * matrix instead of waiting, until a matrix is popped.
+    * @param [out] bool returns true if the buffer is full, i.e. push would block, otherwise false.
     */
     inline bool releaseFromPush();
 
 private:
     //=========================================================================================================
     /**
-    * Returns the current circular index to the corresponding given index.
+    * Waits until a slot is free for writing.
+    *
+    * @return false if the push was released and the matrix has to be dropped.
+    */
+    inline bool waitForFree();
+
+    //=========================================================================================================
+    /**
+    * Waits until a slot is available for reading.
+    *
+    * @return false if the pop was released and a zero matrix has to be returned.
+    */
+    inline bool waitForUsed();
+
+    //=========================================================================================================
+    /**
+    * Wakes up the other thread when it is blocked in a wait condition.
+    *
+    * @param [in] condition     wait condition to wake up.
+    */
+    inline void notify(QWaitCondition& condition);
+
+    //=========================================================================================================
+    /**
+    * Returns the counter following uiCount, wrapped around at twice the capacity.
+    *
+    * @param [in] uiCount   read or write counter.
+    */
+    inline quint32 nextCount(quint32 uiCount) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of stored matrices for the given counters.
     *
-    * @param [in] index which should be mapped.
-    * @return the mapped index.
+    * @param [in] uiWrite   write counter.
+    * @param [in] uiRead    read counter.
     */
-    inline unsigned int mapIndex(int& index);
+    inline quint32 usedCount(quint32 uiWrite, quint32 uiRead) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the first element of the slot the given counter points to.
+    *
+    * @param [in] uiCount   read or write counter.
+    */
+    inline _Tp* slot(quint32 uiCount) const;
 
     unsigned int    m_uiMaxNumMatrices;         /**< Holds the maximal number of matrices.*/
     unsigned int    m_uiRows;                   /**< Holds the number rows.*/
     unsigned int    m_uiCols;                   /**< Holds the number cols.*/
+    unsigned int    m_uiMatrixSize;             /**< Holds the number of elements of one matrix.*/
     unsigned int    m_uiMaxNumElements;         /**< Holds the maximal number of buffer elements.*/
+    quint32         m_uiCountRange;             /**< Holds the range of the counters, twice the maximal number of matrices.*/
     _Tp*            m_pBuffer;                  /**< Holds the circular buffer.*/
-    int             m_iCurrentReadIndex;        /**< Holds the current read index.*/
-    int             m_iCurrentWriteIndex;       /**< Holds the current write index.*/
-    QSemaphore*     m_pFreeElements;            /**< Holds a semaphore which acquires free elements for thread safe writing. A semaphore is a generalization of a mutex.*/
-    QSemaphore*     m_pUsedElements;            /**< Holds a semaphore which acquires written semaphore for thread safe reading.*/
+    QAtomicInteger<quint32> m_uiReadCount;      /**< Holds the number of matrices popped so far modulo m_uiCountRange. Advanced by the consumer and clear().*/
+    QAtomicInteger<quint32> m_uiWriteCount;     /**< Holds the number of matrices pushed so far modulo m_uiCountRange. Only written by the producer.*/
+    QAtomicInt      m_iPopReleased;             /**< Holds whether a pop on an empty buffer should return immediately.*/
+    QAtomicInt      m_iPushReleased;            /**< Holds whether a push on a full buffer should return immediately.*/
+    QAtomicInt      m_iWaiting;                 /**< Holds the number of threads blocked in a wait condition.*/
+    QMutex          m_mutexWait;                /**< Holds the mutex for the wait conditions. Only used when a thread has to block.*/
+    QWaitCondition  m_condFree;                 /**< Holds the wait condition which is signaled when a matrix was popped.*/
+    QWaitCondition  m_condUsed;                 /**< Holds the wait condition which is signaled when a matrix was pushed.*/
     bool            m_bPause;
 };
 
@@ -213,12 +288,15 @@ CircularMatrixBuffer<_Tp>::CircularMatrixBuffer(unsigned int uiMaxNumMatrices, u
 , m_uiMaxNumMatrices(uiMaxNumMatrices)
 , m_uiRows(uiRows)
 , m_uiCols(uiCols)
-, m_uiMaxNumElements(m_uiMaxNumMatrices*m_uiRows*m_uiCols)
+, m_uiMatrixSize(m_uiRows*m_uiCols)
+, m_uiMaxNumElements(m_uiMaxNumMatrices*m_uiMatrixSize)
+, m_uiCountRange(2*m_uiMaxNumMatrices)
 , m_pBuffer(new _Tp[m_uiMaxNumElements])
-, m_iCurrentReadIndex(-1)
-, m_iCurrentWriteIndex(-1)
-, m_pFreeElements(new QSemaphore(m_uiMaxNumElements))
-, m_pUsedElements(new QSemaphore(0))
+, m_uiReadCount(0)
+, m_uiWriteCount(0)
+, m_iPopReleased(0)
+, m_iPushReleased(0)
+, m_iWaiting(0)
 , m_bPause(false)
 {
 
@@ -230,8 +308,6 @@ CircularMatrixBuffer<_Tp>::CircularMatrixBuffer(unsigned int uiMaxNumMatrices, u
 template<typename _Tp>
 CircularMatrixBuffer<_Tp>::~CircularMatrixBuffer()
 {
-    delete m_pFreeElements;
-    delete m_pUsedElements;
     delete [] m_pBuffer;
 }
 
@@ -243,13 +319,19 @@ inline void CircularMatrixBuffer<_Tp>::push(const Matrix<_Tp, Dynamic, Dynamic>*
 {
     if(!m_bPause)
     {
-        unsigned int t_size = pMatrix->size();
-        if(t_size == m_uiRows*m_uiCols)
+        if((unsigned int)pMatrix->size() == m_uiMatrixSize)
         {
-            m_pFreeElements->acquire(t_size);
-            for(unsigned int i = 0; i < t_size; ++i)
-                m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = pMatrix->data()[i];
-            m_pUsedElements->release(t_size);
+            if(!waitForFree())
+                return;
+
+            quint32 t_uiWrite = m_uiWriteCount.load();
+            memcpy(slot(t_uiWrite), pMatrix->data(), m_uiMatrixSize*sizeof(_Tp));
+
+            //New data is available, a released pop does not need to return a zero matrix anymore
+            m_iPopReleased.storeRelease(0);
+            m_uiWriteCount.storeRelease(nextCount(t_uiWrite));
+
+            notify(m_condUsed);
         }
     //    else
     //        printf("Error: Matrix not appended to CircularMatrixBuffer - wrong dimensions\n");
@@ -264,44 +346,166 @@ inline Matrix<_Tp, Dynamic, Dynamic> CircularMatrixBuffer<_Tp>::pop()
 {
     Matrix<_Tp, Dynamic, Dynamic> matrix(m_uiRows, m_uiCols);
 
-    if(!m_bPause)
+    popInto(matrix);
+
+    return matrix;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void CircularMatrixBuffer<_Tp>::popInto(Matrix<_Tp, Dynamic, Dynamic>& matrix)
+{
+    if((unsigned int)matrix.rows() != m_uiRows || (unsigned int)matrix.cols() != m_uiCols)
+        matrix.resize(m_uiRows, m_uiCols);
+
+    while(!m_bPause && waitForUsed())
     {
-        m_pUsedElements->acquire(m_uiRows*m_uiCols);
-        for(quint32 i = 0; i < m_uiRows*m_uiCols; ++i)
-            matrix.data()[i] = m_pBuffer[mapIndex(m_iCurrentReadIndex)];
-        m_pFreeElements->release(m_uiRows*m_uiCols);
+        quint32 t_uiRead = m_uiReadCount.loadAcquire();
+        memcpy(matrix.data(), slot(t_uiRead), m_uiMatrixSize*sizeof(_Tp));
+
+        //A concurrent clear() moved the read counter, the slot may have been overwritten meanwhile -> pop again
+        if(!m_uiReadCount.testAndSetOrdered(t_uiRead, nextCount(t_uiRead)))
+            continue;
+
+        //Space is available, a released push does not need to drop its matrix anymore
+        m_iPushReleased.storeRelease(0);
+
+        notify(m_condFree);
+        return;
     }
-    else
-        matrix.setZero();
 
-    return matrix;
+    matrix.setZero();
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool CircularMatrixBuffer<_Tp>::waitForFree()
+{
+    //The counts are reloaded on every check, clear() may advance the read count while this thread waits
+
+    //Spin shortly before falling back to the wait condition
+    for(int i = 0; i < 64; ++i)
+    {
+        if(count() < m_uiMaxNumMatrices)
+            return true;
+        if(m_iPushReleased.loadAcquire() && m_iPushReleased.fetchAndStoreOrdered(0))
+            return false;
+        QThread::yieldCurrentThread();
+    }
+
+    QMutexLocker locker(&m_mutexWait);
+    m_iWaiting.fetchAndAddOrdered(1);
+    bool t_bFree = true;
+    while(count() >= m_uiMaxNumMatrices)
+    {
+        if(m_iPushReleased.fetchAndStoreOrdered(0))
+        {
+            t_bFree = false;
+            break;
+        }
+        m_condFree.wait(&m_mutexWait, 100);
+    }
+    m_iWaiting.fetchAndAddOrdered(-1);
+
+    return t_bFree;
 }
 
 
 //*************************************************************************************************************
 
 template<typename _Tp>
-inline unsigned int CircularMatrixBuffer<_Tp>::mapIndex(int& index)
+inline bool CircularMatrixBuffer<_Tp>::waitForUsed()
 {
-    int AuxIndex;
-    AuxIndex = ++index;
-    return index = AuxIndex % m_uiMaxNumElements;
+    //The counts are reloaded on every check, clear() may advance the read count while this thread waits
 
+    //Spin shortly before falling back to the wait condition
+    for(int i = 0; i < 64; ++i)
+    {
+        if(count() != 0)
+            return true;
+        if(m_iPopReleased.loadAcquire() && m_iPopReleased.fetchAndStoreOrdered(0))
+            return false;
+        QThread::yieldCurrentThread();
+    }
+
+    QMutexLocker locker(&m_mutexWait);
+    m_iWaiting.fetchAndAddOrdered(1);
+    bool t_bUsed = true;
+    while(count() == 0)
+    {
+        if(m_iPopReleased.fetchAndStoreOrdered(0))
+        {
+            t_bUsed = false;
+            break;
+        }
+        m_condUsed.wait(&m_mutexWait, 100);
+    }
+    m_iWaiting.fetchAndAddOrdered(-1);
+
+    return t_bUsed;
 }
 
 
 //*************************************************************************************************************
 
 template<typename _Tp>
-void CircularMatrixBuffer<_Tp>::clear()
+inline void CircularMatrixBuffer<_Tp>::notify(QWaitCondition& condition)
 {
-    delete m_pFreeElements;
-    m_pFreeElements = new QSemaphore(m_uiMaxNumElements);
-    delete m_pUsedElements;
-    m_pUsedElements = new QSemaphore(0);
+    //The ordered read pairs with the increment in the wait functions, so either the waiting thread sees the new
+    //count before it blocks or we see the waiting thread here.
+    if(m_iWaiting.fetchAndAddOrdered(0) > 0)
+    {
+        QMutexLocker locker(&m_mutexWait);
+        condition.wakeAll();
+    }
+}
+
+
+//*************************************************************************************************************
 
-    m_iCurrentReadIndex = -1;
-    m_iCurrentWriteIndex = -1;
+template<typename _Tp>
+inline quint32 CircularMatrixBuffer<_Tp>::nextCount(quint32 uiCount) const
+{
+    return uiCount + 1 == m_uiCountRange ? 0 : uiCount + 1;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 CircularMatrixBuffer<_Tp>::usedCount(quint32 uiWrite, quint32 uiRead) const
+{
+    return uiWrite >= uiRead ? uiWrite - uiRead : uiWrite + m_uiCountRange - uiRead;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline _Tp* CircularMatrixBuffer<_Tp>::slot(quint32 uiCount) const
+{
+    return m_pBuffer + (uiCount < m_uiMaxNumMatrices ? uiCount : uiCount - m_uiMaxNumMatrices)*m_uiMatrixSize;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+void CircularMatrixBuffer<_Tp>::clear()
+{
+    //Drop everything which was pushed so far, the producer keeps owning the write count. The read count never
+    //passes the write count, a pop which raced with this loses its compare and swap and pops again.
+    quint32 t_uiRead = m_uiReadCount.loadAcquire();
+    while(!m_uiReadCount.testAndSetOrdered(t_uiRead, m_uiWriteCount.loadAcquire()))
+        t_uiRead = m_uiReadCount.loadAcquire();
+
+    //The ring is empty now, wake a producer blocked on the full ring unconditionally. It rechecks the counts.
+    QMutexLocker locker(&m_mutexWait);
+    m_condFree.wakeAll();
 }
 
 
@@ -332,6 +536,17 @@ inline quint32 CircularMatrixBuffer<_Tp>::cols() const
 }
 
 
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 CircularMatrixBuffer<_Tp>::count() const
+{
+    //Read the read count first, it can only move towards the write count which is loaded afterwards
+    quint32 t_uiRead = m_uiReadCount.loadAcquire();
+    return usedCount(m_uiWriteCount.loadAcquire(), t_uiRead);
+}
+
+
 //*************************************************************************************************************
 
 template<typename _Tp>
@@ -346,15 +561,13 @@ inline void CircularMatrixBuffer<_Tp>::pause(bool bPause)
 template<typename _Tp>
 inline bool CircularMatrixBuffer<_Tp>::releaseFromPop()
 {
-   if((uint)m_pUsedElements->available() < m_uiRows*m_uiCols)
+    if(count() == 0)
     {
-        //The last matrix which is to be popped from the buffer is supposed to be a zero matrix
-        unsigned int t_size = m_uiRows*m_uiCols;
-        for(unsigned int i = 0; i < t_size; ++i)
-            m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
+        //The pop function returns a zero matrix instead of waiting for new data
+        m_iPopReleased.storeRelease(1);
 
-        //Release (create) values from m_pUsedElements so that the pop function can leave the acquire statement in the pop function
-        m_pUsedElements->release(m_uiRows*m_uiCols);
+        QMutexLocker locker(&m_mutexWait);
+        m_condUsed.wakeAll();
 
         return true;
     }
@@ -368,15 +581,13 @@ inline bool CircularMatrixBuffer<_Tp>::releaseFromPop()
 template<typename _Tp>
 inline bool CircularMatrixBuffer<_Tp>::releaseFromPush()
 {
-    if((uint)m_pFreeElements->available() < m_uiRows*m_uiCols)
+    if(count() >= m_uiMaxNumMatrices)
     {
-        //The last matrix which is to be pushed to the buffer is supposed to be a zero matrix
-        unsigned int t_size = m_uiRows*m_uiCols;
-        for(unsigned int i = 0; i < t_size; ++i)
-            m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
+        //The push function drops its matrix instead of waiting for free space
+        m_iPushReleased.storeRelease(1);
 
-        //Release (create) values from m_pFreeElements so that the push function can leave the acquire statement in the push function
-        m_pFreeElements->release(m_uiRows*m_uiCols);
+        QMutexLocker locker(&m_mutexWait);
+        m_condFree.wakeAll();
 
         return true;
     }
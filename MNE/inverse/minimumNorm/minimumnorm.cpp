@@ -50,6 +50,11 @@
 //=============================================================================================================
 
 #include <iostream>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 //*************************************************************************************************************
@@ -70,6 +75,77 @@ using namespace MNELIB;
 using namespace INVERSELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+const qint32 KERNEL_BLOCK_SOURCES = 128;    /**< Sources processed per kernel block, keeps the block result in cache */
+
+//=============================================================================================================
+/**
+* Applies the imaging kernel block by block: each block of kernel rows is multiplied with the data, pooled
+* over the three orientations (if bFreeOri) and noise normalized before the next block is touched.
+*
+* @param[in] matKernel      Imaging kernel
+* @param[in] matData        Sensor data
+* @param[in] bFreeOri       Whether the kernel rows come in xyz triplets which are pooled by their norm
+* @param[in] vecNoiseNorm   Noise normalization factors per source (n_sources), empty for none
+* @param[out] matOut        Source data, already sized [n_sources x n_times]
+*/
+template<typename T>
+void applyKernel(const Matrix<T,Dynamic,Dynamic> &matKernel,
+                 const Matrix<T,Dynamic,Dynamic> &matData,
+                 bool bFreeOri,
+                 const Matrix<T,Dynamic,1> &vecNoiseNorm,
+                 Matrix<T,Dynamic,Dynamic> &matOut)
+{
+    const qint32 nOri = bFreeOri ? 3 : 1;
+    const qint32 nSources = matOut.rows();
+    const qint32 nBlocks = (nSources + KERNEL_BLOCK_SOURCES - 1) / KERNEL_BLOCK_SOURCES;
+    const bool bNoiseNorm = vecNoiseNorm.size() > 0;
+
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        Matrix<T,Dynamic,Dynamic> matBlock;
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(static)
+        #endif
+        for(qint32 b = 0; b < nBlocks; ++b)
+        {
+            qint32 iFirst = b * KERNEL_BLOCK_SOURCES;
+            qint32 iCount = std::min(KERNEL_BLOCK_SOURCES, nSources - iFirst);
+
+            if(!bFreeOri)
+            {
+                matOut.middleRows(iFirst, iCount).noalias() = matKernel.middleRows(iFirst, iCount) * matData;
+            }
+            else
+            {
+                matBlock.resize(iCount * nOri, matData.cols());
+                matBlock.noalias() = matKernel.middleRows(iFirst * nOri, iCount * nOri) * matData;
+
+                for(qint32 i = 0; i < iCount; ++i)
+                    matOut.row(iFirst + i) = (matBlock.row(3*i).array().square()
+                                              + matBlock.row(3*i+1).array().square()
+                                              + matBlock.row(3*i+2).array().square()).sqrt();
+            }
+
+            if(bNoiseNorm)
+                matOut.middleRows(iFirst, iCount).array().colwise() *= vecNoiseNorm.segment(iFirst, iCount).array();
+        }
+    }
+}
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -78,6 +154,7 @@ using namespace INVERSELIB;
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, const QString method)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bUseFloatKernel(false)
 {
     this->setRegularization(lambda);
     this->setMethod(method);
@@ -88,6 +165,7 @@ MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lamb
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, bool dSPM, bool sLORETA)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bUseFloatKernel(false)
 {
     this->setRegularization(lambda);
     this->setMethod(dSPM, sLORETA);
@@ -201,44 +279,105 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
         return MNESourceEstimate();
     }
 
-    MatrixXd sol = K * data; //apply imaging kernel
+    MatrixXd sol;
+    if(!calculateInverse(data, sol))
+        return MNESourceEstimate();
+
+    return MNESourceEstimate(sol, m_vecVertices, tmin, tstep);
+}
+
+
+//*************************************************************************************************************
+
+bool MinimumNorm::calculateInverse(const MatrixXd &data, float tmin, float tstep, MNESourceEstimate &p_sourceEstimate) const
+{
+    if(!calculateInverse(data, p_sourceEstimate.data))
+        return false;
+
+    if(p_sourceEstimate.vertices.size() != m_vecVertices.size())
+        p_sourceEstimate.vertices = m_vecVertices;
+
+    p_sourceEstimate.tmin = tmin;
+    p_sourceEstimate.tstep = tstep;
+
+    if(p_sourceEstimate.times.size() != p_sourceEstimate.data.cols())
+        p_sourceEstimate.times.resize(p_sourceEstimate.data.cols());
+    for(qint32 i = 0; i < p_sourceEstimate.times.size(); ++i)
+        p_sourceEstimate.times[i] = tmin + i*tstep;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
 
-    if (inv.source_ori == FIFFV_MNE_FREE_ORI)
+bool MinimumNorm::calculateInverse(const MatrixXd &data, MatrixXd &matSourceOut) const
+{
+    if(!inverseSetup)
     {
-        printf("combining the current components...");
-        MatrixXd sol1(sol.rows()/3,sol.cols());
-        for(qint32 i = 0; i < sol.cols(); ++i)
-        {
-            VectorXd* tmp = MNEMath::combine_xyz(sol.block(0,i,sol.rows(),1));
-            sol1.block(0,i,sol.rows()/3,1) = tmp->cwiseSqrt();
-            delete tmp;
-        }
-        sol.resize(sol1.rows(),sol1.cols());
-        sol = sol1;
+        qWarning("Inverse not setup -> call doInverseSetup first!");
+        return false;
     }
 
-    if (m_bdSPM)
+    if(data.rows() != K.cols())
     {
-        printf("(dSPM)...");
-        sol = inv.noisenorm*sol;
+        qWarning("MinimumNorm::calculateInverse - Data has %d rows, kernel expects %d channels.", (int)data.rows(), (int)K.cols());
+        return false;
     }
-    else if (m_bsLORETA)
+
+    bool bFreeOri = inv.source_ori == FIFFV_MNE_FREE_ORI;
+    qint32 nSources = bFreeOri ? K.rows()/3 : K.rows();
+
+    if((m_bdSPM || m_bsLORETA) && m_vecNoiseNorm.size() != nSources)
     {
-        printf("(sLORETA)...");
-        sol = inv.noisenorm*sol;
+        qWarning("MinimumNorm::calculateInverse - Noise normalization has %d factors, expected %d sources.", (int)m_vecNoiseNorm.size(), nSources);
+        return false;
     }
-    printf("[done]\n");
 
-    //Results
-    VectorXi p_vecVertices(inv.src[0].vertno.size() + inv.src[1].vertno.size());
-    p_vecVertices << inv.src[0].vertno, inv.src[1].vertno;
+    if(matSourceOut.rows() != nSources || matSourceOut.cols() != data.cols())
+        matSourceOut.resize(nSources, data.cols());
 
-//    VectorXi p_vecVertices();
-//    for(qint32 h = 0; h < inv.src.size(); ++h)
-//        t_qListVertices.push_back(inv.src[h].vertno);
+    applyKernel<double>(K, data, bFreeOri, m_vecNoiseNorm, matSourceOut);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MinimumNorm::calculateInverse(const MatrixXd &data, MatrixXf &matSourceOut) const
+{
+    if(!inverseSetup || m_matKernelFloat.size() == 0)
+    {
+        qWarning("Float kernel not setup -> call setUseFloatKernel(true) and doInverseSetup first!");
+        return false;
+    }
+
+    if(data.rows() != m_matKernelFloat.cols())
+    {
+        qWarning("MinimumNorm::calculateInverse - Data has %d rows, kernel expects %d channels.", (int)data.rows(), (int)m_matKernelFloat.cols());
+        return false;
+    }
 
-    return MNESourceEstimate(sol, p_vecVertices, tmin, tstep);
+    bool bFreeOri = inv.source_ori == FIFFV_MNE_FREE_ORI;
+    qint32 nSources = bFreeOri ? m_matKernelFloat.rows()/3 : m_matKernelFloat.rows();
 
+    if((m_bdSPM || m_bsLORETA) && m_vecNoiseNormFloat.size() != nSources)
+    {
+        qWarning("MinimumNorm::calculateInverse - Noise normalization has %d factors, expected %d sources.", (int)m_vecNoiseNormFloat.size(), nSources);
+        return false;
+    }
+
+    if(matSourceOut.rows() != nSources || matSourceOut.cols() != data.cols())
+        matSourceOut.resize(nSources, data.cols());
+
+    //Converted into a per thread buffer, so concurrent callers of this const method do not share it. The buffer is
+    //only reallocated when the data dimensions change.
+    static thread_local MatrixXf t_matDataFloat;
+    t_matDataFloat = data.cast<float>();
+    applyKernel<float>(m_matKernelFloat, t_matDataFloat, bFreeOri, m_vecNoiseNormFloat, matSourceOut);
+
+    return true;
 }
 
 
@@ -256,6 +395,27 @@ void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
 
     std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
 
+    // The noise normalization is diagonal - keep only its factors for the fused apply
+    m_vecNoiseNorm.resize(0);
+    if((m_bdSPM || m_bsLORETA) && inv.noisenorm.rows() > 0)
+    {
+        m_vecNoiseNorm = VectorXd::Zero(inv.noisenorm.rows());
+        for(qint32 k = 0; k < inv.noisenorm.outerSize(); ++k)
+            for(SparseMatrix<double>::InnerIterator it(inv.noisenorm,k); it; ++it)
+                if(it.row() == it.col())
+                    m_vecNoiseNorm[it.row()] = it.value();
+    }
+    else if(m_bdSPM || m_bsLORETA)
+    {
+        qWarning("MinimumNorm::doInverseSetup - No noise normalization available for %s.", m_sMethod.toLatin1().constData());
+    }
+    m_vecNoiseNormFloat = m_vecNoiseNorm.cast<float>();
+
+    m_matKernelFloat = m_bUseFloatKernel ? MatrixXf(K.cast<float>()) : MatrixXf();
+
+    m_vecVertices.resize(inv.src[0].vertno.size() + inv.src[1].vertno.size());
+    m_vecVertices << inv.src[0].vertno, inv.src[1].vertno;
+
     inverseSetup = true;
 }
 
@@ -327,3 +487,14 @@ void MinimumNorm::setRegularization(float lambda)
 {
     m_fLambda = lambda;
 }
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::setUseFloatKernel(bool useFloat)
+{
+    m_bUseFloatKernel = useFloat;
+
+    if(inverseSetup)
+        m_matKernelFloat = m_bUseFloatKernel ? MatrixXf(K.cast<float>()) : MatrixXf();
+}
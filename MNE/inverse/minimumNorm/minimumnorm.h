@@ -127,6 +127,44 @@ public:
 
     virtual MNESourceEstimate calculateInverse(const MatrixXd &data, float tmin, float tstep) const;
 
+    //=========================================================================================================
+    /**
+    * Streaming apply path: applies the imaging kernel, pools free orientations and applies the dSPM/sLORETA
+    * noise normalization in one blocked pass over the kernel rows. The result is written into the caller
+    * owned buffer, which is only reallocated when its dimensions change.
+    *
+    * @param[in] data               Sensor data, picked to the channels of the inverse operator.
+    * @param[out] matSourceOut      The source estimate data [n_sources x n_times].
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool calculateInverse(const MatrixXd &data, MatrixXd &matSourceOut) const;
+
+    //=========================================================================================================
+    /**
+    * Single precision variant of the streaming apply path. Requires the float kernel, see setUseFloatKernel.
+    *
+    * @param[in] data               Sensor data, picked to the channels of the inverse operator.
+    * @param[out] matSourceOut      The source estimate data [n_sources x n_times].
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool calculateInverse(const MatrixXd &data, MatrixXf &matSourceOut) const;
+
+    //=========================================================================================================
+    /**
+    * Streaming apply path which fills a caller owned source estimate. Its data and times buffers are only
+    * reallocated when the number of samples changes.
+    *
+    * @param[in] data                   Sensor data, picked to the channels of the inverse operator.
+    * @param[in] tmin                   Time of the first sample.
+    * @param[in] tstep                  Time step between two samples.
+    * @param[out] p_sourceEstimate      The source estimate to fill.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool calculateInverse(const MatrixXd &data, float tmin, float tstep, MNESourceEstimate &p_sourceEstimate) const;
+
     virtual void doInverseSetup(qint32 nave, bool pick_normal = false);
 
 
@@ -167,6 +205,14 @@ public:
     */
     void setRegularization(float lambda);
 
+    //=========================================================================================================
+    /**
+    * Keep a single precision copy of the imaging kernel for the float streaming apply path.
+    *
+    * @param[in] useFloat   Whether to keep the float kernel
+    */
+    void setUseFloatKernel(bool useFloat);
+
     inline MatrixXd& getKernel();
 
 private:
@@ -183,6 +229,12 @@ private:
     Label label;                            /**< The corresponding labels */
     MatrixXd K;                             /**< Imaging kernel */
 
+    bool m_bUseFloatKernel;                 /**< Keep the single precision kernel */
+    MatrixXf m_matKernelFloat;              /**< Single precision imaging kernel */
+    VectorXd m_vecNoiseNorm;                /**< Diagonal of the noise normalization, empty for MNE */
+    VectorXf m_vecNoiseNormFloat;           /**< Single precision diagonal of the noise normalization */
+    VectorXi m_vecVertices;                 /**< Vertices of both hemispheres */
+
 };
 
 //*************************************************************************************************************
@@ -41,6 +41,10 @@
 
 #include <utils/mnemath.h>
 
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -478,28 +482,8 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         clock_t start_subcorr, end_subcorr;
         start_subcorr = clock();
 
-        //Multithreading correlation calculation
-        #ifdef _OPENMP
-        #pragma omp parallel num_threads(m_iMaxNumThreads)
-        #endif
-        {
-        #ifdef _OPENMP
-        #pragma omp for
-        #endif
-            for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
-            {
-                //new Version: calculate matrix multiplication before
-                //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
-
-                int idx1 = m_ppPairIdxCombinations[i]->x1;
-                int idx2 = m_ppPairIdxCombinations[i]->x2;
-
-                RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
-
-                t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
-            }
-        }
+        //Correlation scan over all pair combinations
+        scanPairCombinations(t_matProj_LeadField, t_matU_B, t_vecRoh);
 
 
 //         if(r==0)
@@ -751,6 +735,96 @@ double RapMusic::subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vecto
 }
 
 
+//*************************************************************************************************************
+
+double RapMusic::subcorr(const Matrix6T& p_matGram, const Matrix6T& p_matCorGram)
+{
+    //Singular values of G are the square roots of the eigenvalues of G^T G
+    Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigGram(p_matGram);
+
+    //Whitening on the retained components (lt. Mosher 1998 only retain nonzero singular values), the
+    //columns of dropped components stay zero and do not contribute to the largest eigenvalue
+    Matrix6T t_matW = Matrix6T::Zero();
+    for(int i = 0; i < 6; ++i)
+        if(t_eigGram.eigenvalues()(i) > 0.00001*0.00001)
+            t_matW.col(i) = t_eigGram.eigenvectors().col(i) / sqrt(t_eigGram.eigenvalues()(i));
+
+    //C^T C = U_A^T U_B U_B^T U_A with U_A = G W
+    Matrix6T t_matCor = t_matW.transpose() * p_matCorGram * t_matW;
+
+    Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigCor(t_matCor, Eigen::EigenvaluesOnly);
+
+    double t_dMaxEig = t_eigCor.eigenvalues()(5);
+
+    return t_dMaxEig > 0 ? sqrt(t_dMaxEig) : 0;
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::scanPairCombinations(const MatrixXT& p_matProj_LeadField, const MatrixXT& p_matU_B, VectorXT& p_vecRoh) const
+{
+    const int t_iBlockSize = 32;
+    const int t_iNumPoints = m_iNumGridPoints;
+    const int t_iNumBlocks = (t_iNumPoints + t_iBlockSize - 1) / t_iBlockSize;
+
+    //Projection of every grid point gain onto the signal subspace U_B^T G
+    MatrixXT t_matY = p_matU_B.transpose() * p_matProj_LeadField;
+
+    //Per grid point Gram G_i^T G_i
+    MatrixXT t_matPointGram(3, 3*t_iNumPoints);
+    for(int i = 0; i < t_iNumPoints; ++i)
+        t_matPointGram.middleCols(3*i, 3).noalias() = p_matProj_LeadField.middleCols(3*i, 3).transpose() * p_matProj_LeadField.middleCols(3*i, 3);
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
+    #endif
+    {
+        MatrixXT t_matBlockGram;
+        Matrix6T t_matGram;
+        Matrix6T t_matCorGram;
+        MatrixX6T t_matY_pair(t_matY.rows(), 6);
+
+    #ifdef _OPENMP
+    #pragma omp for schedule(dynamic)
+    #endif
+        for(int b = 0; b < t_iNumBlocks; ++b)
+        {
+            int t_iFirst = b * t_iBlockSize;
+            int t_iCount = std::min(t_iBlockSize, t_iNumPoints - t_iFirst);
+
+            //G_block^T G_j for all grid points j >= first of block
+            t_matBlockGram.noalias() = p_matProj_LeadField.middleCols(3*t_iFirst, 3*t_iCount).transpose()
+                    * p_matProj_LeadField.rightCols(3*(t_iNumPoints - t_iFirst));
+
+            for(int idx1 = t_iFirst; idx1 < t_iFirst + t_iCount; ++idx1)
+            {
+                int t_iRow = 3*(idx1 - t_iFirst);
+                //Position of (idx1, idx1) in the pair combinations (see getPointPair)
+                int t_iCombIdx = idx1*t_iNumPoints - idx1*(idx1-1)/2;
+
+                t_matGram.block<3,3>(0,0) = t_matPointGram.middleCols(3*idx1, 3);
+                t_matY_pair.leftCols(3) = t_matY.middleCols(3*idx1, 3);
+
+                for(int idx2 = idx1; idx2 < t_iNumPoints; ++idx2, ++t_iCombIdx)
+                {
+                    int t_iCol = 3*(idx2 - t_iFirst);
+
+                    t_matGram.block<3,3>(3,3) = t_matPointGram.middleCols(3*idx2, 3);
+                    t_matGram.block<3,3>(0,3) = t_matBlockGram.block(t_iRow, t_iCol, 3, 3);
+                    t_matGram.block<3,3>(3,0) = t_matGram.block<3,3>(0,3).transpose();
+
+                    t_matY_pair.rightCols(3) = t_matY.middleCols(3*idx2, 3);
+                    t_matCorGram.noalias() = t_matY_pair.transpose() * t_matY_pair;
+
+                    p_vecRoh(t_iCombIdx) = RapMusic::subcorr(t_matGram, t_matCorGram);
+                }
+            }
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 void RapMusic::calcA_k_1(   const MatrixX6T& p_matG_k_1,
@@ -228,6 +228,32 @@ protected:
     */
     static double subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vector6T& p_vec_phi_k_1);
 
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of a dipole pair in closed form from 6 x 6 Gram matrices, equivalent to
+    * subcorr(p_matProj_G, p_matU_B) with G = p_matProj_G: the correlation is the square root of the largest
+    * eigenvalue of G^T U_B U_B^T G restricted to the range of G^T G (components with singular values of G
+    * below epsilon = 10^-5 are dropped as in useFullRank).
+    *
+    * @param[in] p_matGram      G^T G of the projected Lead Field combination.
+    * @param[in] p_matCorGram   G^T U_B U_B^T G of the projected Lead Field combination.
+    * @return   The maximal correlation c_1 of the subspace correlation.
+    */
+    static double subcorr(const Matrix6T& p_matGram, const Matrix6T& p_matCorGram);
+
+    //=========================================================================================================
+    /**
+    * Scans all dipole pair combinations. The grid points are processed in blocks: for each block the Gram
+    * products of its projected gains with all following grid points are computed by one matrix product, and
+    * the pair correlations are evaluated with the closed form subcorr. Every correlation is computed
+    * independently of the thread partitioning, so the result is reproducible for any number of threads.
+    *
+    * @param[in] p_matProj_LeadField    The projected Lead Field.
+    * @param[in] p_matU_B               The matrix U is the subspace projection of the orthogonal projected Phi_s
+    * @param[out] p_vecRoh              The correlation of each pair combination.
+    */
+    void scanPairCombinations(const MatrixXT& p_matProj_LeadField, const MatrixXT& p_matU_B, VectorXT& p_vecRoh) const;
+
     //=========================================================================================================
     /**
     * Calculates the accumulated manifold vectors A_{k1}
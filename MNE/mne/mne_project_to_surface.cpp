@@ -56,6 +56,8 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QtConcurrent>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -65,6 +67,15 @@
 #include <Eigen/Geometry>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <limits>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -79,6 +90,54 @@ using namespace Eigen;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace
+{
+
+const int BVH_LEAF_SIZE = 8;                /**< Maximal number of triangles in a leaf of the search tree */
+const int BVH_MAX_DEPTH = 64;               /**< Size of the traversal stack, the median split keeps the tree balanced */
+const int PROJECTION_CHUNK_SIZE = 64;       /**< Number of points projected by one worker */
+const float BVH_PRUNE_SLACK = 1.0001f;      /**< Relative tolerance of the squared box distance test */
+
+//=============================================================================================================
+/**
+* Squared distance between a point and an axis aligned box, zero if the point lies inside.
+*/
+inline float boxDistSquared(const Vector3f &r, const Vector3f &boxMin, const Vector3f &boxMax)
+{
+    float dist2 = 0.0f;
+    for (int i = 0; i < 3; ++i)
+    {
+        float d = 0.0f;
+        if (r[i] < boxMin[i])
+        {
+            d = boxMin[i] - r[i];
+        }
+        else if (r[i] > boxMax[i])
+        {
+            d = r[i] - boxMax[i];
+        }
+        dist2 += d*d;
+    }
+    return dist2;
+}
+
+//=============================================================================================================
+/**
+* Orders triangle indices by the coordinate of their centroid along one axis.
+*/
+struct CentroidLess
+{
+    const MatrixX3f* pCentroids;
+    int iAxis;
+
+    bool operator()(int i, int j) const
+    {
+        return (*pCentroids)(i,iAxis) < (*pCentroids)(j,iAxis);
+    }
+};
+
+} // anonymous namespace
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -133,6 +192,8 @@ MNEProjectToSurface::MNEProjectToSurface(const MNEBemSurface &p_MNEBemSurf)
         }
     }
     det = (a.array()*b.array() - c.array()*c.array()).matrix();
+
+    initSearchTree();
 }
 
 
@@ -160,16 +221,76 @@ MNEProjectToSurface::MNEProjectToSurface(const MNESurface &p_MNESurf)
     }
 
     det = (a.array()*b.array() - c.array()*c.array()).matrix();
+
+    initSearchTree();
 }
 
 
 //*************************************************************************************************************
 
 bool MNEProjectToSurface::mne_find_closest_on_surface(const MatrixXf &r, const int np, MatrixXf &rTri,
-                                                      VectorXi &nearest, VectorXf &dist)
+                                                      VectorXi &nearest, VectorXf &dist) const
+{
+    nearest.resize(np);
+    dist.resize(np);
+    if (rTri.rows() != np || rTri.cols() != 3)
+    {
+        rTri.resize(np, 3);
+    }
+    if (this->r1.isZero(0) || m_vecBvhNodes.isEmpty())
+    {
+        qDebug() << "No surface loaded to make the projection./n";
+        return false;
+    }
+
+    QVector<ProjectionChunk> qVecChunks;
+    for (int k = 0; k < np; k += PROJECTION_CHUNK_SIZE)
+    {
+        ProjectionChunk chunk;
+        chunk.pSurface = this;
+        chunk.pR = &r;
+        chunk.pRTri = &rTri;
+        chunk.pNearest = &nearest;
+        chunk.pDist = &dist;
+        chunk.iFrom = k;
+        chunk.iTo = std::min(k + PROJECTION_CHUNK_SIZE, np);
+        chunk.iFailed = -1;
+        qVecChunks.append(chunk);
+    }
+
+    //Every chunk writes its own rows only, small sets are not worth the thread pool overhead
+    if (qVecChunks.size() > 1)
+    {
+        QtConcurrent::blockingMap(qVecChunks, projectChunk);
+    }
+    else if (qVecChunks.size() == 1)
+    {
+        projectChunk(qVecChunks[0]);
+    }
+
+    for (int i = 0; i < qVecChunks.size(); ++i)
+    {
+        if (qVecChunks[i].iFailed >= 0)
+        {
+            qDebug() << "The projection of point number " << qVecChunks[i].iFailed << " didn't work./n";
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEProjectToSurface::mne_find_closest_on_surface_linear(const MatrixXf &r, const int np, MatrixXf &rTri,
+                                                             VectorXi &nearest, VectorXf &dist) const
 {
     nearest.resize(np);
     dist.resize(np);
+    if (rTri.rows() != np || rTri.cols() != 3)
+    {
+        rTri.resize(np, 3);
+    }
     if (this->r1.isZero(0))
     {
         qDebug() << "No surface loaded to make the projection./n";
@@ -180,11 +301,7 @@ bool MNEProjectToSurface::mne_find_closest_on_surface(const MatrixXf &r, const i
     Vector3f rTriK;
     for (int k = 0; k < np; ++k)
     {
-        /*
-         * To do: decide_search_restriction for the use in an iterative closest point to plane algorithm
-         * For now it's OK to go through all triangles.
-         */
-        if (!this->mne_project_to_surface(r.row(k).transpose(), rTriK, bestTri, bestDist))
+        if (!this->mne_project_to_surface_linear(r.row(k).transpose(), rTriK, bestTri, bestDist))
         {
             qDebug() << "The projection of point number " << k << " didn't work./n";
             return false;
@@ -199,12 +316,204 @@ bool MNEProjectToSurface::mne_find_closest_on_surface(const MatrixXf &r, const i
 
 //*************************************************************************************************************
 
-bool MNEProjectToSurface::mne_project_to_surface(const Vector3f &r, Vector3f &rTri, int &bestTri, float &bestDist)
+void MNEProjectToSurface::projectChunk(ProjectionChunk &chunk)
+{
+    int bestTri = -1;
+    float bestDist = -1;
+    Vector3f rTriK;
+    for (int k = chunk.iFrom; k < chunk.iTo; ++k)
+    {
+        if (!chunk.pSurface->mne_project_to_surface(chunk.pR->row(k).transpose(), rTriK, bestTri, bestDist))
+        {
+            chunk.iFailed = k;
+            return;
+        }
+        chunk.pRTri->row(k) = rTriK.transpose();
+        (*chunk.pNearest)[k] = bestTri;
+        (*chunk.pDist)[k] = bestDist;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MNEProjectToSurface::initSearchTree()
+{
+    m_vecBvhNodes.clear();
+    m_vecTriOrder.clear();
+
+    const int ntri = a.size();
+    if (ntri == 0 || r1.isZero(0))
+    {
+        return;
+    }
+
+    //The search prunes with euclidean box distances, hence the plane distances must be euclidean as well
+    for (int i = 0; i < ntri; ++i)
+    {
+        float norm = nn.row(i).norm();
+        if (norm > 0.0f)
+        {
+            nn.row(i) /= norm;
+        }
+    }
+
+    MatrixX3f matCentroids = r1 + (r12 + r13) / 3.0f;
+
+    m_vecTriOrder.resize(ntri);
+    for (int i = 0; i < ntri; ++i)
+    {
+        m_vecTriOrder[i] = i;
+    }
+    m_vecBvhNodes.reserve(2 * (ntri / BVH_LEAF_SIZE + 1));
+
+    buildBvh(matCentroids, 0, ntri);
+}
+
+
+//*************************************************************************************************************
+
+int MNEProjectToSurface::buildBvh(const MatrixX3f &matCentroids, int first, int count)
+{
+    BvhNode node;
+    node.boxMin.setConstant(std::numeric_limits<float>::max());
+    node.boxMax.setConstant(-std::numeric_limits<float>::max());
+    for (int i = first; i < first + count; ++i)
+    {
+        int tri = m_vecTriOrder[i];
+        Vector3f r1Tri = r1.row(tri).transpose();
+        Vector3f r2Tri = r1Tri + r12.row(tri).transpose();
+        Vector3f r3Tri = r1Tri + r13.row(tri).transpose();
+        node.boxMin = node.boxMin.cwiseMin(r1Tri).cwiseMin(r2Tri).cwiseMin(r3Tri);
+        node.boxMax = node.boxMax.cwiseMax(r1Tri).cwiseMax(r2Tri).cwiseMax(r3Tri);
+    }
+    node.iFirst = first;
+    node.iCount = count;
+    node.iLeft = -1;
+    node.iRight = -1;
+
+    int iNode = m_vecBvhNodes.size();
+    m_vecBvhNodes.append(node);
+
+    if (count <= BVH_LEAF_SIZE)
+    {
+        return iNode;
+    }
+
+    //Median split along the longest box axis
+    CentroidLess less;
+    less.pCentroids = &matCentroids;
+    (node.boxMax - node.boxMin).maxCoeff(&less.iAxis);
+
+    int half = count / 2;
+    int* pOrder = m_vecTriOrder.data();
+    std::nth_element(pOrder + first, pOrder + first + half, pOrder + first + count, less);
+
+    int iLeft = buildBvh(matCentroids, first, half);
+    int iRight = buildBvh(matCentroids, first + half, count - half);
+
+    m_vecBvhNodes[iNode].iCount = 0;
+    m_vecBvhNodes[iNode].iLeft = iLeft;
+    m_vecBvhNodes[iNode].iRight = iRight;
+
+    return iNode;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEProjectToSurface::mne_project_to_surface(const Vector3f &r, Vector3f &rTri, int &bestTri, float &bestDist) const
+{
+    float p = 0, q = 0, p0 = 0, q0 = 0, dist0 = 0;
+    float bestAbsDist = std::numeric_limits<float>::max();
+    bestDist = 0;
+    bestTri = -1;
+
+    if (m_vecBvhNodes.isEmpty())
+    {
+        qDebug() << "No search tree available./n";
+        return false;
+    }
+
+    const BvhNode* pNodes = m_vecBvhNodes.constData();
+    int stack[BVH_MAX_DEPTH];
+    int iStack = 0;
+    stack[iStack++] = 0;
+
+    while (iStack > 0)
+    {
+        const BvhNode &node = pNodes[stack[--iStack]];
+
+        //Ties are resolved towards the lower triangle index below, so only boxes which are farther away by
+        //more than the rounding error of the triangle distances are skipped
+        if (bestTri >= 0 && boxDistSquared(r, node.boxMin, node.boxMax) > BVH_PRUNE_SLACK*bestAbsDist*bestAbsDist)
+        {
+            continue;
+        }
+
+        if (node.iCount > 0)
+        {
+            for (int i = node.iFirst; i < node.iFirst + node.iCount; ++i)
+            {
+                int tri = m_vecTriOrder[i];
+                if (!this->nearest_triangle_point(r, tri, p0, q0, dist0))
+                {
+                    qDebug() << "The projection on triangle " << tri << " didn't work./n";
+                    return false;
+                }
+
+                float absDist0 = fabs(dist0);
+                if ((bestTri < 0) || (absDist0 < bestAbsDist) || (absDist0 == bestAbsDist && tri < bestTri))
+                {
+                    bestDist = dist0;
+                    bestAbsDist = absDist0;
+                    p = p0;
+                    q = q0;
+                    bestTri = tri;
+                }
+            }
+        }
+        else
+        {
+            //Push the farther child first so that the nearer one is visited next
+            float distLeft = boxDistSquared(r, pNodes[node.iLeft].boxMin, pNodes[node.iLeft].boxMax);
+            float distRight = boxDistSquared(r, pNodes[node.iRight].boxMin, pNodes[node.iRight].boxMax);
+            if (distLeft < distRight)
+            {
+                stack[iStack++] = node.iRight;
+                stack[iStack++] = node.iLeft;
+            }
+            else
+            {
+                stack[iStack++] = node.iLeft;
+                stack[iStack++] = node.iRight;
+            }
+        }
+    }
+
+    if (bestTri >= 0)
+    {
+        if (!this->project_to_triangle(rTri, p, q, bestTri))
+        {
+            qDebug() << "The coordinate transform to cartesian system didn't work./n";
+            return false;
+        }
+        return true;
+    }
+
+    qDebug() << "No best Triangle found./n";
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEProjectToSurface::mne_project_to_surface_linear(const Vector3f &r, Vector3f &rTri, int &bestTri, float &bestDist) const
 {
     float p = 0, q = 0, p0 = 0, q0 = 0, dist0 = 0;
     bestDist = 0;
     bestTri = -1;
-    for (int tri = 0; tri < a .size(); ++tri)
+    for (int tri = 0; tri < a.size(); ++tri)
     {
         if (!this->nearest_triangle_point(r, tri, p0, q0, dist0))
         {
@@ -238,7 +547,7 @@ bool MNEProjectToSurface::mne_project_to_surface(const Vector3f &r, Vector3f &rT
 
 //*************************************************************************************************************
 
-bool MNEProjectToSurface::nearest_triangle_point(const Vector3f &r, const int tri, float &p, float &q, float &dist)
+bool MNEProjectToSurface::nearest_triangle_point(const Vector3f &r, const int tri, float &p, float &q, float &dist) const
 {
     //Calculate some helpers
     Vector3f rr = r - this->r1.row(tri).transpose(); //Vector from triangle corner #1 to r
@@ -347,7 +656,7 @@ bool MNEProjectToSurface::nearest_triangle_point(const Vector3f &r, const int tr
 
 //*************************************************************************************************************
 
-bool MNEProjectToSurface::project_to_triangle(Vector3f &rTri, const float p, const float q, const int tri)
+bool MNEProjectToSurface::project_to_triangle(Vector3f &rTri, const float p, const float q, const int tri) const
 {
     rTri = this->r1.row(tri) + p*this->r12.row(tri) + q*this->r13.row(tri);
     return true;
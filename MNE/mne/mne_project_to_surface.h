@@ -51,6 +51,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -122,7 +123,8 @@ public:
 
     //=========================================================================================================
     /**
-     * Projects a set of points r on the Surface
+     * Projects a set of points r on the Surface. The nearest triangle of every point is searched in the
+     * bounding volume hierarchy built by the constructor, larger point sets are processed in parallel.
      *
      * @brief mne_find_closest_on_surface
      *
@@ -135,14 +137,87 @@ public:
      * @return true if succeeded, false otherwise
      */
     bool mne_find_closest_on_surface(const Eigen::MatrixXf &r, const int np, Eigen::MatrixXf &rTri,
-                                     Eigen::VectorXi &nearest, Eigen::VectorXf &dist);
+                                     Eigen::VectorXi &nearest, Eigen::VectorXf &dist) const;
+
+    //=========================================================================================================
+    /**
+     * Projects a set of points r on the Surface by scanning all triangles for every point. Gives the same
+     * result as mne_find_closest_on_surface and serves as its reference.
+     *
+     * @brief mne_find_closest_on_surface_linear
+     *
+     * @param[in] r         Set of pionts, which are to be projectied.
+     * @param[in] np        number of points
+     * @param[out] rTri     set of points on the surface
+     * @param[out] nearest  Triangle of the new point
+     * @param[out] dist     Distance between r and rTri
+     *
+     * @return true if succeeded, false otherwise
+     */
+    bool mne_find_closest_on_surface_linear(const Eigen::MatrixXf &r, const int np, Eigen::MatrixXf &rTri,
+                                            Eigen::VectorXi &nearest, Eigen::VectorXf &dist) const;
 
 protected:
 
 private:
+    /**
+    * Node of the bounding volume hierarchy over the surface triangles. Leaves reference the range
+    * [iFirst, iFirst+iCount) of m_vecTriOrder, inner nodes their two children.
+    */
+    struct BvhNode {
+        Eigen::Vector3f boxMin;     /**< Lower corner of the axis aligned bounding box */
+        Eigen::Vector3f boxMax;     /**< Upper corner of the axis aligned bounding box */
+        int iFirst;                 /**< First entry in m_vecTriOrder (leaves only) */
+        int iCount;                 /**< Number of triangles, 0 for inner nodes */
+        int iLeft;                  /**< Index of the left child (inner nodes only) */
+        int iRight;                 /**< Index of the right child (inner nodes only) */
+    };
+
+    /**
+    * Range of query points which is projected by one worker of mne_find_closest_on_surface.
+    */
+    struct ProjectionChunk {
+        const MNEProjectToSurface* pSurface;    /**< The surface to project on */
+        const Eigen::MatrixXf* pR;              /**< The query points */
+        Eigen::MatrixXf* pRTri;                 /**< The projected points */
+        Eigen::VectorXi* pNearest;              /**< The nearest triangles */
+        Eigen::VectorXf* pDist;                 /**< The distances */
+        int iFrom;                              /**< First query point of this chunk */
+        int iTo;                                /**< One past the last query point of this chunk */
+        int iFailed;                            /**< First point which could not be projected, -1 if none */
+    };
+
     //=========================================================================================================
     /**
-     * Projects a point r on the Surface
+     * Projects all points of a chunk. Used as the map function of mne_find_closest_on_surface.
+     *
+     * @param[in, out] chunk    The chunk to process.
+     */
+    static void projectChunk(ProjectionChunk &chunk);
+
+    //=========================================================================================================
+    /**
+     * Normalizes the triangle normals and builds the bounding volume hierarchy over the triangles.
+     * Called once by the constructors.
+     */
+    void initSearchTree();
+
+    //=========================================================================================================
+    /**
+     * Recursively builds the bounding volume hierarchy over the triangles m_vecTriOrder[first..first+count).
+     *
+     * @param[in] matCentroids  Triangle centroids used to split the nodes.
+     * @param[in] first         First entry in m_vecTriOrder.
+     * @param[in] count         Number of triangles.
+     *
+     * @return the index of the created node in m_vecBvhNodes.
+     */
+    int buildBvh(const Eigen::MatrixX3f &matCentroids, int first, int count);
+
+    //=========================================================================================================
+    /**
+     * Projects a point r on the Surface. The bounding volume hierarchy is traversed nearest box first and
+     * subtrees whose bounding box is farther away than the best triangle found so far are skipped.
      *
      * @brief mne_project_to_surface
      *
@@ -153,7 +228,22 @@ private:
      *
      * @return true if succeeded, false otherwise
      */
-    bool mne_project_to_surface(const Eigen::Vector3f &r, Eigen::Vector3f &rTri, int &bestTri, float &bestDist);
+    bool mne_project_to_surface(const Eigen::Vector3f &r, Eigen::Vector3f &rTri, int &bestTri, float &bestDist) const;
+
+    //=========================================================================================================
+    /**
+     * Projects a point r on the Surface by scanning all triangles.
+     *
+     * @brief mne_project_to_surface_linear
+     *
+     * @param[in] r         Piont, which is to be projectied.
+     * @param[out] rTri     Point on the surface
+     * @param[out] bestTri  Triangle of the new point
+     * @param[out] bestDist Distance between r and rTri.
+     *
+     * @return true if succeeded, false otherwise
+     */
+    bool mne_project_to_surface_linear(const Eigen::Vector3f &r, Eigen::Vector3f &rTri, int &bestTri, float &bestDist) const;
 
     //=========================================================================================================
     /**
@@ -169,7 +259,7 @@ private:
      *
      * @return true if succeeded, false otherwise
      */
-    bool nearest_triangle_point(const Eigen::Vector3f &r, const int tri, float &p, float &q, float &dist);
+    bool nearest_triangle_point(const Eigen::Vector3f &r, const int tri, float &p, float &q, float &dist) const;
 
     //=========================================================================================================
     /**
@@ -184,7 +274,7 @@ private:
      *
      * @return true if succeeded, false otherwise
      */
-    bool project_to_triangle(Eigen::Vector3f &rTri, const float p, const float q, const int tri);
+    bool project_to_triangle(Eigen::Vector3f &rTri, const float p, const float q, const int tri) const;
 
     Eigen::MatrixX3f r1;         /**< Cartesian Vector to the first triangel corner */
     Eigen::MatrixX3f r12;        /**< Cartesian Vector from the first to the second triangel corner */
@@ -194,6 +284,9 @@ private:
     Eigen::VectorXf b;           /**< r13*r13 */
     Eigen::VectorXf c;           /**< r12*r13 */
     Eigen::VectorXf det;         /**< Determinant of the Matrix [a c, c b] */
+
+    QVector<BvhNode> m_vecBvhNodes;  /**< Bounding volume hierarchy over the triangles, the root is the first node */
+    QVector<int> m_vecTriOrder;      /**< Triangle indices ordered such that every leaf covers a contiguous range */
 };
 
 
@@ -151,6 +151,9 @@ void RtClient::run()
     // set data client alias -> for convinience (optional)
     t_dataClient.setClientAlias(m_sClientAlias); // used in option 2 later on
 
+    // request native float buffers, older servers keep sending fiff tags
+    t_dataClient.setDataFormat(FIFFV_MNE_RT_DATA_FORMAT_FLOAT32);
+
 //    // example commands
 //    t_cmdClient["help"].send();
 //    t_cmdClient.waitForDataAvailable(1000);
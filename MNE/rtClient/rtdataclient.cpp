@@ -43,6 +43,22 @@
 #include "rtdataclient.h"
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -51,6 +67,21 @@
 using namespace RTCLIENTLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+const qint32 MAX_PACKED_BUFFER_SIZE = 256*1024*1024;   /**< Upper limit of a packed buffer payload in bytes */
+const qint32 MAX_PACKED_BUFFER_CHANNELS = 65536;        /**< Upper limit of the channel count of a packed buffer */
+const qint32 MAX_PACKED_BUFFER_SAMPLES = 1024*1024;     /**< Upper limit of the sample count of a packed buffer */
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -59,6 +90,7 @@ using namespace RTCLIENTLIB;
 RtDataClient::RtDataClient(QObject *parent)
 : QTcpSocket(parent)
 , m_clientID(-1)
+, m_iDataFormat(FIFFV_MNE_RT_DATA_FORMAT_FIFF)
 {
     getClientId();
 }
@@ -78,6 +110,7 @@ void RtDataClient::disconnectFromHost()
 {
     QTcpSocket::disconnectFromHost();
     m_clientID = -1;
+    m_iDataFormat = FIFFV_MNE_RT_DATA_FORMAT_FIFF;
 }
 
 
@@ -363,6 +396,40 @@ void RtDataClient::readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t&
 //        data = [];
 
     FiffStream t_fiffStream(this);
+
+    //
+    // Packed buffers are decoded without creating a tag
+    //
+    while(this->bytesAvailable() < 16)
+        this->waitForReadyRead(10);
+
+    uchar t_header[16];
+    this->peek(reinterpret_cast<char*>(t_header), 16);
+
+    if(qFromBigEndian<qint32>(t_header) == FIFF_MNE_RT_DATA_BUFFER)
+    {
+        qint32 t_iDataSize = qFromBigEndian<qint32>(t_header + 8);
+
+        //Validate the announced size before waiting for or allocating it. The header is consumed, the stream can't be resynchronized.
+        if(t_iDataSize < 12 || t_iDataSize > MAX_PACKED_BUFFER_SIZE)
+        {
+            printf("Error: Packed buffer with invalid size %d received.\n", t_iDataSize);
+            this->read(reinterpret_cast<char*>(t_header), 16);
+            kind = FIFF_MNE_RT_DATA_BUFFER;
+            return;
+        }
+
+        while(this->bytesAvailable() < 16 + t_iDataSize)
+            this->waitForReadyRead(10);
+
+        m_qPackedBuffer.resize(t_iDataSize);
+        this->read(reinterpret_cast<char*>(t_header), 16);
+        this->read(m_qPackedBuffer.data(), t_iDataSize);
+
+        kind = decodePackedBuffer(data) ? FIFF_DATA_BUFFER : FIFF_MNE_RT_DATA_BUFFER;
+        return;
+    }
+
     //
     // Find the start
     //
@@ -375,13 +442,133 @@ void RtDataClient::readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t&
     if(kind == FIFF_DATA_BUFFER)
     {
         qint32 nSamples = (t_pTag->size()/4)/p_nChannels;
-        data = MatrixXf(Map< MatrixXf >(t_pTag->toFloat(), p_nChannels, nSamples));
+        data = Map< MatrixXf >(t_pTag->toFloat(), p_nChannels, nSamples);
     }
 //        else
 //            data = tag.data;
 }
 
 
+//*************************************************************************************************************
+
+bool RtDataClient::decodePackedBuffer(MatrixXf& data)
+{
+    const uchar* t_pIn = reinterpret_cast<const uchar*>(m_qPackedBuffer.constData());
+    const qint32 t_iSize = m_qPackedBuffer.size();
+
+    if(t_iSize < 12)
+        return false;
+
+    qint32 t_iFormat = qFromLittleEndian<qint32>(t_pIn);
+    qint32 t_iNChan = qFromLittleEndian<qint32>(t_pIn + 4);
+    qint32 t_iNSamp = qFromLittleEndian<qint32>(t_pIn + 8);
+    t_pIn += 12;
+
+    qint32 t_iBytesPerSample = 0;
+    switch(t_iFormat)
+    {
+        case FIFFV_MNE_RT_DATA_FORMAT_FLOAT32:
+            t_iBytesPerSample = 4;
+            break;
+        case FIFFV_MNE_RT_DATA_FORMAT_INT16:
+            t_iBytesPerSample = 2;
+            break;
+        case FIFFV_MNE_RT_DATA_FORMAT_INT24:
+            t_iBytesPerSample = 3;
+            break;
+        default:
+            printf("RtDataClient: unknown data format %d\n", t_iFormat);
+            return false;
+    }
+
+    if(t_iNChan <= 0 || t_iNChan > MAX_PACKED_BUFFER_CHANNELS || t_iNSamp < 0 || t_iNSamp > MAX_PACKED_BUFFER_SAMPLES)
+    {
+        printf("RtDataClient: malformed data buffer (%d channels, %d samples)\n", t_iNChan, t_iNSamp);
+        return false;
+    }
+
+    //The bounds above keep the 64 bit size computation exact, the header values must describe the received bytes
+    const qint64 t_iNEl = (qint64)t_iNChan*t_iNSamp;
+    const qint64 t_iScaleSize = t_iFormat == FIFFV_MNE_RT_DATA_FORMAT_FLOAT32 ? 0 : 4*(qint64)t_iNChan;
+    if((qint64)t_iSize != 12 + t_iScaleSize + t_iNEl*t_iBytesPerSample)
+    {
+        printf("RtDataClient: malformed data buffer\n");
+        return false;
+    }
+
+    if(data.rows() != t_iNChan || data.cols() != t_iNSamp)
+        data.resize(t_iNChan, t_iNSamp);
+
+    float* t_pData = data.data();
+
+    if(t_iFormat == FIFFV_MNE_RT_DATA_FORMAT_FLOAT32)
+    {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        memcpy(t_pData, t_pIn, (size_t)t_iNEl*sizeof(float));
+#else
+        for(qint64 i = 0; i < t_iNEl; ++i)
+        {
+            quint32 t_iBits = qFromLittleEndian<quint32>(t_pIn + 4*i);
+            memcpy(t_pData + i, &t_iBits, sizeof(float));
+        }
+#endif
+        return true;
+    }
+
+    VectorXf t_vecScale(t_iNChan);
+    for(qint32 c = 0; c < t_iNChan; ++c)
+    {
+        quint32 t_iBits = qFromLittleEndian<quint32>(t_pIn + 4*c);
+        memcpy(t_vecScale.data() + c, &t_iBits, sizeof(float));
+    }
+    t_pIn += t_iScaleSize;
+
+    for(qint32 s = 0; s < t_iNSamp; ++s)
+    {
+        float* t_pSample = t_pData + s*t_iNChan;
+        for(qint32 c = 0; c < t_iNChan; ++c)
+        {
+            qint32 t_iValue;
+            if(t_iBytesPerSample == 2)
+            {
+                t_iValue = (qint16)(t_pIn[0] | (t_pIn[1] << 8));
+            }
+            else
+            {
+                t_iValue = t_pIn[0] | (t_pIn[1] << 8) | (t_pIn[2] << 16);
+                if(t_iValue & 0x800000)
+                    t_iValue -= 0x1000000;
+            }
+            t_pSample[c] = t_iValue*t_vecScale[c];
+            t_pIn += t_iBytesPerSample;
+        }
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RtDataClient::setDataFormat(qint32 p_iFormat)
+{
+    FiffStream t_fiffStream(this);
+    t_fiffStream.write_rt_command(3, QString::number(p_iFormat));//MNE_RT.MNE_RT_SET_DATA_FORMAT
+    this->flush();
+
+    // Servers which do not know the command do not answer -> keep FIFF tags
+    if(this->bytesAvailable() < 16 && !this->waitForReadyRead(1000))
+        return false;
+
+    FiffTag::SPtr t_pTag;
+    FiffTag::read_rt_tag(&t_fiffStream, t_pTag);
+    if(t_pTag->kind == FIFF_MNE_RT_DATA_FORMAT)
+        m_iDataFormat = *t_pTag->toInt();
+
+    return m_iDataFormat == p_iFormat;
+}
+
+
 //*************************************************************************************************************
 
 void RtDataClient::setClientAlias(const QString &p_sAlias)
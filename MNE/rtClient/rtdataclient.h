@@ -61,6 +61,7 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QByteArray>
 #include <QSharedPointer>
 #include <QString>
 #include <QTcpSocket>
@@ -138,7 +139,9 @@ public:
 
     //=========================================================================================================
     /**
-    * Reads fiff measurement information of a data the connection
+    * Reads fiff measurement information of a data the connection. Packed buffers of a negotiated data format
+    * are decoded directly into data and reported as FIFF_DATA_BUFFER. data is only reallocated when the
+    * buffer size changes.
     *
     * @param[in] p_nChannels    Number of channels to reshape the received data
     * @param[out] data          The read data - ToDo change this to raw buffer data object
@@ -146,6 +149,25 @@ public:
     */
     void readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t& kind);
 
+    //=========================================================================================================
+    /**
+    * Requests a transport format for the raw buffers of this data client. Servers which do not support
+    * the request do not answer, in this case the client keeps receiving FIFF float tags.
+    *
+    * @param[in] p_iFormat  The requested format, one of FIFFV_MNE_RT_DATA_FORMAT_*
+    *
+    * @return true if the server acknowledged the requested format, false otherwise
+    */
+    bool setDataFormat(qint32 p_iFormat);
+
+    //=========================================================================================================
+    /**
+    * Returns the transport format of the raw buffers which was acknowledged by the server.
+    *
+    * @return the data format, one of FIFFV_MNE_RT_DATA_FORMAT_*
+    */
+    inline qint32 getDataFormat() const;
+
     //=========================================================================================================
     /**
     * Sets the alias of the data client
@@ -155,7 +177,19 @@ public:
     void setClientAlias(const QString &p_sAlias);
 
 private:
-    qint32 m_clientID;  /**< Corresponding client id of the data client at mne_rt_server */
+    //=========================================================================================================
+    /**
+    * Decodes the packed buffer in m_qPackedBuffer.
+    *
+    * @param[out] data      The decoded data
+    *
+    * @return true if the buffer was decoded, false if it is malformed
+    */
+    bool decodePackedBuffer(MatrixXf& data);
+
+    qint32 m_clientID;          /**< Corresponding client id of the data client at mne_rt_server */
+    qint32 m_iDataFormat;       /**< Acknowledged transport format of the raw buffers */
+    QByteArray m_qPackedBuffer; /**< Receive buffer for packed raw buffers, reused between reads */
 
 signals:
     
@@ -163,6 +197,16 @@ public slots:
     
 };
 
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint32 RtDataClient::getDataFormat() const
+{
+    return m_iDataFormat;
+}
+
 } // NAMESPACE
 
 #endif // RTDATACLIENT_H
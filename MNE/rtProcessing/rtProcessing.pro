@@ -93,7 +93,9 @@ SOURCES += \
         rtave.cpp \
         rtnoise.cpp \
         rthpis.cpp \
-        rtfilter.cpp
+        rtfilter.cpp \
+        rtsssengine.cpp \
+        rtspharaoperator.cpp
 
 HEADERS +=  \
         rtprocessing_global.h \
@@ -102,7 +104,9 @@ HEADERS +=  \
         rtave.h \
         rtnoise.h \
         rthpis.h \
-        rtfilter.h
+        rtfilter.h \
+        rtsssengine.h \
+        rtspharaoperator.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
 INCLUDEPATH += $${MNE_INCLUDE_DIR}
@@ -241,6 +241,30 @@ void RtAve::setBaselineTo(int toSamp, int toMSec)
 }
 
 
+//*************************************************************************************************************
+
+bool RtAve::getStandardError(double dTriggerType, MatrixXd& matStdErr)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(!m_mapConditionIdx.contains(dTriggerType)) {
+        return false;
+    }
+
+    const ConditionAverage& condition = m_vecConditions.at(m_mapConditionIdx.value(dTriggerType));
+    const double n = condition.iSumCount;
+
+    if(condition.iSumCount < 2) {
+        return false;
+    }
+
+    //var = (sum(x^2) - sum(x)^2/n)/(n-1), sem = sqrt(var/n)
+    matStdErr = ((condition.matSumSquares.array() - condition.matSum.array().square() / n).max(0.0) / ((n - 1.0) * n)).sqrt().matrix();
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 bool RtAve::start()
@@ -294,8 +318,18 @@ void RtAve::run()
             //Acquire Data m_pRawMatrixBuffer is thread safe
             MatrixXd rawSegment = m_pRawMatrixBuffer->pop();
 
-            //QMutexLocker locker(&m_qMutex);
-            doAveraging(rawSegment);
+            //The running sums are read by getStandardError from other threads. The evoked set is emitted as a
+            //snapshot after unlocking, so receivers neither block the averaging nor see it change.
+            FiffEvokedSet::SPtr pEvokedSet;
+            m_qMutex.lock();
+            if(doAveraging(rawSegment)) {
+                pEvokedSet = FiffEvokedSet::SPtr(new FiffEvokedSet(*m_pStimEvokedSet));
+            }
+            m_qMutex.unlock();
+
+            if(pEvokedSet) {
+                emit evokedStim(pEvokedSet);
+            }
 
             //qDebug()<<"RtAve::run() - time.elapsed()"<<time.elapsed();
         }
@@ -305,11 +339,9 @@ void RtAve::run()
 
 //*************************************************************************************************************
 
-void RtAve::doAveraging(const MatrixXd& rawSegment)
+bool RtAve::doAveraging(const MatrixXd& rawSegment)
 {
-    //qDebug()<<"";
-    //qDebug()<<"";
-    //qDebug()<<"";
+    bool bNewAverage = false;
 
     //Detect trigger
 
@@ -321,198 +353,198 @@ void RtAve::doAveraging(const MatrixXd& rawSegment)
     //qDebug()<<"RtAve::doAveraging() - time for detection"<<time.elapsed();
     //time.start();
 
-    for(int i = 0; i < lDetectedTriggers.size(); ++i) {
-        if(!m_mapFillingBackBuffer.contains(lDetectedTriggers.at(i).second)) {
-            double dTriggerType = lDetectedTriggers.at(i).second;
+    //Init the global pre stim buffer
+    if(m_matDataPre.rows() != rawSegment.rows() || m_matDataPre.cols() != m_iPreStimSamples) {
+        m_matDataPre = MatrixXd::Zero(rawSegment.rows(), m_iPreStimSamples);
+    }
 
-            //qDebug()<<"Adding dTriggerType"<<dTriggerType;
+    //Resolve the trigger types to condition indices once, new trigger types get a new condition
+    QList<QPair<int,qint32> > lTriggerConditions;
+    for(int i = 0; i < lDetectedTriggers.size(); ++i) {
+        double dTriggerType = lDetectedTriggers.at(i).second;
 
-            m_mapFillingBackBuffer[dTriggerType] = false;
-            m_mapMatDataPostIdx[dTriggerType] = 0;
-            m_mapDataPost[dTriggerType].resize(m_pFiffInfo->chs.size(), m_iPostStimSamples);
-            m_mapDataPost[dTriggerType].setZero();
+        qint32 iCondition = m_mapConditionIdx.value(dTriggerType, -1);
+        if(iCondition == -1) {
+            iCondition = addCondition(dTriggerType);
         }
-    }
 
-    //Fill front / pre stim buffer even if no triggers have been located at all yet
-    if(m_mapFillingBackBuffer.isEmpty()) {
-        fillFrontBuffer(rawSegment, -1.0);
+        lTriggerConditions.append(qMakePair(lDetectedTriggers.at(i).first, iCondition));
     }
 
-    //Do averaging for each trigger type
-    QMutableMapIterator<double,bool> idx(m_mapFillingBackBuffer);
-    while(idx.hasNext()) {
-        idx.next();
-
-        double dTriggerType = idx.key();
+    //Do averaging for each condition
+    for(int iCondition = 0; iCondition < m_vecConditions.size(); ++iCondition) {
+        ConditionAverage& condition = m_vecConditions[iCondition];
 
-        //qDebug()<<"1 dTriggerType"<<dTriggerType;
+        if(!condition.bFillingBackBuffer) {
+            for(int i = 0; i < lTriggerConditions.size(); ++i) {
+                if(lTriggerConditions.at(i).second == iCondition) {
+                    int iTriggerPos = lTriggerConditions.at(i).first;
 
-        if(lDetectedTriggers.isEmpty()) {
-            //qDebug()<<"6";
-            //Fill front / pre stim buffer
-            fillFrontBuffer(rawSegment, -1.0);
-        }
+                    //If number of averages is equals zero do not perform averages
+                    if(m_iNumAverages == 0) {
+                        iTriggerPos = rawSegment.cols()-1;
+                    }
 
-        //Fill back buffer and decide when to do the data packing of the different buffers
-        if(m_mapFillingBackBuffer[dTriggerType]) {
-            //qDebug()<<"2";
-            if(m_mapMatDataPostIdx[dTriggerType] == m_iPostStimSamples) {
-                //qDebug()<<"3";
-                m_mapFillingBackBuffer[dTriggerType] = 0;
+                    //Do front buffer stuff: the samples before this block followed by the ones before the trigger
+                    condition.matDataPre = m_matDataPre;
 
-                //Merge the different buffers
-                mergeData(dTriggerType);
+                    if(iTriggerPos >= m_iPreStimSamples) {
+                        fillFrontBuffer(rawSegment.block(0,iTriggerPos - m_iPreStimSamples,rawSegment.rows(),m_iPreStimSamples), condition.matDataPre);
+                    } else {
+                        fillFrontBuffer(rawSegment.block(0,0,rawSegment.rows(),iTriggerPos), condition.matDataPre);
+                    }
 
-                //Calculate the final average/evoked data
-                generateEvoked(dTriggerType);
+                    //Do back buffer stuff
+                    condition.iDataPostIdx = 0;
+                    condition.bFillingBackBuffer = true;
+                    fillBackBuffer(rawSegment.block(0,iTriggerPos,rawSegment.rows(),rawSegment.cols() - iTriggerPos), condition);
 
-                //If number of averages was reached emit new average
-                if(m_mapStimAve[dTriggerType].size() > 0) {
-                    emit evokedStim(m_pStimEvokedSet);
+                    //qDebug()<<"Trigger type "<<condition.dTriggerType<<" found at "<<iTriggerPos;
+                    break;
                 }
-
-                m_mapFillingBackBuffer[dTriggerType] = false;
-
-                //qDebug()<<"RtAve::run() - Number of calculated averages:" << m_iNumberCalcAverages[dTriggerType];
-                //qDebug()<<"RtAve::run() - dTriggerType:" << dTriggerType;
-                //qDebug()<<"RtAve::run() - m_mapStimAve[dTriggerType].size():" << m_mapStimAve[dTriggerType].size();
-            } else {
-                //qDebug()<<"4";
-                fillBackBuffer(rawSegment, dTriggerType);
             }
         } else {
-            if(lDetectedTriggers.isEmpty()) {
-                //qDebug()<<"6";
-                //Fill front / pre stim buffer
-                fillFrontBuffer(rawSegment, dTriggerType);
-            } else {
-                for(int i = 0; i < lDetectedTriggers.size(); ++i) {
-                    if(dTriggerType == lDetectedTriggers.at(i).second) {
-                        //qDebug()<<"8";
-                        int iTriggerPos = lDetectedTriggers.at(i).first;
-
-                        //If number of averages is equals zero do not perform averages
-                        if(m_iNumAverages == 0) {
-                            iTriggerPos = rawSegment.cols()-1;
-                        }
-
-                        //qDebug()<<"8.1";
-
-                        //Do front buffer stuff
-                        MatrixXd tempMat;
-
-                        if(iTriggerPos >= m_iPreStimSamples) {
-                            tempMat = rawSegment.block(0,iTriggerPos - m_iPreStimSamples,rawSegment.rows(),m_iPreStimSamples);
-                            fillFrontBuffer(tempMat, dTriggerType);
-                        } else {
-                            tempMat = rawSegment.block(0,0,rawSegment.rows(),iTriggerPos);
-                            fillFrontBuffer(tempMat, dTriggerType);
-                        }
-
-                        //qDebug()<<"8.2";
-
-                        //Do back buffer stuff
-                        if(rawSegment.cols() - iTriggerPos >= m_mapDataPost[dTriggerType].cols()) {
-                            m_mapDataPost[dTriggerType] = rawSegment.block(0,iTriggerPos,m_mapDataPost[dTriggerType].rows(),m_mapDataPost[dTriggerType].cols());
-                            m_mapMatDataPostIdx[dTriggerType] = m_iPostStimSamples;
-                        } else {
-                            m_mapDataPost[dTriggerType].block(0,0,m_mapDataPost[dTriggerType].rows(),rawSegment.cols() - iTriggerPos) = rawSegment.block(0,iTriggerPos,rawSegment.rows(),rawSegment.cols() - iTriggerPos);
-                            m_mapMatDataPostIdx[dTriggerType] = rawSegment.cols() - iTriggerPos;
-                        }
-
-                        //qDebug()<<"8.3";
-
-                        m_mapFillingBackBuffer[dTriggerType] = true;
-
-                        //qDebug()<<"Trigger type "<<dTriggerType<<" found at "<<iTriggerPos;
-                    }
-                }
+            fillBackBuffer(rawSegment, condition);
+        }
+
+        //Merge the different buffers as soon as the back buffer is complete
+        if(condition.bFillingBackBuffer && condition.iDataPostIdx == m_iPostStimSamples) {
+            condition.bFillingBackBuffer = false;
+
+            mergeData(condition);
+
+            //Calculate the final average/evoked data
+            generateEvoked(condition);
+
+            //If number of averages was reached emit new average
+            if(condition.iRingCount > 0) {
+                bNewAverage = true;
             }
         }
     }
 
+    //Keep the most recent samples as pre stim data for upcoming triggers
+    fillFrontBuffer(rawSegment, m_matDataPre);
+
     //qDebug()<<"RtAve::doAveraging() - time for procesing"<<time.elapsed();
+
+    return bNewAverage;
 }
 
 
 //*************************************************************************************************************
 
-void RtAve::fillBackBuffer(const MatrixXd &data, double dTriggerType)
+qint32 RtAve::addCondition(double dTriggerType)
 {
-    QMutexLocker locker(&m_qMutex);
+    ConditionAverage condition;
+    condition.dTriggerType = dTriggerType;
+    condition.matDataPost = MatrixXd::Zero(m_pFiffInfo->chs.size(), m_iPostStimSamples);
+    condition.iDataPostIdx = 0;
+    condition.bFillingBackBuffer = false;
+    condition.iRingHead = 0;
+    condition.iRingCount = 0;
+    condition.iSumCount = 0;
+    condition.iNumberCalcAverages = 0;
+    condition.iEvokedIdx = -1;
+
+    //The cumulative mode never drops epochs, hence only the newest one needs to be kept. The epoch
+    //matrices themselves are allocated when a slot is written for the first time.
+    condition.vecEpochRing.resize(m_iAverageMode == 0 ? qMax(m_iNumAverages, 1) : 1);
+
+    m_vecConditions.append(condition);
+    m_mapConditionIdx.insert(dTriggerType, m_vecConditions.size() - 1);
+
+    return m_vecConditions.size() - 1;
+}
+
+
+//*************************************************************************************************************
 
+void RtAve::fillBackBuffer(const MatrixXd &data, ConditionAverage& condition)
+{
     int iResidualCols = data.cols();
-    if(m_mapMatDataPostIdx[dTriggerType] + data.cols() > m_iPostStimSamples) {
-        iResidualCols = m_iPostStimSamples - m_mapMatDataPostIdx[dTriggerType];
-        m_mapDataPost[dTriggerType].block(0,m_mapMatDataPostIdx[dTriggerType],m_mapDataPost[dTriggerType].rows(),iResidualCols) = data.block(0,0,data.rows(),iResidualCols);
-    } else {
-        m_mapDataPost[dTriggerType].block(0,m_mapMatDataPostIdx[dTriggerType],m_mapDataPost[dTriggerType].rows(),iResidualCols) = data;
+    if(condition.iDataPostIdx + data.cols() > m_iPostStimSamples) {
+        iResidualCols = m_iPostStimSamples - condition.iDataPostIdx;
     }
 
-    m_mapMatDataPostIdx[dTriggerType] += iResidualCols;
+    condition.matDataPost.block(0,condition.iDataPostIdx,condition.matDataPost.rows(),iResidualCols) = data.block(0,0,data.rows(),iResidualCols);
+
+    condition.iDataPostIdx += iResidualCols;
 }
 
 
 //*************************************************************************************************************
 
-void RtAve::fillFrontBuffer(const MatrixXd &data, double dTriggerType)
+void RtAve::fillFrontBuffer(const MatrixXd &data, MatrixXd& matPre)
 {
-    QMutexLocker locker(&m_qMutex);
-
-    //Init m_mapDataPre
-    if(!m_mapDataPre.contains(dTriggerType)) {
-        if(dTriggerType != -1.0) {
-            m_mapDataPre[dTriggerType] = m_mapDataPre[-1.0];
-        } else {
-            m_mapDataPre[-1.0].resize(m_pFiffInfo->chs.size(), m_iPreStimSamples);
-            m_mapDataPre[-1.0].setZero();
-        }
-    }
-
-    if(m_mapDataPre[dTriggerType].cols() <= data.cols()) {
-        m_mapDataPre[dTriggerType] = data.block(0,data.cols() - m_iPreStimSamples,data.rows(),m_iPreStimSamples);
+    if(matPre.cols() <= data.cols()) {
+        matPre = data.block(0,data.cols() - matPre.cols(),data.rows(),matPre.cols());
     } else {
-        int residual = m_mapDataPre[dTriggerType].cols() - data.cols();
+        int residual = matPre.cols() - data.cols();
 
         //Copy shift data
-        m_mapDataPre[dTriggerType].block(0,0,m_mapDataPre[dTriggerType].rows(),residual) = m_mapDataPre[dTriggerType].block(0,m_mapDataPre[dTriggerType].cols() - residual,m_mapDataPre[dTriggerType].rows(),residual);
+        for(int i = 0; i < residual; ++i) {
+            matPre.col(i) = matPre.col(i + data.cols());
+        }
 
         //Copy new data in
-        m_mapDataPre[dTriggerType].block(0,residual,m_mapDataPre[dTriggerType].rows(),data.cols()) = data;
+        matPre.block(0,residual,matPre.rows(),data.cols()) = data;
     }
 }
 
 
 //*************************************************************************************************************
 
-void RtAve::mergeData(double dTriggerType)
+void RtAve::mergeData(ConditionAverage& condition)
 {
-    QMutexLocker locker(&m_qMutex);
-
-    MatrixXd mergedData(m_mapDataPre[dTriggerType].rows(), m_mapDataPre[dTriggerType].cols() + m_mapDataPost[dTriggerType].cols());
-
-    mergedData << m_mapDataPre[dTriggerType], m_mapDataPost[dTriggerType];
+    condition.matEpoch.resize(condition.matDataPre.rows(), condition.matDataPre.cols() + condition.matDataPost.cols());
+    condition.matEpoch << condition.matDataPre, condition.matDataPost;
 
     //Perform artifact threshold
     bool bArtifactedDetected = false;
 
     if(m_bDoArtifactReduction) {
-       bArtifactedDetected = checkForArtifact(mergedData, m_dArtifactThreshold);
+       bArtifactedDetected = checkForArtifact(condition.matEpoch, m_dArtifactThreshold);
+    }
+
+    if(bArtifactedDetected) {
+        return;
     }
 
-    if(bArtifactedDetected == false) {
-        //Add cut data to average buffer
-        m_mapStimAve[dTriggerType].append(mergedData);
+    if(condition.iSumCount == 0) {
+        condition.matSum = MatrixXd::Zero(condition.matEpoch.rows(), condition.matEpoch.cols());
+        condition.matSumSquares = MatrixXd::Zero(condition.matEpoch.rows(), condition.matEpoch.cols());
+    }
+
+    const int iRingSize = condition.vecEpochRing.size();
+    MatrixXd& matOldest = condition.vecEpochRing[condition.iRingHead];
 
-        //Pop data from buffer
-        if(m_mapStimAve[dTriggerType].size() > m_iNumAverages && m_iNumAverages >= 1) {
-            m_mapStimAve[dTriggerType].pop_front();
+    //Remove the oldest epoch from the running window. The cumulative mode keeps all epochs in the sums.
+    if(condition.iRingCount == iRingSize) {
+        if(m_iAverageMode == 0) {
+            condition.matSum -= matOldest;
+            condition.matSumSquares.array() -= matOldest.array().square();
+            --condition.iSumCount;
         }
+    } else {
+        ++condition.iRingCount;
+    }
 
-        //Proceed a bit different if we use zero number of averages
-        if(m_mapStimAve[dTriggerType].size() > 1 && m_iNumAverages == 0) {
-            m_mapStimAve[dTriggerType].pop_front();
+    //Add cut data to average buffer, swapping keeps both allocations alive for the next epoch
+    matOldest.swap(condition.matEpoch);
+    condition.matSum += matOldest;
+    condition.matSumSquares.array() += matOldest.array().square();
+    ++condition.iSumCount;
+
+    condition.iRingHead = (condition.iRingHead + 1) % iRingSize;
+
+    //Recompute the sums once per ring cycle so that the rounding errors of the subtractions do not accumulate
+    if(m_iAverageMode == 0 && condition.iRingHead == 0 && iRingSize > 1) {
+        condition.matSum.setZero();
+        condition.matSumSquares.setZero();
+        for(int i = 0; i < iRingSize; ++i) {
+            condition.matSum += condition.vecEpochRing.at(i);
+            condition.matSumSquares.array() += condition.vecEpochRing.at(i).array().square();
         }
     }
 }
@@ -562,28 +594,15 @@ bool RtAve::checkForArtifact(MatrixXd& data, double dThreshold)
 
 //*************************************************************************************************************
 
-void RtAve::generateEvoked(double dTriggerType)
+void RtAve::generateEvoked(ConditionAverage& condition)
 {
-    QMutexLocker locker(&m_qMutex);
-
-    if(m_mapStimAve[dTriggerType].isEmpty()) {
+    if(condition.iRingCount == 0) {
         return;
     }
 
-    //Init evoked
-    FiffEvoked evoked;    
-    int iEvokedIdx = -1;
-
-    for(int i = 0; i < m_pStimEvokedSet->evoked.size(); ++i) {
-        if(m_pStimEvokedSet->evoked.at(i).comment == QString::number(dTriggerType)) {
-            evoked = m_pStimEvokedSet->evoked.at(i);
-            iEvokedIdx = i;
-            break;
-        }
-    }
-
     //If the evoked is not yet present add it here
-    if(iEvokedIdx == -1) {
+    if(condition.iEvokedIdx == -1) {
+        FiffEvoked evoked;
         float T = 1.0/m_pFiffInfo->sfreq;
 
         evoked.setInfo(*m_pFiffInfo.data());
@@ -594,53 +613,37 @@ void RtAve::generateEvoked(double dTriggerType)
             evoked.times[i] = evoked.times[i-1] + T;
         evoked.first = evoked.times[0];
         evoked.last = evoked.times[evoked.times.size()-1];
-        evoked.comment = QString::number(dTriggerType);
+        evoked.comment = QString::number(condition.dTriggerType);
+
+        m_pStimEvokedSet->evoked.append(evoked);
+        condition.iEvokedIdx = m_pStimEvokedSet->evoked.size() - 1;
     }
 
-    // Generate final evoked
-    MatrixXd finalAverage = MatrixXd::Zero(m_mapStimAve[dTriggerType].first().rows(), m_iPreStimSamples+m_iPostStimSamples);
+    FiffEvoked& evoked = m_pStimEvokedSet->evoked[condition.iEvokedIdx];
 
+    // Generate final evoked
     if(m_iAverageMode == 0) {
-        for(int i = 0; i < m_mapStimAve[dTriggerType].size(); ++i) {
-            finalAverage += m_mapStimAve[dTriggerType].at(i);
-        }
-
-        if(m_mapStimAve[dTriggerType].isEmpty()) {
-            finalAverage = finalAverage/1;
-        } else {
-            finalAverage = finalAverage/m_mapStimAve[dTriggerType].size();
-        }
+        evoked.data = condition.matSum / condition.iSumCount;
 
         if(m_bDoBaselineCorrection) {
-            finalAverage = MNEMath::rescale(finalAverage, evoked.times, m_pairBaselineSec, QString("mean"));
+            evoked.data = MNEMath::rescale(evoked.data, evoked.times, m_pairBaselineSec, QString("mean"));
         }
 
-        evoked.data = finalAverage;
-
-        if(m_mapNumberCalcAverages[dTriggerType] < m_iNumAverages) {
-            m_mapNumberCalcAverages[dTriggerType]++;
+        if(condition.iNumberCalcAverages < m_iNumAverages) {
+            condition.iNumberCalcAverages++;
         }
 
-        evoked.nave = m_mapNumberCalcAverages[dTriggerType];
+        evoked.nave = condition.iNumberCalcAverages;
     } else if(m_iAverageMode == 1) {
-        MatrixXd tempMatrix = m_mapStimAve[dTriggerType].last();
+        const int iNewest = (condition.iRingHead + condition.vecEpochRing.size() - 1) % condition.vecEpochRing.size();
 
         if(m_bDoBaselineCorrection) {
-            tempMatrix = MNEMath::rescale(tempMatrix, evoked.times, m_pairBaselineSec, QString("mean"));
+            evoked += MNEMath::rescale(condition.vecEpochRing.at(iNewest), evoked.times, m_pairBaselineSec, QString("mean"));
+        } else {
+            evoked += condition.vecEpochRing.at(iNewest);
         }
 
-        evoked += tempMatrix;
-
-        m_mapNumberCalcAverages[dTriggerType]++;
-    }
-
-    //Add new data to evoked data set
-    if(iEvokedIdx != -1) {
-        //Evoked data is already present
-        m_pStimEvokedSet->evoked[iEvokedIdx] = evoked;
-    } else {
-        //Evoked data is not present yet
-        m_pStimEvokedSet->evoked.append(evoked);
+        condition.iNumberCalcAverages++;
     }
 }
 
@@ -676,12 +679,9 @@ void RtAve::reset()
 //    m_mapNumberCalcAverages.clear();
 
     m_qMapDetectedTrigger.clear();
-    m_mapStimAve.clear();
-    m_mapDataPre.clear();
-    m_mapDataPost.clear();
-    m_mapMatDataPostIdx.clear();
-    m_mapFillingBackBuffer.clear();
-    m_mapNumberCalcAverages.clear();
+    m_vecConditions.clear();
+    m_mapConditionIdx.clear();
+    m_matDataPre.resize(0,0);
 
     qDebug()<<"RtAve::reset() - 4";
 
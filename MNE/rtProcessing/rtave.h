@@ -58,6 +58,8 @@
 #include <QThread>
 #include <QMutex>
 #include <QSharedPointer>
+#include <QVector>
+#include <QMap>
 
 
 //*************************************************************************************************************
@@ -215,6 +217,19 @@ public:
     */
     void setBaselineTo(int toSamp, int toMSec);
 
+    //=========================================================================================================
+    /**
+    * Returns the standard error of the mean of the current average of a trigger type. The standard error is
+    * derived from the running sums of the epochs in the averaging window (running mode) or of all epochs
+    * averaged so far (cumulative mode). No baseline correction is applied.
+    *
+    * @param[in] dTriggerType   The trigger type.
+    * @param[out] matStdErr     The standard error for every channel and sample.
+    *
+    * @return true if at least two epochs of the trigger type were averaged, false otherwise
+    */
+    bool getStandardError(double dTriggerType, Eigen::MatrixXd& matStdErr);
+
     //=========================================================================================================
     /**
     * Starts the RtAve by starting the producer's thread.
@@ -253,35 +268,73 @@ protected:
     virtual void run();
 
 private:
+    /**
+    * Averaging state of one trigger type. The accepted epochs are kept in a ring which is reused once it
+    * is full. The running sum and sum of squares are updated when an epoch enters or leaves the window.
+    */
+    struct ConditionAverage {
+        double                      dTriggerType;           /**< The trigger value of this condition. */
+        Eigen::MatrixXd             matDataPre;             /**< The pre stim data of the current epoch. */
+        Eigen::MatrixXd             matDataPost;            /**< The post stim data of the current epoch. */
+        Eigen::MatrixXd             matEpoch;               /**< Scratch epoch, swapped into the ring when accepted. */
+        qint32                      iDataPostIdx;           /**< Current index inside of matDataPost. */
+        bool                        bFillingBackBuffer;     /**< Whether the back buffer is currently getting filled. */
+        QVector<Eigen::MatrixXd>    vecEpochRing;           /**< Ring of the most recent accepted epochs. */
+        qint32                      iRingHead;              /**< Ring slot which is written next. */
+        qint32                      iRingCount;             /**< Number of valid epochs in the ring. */
+        Eigen::MatrixXd             matSum;                 /**< Running sum of the averaged epochs. */
+        Eigen::MatrixXd             matSumSquares;          /**< Running sum of the squared averaged epochs. */
+        qint32                      iSumCount;              /**< Number of epochs in matSum. */
+        qint32                      iNumberCalcAverages;    /**< The number of calculated averages reported as nave. */
+        qint32                      iEvokedIdx;             /**< Index of the evoked in m_pStimEvokedSet, -1 if not yet present. */
+    };
+
     //=========================================================================================================
     /**
-    * do the actual averaging here.
+    * do the actual averaging here. Must be called with m_qMutex locked, the helpers below do not lock themselves.
+    *
+    * @param[in] rawSegment     The new data block.
+    *
+    * @return true if at least one condition has a new average in m_pStimEvokedSet.
     */
-    void doAveraging(const Eigen::MatrixXd& rawSegment);
+    bool doAveraging(const Eigen::MatrixXd& rawSegment);
 
     //=========================================================================================================
     /**
-    * Prepends incoming data to front/pre stim buffer.
+    * Adds a new trigger type and returns its condition index.
+    *
+    * @param[in] dTriggerType   The trigger type.
+    *
+    * @return the index of the new condition in m_vecConditions.
+    */
+    qint32 addCondition(double dTriggerType);
+
+    //=========================================================================================================
+    /**
+    * Shifts incoming data into a front/pre stim buffer.
+    *
+    * @param[in] data           The new data.
+    * @param[in, out] matPre    The pre stim buffer.
     */
-    void fillFrontBuffer(const Eigen::MatrixXd& data, double dTriggerType);
+    void fillFrontBuffer(const Eigen::MatrixXd& data, Eigen::MatrixXd& matPre);
 
     //=========================================================================================================
     /**
-    * Prepends incoming data to back/post stim buffer.
+    * Appends incoming data to the back/post stim buffer of a condition.
     */
-    void fillBackBuffer(const Eigen::MatrixXd& data, double dTriggerType);
+    void fillBackBuffer(const Eigen::MatrixXd& data, ConditionAverage& condition);
 
     //=========================================================================================================
     /**
-    * Packs the buffers togehter as one and calcualtes the current running average and emits the result if number of averages has been reached.
+    * Packs the buffers together as one epoch and adds it to the running sums of the condition.
     */
-    void mergeData(double dTriggerType);
+    void mergeData(ConditionAverage& condition);
 
     //=========================================================================================================
     /**
-    * Generates the final evoke variable.
+    * Generates the final evoke variable from the running sums of the condition.
     */
-    void generateEvoked(double dTriggerType);
+    void generateEvoked(ConditionAverage& condition);
 
     //=========================================================================================================
     /**
@@ -345,12 +398,9 @@ private:
     FIFFLIB::FiffEvokedSet::SPtr                    m_pStimEvokedSet;           /**< Holds the evoked information. */
 
     QMap<int,QList<int> >                           m_qMapDetectedTrigger;      /**< Detected trigger for each trigger channel. */
-    QMap<double,QList<Eigen::MatrixXd> >            m_mapStimAve;               /**< the current stimulus average buffer. Holds m_iNumAverages vectors */
-    QMap<double,Eigen::MatrixXd>                    m_mapDataPre;               /**< The matrix holding the pre stim data. */
-    QMap<double,Eigen::MatrixXd>                    m_mapDataPost;              /**< The matrix holding the post stim data. */
-    QMap<double,qint32>                             m_mapMatDataPostIdx;        /**< Current index inside of the matrix m_matDataPost */
-    QMap<double,bool>                               m_mapFillingBackBuffer;     /**< Whether the back buffer is currently getting filled. */
-    QMap<double,qint32>                             m_mapNumberCalcAverages;    /**< The number of currently calculated averages for each trigger type. */
+    QVector<ConditionAverage>                       m_vecConditions;            /**< Averaging state for each trigger type, addressed by condition index. */
+    QMap<double,qint32>                             m_mapConditionIdx;          /**< Maps a trigger type to its condition index. Only used when triggers are detected. */
+    Eigen::MatrixXd                                 m_matDataPre;               /**< The most recent pre stim samples, the pre stim data of new epochs starts from here. */
 
     IOBUFFER::CircularMatrixBuffer<double>::SPtr    m_pRawMatrixBuffer;         /**< The Circular Raw Matrix Buffer. */
 
@@ -46,12 +46,22 @@
 #include <fiff/fiff_cov.h>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Dense>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
 #include <QDebug>
+#include <QMap>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -74,6 +84,15 @@ RtCov::RtCov(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, QObject *parent)
 , m_iNewMaxSamples(0)
 , m_pFiffInfo(p_pFiffInfo)
 , m_bIsRunning(false)
+, m_estimationMode(Block)
+, m_iEmitInterval(p_iMaxSamples)
+, m_bShrinkage(false)
+, m_bSettingsChanged(false)
+, m_dNumSamples(0)
+, m_iSamplesSinceEmit(0)
+, m_iSamplesReceived(0)
+, m_iWindowUpdates(0)
+, m_iNumGroups(0)
 {
     qRegisterMetaType<FiffCov::SPtr>("FiffCov::SPtr");
 }
@@ -105,10 +124,41 @@ void RtCov::append(const MatrixXd &p_DataSegment)
 
 void RtCov::setSamples(qint32 samples)
 {
+    QMutexLocker locker(&mutex);
     m_iNewMaxSamples = samples;
 }
 
 
+//*************************************************************************************************************
+
+void RtCov::setEstimationMode(EstimationMode mode)
+{
+    QMutexLocker locker(&mutex);
+    if(mode != m_estimationMode) {
+        m_estimationMode = mode;
+        m_bSettingsChanged = true;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtCov::setEmitInterval(qint32 samples)
+{
+    QMutexLocker locker(&mutex);
+    m_iEmitInterval = samples > 0 ? samples : 1;
+}
+
+
+//*************************************************************************************************************
+
+void RtCov::setShrinkage(bool bShrinkage)
+{
+    QMutexLocker locker(&mutex);
+    m_bShrinkage = bShrinkage;
+}
+
+
 //*************************************************************************************************************
 
 bool RtCov::start()
@@ -149,68 +199,297 @@ void RtCov::run()
             exclude << m_pFiffInfo->chs.at(i).ch_name;
         }
     }
-    bool doProj = true;
 
-    quint32 n_samples = 0;
+    initChannelGroups();
+    resetStatistics();
 
-    FiffCov::SPtr cov(new FiffCov());
-    VectorXd mu;
+    MatrixXd rawSegment;
 
     while(m_bIsRunning)
     {
         if(m_pRawMatrixBuffer)
         {
-            MatrixXd rawSegment = m_pRawMatrixBuffer->pop();
+            m_pRawMatrixBuffer->popInto(rawSegment);
+
+            QMutexLocker locker(&mutex);
 
-            if(n_samples == 0)
+            if(m_iNewMaxSamples > 0)
             {
-                mu = rawSegment.rowwise().sum();
-                cov->data = rawSegment * rawSegment.transpose();
+                m_iMaxSamples = m_iNewMaxSamples;
+                m_iNewMaxSamples = 0;
+                m_bSettingsChanged = true;
             }
-            else
+
+            if(m_bSettingsChanged)
             {
-                mu.array() += rawSegment.rowwise().sum().array();
-                cov->data += rawSegment * rawSegment.transpose();
+                resetStatistics();
+                m_bSettingsChanged = false;
             }
-            n_samples += rawSegment.cols();
 
-            if(n_samples > m_iMaxSamples)
+            addBlock(rawSegment);
+
+            if(m_estimationMode == Block)
+            {
+                if(m_dNumSamples > m_iMaxSamples)
+                {
+                    emit covCalculated(estimateCov(exclude));
+                    resetStatistics();
+                }
+            }
+            else
             {
-                mu /= (float)n_samples;
-                cov->data.array() -= n_samples * (mu * mu.transpose()).array();
-                cov->data.array() /= (n_samples - 1);
+                if(m_estimationMode == SlidingWindow)
+                {
+                    while(!m_lWindowBlocks.isEmpty() && m_dNumSamples - m_lWindowBlocks.first().cols() >= m_iMaxSamples)
+                        removeOldestBlock();
+
+                    //Downdates accumulate round-off errors, start from scratch once in a while
+                    if(m_iWindowUpdates > 1000)
+                        refreshSlidingWindow();
+                }
+
+                if(m_iSamplesReceived >= m_iMaxSamples && m_iSamplesSinceEmit >= m_iEmitInterval)
+                {
+                    emit covCalculated(estimateCov(exclude));
+                    m_iSamplesSinceEmit = 0;
+                }
+            }
+        }
+    }
+}
 
-                cov->kind = FIFFV_MNE_NOISE_COV;
-                cov->diag = false;
-                cov->dim = cov->data.rows();
 
-                //ToDo do picks
-                cov->names = m_pFiffInfo->ch_names;
-                cov->projs = m_pFiffInfo->projs;
-                cov->bads = m_pFiffInfo->bads;
-                cov->nfree = n_samples;
+//*************************************************************************************************************
 
-                // regularize noise covariance
-                *cov.data() = cov->regularize(*m_pFiffInfo, 0.05, 0.05, 0.1, doProj, exclude);
+void RtCov::resetStatistics()
+{
+    m_matSumSq.resize(0,0);
+    m_vecSum.resize(0);
+    m_dNumSamples = 0;
+    m_vecSumFourth = VectorXd::Zero(m_iNumGroups);
+    m_iSamplesSinceEmit = 0;
+    m_iSamplesReceived = 0;
+    m_iWindowUpdates = 0;
+    m_lWindowBlocks.clear();
+    m_lWindowFourth.clear();
+}
 
-                emit covCalculated(cov);
 
-                cov = FiffCov::SPtr(new FiffCov());
-                n_samples = 0;
-            }
+//*************************************************************************************************************
+
+void RtCov::initChannelGroups()
+{
+    QMap<qint32, qint32> mapGroups;
+
+    m_vecChannelGroup.resize(m_pFiffInfo->chs.size());
+
+    for(int i = 0; i < m_pFiffInfo->chs.size(); ++i)
+    {
+        //Channels of the same kind and unit (e.g. magnetometers, gradiometers, EEG) share a group
+        qint32 key = m_pFiffInfo->chs.at(i).kind * 1000 + m_pFiffInfo->chs.at(i).unit;
+        if(!mapGroups.contains(key))
+            mapGroups.insert(key, mapGroups.size());
+        m_vecChannelGroup[i] = mapGroups.value(key);
+    }
+
+    m_iNumGroups = mapGroups.size();
+}
+
+
+//*************************************************************************************************************
+
+void RtCov::addBlock(const MatrixXd &matBlock)
+{
+    if(m_matSumSq.rows() != matBlock.rows())
+    {
+        m_matSumSq = MatrixXd::Zero(matBlock.rows(), matBlock.rows());
+        m_vecSum = VectorXd::Zero(matBlock.rows());
+    }
 
+    const qint32 iSamples = matBlock.cols();
 
-//            qint32 samples = rawSegment.cols();
-//            VectorXf mu = rawSegment.rowwise().sum().array() / (float)samples;
+    if(m_estimationMode == ExponentialWindow)
+    {
+        //Sample j of the block is weighted by lambda^(samples - 1 - j), the old sums by lambda^samples
+        const double dLambda = exp(-1.0 / m_iMaxSamples);
+        const double dDecay = pow(dLambda, iSamples);
+
+        VectorXd vecWeights(iSamples);
+        for(qint32 j = 0; j < iSamples; ++j)
+            vecWeights[j] = pow(dLambda, iSamples - 1 - j);
 
-//            MatrixXf noise_covariance = rawSegment * rawSegment.transpose();// noise_covariance == raw_covariance
-//            noise_covariance.array() -= samples * (mu * mu.transpose()).array();
-//            noise_covariance.array() /= (samples - 1);
+        VectorXd vecFourth = fourthMoments(matBlock, vecWeights);
 
-//            std::cout << "Noise Covariance:\n" << noise_covariance.block(0,0,10,10) << std::endl;
+        m_matWeighted = matBlock * vecWeights.cwiseSqrt().asDiagonal();
+
+        m_matSumSq *= dDecay;
+        m_matSumSq.selfadjointView<Lower>().rankUpdate(m_matWeighted);
+        m_vecSum = dDecay * m_vecSum + matBlock * vecWeights;
+        m_dNumSamples = dDecay * m_dNumSamples + vecWeights.sum();
+        m_vecSumFourth = dDecay * m_vecSumFourth + vecFourth;
+    }
+    else
+    {
+        VectorXd vecFourth = fourthMoments(matBlock);
 
-//            printf("%d raw buffer (%d x %d) generated\r\n", count, tmp.rows(), tmp.cols());
+        m_matSumSq.selfadjointView<Lower>().rankUpdate(matBlock);
+        m_vecSum += matBlock.rowwise().sum();
+        m_dNumSamples += iSamples;
+        m_vecSumFourth += vecFourth;
 
+        if(m_estimationMode == SlidingWindow)
+        {
+            m_lWindowBlocks.append(matBlock);
+            m_lWindowFourth.append(vecFourth);
         }
     }
+
+    m_iSamplesSinceEmit += iSamples;
+    m_iSamplesReceived += iSamples;
+}
+
+
+//*************************************************************************************************************
+
+void RtCov::removeOldestBlock()
+{
+    const MatrixXd& matBlock = m_lWindowBlocks.first();
+
+    m_matSumSq.selfadjointView<Lower>().rankUpdate(matBlock, -1.0);
+    m_vecSum -= matBlock.rowwise().sum();
+    m_dNumSamples -= matBlock.cols();
+    m_vecSumFourth -= m_lWindowFourth.first();
+
+    m_lWindowBlocks.removeFirst();
+    m_lWindowFourth.removeFirst();
+
+    ++m_iWindowUpdates;
+}
+
+
+//*************************************************************************************************************
+
+void RtCov::refreshSlidingWindow()
+{
+    m_matSumSq.setZero();
+    m_vecSum.setZero();
+    m_dNumSamples = 0;
+    m_vecSumFourth.setZero();
+
+    for(int i = 0; i < m_lWindowBlocks.size(); ++i)
+    {
+        m_matSumSq.selfadjointView<Lower>().rankUpdate(m_lWindowBlocks.at(i));
+        m_vecSum += m_lWindowBlocks.at(i).rowwise().sum();
+        m_dNumSamples += m_lWindowBlocks.at(i).cols();
+        m_vecSumFourth += m_lWindowFourth.at(i);
+    }
+
+    m_iWindowUpdates = 0;
+}
+
+
+//*************************************************************************************************************
+
+VectorXd RtCov::fourthMoments(const MatrixXd &matBlock, const VectorXd &vecWeights) const
+{
+    VectorXd vecFourth = VectorXd::Zero(m_iNumGroups);
+
+    if(m_iNumGroups == 0 || matBlock.rows() != m_vecChannelGroup.size())
+        return vecFourth;
+
+    //Center with the current mean estimate
+    VectorXd vecMean = m_dNumSamples > 0 ? VectorXd(m_vecSum / m_dNumSamples) : VectorXd::Zero(matBlock.rows());
+
+    MatrixXd matNorms = MatrixXd::Zero(m_iNumGroups, matBlock.cols());
+    for(qint32 i = 0; i < matBlock.rows(); ++i)
+        matNorms.row(m_vecChannelGroup[i]).array() += (matBlock.row(i).array() - vecMean[i]).square();
+
+    if(vecWeights.size() == 0)
+        vecFourth = matNorms.array().square().rowwise().sum();
+    else
+        vecFourth = matNorms.array().square().matrix() * vecWeights;
+
+    return vecFourth;
+}
+
+
+//*************************************************************************************************************
+
+FiffCov::SPtr RtCov::estimateCov(const QStringList &exclude)
+{
+    FiffCov::SPtr cov(new FiffCov());
+
+    VectorXd mu = m_vecSum / m_dNumSamples;
+
+    cov->data = m_matSumSq.selfadjointView<Lower>();
+    cov->data -= m_dNumSamples * (mu * mu.transpose());
+    cov->data /= (m_dNumSamples - 1);
+
+    cov->kind = FIFFV_MNE_NOISE_COV;
+    cov->diag = false;
+    cov->dim = cov->data.rows();
+
+    //ToDo do picks
+    cov->names = m_pFiffInfo->ch_names;
+    cov->projs = m_pFiffInfo->projs;
+    cov->bads = m_pFiffInfo->bads;
+    cov->nfree = (fiff_int_t)m_dNumSamples;
+
+    if(m_bShrinkage)
+    {
+        shrinkLedoitWolf(cov->data);
+    }
+    else
+    {
+        // regularize noise covariance
+        bool doProj = true;
+        *cov.data() = cov->regularize(*m_pFiffInfo, 0.05, 0.05, 0.1, doProj, exclude);
+    }
+
+    return cov;
+}
+
+
+//*************************************************************************************************************
+
+void RtCov::shrinkLedoitWolf(MatrixXd &matCov) const
+{
+    if(matCov.rows() != m_vecChannelGroup.size())
+        return;
+
+    VectorXd vecScale = VectorXd::Ones(matCov.rows());
+    VectorXd vecTarget = VectorXd::Zero(matCov.rows());
+
+    for(qint32 g = 0; g < m_iNumGroups; ++g)
+    {
+        QVector<qint32> idx;
+        for(qint32 i = 0; i < m_vecChannelGroup.size(); ++i)
+            if(m_vecChannelGroup[i] == g)
+                idx.append(i);
+
+        double dTrace = 0, dFrob = 0;
+        for(qint32 a = 0; a < idx.size(); ++a)
+        {
+            dTrace += matCov(idx[a], idx[a]);
+            for(qint32 b = 0; b < idx.size(); ++b)
+                dFrob += matCov(idx[a], idx[b]) * matCov(idx[a], idx[b]);
+        }
+
+        //Ledoit & Wolf (2004): shrink towards mu*I with intensity min(beta, delta)/delta
+        double dMu = dTrace / idx.size();
+        double dDelta = dFrob - 2 * dMu * dTrace + dMu * dMu * idx.size();
+        double dBeta = (m_vecSumFourth[g] - m_dNumSamples * dFrob) / (m_dNumSamples * m_dNumSamples);
+        dBeta = qBound(0.0, dBeta, dDelta);
+        double dAlpha = dDelta > 0 ? dBeta / dDelta : 0.0;
+
+        for(qint32 a = 0; a < idx.size(); ++a)
+        {
+            vecScale[idx[a]] = sqrt(1.0 - dAlpha);
+            vecTarget[idx[a]] = dAlpha * dMu;
+        }
+    }
+
+    //Scaling from both sides keeps the cross terms between groups consistent and the result positive definite
+    matCov = vecScale.asDiagonal() * matCov * vecScale.asDiagonal();
+    matCov.diagonal() += vecTarget;
 }
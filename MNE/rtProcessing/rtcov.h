@@ -68,6 +68,7 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QList>
 #include <QSharedPointer>
 
 
@@ -100,7 +101,11 @@ using namespace FIFFLIB;
 
 //=============================================================================================================
 /**
-* Real-time covariance estimation
+* Real-time covariance estimation. The sample covariance is maintained incrementally: every incoming block updates
+* the running sums with a rank-k update, the oldest block of a sliding window is removed with a rank-k downdate.
+* Besides the original block-wise estimation, a fixed sliding window and an exponentially weighted window are
+* supported, which can be emitted at a configurable cadence. Optionally a Ledoit-Wolf shrinkage is applied to the
+* emitted covariance instead of the default regularization.
 *
 * @brief Real-time covariance estimation
 */
@@ -111,6 +116,12 @@ public:
     typedef QSharedPointer<RtCov> SPtr;             /**< Shared pointer type for RtCov. */
     typedef QSharedPointer<const RtCov> ConstSPtr;  /**< Const shared pointer type for RtCov. */
 
+    enum EstimationMode {
+        Block,              /**< Collect the given number of samples, emit their covariance and start over. */
+        SlidingWindow,      /**< Covariance of the last given number of samples, emitted every emit interval. */
+        ExponentialWindow   /**< Exponentially weighted covariance with an effective window of the given number of samples, emitted every emit interval. */
+    };
+
     //=========================================================================================================
     /**
     * Creates the real-time covariance estimation object.
@@ -151,6 +162,31 @@ public:
     */
     void setSamples(qint32 samples);
 
+    //=========================================================================================================
+    /**
+    * Set the estimation mode. Restarts the estimation.
+    *
+    * @param[in] mode       the estimation mode
+    */
+    void setEstimationMode(EstimationMode mode);
+
+    //=========================================================================================================
+    /**
+    * Set the number of samples between two emitted covariances in the sliding and exponential window mode.
+    *
+    * @param[in] samples    number of samples between two emitted covariances
+    */
+    void setEmitInterval(qint32 samples);
+
+    //=========================================================================================================
+    /**
+    * Enables the Ledoit-Wolf shrinkage of the emitted covariance. The shrinkage is done per channel type towards a
+    * scaled identity and replaces the default regularization.
+    *
+    * @param[in] bShrinkage     whether to apply the Ledoit-Wolf shrinkage
+    */
+    void setShrinkage(bool bShrinkage);
+
     //=========================================================================================================
     /**
     * Starts the RtCov by starting the producer's thread.
@@ -186,6 +222,67 @@ protected:
     virtual void run();
 
 private:
+    //=========================================================================================================
+    /**
+    * Resets the running sums and the sliding window.
+    */
+    void resetStatistics();
+
+    //=========================================================================================================
+    /**
+    * Assigns each channel to a group of the same kind and unit, used for the shrinkage.
+    */
+    void initChannelGroups();
+
+    //=========================================================================================================
+    /**
+    * Adds a block of samples to the running sums.
+    *
+    * @param[in] matBlock   the new data block (channels x samples)
+    */
+    void addBlock(const MatrixXd &matBlock);
+
+    //=========================================================================================================
+    /**
+    * Removes the oldest block of the sliding window from the running sums.
+    */
+    void removeOldestBlock();
+
+    //=========================================================================================================
+    /**
+    * Recomputes the running sums from the blocks of the sliding window to avoid accumulated round-off errors.
+    */
+    void refreshSlidingWindow();
+
+    //=========================================================================================================
+    /**
+    * Sum of the squared norms, squared, of the centered samples per channel group. Required by the shrinkage.
+    *
+    * @param[in] matBlock   the data block (channels x samples)
+    * @param[in] vecWeights the weights of the samples, empty for unit weights
+    *
+    * @return the sum per channel group
+    */
+    VectorXd fourthMoments(const MatrixXd &matBlock, const VectorXd &vecWeights = VectorXd()) const;
+
+    //=========================================================================================================
+    /**
+    * Estimates the covariance from the running sums.
+    *
+    * @param[in] exclude    channels excluded from the regularization
+    *
+    * @return the covariance
+    */
+    FiffCov::SPtr estimateCov(const QStringList &exclude);
+
+    //=========================================================================================================
+    /**
+    * Applies the Ledoit-Wolf shrinkage per channel group.
+    *
+    * @param[in, out] matCov    the covariance to shrink
+    */
+    void shrinkLedoitWolf(MatrixXd &matCov) const;
+
     QMutex      mutex;                  /**< Provides access serialization between threads*/
 
     quint32      m_iMaxSamples;         /**< Maximal amount of samples received, before covariance is estimated.*/
@@ -197,6 +294,38 @@ private:
     bool        m_bIsRunning;           /**< Holds if real-time Covariance estimation is running.*/
 
     CircularMatrixBuffer<double>::SPtr m_pRawMatrixBuffer;   /**< The Circular Raw Matrix Buffer. */
+
+    EstimationMode  m_estimationMode;   /**< The estimation mode.*/
+
+    quint32     m_iEmitInterval;        /**< Number of samples between two emitted covariances (sliding and exponential window).*/
+
+    bool        m_bShrinkage;           /**< Whether the Ledoit-Wolf shrinkage is applied.*/
+
+    bool        m_bSettingsChanged;     /**< Whether the estimation has to be restarted because of new settings.*/
+
+    MatrixXd    m_matSumSq;             /**< Running (weighted) sum of x*x^T, only the lower triangle is used.*/
+
+    VectorXd    m_vecSum;               /**< Running (weighted) sum of x.*/
+
+    double      m_dNumSamples;          /**< Running (weighted) number of samples.*/
+
+    VectorXd    m_vecSumFourth;         /**< Running (weighted) sum of the fourth moments per channel group.*/
+
+    quint32     m_iSamplesSinceEmit;    /**< Samples received since the last emitted covariance.*/
+
+    quint32     m_iSamplesReceived;     /**< Samples received since the estimation was (re-)started.*/
+
+    qint32      m_iWindowUpdates;       /**< Number of downdates since the sliding window sums were recomputed.*/
+
+    QList<MatrixXd> m_lWindowBlocks;    /**< The blocks of the sliding window.*/
+
+    QList<VectorXd> m_lWindowFourth;    /**< The fourth moments of the blocks of the sliding window.*/
+
+    VectorXi    m_vecChannelGroup;      /**< Channel group index of each channel.*/
+
+    qint32      m_iNumGroups;           /**< Number of channel groups.*/
+
+    MatrixXd    m_matWeighted;          /**< Work buffer for the weighted samples of the exponential window.*/
 };
 
 //*************************************************************************************************************
@@ -41,6 +41,14 @@
 #include "rtfilter.h"
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -54,32 +62,50 @@ using namespace FIFFLIB;
 
 //*************************************************************************************************************
 //=============================================================================================================
-// DEFINE GLOBAL METHODS
+// DEFINE MEMBER METHODS
 //=============================================================================================================
 
-void doFilterPerChannelRTMSA(QPair<QList<FilterData>,QPair<int,RowVectorXd> > &channelDataTime)
+RtFilter::RtFilter(FilterMode mode)
+: m_filterMode(mode)
+, m_iNumChannels(0)
+, m_iWorkerFFTLength(0)
 {
-    for(int i = 0; i < channelDataTime.first.size(); ++i) {
-        //channelDataTime.second.second = channelDataTime.first.at(i).applyConvFilter(channelDataTime.second.second, true, FilterData::ZeroPad);
-        channelDataTime.second.second = channelDataTime.first.at(i).applyFFTFilter(channelDataTime.second.second, true, FilterData::ZeroPad); //FFT Convolution for rt is not suitable. FFT make the signal filtering non causal.
-    }
 }
 
 
 //*************************************************************************************************************
-//=============================================================================================================
-// DEFINE MEMBER METHODS
-//=============================================================================================================
 
-RtFilter::RtFilter()
+RtFilter::~RtFilter()
 {
 }
 
 
 //*************************************************************************************************************
 
-RtFilter::~RtFilter()
+void RtFilter::setFilterMode(FilterMode mode)
+{
+    if(mode != m_filterMode) {
+        m_filterMode = mode;
+        reset();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtFilter::reset()
 {
+    m_lFilterCoeffs.clear();
+    m_vecCoeffs.resize(0);
+    m_mapPlans.clear();
+    m_lFilterChannelList.clear();
+    m_iNumChannels = 0;
+    m_vecFilterChannels.clear();
+    m_vecPassChannels.clear();
+    m_lWorkers.clear();
+    m_iWorkerFFTLength = 0;
+    m_matHistory.resize(0,0);
+    m_matDelay.resize(0,0);
 }
 
 
@@ -87,68 +113,297 @@ RtFilter::~RtFilter()
 
 MatrixXd RtFilter::filterChannelsConcurrently(const MatrixXd& matDataIn, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<FilterData>& lFilterData)
 {
-    //Initialise the overlay matrix
-    if(m_matOverlap.cols() != iMaxFilterLength || m_matOverlap.rows() < matDataIn.rows()) {
-        m_matOverlap.resize(matDataIn.rows(), iMaxFilterLength);
-        m_matOverlap.setZero();
+    MatrixXd matDataOut(matDataIn.rows(), matDataIn.cols());
+
+    filterChannelsConcurrently(matDataIn, matDataOut, iMaxFilterLength, lFilterChannelList, lFilterData);
+
+    return matDataOut;
+}
+
+
+//*************************************************************************************************************
+
+void RtFilter::filterChannelsConcurrently(const MatrixXd& matDataIn, MatrixXd& matDataOut, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<FilterData>& lFilterData)
+{
+    if(matDataOut.rows() != matDataIn.rows() || matDataOut.cols() != matDataIn.cols()) {
+        matDataOut.resize(matDataIn.rows(), matDataIn.cols());
     }
 
-    if(m_matDelay.cols() != iMaxFilterLength/2 || m_matOverlap.rows() < matDataIn.rows()) {
-        m_matDelay.resize(matDataIn.rows(), iMaxFilterLength/2);
-        m_matDelay.setZero();
+    Q_UNUSED(iMaxFilterLength);
+
+    const int iBlockSize = matDataIn.cols();
+
+    updateCoefficients(lFilterData);
+    updateChannels(matDataIn.rows(), lFilterChannelList);
+
+    //Filter the selected channels with the overlap-save method
+    const int iNumFilterChannels = m_vecFilterChannels.size();
+
+    if(iNumFilterChannels > 0 && m_vecCoeffs.cols() > 0 && iBlockSize > 0) {
+        const FilterPlan& plan = getPlan(iBlockSize);
+
+        //Gather the filtered channels into a channel-major layout, i.e. the samples of one channel are contiguous
+        if(m_matBlockIn.rows() != iBlockSize || m_matBlockIn.cols() != iNumFilterChannels) {
+            m_matBlockIn.resize(iBlockSize, iNumFilterChannels);
+            m_matBlockOut.resize(iBlockSize, iNumFilterChannels);
+        }
+        for(int c = 0; c < iNumFilterChannels; ++c) {
+            m_matBlockIn.col(c) = matDataIn.row(m_vecFilterChannels[c]).transpose();
+        }
+
+        //(Re-)Size the worker buffers when the FFT length changed
+        if(m_iWorkerFFTLength != plan.iFFTLength) {
+            for(int i = 0; i < m_lWorkers.size(); ++i) {
+                m_lWorkers[i].vecTime.resize(plan.iFFTLength);
+                m_lWorkers[i].vecFreq.resize(plan.iFFTLength/2 + 1);
+            }
+            m_iWorkerFFTLength = plan.iFFTLength;
+        }
+
+        if(m_lWorkers.size() == 1) {
+            filterWorkerChannels(m_lWorkers[0], plan);
+        } else {
+            QtConcurrent::blockingMap(m_lWorkers, [this, &plan](FilterWorker& worker) {
+                filterWorkerChannels(worker, plan);
+            });
+        }
+
+        for(int c = 0; c < iNumFilterChannels; ++c) {
+            matDataOut.row(m_vecFilterChannels[c]) = m_matBlockOut.col(c).transpose();
+        }
     }
 
-    //Resize output matrix to match input matrix
-    MatrixXd matDataOut(matDataIn.rows(), matDataIn.cols());
+    //Unfiltered channels are delayed by the group delay of the combined linear-phase filter, i.e. half its length.
+    //The delay line may span several blocks.
+    const int iDelay = m_filterMode == LinearPhase ? qMax(int(m_vecCoeffs.cols()) - 1, 0)/2 : 0;
+    const int iNumPassChannels = m_vecPassChannels.size();
 
-    //Generate QList structure which can be handled by the QConcurrent framework
-    QList<QPair<QList<FilterData>,QPair<int,RowVectorXd> > > timeData;
-    QList<int> notFilterChannelIndex;
+    if(m_matDelay.rows() != iNumPassChannels || m_matDelay.cols() != iDelay) {
+        m_matDelay = MatrixXd::Zero(iNumPassChannels, iDelay);
+    }
+
+    for(int i = 0; i < iNumPassChannels; ++i) {
+        const int iChannel = m_vecPassChannels[i];
 
-    //Only select channels specified in lFilterChannelList
-    for(qint32 i = 0; i < matDataIn.rows(); ++i) {
-        int pos = lFilterChannelList.indexOf(i);
-        if(pos != -1 && pos < matDataIn.rows()) {
-            timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(lFilterData,QPair<int,RowVectorXd>(pos,matDataIn.row(pos))));
+        if(iDelay == 0) {
+            matDataOut.row(iChannel) = matDataIn.row(iChannel);
+        } else if(iBlockSize >= iDelay) {
+            matDataOut.row(iChannel).head(iDelay) = m_matDelay.row(i);
+            matDataOut.row(iChannel).tail(iBlockSize - iDelay) = matDataIn.row(iChannel).head(iBlockSize - iDelay);
+            m_matDelay.row(i) = matDataIn.row(iChannel).tail(iDelay);
         } else {
-            notFilterChannelIndex.append(i);
+            matDataOut.row(iChannel) = m_matDelay.row(i).head(iBlockSize);
+            m_matDelay.row(i).head(iDelay - iBlockSize) = m_matDelay.row(i).tail(iDelay - iBlockSize).eval();
+            m_matDelay.row(i).tail(iBlockSize) = matDataIn.row(iChannel);
         }
     }
+}
+
 
-    //Do the concurrent filtering
-    if(!timeData.isEmpty()) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                             doFilterPerChannelRTMSA);
+//*************************************************************************************************************
 
-        future.waitForFinished();
+void RtFilter::updateCoefficients(const QList<FilterData>& lFilterData)
+{
+    bool bChanged = lFilterData.size() != m_lFilterCoeffs.size();
 
-        //Do the overlap add method and store in matDataOut
-        int iFilteredNumberCols = timeData.at(0).second.second.cols();
+    for(int i = 0; !bChanged && i < lFilterData.size(); ++i) {
+        const RowVectorXd& vecCoeffs = lFilterData.at(i).m_dCoeffA;
+        bChanged = vecCoeffs.cols() != m_lFilterCoeffs.at(i).cols() || vecCoeffs != m_lFilterCoeffs.at(i);
+    }
 
-        for(int r = 0; r < timeData.size(); r++) {
-            //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-            RowVectorXd tempData = timeData.at(r).second.second;
+    if(!bChanged) {
+        return;
+    }
 
-            //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-            tempData.head(iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
+    //Filters applied one after another equal one filter with the convolved impulse responses
+    m_lFilterCoeffs.clear();
+    m_vecCoeffs.resize(0);
 
-            //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
-            int start = 0;
-            matDataOut.row(timeData.at(r).second.first).segment(start,iFilteredNumberCols-iMaxFilterLength) = tempData.head(iFilteredNumberCols-iMaxFilterLength);
+    for(int i = 0; i < lFilterData.size(); ++i) {
+        const RowVectorXd& vecCoeffs = lFilterData.at(i).m_dCoeffA;
+        m_lFilterCoeffs.append(vecCoeffs);
 
-            //Refresh the m_matOverlap with the new calculated filtered data.
-            m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(iMaxFilterLength);
+        if(vecCoeffs.cols() == 0) {
+            continue;
+        }
+
+        if(m_vecCoeffs.cols() == 0) {
+            m_vecCoeffs = vecCoeffs;
+        } else {
+            RowVectorXd vecConv = RowVectorXd::Zero(m_vecCoeffs.cols() + vecCoeffs.cols() - 1);
+            for(int k = 0; k < vecCoeffs.cols(); ++k) {
+                vecConv.segment(k, m_vecCoeffs.cols()) += vecCoeffs(k) * m_vecCoeffs;
+            }
+            m_vecCoeffs = vecConv;
         }
     }
 
-    //Fill filtered data with raw data if the channel was not filtered
-    for(int i = 0; i < notFilterChannelIndex.size(); ++i) {
-        matDataOut.row(notFilterChannelIndex.at(i)) << m_matDelay.row(notFilterChannelIndex.at(i)), matDataIn.row(notFilterChannelIndex.at(i)).head(matDataIn.cols() - iMaxFilterLength/2);
+    if(m_filterMode == MinimumPhase && m_vecCoeffs.cols() > 1) {
+        m_vecCoeffs = minimumPhase(m_vecCoeffs);
+    }
+
+    //The plans and the signal history depend on the filter length
+    m_mapPlans.clear();
+    m_matHistory = MatrixXd::Zero(qMax(int(m_vecCoeffs.cols()) - 1, 0), m_vecFilterChannels.size());
+}
+
 
-        //matDataOut.row(notFilterChannelIndex.at(i)).segment(0, matDataIn.row(notFilterChannelIndex.at(i)).cols()) = matDataIn.row(notFilterChannelIndex.at(i));
+//*************************************************************************************************************
+
+void RtFilter::updateChannels(int iNumChannels, const QVector<int>& lFilterChannelList)
+{
+    if(iNumChannels == m_iNumChannels && lFilterChannelList == m_lFilterChannelList) {
+        return;
     }
 
-    m_matDelay = matDataIn.block(0, matDataIn.cols()-iMaxFilterLength/2, matDataIn.rows(), iMaxFilterLength/2);
+    m_iNumChannels = iNumChannels;
+    m_lFilterChannelList = lFilterChannelList;
 
-    return matDataOut;
+    m_vecFilterChannels.clear();
+    m_vecPassChannels.clear();
+
+    QVector<bool> vecIsFiltered(iNumChannels, false);
+    for(int i = 0; i < lFilterChannelList.size(); ++i) {
+        if(lFilterChannelList.at(i) >= 0 && lFilterChannelList.at(i) < iNumChannels) {
+            vecIsFiltered[lFilterChannelList.at(i)] = true;
+        }
+    }
+
+    for(int i = 0; i < iNumChannels; ++i) {
+        if(vecIsFiltered.at(i)) {
+            m_vecFilterChannels.append(i);
+        } else {
+            m_vecPassChannels.append(i);
+        }
+    }
+
+    m_matHistory = MatrixXd::Zero(qMax(int(m_vecCoeffs.cols()) - 1, 0), m_vecFilterChannels.size());
+    m_matDelay.resize(0,0);
+
+    //Distribute the channels in contiguous ranges over the workers
+    const int iNumFilterChannels = m_vecFilterChannels.size();
+    const int iNumWorkers = qMax(1, qMin(QThread::idealThreadCount(), iNumFilterChannels));
+
+    m_lWorkers.clear();
+    m_iWorkerFFTLength = 0;
+
+    for(int i = 0; i < iNumWorkers; ++i) {
+        FilterWorker worker;
+        worker.iFirstChannel = (i * iNumFilterChannels) / iNumWorkers;
+        worker.iNumChannels = ((i + 1) * iNumFilterChannels) / iNumWorkers - worker.iFirstChannel;
+        worker.fft.SetFlag(worker.fft.HalfSpectrum);
+        m_lWorkers.append(worker);
+    }
+}
+
+
+//*************************************************************************************************************
+
+const RtFilter::FilterPlan& RtFilter::getPlan(int iBlockSize)
+{
+    QMap<int, FilterPlan>::iterator it = m_mapPlans.find(iBlockSize);
+
+    if(it != m_mapPlans.end()) {
+        return it.value();
+    }
+
+    FilterPlan plan;
+
+    //Linear convolution of the history and the new block has to fit into the FFT length to avoid circular aliasing
+    plan.iFFTLength = 4;
+    while(plan.iFFTLength < iBlockSize + m_vecCoeffs.cols() - 1) {
+        plan.iFFTLength *= 2;
+    }
+
+    VectorXd vecCoeffsZeroPad = VectorXd::Zero(plan.iFFTLength);
+    vecCoeffsZeroPad.head(m_vecCoeffs.cols()) = m_vecCoeffs.transpose();
+
+    Eigen::FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+    plan.vecFreqCoeffs.resize(plan.iFFTLength/2 + 1);
+    fft.fwd(plan.vecFreqCoeffs.data(), vecCoeffsZeroPad.data(), plan.iFFTLength);
+
+    return m_mapPlans.insert(iBlockSize, plan).value();
+}
+
+
+//*************************************************************************************************************
+
+void RtFilter::filterWorkerChannels(FilterWorker& worker, const FilterPlan& plan)
+{
+    const int iBlockSize = m_matBlockIn.rows();
+    const int iHistory = m_matHistory.rows();
+    double* pTime = worker.vecTime.data();
+
+    for(int c = worker.iFirstChannel; c < worker.iFirstChannel + worker.iNumChannels; ++c) {
+        //[history | block | zeros]
+        Map<VectorXd>(pTime, iHistory) = m_matHistory.col(c);
+        Map<VectorXd>(pTime + iHistory, iBlockSize) = m_matBlockIn.col(c);
+        Map<VectorXd>(pTime + iHistory + iBlockSize, plan.iFFTLength - iHistory - iBlockSize).setZero();
+
+        //Keep the last samples as history for the next block
+        double* pHistory = m_matHistory.col(c).data();
+        if(iBlockSize >= iHistory) {
+            Map<VectorXd>(pHistory, iHistory) = m_matBlockIn.col(c).tail(iHistory);
+        } else {
+            for(int i = 0; i < iHistory - iBlockSize; ++i) {
+                pHistory[i] = pHistory[i + iBlockSize];
+            }
+            Map<VectorXd>(pHistory + iHistory - iBlockSize, iBlockSize) = m_matBlockIn.col(c);
+        }
+
+        worker.fft.fwd(worker.vecFreq.data(), pTime, plan.iFFTLength);
+        worker.vecFreq.array() *= plan.vecFreqCoeffs.array();
+        worker.fft.inv(pTime, worker.vecFreq.data(), plan.iFFTLength);
+
+        //The first (filter length - 1) samples are corrupted by the circular convolution, the rest is the valid output
+        m_matBlockOut.col(c) = Map<VectorXd>(pTime + iHistory, iBlockSize);
+    }
+}
+
+
+//*************************************************************************************************************
+
+RowVectorXd RtFilter::minimumPhase(const RowVectorXd& vecCoeffs)
+{
+    //Oversample the spectrum to keep the aliasing of the cepstrum low
+    int iFFTLength = 4;
+    while(iFFTLength < 8 * vecCoeffs.cols()) {
+        iFFTLength *= 2;
+    }
+
+    Eigen::FFT<double> fft;
+
+    VectorXcd vecCoeffsZeroPad = VectorXcd::Zero(iFFTLength);
+    vecCoeffsZeroPad.head(vecCoeffs.cols()) = vecCoeffs.transpose().cast<std::complex<double> >();
+
+    VectorXcd vecFreq;
+    fft.fwd(vecFreq, vecCoeffsZeroPad);
+
+    //Real cepstrum of the log magnitude, zeros of the stopband are floored
+    double dFloor = 1e-10 * vecFreq.cwiseAbs().maxCoeff();
+    VectorXcd vecLogMag(iFFTLength);
+    for(int i = 0; i < iFFTLength; ++i) {
+        vecLogMag(i) = std::log(qMax(std::abs(vecFreq(i)), dFloor));
+    }
+
+    VectorXcd vecCepstrum;
+    fft.inv(vecCepstrum, vecLogMag);
+
+    //Fold the anti-causal part onto the causal part
+    VectorXcd vecFolded = VectorXcd::Zero(iFFTLength);
+    vecFolded(0) = vecCepstrum(0).real();
+    for(int i = 1; i < iFFTLength/2; ++i) {
+        vecFolded(i) = 2.0 * vecCepstrum(i).real();
+    }
+    vecFolded(iFFTLength/2) = vecCepstrum(iFFTLength/2).real();
+
+    VectorXcd vecMinFreq;
+    fft.fwd(vecMinFreq, vecFolded);
+    vecMinFreq = vecMinFreq.array().exp();
+
+    VectorXcd vecMinTime;
+    fft.inv(vecMinTime, vecMinFreq);
+
+    return vecMinTime.head(vecCoeffs.cols()).real().transpose();
 }
@@ -54,6 +54,8 @@
 #include <QSharedPointer>
 #include <QtConcurrent/QtConcurrent>
 #include <QFuture>
+#include <QMap>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -82,52 +84,182 @@ namespace RTPROCESSINGLIB
 
 //=============================================================================================================
 /**
-* Real-time noise Spectrum estimation
+* Real-time multichannel FIR filtering. The filters are applied block by block with the overlap-save method. The
+* frequency-domain coefficients are cached per filter set and block size, the FFT work buffers are kept per worker
+* thread and the channels are processed in a channel-major (contiguous samples) layout. Once the filter set and the
+* block size are stable no memory is allocated anymore.
 *
-* @brief Real-time Noise estimation
+* @brief Real-time overlap-save FIR filtering
 */
 class RTPROCESSINGSHARED_EXPORT RtFilter
 {
-
 public:
     typedef QSharedPointer<RtFilter> SPtr;             /**< Shared pointer type for RtFilter. */
     typedef QSharedPointer<const RtFilter> ConstSPtr;  /**< Const shared pointer type for RtFilter. */
 
+    enum FilterMode {
+        LinearPhase,    /**< Linear-phase FIR, constant delay of half the combined filter length. Unfiltered channels are delayed accordingly. */
+        MinimumPhase    /**< Minimum-phase equivalent of the FIR with the same magnitude response. Fully causal with minimum latency, unfiltered channels are not delayed. */
+    };
+
     //=========================================================================================================
     /**
-    * Creates the real-time covariance estimation object.
+    * Creates the real-time filter object.
+    *
+    * @param [in] mode      the filter mode, linear-phase by default.
     */
-    explicit RtFilter();
+    explicit RtFilter(FilterMode mode = LinearPhase);
 
     //=========================================================================================================
     /**
-    * Destroys the Real-time noise estimation object.
+    * Destroys the real-time filter object.
     */
     ~RtFilter();
 
+    //=========================================================================================================
+    /**
+    * Sets the filter mode. Resets the filter state.
+    *
+    * @param [in] mode      the new filter mode.
+    */
+    void setFilterMode(FilterMode mode);
+
+    //=========================================================================================================
+    /**
+    * Returns the current filter mode.
+    *
+    * @return the filter mode.
+    */
+    inline FilterMode getFilterMode() const;
+
+    //=========================================================================================================
+    /**
+    * Clears the filter state (signal history) and all cached filter plans.
+    */
+    void reset();
+
     //=========================================================================================================
     /**
     * Calculates the filtered version of the raw input data
     *
-    * @param [in] matDataIn     data which is to be filtered
-    * @param [out] matDataOut    data which is to be filtered
-    * @param [in] iDataIndex    current position in the global data matrix
+    * @param [in] matDataIn             data which is to be filtered
+    * @param [in] iMaxFilterLength      the maximal filter length of lFilterData. Kept for compatibility, the delay of the unfiltered channels follows from the combined filter
+    * @param [in] lFilterChannelList    the indices of the channels which are to be filtered
+    * @param [in] lFilterData           the filters which are applied one after another
+    *
+    * @return the filtered data
     */
     Eigen::MatrixXd filterChannelsConcurrently(const Eigen::MatrixXd& matDataIn, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<UTILSLIB::FilterData> &lFilterData);
 
+    //=========================================================================================================
+    /**
+    * Calculates the filtered version of the raw input data and writes it to a caller owned matrix, which is only
+    * resized if its dimensions do not match matDataIn.
+    *
+    * @param [in] matDataIn             data which is to be filtered
+    * @param [out] matDataOut           the filtered data
+    * @param [in] iMaxFilterLength      the maximal filter length of lFilterData. Kept for compatibility, the delay of the unfiltered channels follows from the combined filter
+    * @param [in] lFilterChannelList    the indices of the channels which are to be filtered
+    * @param [in] lFilterData           the filters which are applied one after another
+    */
+    void filterChannelsConcurrently(const Eigen::MatrixXd& matDataIn, Eigen::MatrixXd& matDataOut, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<UTILSLIB::FilterData> &lFilterData);
+
 protected:
-    Eigen::MatrixXd                 m_matOverlap;                   /**< Last overlap block */
-    Eigen::MatrixXd                 m_matDelay;                     /**< Last delay block */
+    Eigen::MatrixXd                 m_matHistory;                   /**< Last (filter length - 1) input samples of the filtered channels, one column per channel */
+    Eigen::MatrixXd                 m_matDelay;                     /**< Delay line of the unfiltered channels, one row per unfiltered channel, as long as the group delay */
 
 private:
+    /**
+    * Frequency-domain representation of the filter for one block size.
+    */
+    struct FilterPlan {
+        int                 iFFTLength;         /**< FFT length, power of 2 >= block size + filter length - 1 */
+        Eigen::VectorXcd    vecFreqCoeffs;      /**< Half spectrum of the zero-padded filter coefficients */
+    };
 
+    /**
+    * Work buffers of one worker, which filters a contiguous range of channels.
+    */
+    struct FilterWorker {
+        int                 iFirstChannel;      /**< First channel (column) processed by this worker */
+        int                 iNumChannels;       /**< Number of channels processed by this worker */
+        Eigen::FFT<double>  fft;                /**< FFT object, keeps the plans (twiddles) of the used FFT lengths */
+        Eigen::VectorXd     vecTime;            /**< Time-domain work buffer */
+        Eigen::VectorXcd    vecFreq;            /**< Frequency-domain work buffer */
+    };
+
+    //=========================================================================================================
+    /**
+    * Combines the filters to one impulse response. The state is reset if the filters changed.
+    *
+    * @param [in] lFilterData   the filters which are applied one after another
+    */
+    void updateCoefficients(const QList<UTILSLIB::FilterData> &lFilterData);
+
+    //=========================================================================================================
+    /**
+    * Updates the channel selection and the per channel state. The state is reset if the selection changed.
+    *
+    * @param [in] iNumChannels          number of channels of the input data
+    * @param [in] lFilterChannelList    the indices of the channels which are to be filtered
+    */
+    void updateChannels(int iNumChannels, const QVector<int>& lFilterChannelList);
+
+    //=========================================================================================================
+    /**
+    * Returns the cached filter plan for a block size, creates it if necessary.
+    *
+    * @param [in] iBlockSize    the number of samples per block
+    *
+    * @return the filter plan
+    */
+    const FilterPlan& getPlan(int iBlockSize);
+
+    //=========================================================================================================
+    /**
+    * Filters the channels of one worker with the overlap-save method.
+    *
+    * @param [in] worker    the worker and its buffers
+    * @param [in] plan      the filter plan of the current block size
+    */
+    void filterWorkerChannels(FilterWorker& worker, const FilterPlan& plan);
+
+    //=========================================================================================================
+    /**
+    * Converts a FIR filter to its minimum-phase equivalent with the same magnitude response (homomorphic method).
+    *
+    * @param [in] vecCoeffs     the FIR filter coefficients
+    *
+    * @return the minimum-phase filter coefficients of the same length
+    */
+    static Eigen::RowVectorXd minimumPhase(const Eigen::RowVectorXd& vecCoeffs);
+
+    FilterMode                      m_filterMode;                   /**< The filter mode */
+    QList<Eigen::RowVectorXd>       m_lFilterCoeffs;                /**< Coefficients of the filters the cache was built for */
+    Eigen::RowVectorXd              m_vecCoeffs;                    /**< Combined impulse response of all filters */
+    QMap<int, FilterPlan>           m_mapPlans;                     /**< Cached filter plans per block size */
+    QVector<int>                    m_lFilterChannelList;           /**< Channel selection the state was built for */
+    int                             m_iNumChannels;                 /**< Number of input channels the state was built for */
+    QVector<int>                    m_vecFilterChannels;            /**< Indices of the filtered channels */
+    QVector<int>                    m_vecPassChannels;              /**< Indices of the unfiltered channels */
+    QList<FilterWorker>             m_lWorkers;                     /**< Workers, each with its own FFT and buffers */
+    int                             m_iWorkerFFTLength;             /**< FFT length the worker buffers are sized for */
+    Eigen::MatrixXd                 m_matBlockIn;                   /**< Filtered channels of the current input block, one column per channel */
+    Eigen::MatrixXd                 m_matBlockOut;                  /**< Filtered channels of the current output block, one column per channel */
 };
 
+
 //*************************************************************************************************************
 //=============================================================================================================
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+inline RtFilter::FilterMode RtFilter::getFilterMode() const
+{
+    return m_filterMode;
+}
+
+
 } // NAMESPACE
 
 #endif // RTFILTER_H
@@ -45,7 +45,7 @@
 
 #include <iostream>
 #include <fiff/fiff_cov.h>
-#include <fstream>
+#include <algorithm>
 
 
 //*************************************************************************************************************
@@ -63,6 +63,7 @@
 //=============================================================================================================
 
 #include <QElapsedTimer>
+#include <QMutexLocker>
 #include <QDebug>
 
 
@@ -75,6 +76,90 @@ using namespace RTPROCESSINGLIB;
 using namespace FIFFLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+const int HPI_LM_MAX_ITER = 50;                 /**< Maximal number of Levenberg-Marquardt iterations per coil */
+const double HPI_LM_POS_TOL = 1e-9;             /**< Step length in m below which the fit has converged */
+const double HPI_MAX_WARM_START_ERROR = 0.05;   /**< Relative error above which a warm started fit is repeated from a cold start */
+const double HPI_COLD_START_DEPTH = 0.02;       /**< Distance in m of the cold start point below the sensor with the largest amplitude */
+
+QMutex devHeadTransMutex;                       /**< Guards FiffInfo::dev_head_t.trans, which is updated by the head tracking */
+
+//=============================================================================================================
+/**
+* Lead field of a magnetic dipole at pos in an infinite medium, see RtHPIS::magnetic_dipole.
+*/
+void dipoleLeadfield(const Vector3d &pos, const struct sens &sensors, bool bUseTra, MatrixXd &lf)
+{
+    const double dScale = 1e-7 / (4 * M_PI);
+    const int nchan = sensors.coilpos.rows();
+
+    lf.resize(nchan, 3);
+    for(int i = 0; i < nchan; ++i) {
+        Vector3d R = sensors.coilpos.row(i).transpose() - pos;
+        Vector3d o = sensors.coilori.row(i).transpose();
+        double r2 = R.squaredNorm();
+        double r5 = r2 * r2 * std::sqrt(r2);
+        lf.row(i) = (dScale / r5) * (3 * R.dot(o) * R - r2 * o).transpose();
+    }
+
+    if(bUseTra) {
+        lf = sensors.tra * lf;
+    }
+}
+
+//=============================================================================================================
+/**
+* Derivative of the field of a magnetic dipole with moment mom with respect to the dipole position.
+* Row i holds the gradient of sensor i.
+*/
+void dipoleFieldGradient(const Vector3d &pos, const Vector3d &mom, const struct sens &sensors, bool bUseTra, MatrixXd &grad)
+{
+    const double dScale = 1e-7 / (4 * M_PI);
+    const int nchan = sensors.coilpos.rows();
+
+    grad.resize(nchan, 3);
+    for(int i = 0; i < nchan; ++i) {
+        Vector3d R = sensors.coilpos.row(i).transpose() - pos;
+        Vector3d o = sensors.coilori.row(i).transpose();
+        double r2 = R.squaredNorm();
+        double r5 = r2 * r2 * std::sqrt(r2);
+        double Ro = R.dot(o);
+        double Rm = R.dot(mom);
+        double om = o.dot(mom);
+
+        //f = (3 (R.o)(R.m) - r^2 (o.m)) / r^5, the dipole position enters as R = coilpos - pos
+        Vector3d gradR = (3 * (Rm * o + Ro * mom) - 2 * om * R) / r5 - (5 * (3 * Ro * Rm - r2 * om) / (r5 * r2)) * R;
+        grad.row(i) = -dScale * gradR.transpose();
+    }
+
+    if(bUseTra) {
+        grad = sensors.tra * grad;
+    }
+}
+
+//=============================================================================================================
+/**
+* Solves the dipole moment by linear least squares and returns the relative residual error.
+*/
+double dipoleResidual(const MatrixXd &lf, const VectorXd &data, double dDataNorm, LDLT<Matrix3d> &ldlt, Vector3d &mom, VectorXd &res)
+{
+    ldlt.compute(lf.transpose() * lf);
+    mom = ldlt.solve(lf.transpose() * data);
+    res = data - lf * mom;
+
+    return res.squaredNorm() / dDataNorm;
+}
+
+} // anonymous namespace
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -87,11 +172,13 @@ RtHPIS::RtHPIS(FiffInfo::SPtr p_pFiffInfo, QObject *parent)
 , m_iMaxSamples(0)
 , m_iNewMaxSamples(0)
 , simplex_numitr(0)
+, m_iLocalizationRate(1)
 {
     qRegisterMetaType<Eigen::MatrixXd>("Eigen::MatrixXd");
     //qRegisterMetaType<QVector<double>>("QVector<double>");
     SendDataToBuffer = true;
 
+    m_lastCoilFit.dpfittime = 0;
 }
 
 
@@ -117,6 +204,42 @@ void RtHPIS::append(const MatrixXd &p_DataSegment)
 }
 
 
+//*************************************************************************************************************
+
+void RtHPIS::setLocalizationRate(int iRate)
+{
+    QMutexLocker locker(&mutex);
+    m_iLocalizationRate = iRate > 0 ? iRate : 1;
+}
+
+
+//*************************************************************************************************************
+
+coilParam RtHPIS::getLastFit()
+{
+    QMutexLocker locker(&mutex);
+    return m_lastCoilFit;
+}
+
+
+//*************************************************************************************************************
+
+Eigen::Matrix4d RtHPIS::getDevHeadTrans(const FiffInfo &info)
+{
+    QMutexLocker locker(&devHeadTransMutex);
+    return info.dev_head_t.trans.cast<double>();
+}
+
+
+//*************************************************************************************************************
+
+void RtHPIS::setDevHeadTrans(FiffInfo &info, const Eigen::Matrix4d &trans)
+{
+    QMutexLocker locker(&devHeadTransMutex);
+    info.dev_head_t.trans = trans.cast<float>();
+}
+
+
 //*************************************************************************************************************
 
 bool RtHPIS::start()
@@ -158,7 +281,10 @@ void RtHPIS::run()
     int numCoils = 4;
     int numCh = m_pFiffInfo->nchan;
     int samF = m_pFiffInfo->sfreq;
-    int numLoc = 1, numBlock, samLoc; // numLoc : Number of times to localize in a second
+    int numLoc, numBlock, samLoc; // numLoc : Number of times to localize in a second
+    mutex.lock();
+    numLoc = m_iLocalizationRate;
+    mutex.unlock();
     samLoc = samF/numLoc; // minimum samples required to localize numLoc times in a second
     Eigen::VectorXd coilfreq(numCoils);
 //    coilfreq[0] = 155;  coilfreq[1] = 160;  coilfreq[2] = 165;  coilfreq[3] = 170;
@@ -170,6 +296,8 @@ void RtHPIS::run()
     coil.mom = Eigen::MatrixXd::Zero(numCoils,3);
     coil.dpfiterror = Eigen::VectorXd::Zero(numCoils);
     coil.dpfitnumitr = Eigen::VectorXd::Zero(numCoils);
+    coil.dpfitgof = Eigen::VectorXd::Zero(numCoils);
+    coil.dpfittime = 0;
 
     // Generate simulated data
     Eigen::MatrixXd simsig(samLoc,numCoils*2);
@@ -177,25 +305,15 @@ void RtHPIS::run()
 
     for (int i = 0;i < samLoc;i++) time[i] = i*1.0/samF;
 
-    std::ofstream outsin;
-    outsin.open ("C:/Users/babyMEG/Desktop/Seok/sin.txt");
-    std::ofstream outcos;
-    outcos.open ("C:/Users/babyMEG/Desktop/Seok/cos.txt");
-
     for(int i=0;i<numCoils;i++) {
         for(int j=0;j<samLoc;j++) {
             simsig(j,i) = sin(2*M_PI*coilfreq[i]*time[j]);
             simsig(j,i+numCoils) = cos(2*M_PI*coilfreq[i]*time[j]);
-
-            outsin <<simsig(j,i)<<" ";
-            outcos <<simsig(j,i+numCoils) << " ";
         }
-            outsin <<"\n";
-            outcos <<"\n";
     }
 
-    outsin.close();
-    outcos.close();
+    // The demodulation basis only depends on the window length, hence its pseudo inverse is computed once
+    Eigen::MatrixXd simsigPinvT = pinv(simsig).transpose();
 
     // Get the indices of inner layer channels
     QVector<int> innerind(0);
@@ -279,60 +397,27 @@ void RtHPIS::run()
     Eigen::Matrix4d trans;
 
     QVector<MatrixXd> buffer;
+    int iBufferedSamples = 0;
     double phase;
 
-    // Seok ---------------------------------
-    qDebug()<< "======= coil driving frequency (Hz)======== ";
-    qDebug() << coilfreq[0] << ", " << coilfreq[1] << ", " << coilfreq[2] << ", " << coilfreq[3];
-//    qDebug() << "samLoc (1024): " << samLoc;
-    int OUT_FLAG = 1;
-    int OUT_RAW = 1;
-    std::ofstream outinnerdata;
-    outinnerdata.open ("C:/Users/babyMEG/Desktop/Seok/innerdata.txt");
-    std::ofstream outtrigdata;
-    outtrigdata.open ("C:/Users/babyMEG/Desktop/Seok/trigdata.txt");
-
-    std::ofstream outtopo;
-    outtopo.open ("C:/Users/babyMEG/Desktop/Seok/topo.txt");
-    std::ofstream outamp;
-    outamp.open ("C:/Users/babyMEG/Desktop/Seok/amp.txt");
-    std::ofstream outphase;
-    outphase.open ("C:/Users/babyMEG/Desktop/Seok/phase.txt");
-    std::ofstream outxfm;
-    outxfm.open ("C:/Users/babyMEG/Desktop/Seok/xfm.txt");
-    std::ofstream outcoilp;
-    outcoilp.open ("C:/Users/babyMEG/Desktop/Seok/coilp.txt");
-    std::ofstream outcoilm;
-    outcoilm.open ("C:/Users/babyMEG/Desktop/Seok/coilm.txt");
-    std::ofstream outdpfiterror;
-    outdpfiterror.open ("C:/Users/babyMEG/Desktop/Seok/dpfiterror.txt");
-    std::ofstream outdpfitnumitr;
-    outdpfitnumitr.open ("C:/Users/babyMEG/Desktop/Seok/dpfitnumitr.txt");
-
-    // --------------------------------------
-
-    int counter = 0;
-    int sum = 0;
-
     while(m_bIsRunning)
     {
         if(m_pRawMatrixBuffer)
         {
-            QElapsedTimer timer;
-            timer.start();
-
             MatrixXd t_mat = m_pRawMatrixBuffer->pop();
 
             buffer.append(t_mat);
 //            qDebug() << "buffer(size): " << buffer.length();
 //            qDebug() << "t_mat(size): " << t_mat.rows() << " x " << t_mat.cols();
 
-            if(buffer.size()*t_mat.cols() >= samLoc)
+            iBufferedSamples += t_mat.cols();
+
+            if(iBufferedSamples >= samLoc)
             {
-                Eigen::MatrixXd alldata(t_mat.rows(),buffer.size()*t_mat.cols());
+                Eigen::MatrixXd alldata(t_mat.rows(),iBufferedSamples);
 
                 // Concatenate data into a matrix
-                for(int i=0;i<buffer.size();i++) alldata << buffer[i];
+                for(int i=0, iCol=0;i<buffer.size();iCol+=buffer[i].cols(),i++) alldata.block(0,iCol,t_mat.rows(),buffer[i].cols()) = buffer[i];
 
                 // Get the data from inner layer channels
                 Eigen::MatrixXd innerdata(innerind.size(),samLoc);
@@ -340,27 +425,14 @@ void RtHPIS::run()
 
                 numBlock = alldata.cols()/samLoc;
 
-                // Loop for localizing coils
-                for(int i = 0;i<numBlock;i++) {
+                // Loop for localizing coils - one fit per window
+                for(int iBlock = 0;iBlock<numBlock;iBlock++) {
                     for(int j = 0;j < innerind.size();j++){
-                        innerdata.row(j) << alldata.block(innerind[j],i*samLoc,1,samLoc);
-                        if (OUT_RAW == 1) {
-                            for (int k = 0; k < innerdata.cols(); k++)
-                                outinnerdata << innerdata(j,k) << " ";
-                        }
-                   }
+                        innerdata.row(j) << alldata.block(innerind[j],iBlock*samLoc,1,samLoc);
+                    }
                     for(int j = 0;j < trigind.size();j++){
-                        trigdata.row(j) << alldata.block(trigind[j],i*samLoc,1,samLoc);
-                        if (OUT_RAW == 1) {
-                            for (int k = 0; k < trigdata.cols(); k++)
-                                outtrigdata << trigdata(j,k) << " ";
-                        }
-                   }
-                    if (OUT_RAW == 1) {
-                       outinnerdata << "\n";
-                       outtrigdata << "\n";
-                   }
-                }
+                        trigdata.row(j) << alldata.block(trigind[j],iBlock*samLoc,1,samLoc);
+                    }
 
 //                    qDebug() << "numBlock: " << numBlock;
 //                    qDebug() << "alldata: " << alldata.rows() << " x " << alldata.cols();
@@ -368,22 +440,13 @@ void RtHPIS::run()
 //                    qDebug() << "trigdata: " << trigdata.rows() << " x " << trigdata.cols();
 
                     // topo 247 x 8
-                    topo = innerdata * pinv(simsig).transpose();
+                    topo = innerdata * simsigPinvT;
                     //topo = innerdata * pinv(trigdata.transpose()).transpose();
-                    qDebug() << "topo: " << topo.rows() << " " << topo.cols();
-
-                    for (int i =0; i<numCoils; i++) {
-                        for (int j =0; j< innerind.size(); j++)
-                            outtopo << topo(j,i) << " ";
-
-                        outtopo << "\n";
-                    }
 
 
                     // amp 247 x 4
                     amp = (topo.leftCols(numCoils).array().square() + topo.rightCols(numCoils).array().square()).array().sqrt();
                     //amp = (topo.array().square()).array().sqrt();
-                    qDebug() << "amp: " << amp.rows() << " " << amp.cols();
 
                     for (int i = 0;i < numCoils;i++) {
                         for (int j = 0;j < innerind.size();j++) {
@@ -394,15 +457,6 @@ void RtHPIS::run()
                             else phase = 1;
 
                             amp(j,i) = amp(j,i) * phase;
-
-                            if (OUT_FLAG == 1) {
-                                outamp << amp(j,i) << " ";
-                                outphase << phase << " ";
-                            }
-                        }
-                        if (OUT_FLAG == 1) {
-                            outamp << "\n";
-                            outphase << "\n";
                         }
                     }
 
@@ -414,7 +468,11 @@ void RtHPIS::run()
 //                    coil.pos(1,0) = 0; coil.pos(1,1) = 0; coil.pos(1,2) = 0;
 //                    coil.pos(2,0) = 0; coil.pos(2,1) = 0; coil.pos(2,2) = 0;
 //                    coil.pos(3,0) = 0; coil.pos(3,1) = 0; coil.pos(3,2) = 0;
-                    coil = dipfit(coil, sensors, amp, numCoils);
+                    coil = dipfitLM(coil, sensors, amp, numCoils);
+
+                    mutex.lock();
+                    m_lastCoilFit = coil;
+                    mutex.unlock();
 
 //                    qDebug()<<"HPI head "<<headHPI(0,0)<<" "<<headHPI(0,1)<<" "<<headHPI(0,2);
 //                    qDebug()<<"HPI head "<<headHPI(1,0)<<" "<<headHPI(1,1)<<" "<<headHPI(1,2);
@@ -428,26 +486,9 @@ void RtHPIS::run()
 //                    qDebug()<<"HPI device "<<1e3*coil.pos(3,0)<<" "<<1e3*coil.pos(3,1)<<" "<<1e3*coil.pos(3,2);
 //                    qDebug()<<"HPI dpfit error "<<coil.dpfiterror(0) <<" "<<coil.dpfiterror(1) <<" "<<coil.dpfiterror (2)<<" " << coil.dpfiterror(3);
 
-                    //outcoilp << "   coil position" << "\n";
-                    if (OUT_FLAG == 1) {
-                        outcoilp <<coil.pos(0,0)<<" "<<coil.pos(0,1)<<" "<<coil.pos(0,2) <<"\n";
-                        outcoilp <<coil.pos(1,0)<<" "<<coil.pos(1,1)<<" "<<coil.pos(1,2) <<"\n";
-                        outcoilp <<coil.pos(2,0)<<" "<<coil.pos(2,1)<<" "<<coil.pos(2,2) <<"\n";
-                        outcoilp <<coil.pos(3,0)<<" "<<coil.pos(3,1)<<" "<<coil.pos(3,2) <<"\n";
-
-                        outcoilm <<coil.mom(0,0)<<" "<<coil.mom(0,1)<<" "<<coil.mom(0,2) <<"\n";
-                        outcoilm <<coil.mom(1,0)<<" "<<coil.mom(1,1)<<" "<<coil.mom(1,2) <<"\n";
-                        outcoilm <<coil.mom(2,0)<<" "<<coil.mom(2,1)<<" "<<coil.mom(2,2) <<"\n";
-                        outcoilm <<coil.mom(3,0)<<" "<<coil.mom(3,1)<<" "<<coil.mom(3,2) <<"\n";
-
-                        outdpfiterror << coil.dpfiterror(0) <<" "<<coil.dpfiterror(1) <<" "<<coil.dpfiterror(2) <<" " << coil.dpfiterror(3) <<"\n";
-                        outdpfitnumitr << coil.dpfitnumitr(0) <<" "<<coil.dpfitnumitr(1) <<" "<<coil.dpfitnumitr(2) <<" " << coil.dpfitnumitr(3) <<"\n";
-                    }
                     trans = computeTransformation(coil.pos,headHPI);
 
-                    for(int ti =0; ti<4;ti++)
-                        for(int tj=0;tj<4;tj++)
-                    m_pFiffInfo->dev_head_t.trans(ti,tj) = trans(ti,tj);
+                    setDevHeadTrans(*m_pFiffInfo, trans);
 
 //                    qDebug()<<"**** rotation ------- dev2head transformation ************";
 //                    qDebug()<< trans(0,0)<<" "<<trans(0,1)<<" "<<trans(0,2);
@@ -456,37 +497,19 @@ void RtHPIS::run()
 //                    qDebug()<<"**** translation(dx,dy,dz) - dev2head transformation ***********";
 //                    qDebug()<< 1e3*trans(0,3)<<" "<<1e3*trans(1,3)<<" "<<1e3*trans(2,3);
 
-/*                     if (OUT_FLAG == 1) {
-                    //outxfm << "   rotation" << "\n";
-                    outxfm << trans(0,0)<<" "<<trans(0,1)<<" "<<trans(0,2) <<" "<< trans(0,3)<<"\n";
-                    outxfm << trans(1,0)<<" "<<trans(1,1)<<" "<<trans(1,2) <<" "<< trans(1,3)<<"\n";
-                    outxfm << trans(2,0)<<" "<<trans(2,1)<<" "<<trans(2,2) <<" "<< trans(2,3)<<"\n";
-                    }
-*/
                 }
-                buffer.clear();
-
-                int elapsed = timer.elapsed();
-                qDebug() << "hpi took" << elapsed << "milliseconds";
-
-                counter++;
-                sum += elapsed;
 
-                qDebug() << "current average time for"<< counter <<"values is"<< sum/counter << "milliseconds";
+                // Keep the samples which did not fill a whole window for the next localization
+                int iRemaining = alldata.cols() - numBlock*samLoc;
+                buffer.clear();
+                if(iRemaining > 0)
+                    buffer.append(alldata.rightCols(iRemaining));
+                iBufferedSamples = iRemaining;
+            }
 
         }//m_pRawMatrixBuffer
 
     } //m_bIsRunning
-    outinnerdata.close();
-    outtrigdata.close();
-    outtopo.close();
-    outamp.close();
-    outphase.close();
-    outxfm.close();
-    outcoilp.close();
-    outcoilm.close();
-    outdpfiterror.close();
-    outdpfitnumitr.close();
 
 }
 
@@ -520,6 +543,140 @@ coilParam RtHPIS::dipfit(struct coilParam coil, struct sens sensors, Eigen::Matr
     return coil;
 }
 
+//*************************************************************************************************************
+
+coilParam RtHPIS::dipfitLM(const coilParam &coil, const struct sens &sensors, const Eigen::MatrixXd &data, int numCoils)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    coilParam fit = coil;
+    fit.pos.conservativeResize(numCoils, 3);
+    fit.mom.conservativeResize(numCoils, 3);
+    fit.dpfiterror.conservativeResize(numCoils);
+    fit.dpfitnumitr.conservativeResize(numCoils);
+    fit.dpfitgof.conservativeResize(numCoils);
+
+    Vector3d centroid = sensors.coilpos.colwise().mean().transpose();
+
+    // The coil topographies are demodulated at different frequencies, hence the coils decouple
+    for(int i = 0; i < numCoils; ++i) {
+        VectorXd coilData = data.col(i);
+        Vector3d pos = coil.pos.row(i).transpose();
+        Vector3d mom = Vector3d::Zero();
+        double error = 1.0;
+        int numItr = 0;
+
+        bool bWarmStart = !pos.isZero(0);
+        if(bWarmStart) {
+            error = lmDipoleFit(pos, mom, numItr, coilData, sensors);
+        }
+
+        if(!bWarmStart || error > HPI_MAX_WARM_START_ERROR) {
+            int iMax;
+            coilData.cwiseAbs().maxCoeff(&iMax);
+            Vector3d sensorPos = sensors.coilpos.row(iMax).transpose();
+
+            Vector3d coldPos = sensorPos - HPI_COLD_START_DEPTH * (sensorPos - centroid).normalized();
+            Vector3d coldMom;
+            int coldNumItr = 0;
+            double coldError = lmDipoleFit(coldPos, coldMom, coldNumItr, coilData, sensors);
+
+            numItr += coldNumItr;
+            if(!bWarmStart || coldError < error) {
+                pos = coldPos;
+                mom = coldMom;
+                error = coldError;
+            }
+        }
+
+        fit.pos.row(i) = pos.transpose();
+        fit.mom.row(i) = mom.transpose();
+        fit.dpfiterror(i) = error;
+        fit.dpfitnumitr(i) = numItr;
+        fit.dpfitgof(i) = 1.0 - error;
+    }
+
+    fit.dpfittime = timer.nsecsElapsed() / 1e6;
+
+    return fit;
+}
+
+
+//*************************************************************************************************************
+
+double RtHPIS::lmDipoleFit(Eigen::Vector3d &pos, Eigen::Vector3d &mom, int &numItr, const Eigen::VectorXd &data, const struct sens &sensors)
+{
+    numItr = 0;
+    mom.setZero();
+
+    double dDataNorm = data.squaredNorm();
+    if(dDataNorm == 0) {
+        return 1.0;
+    }
+
+    bool bUseTra = !sensors.tra.isIdentity();
+
+    MatrixXd lf, grad, J;
+    VectorXd res, resTrial;
+    Vector3d momTrial, posTrial, delta;
+    LDLT<Matrix3d> ldlt;
+    Matrix3d JtJ, A;
+    Vector3d Jtr;
+
+    dipoleLeadfield(pos, sensors, bUseTra, lf);
+    double error = dipoleResidual(lf, data, dDataNorm, ldlt, mom, res);
+
+    double lambda = 1e-3;
+    bool bConverged = false;
+
+    while(!bConverged && numItr < HPI_LM_MAX_ITER) {
+        ++numItr;
+
+        // Jacobian of the residual with the moment projected out: J = -(I - L L^+) dL/dpos m
+        dipoleFieldGradient(pos, mom, sensors, bUseTra, grad);
+        J = ldlt.solve(lf.transpose() * grad);
+        J = lf * J - grad;
+
+        JtJ = J.transpose() * J;
+        Jtr = J.transpose() * res;
+
+        bool bAccepted = false;
+        while(!bAccepted) {
+            A = JtJ;
+            A.diagonal() *= 1.0 + lambda;
+            delta = -A.ldlt().solve(Jtr);
+            posTrial = pos + delta;
+
+            dipoleLeadfield(posTrial, sensors, bUseTra, lf);
+            LDLT<Matrix3d> ldltTrial;
+            double errorTrial = dipoleResidual(lf, data, dDataNorm, ldltTrial, momTrial, resTrial);
+
+            if(errorTrial < error) {
+                bConverged = delta.norm() < HPI_LM_POS_TOL || (error - errorTrial) < 1e-12 * error;
+                pos = posTrial;
+                mom = momTrial;
+                res = resTrial;
+                ldlt = ldltTrial;
+                error = errorTrial;
+                lambda = std::max(lambda / 10, 1e-12);
+                bAccepted = true;
+            } else {
+                lambda *= 10;
+                if(lambda > 1e10 || delta.norm() < HPI_LM_POS_TOL) {
+                    // No further descent possible, restore the lead field of the current position
+                    dipoleLeadfield(pos, sensors, bUseTra, lf);
+                    bConverged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    return error;
+}
+
+
 /*********************************************************************************
  * fminsearch Multidimensional unconstrained nonlinear minimization (Nelder-Mead).
  * X = fminsearch(X0, maxiter, maxfun, display, data, sensors) starts at X0 and
@@ -980,6 +1137,7 @@ void RtHPIS::test()
     Eigen::MatrixXd ampl(1,samLoc);
 
     QVector<MatrixXd> buffer;
+    int iBufferedSamples = 0;
 
 
     while(m_bIsRunning)
@@ -989,13 +1147,14 @@ void RtHPIS::test()
             MatrixXd t_mat = m_pRawMatrixBuffer->pop();
 
             buffer.append(t_mat);
+            iBufferedSamples += t_mat.cols();
 
-            if(buffer.size()*t_mat.cols() >= samLoc) {
+            if(iBufferedSamples >= samLoc) {
 
-                Eigen::MatrixXd alldata(t_mat.rows(),buffer.size()*t_mat.cols());
+                Eigen::MatrixXd alldata(t_mat.rows(),iBufferedSamples);
 
                 // Concatenate data into a matrix
-                for(int i=0;i<buffer.size();i++) alldata << buffer[i];
+                for(int i=0, iCol=0;i<buffer.size();iCol+=buffer[i].cols(),i++) alldata.block(0,iCol,t_mat.rows(),buffer[i].cols()) = buffer[i];
 
 
                 // Get the data from inner layer channels
@@ -1004,16 +1163,16 @@ void RtHPIS::test()
 
                 numBlock = alldata.cols()/samLoc;
 
-                // Loop for localizing coils
-                for(int i = 0;i<numBlock;i++) {
+                // Loop for localizing coils - one fit per window
+                for(int iBlock = 0;iBlock<numBlock;iBlock++) {
 
                     for(int j = 0;j < innerind.size();j++) {
                         std::cout << innerind[j] << std::endl;
-                        innerdata.row(j) << alldata.block(innerind[j],i*samLoc,1,samLoc);
+                        innerdata.row(j) << alldata.block(innerind[j],iBlock*samLoc,1,samLoc);
                     }
 
                     for(int j = 0;j < refind.size();j++)
-                        refdata.row(j) << alldata.block(refind[j],i*samLoc,1,samLoc);
+                        refdata.row(j) << alldata.block(refind[j],iBlock*samLoc,1,samLoc);
 
                     ampreal = innerdata*simreal.transpose();
                     ampimag = innerdata*simimag.transpose()*-1;
@@ -1058,12 +1217,16 @@ void RtHPIS::test()
 
                     trans = computeTransformation(coil.pos,headHPI);
 
-                    for(int ti =0; ti<4;ti++)
-                        for(int tj=0;tj<4;tj++)
-                    m_pFiffInfo->dev_head_t.trans(ti,tj) = trans(ti,tj);
+                    setDevHeadTrans(*m_pFiffInfo, trans);
 
                 }
+
+                // Keep the samples which did not fill a whole window for the next localization
+                int iRemaining = alldata.cols() - numBlock*samLoc;
                 buffer.clear();
+                if(iRemaining > 0)
+                    buffer.append(alldata.rightCols(iRemaining));
+                iBufferedSamples = iRemaining;
             }
 
 
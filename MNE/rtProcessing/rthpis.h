@@ -107,6 +107,8 @@ struct coilParam {
     Eigen::MatrixXd mom;
     Eigen::VectorXd dpfiterror;
     Eigen::VectorXd dpfitnumitr;
+    Eigen::VectorXd dpfitgof;
+    double dpfittime;
 };
 
 struct dipError {
@@ -183,6 +185,59 @@ public:
     */
     virtual bool stop();
 
+    //=========================================================================================================
+    /**
+    * Sets the number of coil localizations per second. Each localization demodulates a window of
+    * sfreq/rate samples. Takes effect with the next start(), the RtHpi plugin sets it before starting.
+    *
+    * @param[in] iRate      The number of localizations per second.
+    */
+    void setLocalizationRate(int iRate);
+
+    //=========================================================================================================
+    /**
+    * Returns the most recent coil fit including the goodness of fit of each coil and the fit time.
+    *
+    * @return the most recent coil fit.
+    */
+    coilParam getLastFit();
+
+    //=========================================================================================================
+    /**
+    * Returns the device to head transformation of a measurement info. The head tracking updates it while other
+    * plugins, e.g. RtSss, read it. Both sides go through getDevHeadTrans and setDevHeadTrans.
+    *
+    * @param[in] info       The measurement info.
+    *
+    * @return the device to head transformation.
+    */
+    static Eigen::Matrix4d getDevHeadTrans(const FiffInfo &info);
+
+    //=========================================================================================================
+    /**
+    * Sets the device to head transformation of a measurement info, see getDevHeadTrans.
+    *
+    * @param[in, out] info  The measurement info.
+    * @param[in] trans      The device to head transformation.
+    */
+    static void setDevHeadTrans(FiffInfo &info, const Eigen::Matrix4d &trans);
+
+    //=========================================================================================================
+    /**
+    * Fits the magnetic dipoles of all coils with Levenberg-Marquardt iterations. The dipole moments are
+    * eliminated by linear least squares and the position Jacobian is computed analytically. The previous
+    * coil positions are used as starting points, a coil whose warm started fit is poor or which has no
+    * previous position is additionally fitted from a point below the sensor with the largest amplitude.
+    *
+    * @param[in] coil       The previous coil fit which is used as starting point.
+    * @param[in] sensors    The sensors.
+    * @param[in] data       The coil topographies, one column per coil.
+    * @param[in] numCoils   The number of coils.
+    *
+    * @return the fitted coil parameters, goodness of fit and fit time in ms.
+    */
+    coilParam dipfitLM(const coilParam &coil, const struct sens &sensors, const Eigen::MatrixXd &data, int numCoils);
+
     dipError dipfitError (Eigen::MatrixXd, Eigen::MatrixXd, struct sens);
     Eigen::MatrixXd ft_compute_leadfield(Eigen::MatrixXd, struct sens);
     Eigen::MatrixXd magnetic_dipole(Eigen::MatrixXd, Eigen::MatrixXd, Eigen::MatrixXd);
@@ -213,8 +268,26 @@ protected:
     virtual void run();
 
 private:
+    //=========================================================================================================
+    /**
+    * Levenberg-Marquardt fit of a single magnetic dipole position.
+    *
+    * @param[in, out] pos   The start position, replaced by the fitted position.
+    * @param[out] mom       The fitted dipole moment.
+    * @param[out] numItr    The number of iterations.
+    * @param[in] data       The coil topography.
+    * @param[in] sensors    The sensors.
+    *
+    * @return the relative residual error of the fit.
+    */
+    double lmDipoleFit(Eigen::Vector3d &pos, Eigen::Vector3d &mom, int &numItr, const Eigen::VectorXd &data, const struct sens &sensors);
+
     QMutex      mutex;                  /**< Provides access serialization between threads*/
 
+    int         m_iLocalizationRate;    /**< Number of coil localizations per second. */
+
+    coilParam   m_lastCoilFit;          /**< The most recent coil fit. */
+
     quint32      m_iMaxSamples;         /**< Maximal amount of samples received, before covariance is estimated.*/
 
     quint32      m_iNewMaxSamples;      /**< New maximal amount of samples received, before covariance is estimated.*/
@@ -41,6 +41,8 @@
 
 #include "rtinvop.h"
 
+#include <utils/mnemath.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -50,12 +52,21 @@
 #include <QDebug>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Dense>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
 
 using namespace RTPROCESSINGLIB;
+using namespace UTILSLIB;
 
 
 //*************************************************************************************************************
@@ -68,6 +79,10 @@ RtInvOp::RtInvOp(FiffInfo::SPtr &p_pFiffInfo, MNEForwardSolution::SPtr &p_pFwd,
 , m_bIsRunning(false)
 , m_pFiffInfo(p_pFiffInfo)
 , m_pFwd(p_pFwd)
+, m_updateMode(Incremental)
+, m_iTruncationRank(0)
+, m_bFwdMegPicked(false)
+, m_iMethods(FIFFV_MNE_MEG)
 {
     qRegisterMetaType<MNEInverseOperator::SPtr>("MNEInverseOperator::SPtr");
 }
@@ -91,7 +106,47 @@ void RtInvOp::appendNoiseCov(FiffCov &p_noiseCov)
 
     qDebug() << "RtInvOp m_vecNoiseCov" << m_vecNoiseCov.size();
 
+    m_condNoiseCov.wakeOne();
+    mutex.unlock();
+}
+
+
+//*************************************************************************************************************
+
+void RtInvOp::setUpdateMode(UpdateMode p_updateMode)
+{
+    mutex.lock();
+    m_updateMode = p_updateMode;
+    mutex.unlock();
+}
+
+
+//*************************************************************************************************************
+
+void RtInvOp::setTruncationRank(qint32 p_iRank)
+{
+    mutex.lock();
+    m_iTruncationRank = p_iRank > 0 ? p_iRank : 0;
+    m_matLastEigenVectors.resize(0,0);
+    mutex.unlock();
+}
+
+
+//*************************************************************************************************************
+
+bool RtInvOp::start()
+{
+    //stop() waits for the thread to finish, so a running thread was started twice
+    if(QThread::isRunning())
+        return false;
+
+    mutex.lock();
+    m_bIsRunning = true;
     mutex.unlock();
+
+    QThread::start();
+
+    return true;
 }
 
 
@@ -99,7 +154,11 @@ void RtInvOp::appendNoiseCov(FiffCov &p_noiseCov)
 
 bool RtInvOp::stop()
 {
+    mutex.lock();
     m_bIsRunning = false;
+    m_condNoiseCov.wakeAll();
+    mutex.unlock();
+
     QThread::wait();
 
     return true;
@@ -110,21 +169,211 @@ bool RtInvOp::stop()
 
 void RtInvOp::run()
 {
-    m_bIsRunning = true;
-
-    while(m_bIsRunning)
+    while(true)
     {
-        if(m_vecNoiseCov.size() > 0)
+        // Sleep until a noise covariance arrives or the thread is stopped
+        mutex.lock();
+        while(m_bIsRunning && m_vecNoiseCov.isEmpty())
+            m_condNoiseCov.wait(&mutex);
+
+        if(!m_bIsRunning)
         {
-            // Restrict forward solution as necessary for MEG
-            MNEForwardSolution t_forwardMeg = m_pFwd->pick_types(true, false);
+            mutex.unlock();
+            break;
+        }
 
-            mutex.lock();
-            MNEInverseOperator::SPtr t_invOpMeg(new MNEInverseOperator(*m_pFiffInfo.data(), t_forwardMeg, m_vecNoiseCov[0], 0.2f, 0.8f));
+        // Only the latest estimate matters when incremental - drop the ones which piled up meanwhile
+        UpdateMode t_updateMode = m_updateMode;
+        FiffCov t_noiseCov = t_updateMode == Incremental ? m_vecNoiseCov.last() : m_vecNoiseCov.first();
+        if(t_updateMode == Incremental)
+            m_vecNoiseCov.clear();
+        else
             m_vecNoiseCov.pop_front();
-            mutex.unlock();
+        mutex.unlock();
+
+        MNEInverseOperator::SPtr t_invOpMeg;
+        if(t_updateMode == Incremental)
+        {
+            t_invOpMeg = updateInverseOperator(t_noiseCov);
+        }
+        else
+        {
+            // Restrict forward solution as necessary for MEG
+            MNEForwardSolution t_forwardMeg = m_pFwd->pick_types(true, false);
+            t_invOpMeg = MNEInverseOperator::SPtr(new MNEInverseOperator(*m_pFiffInfo.data(), t_forwardMeg, t_noiseCov, 0.2f, 0.8f));
+        }
 
+        if(t_invOpMeg)
             emit invOperatorCalculated(t_invOpMeg);
+    }
+}
+
+
+//*************************************************************************************************************
+
+MNEInverseOperator::SPtr RtInvOp::updateInverseOperator(const FiffCov &p_noiseCov)
+{
+    // Same settings as the full rebuild: loose = 0.2, depth = 0.8, limit_depth_chs = true
+    if(!m_bFwdMegPicked)
+    {
+        m_fwdMeg = m_pFwd->pick_types(true, false);
+        m_bFwdMegPicked = true;
+    }
+
+    if(m_fwdMeg.source_ori == -1)
+    {
+        qCritical("Error: Forward solution is not oriented in surface coordinates. loose parameter should be 0 not 0.2.\n");
+        return MNEInverseOperator::SPtr();
+    }
+
+    //
+    // Pick channels and compute the whitener - the only covariance dependent steps of prepare_forward
+    //
+    FiffInfo t_gainInfo;
+    MatrixXd t_matGain;
+    MatrixXd t_matWhitener;
+    qint32 n_nzero;
+    FiffCov t_outNoiseCov;
+    m_fwdMeg.prepare_forward(*m_pFiffInfo.data(), p_noiseCov, false, t_gainInfo, t_matGain, t_outNoiseCov, t_matWhitener, n_nzero);
+
+    if(t_gainInfo.ch_names != m_qListCacheChNames)
+        updateCache(t_gainInfo, t_matGain);
+
+    qint32 n_chan = t_matWhitener.rows();
+
+    //
+    // Whitened and weighted lead field A = W G R^(1/2): A A^T = W (G R G^T) W^T is only n_chan x n_chan,
+    // its eigen decomposition yields U and the squared singular values of A
+    //
+    MatrixXd t_matM = t_matWhitener * m_matGainGram * t_matWhitener.transpose();
+    double trace_GRGT = t_matM.trace();
+    double scaling_source_cov = (double)n_nzero / trace_GRGT;
+    t_matM *= scaling_source_cov;
+
+    qint32 iRank = m_iTruncationRank > 0 && m_iTruncationRank < n_chan ? m_iTruncationRank : n_chan;
+
+    // Slowly changing covariance - track the dominant subspace from the previous components
+    bool bSubspaceUpdate = false;
+    if(iRank < n_chan && m_matLastEigenVectors.rows() == n_chan && m_matLastEigenVectors.cols() == iRank
+            && m_matLastNoiseCov.rows() == t_outNoiseCov.data.rows() && m_matLastNoiseCov.cols() == t_outNoiseCov.data.cols())
+    {
+        double dNorm = m_matLastNoiseCov.norm();
+        bSubspaceUpdate = dNorm > 0 && (t_outNoiseCov.data - m_matLastNoiseCov).norm() / dNorm < 0.1;
+    }
+
+    VectorXd p_sing;
+    MatrixXd t_U;
+    if(bSubspaceUpdate)
+    {
+        HouseholderQR<MatrixXd> qr(t_matM * m_matLastEigenVectors);
+        MatrixXd t_matQ = qr.householderQ() * MatrixXd::Identity(n_chan, iRank);
+        SelfAdjointEigenSolver<MatrixXd> es(t_matQ.transpose() * t_matM * t_matQ);
+        p_sing = es.eigenvalues();
+        t_U = t_matQ * es.eigenvectors();
+    }
+    else
+    {
+        SelfAdjointEigenSolver<MatrixXd> es(t_matM);
+        p_sing = es.eigenvalues().tail(iRank);
+        t_U = es.eigenvectors().rightCols(iRank);
+    }
+    p_sing = p_sing.array().max(0.0).sqrt();
+    MNEMath::sort<double>(p_sing, t_U);
+
+    m_matLastNoiseCov = t_outNoiseCov.data;
+    m_matLastEigenVectors = t_U;
+
+    //
+    // V = A^T U S^-1 = (G R^(1/2))^T W^T U S^-1 sqrt(scaling), components without signal are zeroed
+    //
+    VectorXd t_vecInvSing = VectorXd::Zero(p_sing.size());
+    double dEps = p_sing.size() > 0 ? p_sing.maxCoeff() * 1e-10 : 0;
+    for(qint32 i = 0; i < p_sing.size(); ++i)
+        if(p_sing[i] > dEps)
+            t_vecInvSing[i] = sqrt(scaling_source_cov) / p_sing[i];
+
+    MatrixXd t_matProj = t_matWhitener.transpose() * t_U * t_vecInvSing.asDiagonal();
+    MatrixXd t_V = m_matWeightedGain.transpose() * t_matProj;
+
+    printf("\tlargest singular value = %f\n", p_sing.size() > 0 ? p_sing.maxCoeff() : 0.0);
+    printf("\tscaling factor to adjust the trace = %f\n", trace_GRGT);
+
+    FiffCov::SDPtr p_source_cov(new FiffCov(*m_pDepthPrior));
+    p_source_cov->data = m_vecSourceCov * scaling_source_cov;
+
+    MNEInverseOperator::SPtr p_invOp(new MNEInverseOperator());
+    p_invOp->eigen_fields = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(t_U.cols(), t_U.rows(), defaultQStringList, t_gainInfo.ch_names, t_U.transpose()));
+    p_invOp->eigen_leads = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(t_V.rows(), t_V.cols(), defaultQStringList, defaultQStringList, t_V));
+    p_invOp->sing = p_sing;
+    p_invOp->nave = 1;
+    p_invOp->depth_prior = m_pDepthPrior;
+    p_invOp->source_cov = p_source_cov;
+    p_invOp->noise_cov = FiffCov::SDPtr(new FiffCov(t_outNoiseCov));
+    p_invOp->orient_prior = m_pOrientPrior;
+    p_invOp->projs = m_pFiffInfo->projs;
+    p_invOp->eigen_leads_weighted = false;
+    p_invOp->source_ori = m_fwdMeg.source_ori;
+    p_invOp->mri_head_t = m_fwdMeg.mri_head_t;
+    p_invOp->methods = m_iMethods;
+    p_invOp->nsource = m_fwdMeg.nsource;
+    p_invOp->coord_frame = m_fwdMeg.coord_frame;
+    p_invOp->source_nn = m_fwdMeg.source_nn;
+    p_invOp->src = m_fwdMeg.src;
+    p_invOp->info = m_fwdMeg.info;
+    p_invOp->info.bads = m_pFiffInfo->bads;
+
+    return p_invOp;
+}
+
+
+//*************************************************************************************************************
+
+void RtInvOp::updateCache(const FiffInfo &p_gainInfo, const MatrixXd &p_matGain)
+{
+    printf("\tCaching covariance independent inverse operator parts for %d channels.\n", p_gainInfo.ch_names.size());
+
+    bool is_fixed_ori = m_fwdMeg.isFixedOrient();
+
+    MatrixXd patch_areas;
+    m_pDepthPrior = FiffCov::SDPtr(new FiffCov(MNEForwardSolution::compute_depth_prior(p_matGain, p_gainInfo, is_fixed_ori, 0.8, 10.0, patch_areas, true)));
+
+    m_vecSourceCov = m_pDepthPrior->data.col(0);
+    m_pOrientPrior = FiffCov::SDPtr();
+    if(!is_fixed_ori)
+    {
+        m_pOrientPrior = FiffCov::SDPtr(new FiffCov(m_fwdMeg.compute_orient_prior(0.2f)));
+        m_vecSourceCov.array() *= m_pOrientPrior->data.col(0).array();
+    }
+
+    m_matWeightedGain = p_matGain * m_vecSourceCov.array().sqrt().matrix().asDiagonal();
+
+    m_matGainGram = MatrixXd::Zero(m_matWeightedGain.rows(), m_matWeightedGain.rows());
+    m_matGainGram.selfadjointView<Lower>().rankUpdate(m_matWeightedGain);
+    m_matGainGram.triangularView<StrictlyUpper>() = m_matGainGram.transpose();
+
+    // Methods of the picked channels
+    bool has_meg = false;
+    bool has_eeg = false;
+    for(qint32 i = 0; i < m_pFiffInfo->chs.size(); ++i)
+    {
+        if(p_gainInfo.ch_names.contains(m_pFiffInfo->chs[i].ch_name))
+        {
+            QString ch_type = m_pFiffInfo->channel_type(i);
+            if (ch_type == "eeg")
+                has_eeg = true;
+            if ((ch_type == "mag") || (ch_type == "grad"))
+                has_meg = true;
         }
     }
+
+    if(has_eeg && has_meg)
+        m_iMethods = FIFFV_MNE_MEG_EEG;
+    else if(has_meg)
+        m_iMethods = FIFFV_MNE_MEG;
+    else
+        m_iMethods = FIFFV_MNE_EEG;
+
+    m_qListCacheChNames = p_gainInfo.ch_names;
+    m_matLastNoiseCov.resize(0,0);
+    m_matLastEigenVectors.resize(0,0);
 }
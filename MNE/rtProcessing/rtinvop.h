@@ -67,6 +67,7 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QWaitCondition>
 #include <QSharedPointer>
 
 
@@ -110,6 +111,14 @@ public:
     typedef QSharedPointer<RtInvOp> SPtr;             /**< Shared pointer type for RtInvOp. */
     typedef QSharedPointer<const RtInvOp> ConstSPtr;  /**< Const shared pointer type for RtInvOp. */
 
+    /**
+    * How the inverse operator is rebuilt when a new noise covariance arrives.
+    */
+    enum UpdateMode {
+        FullRebuild,    /**< Every noise covariance triggers a complete make_inverse_operator. */
+        Incremental     /**< Covariance independent parts are cached, only the whitened decomposition is recomputed. */
+    };
+
     //=========================================================================================================
     /**
     * Creates the real-time inverse operator estimation object
@@ -134,6 +143,32 @@ public:
     */
     void appendNoiseCov(FiffCov &p_NoiseCov);
 
+    //=========================================================================================================
+    /**
+    * Sets how the inverse operator is rebuilt on new noise covariances. Default is Incremental.
+    *
+    * @param[in] p_updateMode   The update mode
+    */
+    void setUpdateMode(UpdateMode p_updateMode);
+
+    //=========================================================================================================
+    /**
+    * Restricts the number of kept components of the whitened lead field decomposition. With a truncation rank
+    * set, slowly changing noise covariances are tracked by a subspace iteration seeded with the previous
+    * components instead of a full eigen decomposition. Only used in Incremental mode.
+    *
+    * @param[in] p_iRank        Number of kept components, 0 keeps all (default)
+    */
+    void setTruncationRank(qint32 p_iRank);
+
+    //=========================================================================================================
+    /**
+    * Starts the RtInv by starting the producer's thread.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    virtual bool start();
+
     //=========================================================================================================
     /**
     * Stops the RtInv by stopping the producer's thread.
@@ -169,13 +204,50 @@ protected:
     virtual void run();
 
 private:
+    //=========================================================================================================
+    /**
+    * Computes the inverse operator for the given noise covariance, reusing the cached covariance independent
+    * parts (picked forward, depth and orientation prior, weighted gain and its gram matrix).
+    *
+    * @param[in] p_noiseCov     The noise covariance
+    *
+    * @return the inverse operator
+    */
+    MNEInverseOperator::SPtr updateInverseOperator(const FiffCov &p_noiseCov);
+
+    //=========================================================================================================
+    /**
+    * (Re-)builds the covariance independent cache for the given channel selection.
+    *
+    * @param[in] p_gainInfo     Info of the channels picked by prepare_forward
+    * @param[in] p_matGain      Gain matrix of the picked channels (not whitened)
+    */
+    void updateCache(const FiffInfo &p_gainInfo, const MatrixXd &p_matGain);
+
     QMutex      mutex;                  /**< Provides access serialization between threads. */
+    QWaitCondition m_condNoiseCov;      /**< Signaled when a noise covariance was appended or the thread is stopped. */
     bool        m_bIsRunning;           /**< Whether RtInv is running. */
 
     QVector<FiffCov> m_vecNoiseCov;     /**< Noise covariance matrices. */
 
     FiffInfo::SPtr m_pFiffInfo;         /**< The fiff measurement information. */
     MNEForwardSolution::SPtr m_pFwd;    /**< The forward solution. */
+
+    UpdateMode m_updateMode;            /**< How the inverse operator is rebuilt. */
+    qint32 m_iTruncationRank;           /**< Number of kept components, 0 keeps all. */
+
+    bool m_bFwdMegPicked;               /**< Whether m_fwdMeg holds the MEG picked forward solution. */
+    MNEForwardSolution m_fwdMeg;        /**< The MEG picked forward solution. */
+    QStringList m_qListCacheChNames;    /**< Channel names the cache was built for. */
+    qint32 m_iMethods;                  /**< Methods (MEG/EEG) of the cached channel selection. */
+    FiffCov::SDPtr m_pDepthPrior;       /**< Cached depth prior. */
+    FiffCov::SDPtr m_pOrientPrior;      /**< Cached orientation prior. */
+    VectorXd m_vecSourceCov;            /**< Cached unscaled source covariance (depth prior times orientation prior). */
+    MatrixXd m_matWeightedGain;         /**< Cached gain weighted by the square root of the source covariance. */
+    MatrixXd m_matGainGram;             /**< Cached gram matrix of the weighted gain, G R G^T. */
+
+    MatrixXd m_matLastNoiseCov;         /**< Noise covariance of the previous update. */
+    MatrixXd m_matLastEigenVectors;     /**< Components of the previous whitened decomposition. */
 };
 
 //*************************************************************************************************************
@@ -71,14 +71,19 @@ using namespace FIFFLIB;
 
 RtNoise::RtNoise(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, qint32 p_dataLen, QObject *parent)
 : QThread(parent)
-, m_iFFTlength(p_iMaxSamples)
 , m_pFiffInfo(p_pFiffInfo)
-, m_dataLength(p_dataLen)
 , m_bIsRunning(false)
+, m_iFFTlength(p_iMaxSamples)
+, m_dataLength(p_dataLen)
+, m_dWinPower(0)
+, m_iSegLength(p_iMaxSamples)
+, m_iHopSize(1)
+, m_iSegFill(0)
+, m_iNumSegments(1)
+, m_iSegmentsSinceResync(0)
 , m_iNumOfBlocks(0)
 , m_iBlockSize(0)
 , m_iSensors(0)
-, m_iBlockIndex(0)
 {
     qRegisterMetaType<Eigen::MatrixXd>("Eigen::MatrixXd");
     //qRegisterMetaType<QVector<double>>("QVector<double>");
@@ -89,10 +94,7 @@ RtNoise::RtNoise(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, qint32 p_data
 
     m_fWin.clear();
 
-    //create a hanning window
-    m_fWin = hanning(m_iFFTlength,0);
-
-    qDebug()<<"Hanning window is created.";
+    m_fft.SetFlag(m_fft.HalfSpectrum);
 
 }
 
@@ -208,105 +210,125 @@ void RtNoise::run()
             MatrixXd block = m_pRawMatrixBuffer->pop();
 
             if(FirstStart){
-                //init the circ buffer and parameters
-                if(m_dataLength < 0) m_dataLength = 10;
+                //init the segment buffer and parameters
+                if(m_dataLength < 1) m_dataLength = 10;
                 m_iNumOfBlocks = m_dataLength;//60;
                 m_iBlockSize =  block.cols();
                 m_iSensors =  block.rows();
 
-                m_matCircBuf.resize(m_iSensors,m_iNumOfBlocks*m_iBlockSize);
+                //segments longer than the requested data length are capped and zero-padded to m_iFFTlength
+                m_iSegLength = qMin(m_iFFTlength, m_iNumOfBlocks*m_iBlockSize);
+
+                //create a hanning window
+                m_fWin = hanning(m_iSegLength,0);
+
+                m_vecWin.resize(m_iSegLength);
+                for(qint32 i = 0; i < m_iSegLength; ++i)
+                    m_vecWin[i] = m_fWin[i];
+                m_dWinPower = m_vecWin.squaredNorm();
+
+                //refresh the spectrum with every block, with at least 50% overlap between the segments
+                m_iHopSize = qMax(1, qMin(m_iBlockSize, m_iSegLength/2));
 
-                m_iBlockIndex = 0;
+                m_matCircBuf.resize(m_iSensors,m_iSegLength);
+
+                //number of overlapping segments which fit into the requested data length
+                m_iNumSegments = (m_iNumOfBlocks*m_iBlockSize - m_iSegLength)/m_iHopSize + 1;
+
+                m_matPsdSum = MatrixXd::Zero(m_iSensors,m_iFFTlength/2+1);
+                m_qListSegPsd.clear();
+
+                m_iSegFill = 0;
+                m_iSegmentsSinceResync = 0;
                 FirstStart = false;
             }
-            //concate blocks
-            for (int i=0; i< m_iSensors; i++)
-                for (int j=0; j< m_iBlockSize; j++)
-                    m_matCircBuf(i,j+m_iBlockIndex*m_iBlockSize) = block(i,j);
-
-
-            m_iBlockIndex ++;
-            if (m_iBlockIndex >= m_iNumOfBlocks){
-
-                //m_pRawMatrixBuffer.clear(); //empty the buffer
-
-                m_bSendDataToBuffer = false;
-                //stop collect block and start to calculate the spectrum
-                m_iBlockIndex = 0;
-
-                MatrixXd sum_psdx = MatrixXd::Zero(m_iSensors,m_iFFTlength/2+1);
-
-                int nb = floor(m_iNumOfBlocks*m_iBlockSize/m_iFFTlength)+1;
-                qDebug()<<"nb"<<nb<<"NumOfBlocks"<<m_iNumOfBlocks<<"BlockSize"<<m_iBlockSize;
-                MatrixXd t_mat(m_iSensors,m_iFFTlength);
-                MatrixXd t_psdx(m_iSensors,m_iFFTlength/2+1);
-                for (int n = 0; n<nb; n++){
-                    //collect a data block with data length of m_iFFTlength;
-                    if(n==nb-1)
-                    {
-                        for(qint32 ii=0; ii<m_iSensors; ii++)
-                        for(qint32 jj=0; jj<m_iFFTlength; jj++)
-                            if(jj+n*m_iFFTlength<m_iNumOfBlocks*m_iBlockSize)
-                                t_mat(ii,jj) = m_matCircBuf(ii,jj+n*m_iFFTlength);
-                            else
-                                t_mat(ii,jj) = 0.0;
-
-                    }
-                    else
-                    {
-                        for(qint32 ii=0; ii<m_iSensors; ii++)
-                        for(qint32 jj=0; jj<m_iFFTlength; jj++)
-                            t_mat(ii,jj) = m_matCircBuf(ii,jj+n*m_iFFTlength);
-                    }
-
-                    //FFT calculation by row
-                    for(qint32 i = 0; i < t_mat.rows(); i++){
-                        RowVectorXd data;
-
-                        data = t_mat.row(i);
-
-                        //zero-pad data to m_iFFTlength
-                        RowVectorXd t_dataZeroPad = RowVectorXd::Zero(m_iFFTlength);
-                        t_dataZeroPad.head(data.cols()) = data;
-
-                        for (qint32 lk = 0; lk<m_iFFTlength; lk++)
-                            t_dataZeroPad[lk] = t_dataZeroPad[lk]*m_fWin[lk];
-
-                        //generate fft object
-                        Eigen::FFT<double> fft;
-                        fft.SetFlag(fft.HalfSpectrum);
-
-                        //fft-transform data sequence
-                        RowVectorXcd t_freqData(m_iFFTlength/2+1);
-                        fft.fwd(t_freqData,t_dataZeroPad);
-
-                        // calculate spectrum from FFT
-                        for(qint32 j=0; j<m_iFFTlength/2+1;j++)
-                        {
-                            double mag_abs = sqrt(t_freqData(j).real()* t_freqData(j).real() +  t_freqData(j).imag()*t_freqData(j).imag());
-                            double spower = (1.0/(m_Fs*m_iFFTlength))* mag_abs;
-                            if (j>0&&j<m_iFFTlength/2) spower = 2.0*spower;
-                            sum_psdx(i,j) = sum_psdx(i,j) + spower;
-                        }
-                     }//row computing is done
-                }//nb
-
-                //DB-calculation
-                for(qint32 ii=0; ii<m_iSensors; ii++)
-                    for(qint32 jj=0; jj<m_iFFTlength/2+1; jj++)
-                        t_psdx(ii,jj) = 10.0*log10(sum_psdx(ii,jj)/nb);
-
-                qDebug()<<"Send spectrum to Noise Estimator";
-                emit SpecCalculated(t_psdx); //send back the spectrum result
-                if(m_pRawMatrixBuffer->size()>0)
-                    m_pRawMatrixBuffer->clear();
-
-                m_bSendDataToBuffer = true;
+
+            //
+            // Fill the current segment; whenever it is complete update the spectrum and keep the overlapping part
+            //
+            bool bNewSegment = false;
+            qint32 iCol = 0;
+            while(iCol < block.cols())
+            {
+                qint32 n = qMin((qint32)block.cols() - iCol, m_iSegLength - m_iSegFill);
+                m_matCircBuf.block(0,m_iSegFill,m_iSensors,n) = block.block(0,iCol,m_iSensors,n);
+                m_iSegFill += n;
+                iCol += n;
+
+                if(m_iSegFill == m_iSegLength)
+                {
+                    updateSpectrum();
+                    bNewSegment = true;
+
+                    qint32 iOverlap = m_iSegLength - m_iHopSize;
+                    if(iOverlap > 0)
+                        m_matCircBuf.leftCols(iOverlap) = m_matCircBuf.rightCols(iOverlap).eval();
+                    m_iSegFill = iOverlap;
+                }
             }
 
+            //one spectrum per block, even if the block completed several segments
+            if(bNewSegment)
+                emitSpectrum();
         }
-
     }
+}
+
+
+//*************************************************************************************************************
+
+void RtNoise::updateSpectrum()
+{
+    qint32 iNumBins = m_iFFTlength/2+1;
+
+    //taper all channels at once, zero-pad up to m_iFFTlength
+    MatrixXd t_matWin = MatrixXd::Zero(m_iSensors,m_iFFTlength);
+    t_matWin.leftCols(m_iSegLength) = (m_matCircBuf.array().rowwise() * m_vecWin.array()).matrix();
 
+    //
+    // Periodogram of the segment, one-sided and scaled to a power spectral density
+    //
+    MatrixXd t_matSegPsd(m_iSensors,iNumBins);
+    RowVectorXd t_vecRow(m_iFFTlength);
+    RowVectorXcd t_vecFreqData(iNumBins);
+    double dScale = 1.0/(m_Fs*m_dWinPower);
+
+    for(qint32 i = 0; i < m_iSensors; ++i)
+    {
+        t_vecRow = t_matWin.row(i);
+        m_fft.fwd(t_vecFreqData,t_vecRow);
+
+        t_matSegPsd.row(i) = t_vecFreqData.cwiseAbs2() * dScale;
+    }
+    //all bins but DC and (for even lengths) Nyquist appear twice in the two-sided spectrum
+    if(m_iFFTlength > 2)
+        t_matSegPsd.block(0,1,m_iSensors,(m_iFFTlength-1)/2) *= 2.0;
+
+    //
+    // Sliding Welch window over the last m_iNumSegments segments, add the new segment and subtract the evicted ones
+    //
+    m_qListSegPsd.append(t_matSegPsd);
+    m_matPsdSum += t_matSegPsd;
+    while(m_qListSegPsd.size() > m_iNumSegments)
+        m_matPsdSum -= m_qListSegPsd.takeFirst();
+
+    //the running sum accumulates rounding errors, sum up the segments in the window again once per pass
+    if(++m_iSegmentsSinceResync >= m_iNumSegments)
+    {
+        m_matPsdSum = m_qListSegPsd[0];
+        for(qint32 i = 1; i < m_qListSegPsd.size(); ++i)
+            m_matPsdSum += m_qListSegPsd[i];
+        m_iSegmentsSinceResync = 0;
+    }
 }
 
+
+//*************************************************************************************************************
+
+void RtNoise::emitSpectrum()
+{
+    //DB-calculation
+    MatrixXd t_psdx = (10.0/log(10.0))*(m_matPsdSum/m_qListSegPsd.size()).array().log();
+
+    emit SpecCalculated(t_psdx); //send back the spectrum result
+}
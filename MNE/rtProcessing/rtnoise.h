@@ -71,6 +71,7 @@
 #include <QMutex>
 #include <QSharedPointer>
 #include <QVector>
+#include <QList>
 
 
 //*************************************************************************************************************
@@ -182,6 +183,19 @@ protected:
 
     QVector <float> hanning(int N, short itype);
 
+    //=========================================================================================================
+    /**
+    * Adds the spectrum of the completed segment in m_matCircBuf to the sliding Welch average. Segments shorter
+    * than m_iFFTlength are zero-padded.
+    */
+    void updateSpectrum();
+
+    //=========================================================================================================
+    /**
+    * Emits the average of the segment spectra in m_qListSegPsd (dB), taken from their running sum m_matPsdSum.
+    */
+    void emitSpectrum();
+
 private:
     QMutex      mutex;                  /**< Provides access serialization between threads*/
 
@@ -198,11 +212,21 @@ private:
     qint32 m_iFFTlength;
     qint32 m_dataLength;
 
+    Eigen::FFT<double>  m_fft;              /**< FFT object, keeps the plan of m_iFFTlength between segments. */
+    RowVectorXd         m_vecWin;           /**< Hanning taper applied to each segment. */
+    double              m_dWinPower;        /**< Sum of the squared taper coefficients, used for the PSD scaling. */
+    qint32              m_iSegLength;       /**< Number of samples per segment, at most m_iFFTlength. */
+    qint32              m_iHopSize;         /**< Number of new samples between two overlapping segments, at most one block. */
+    qint32              m_iSegFill;         /**< Number of samples of the current segment in m_matCircBuf. */
+    qint32              m_iNumSegments;     /**< Number of segments averaged in the sliding Welch estimate. */
+    qint32              m_iSegmentsSinceResync; /**< Number of segments added to m_matPsdSum since it was last summed up from scratch. */
+    MatrixXd            m_matPsdSum;        /**< Running sum of the segment spectra in m_qListSegPsd. */
+    QList<MatrixXd>     m_qListSegPsd;      /**< Spectra of the segments in the sliding average, oldest first. */
+
 protected:
     int m_iNumOfBlocks;
     int m_iBlockSize;
     int m_iSensors;
-    int m_iBlockIndex;
 
     MatrixXd m_matCircBuf;
 
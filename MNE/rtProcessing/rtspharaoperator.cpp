@@ -0,0 +1,281 @@
+//=============================================================================================================
+/**
+* @file     rtspharaoperator.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RtSpharaOperator class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtspharaoperator.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtSpharaOperator::RtSpharaOperator(int iNumChannels)
+: m_iNumChannels(iNumChannels)
+, m_matSparsePre(iNumChannels, iNumChannels)
+, m_matFactor(iNumChannels, 0)
+, m_vecMask(VectorXd::Ones(iNumChannels))
+{
+    m_matSparsePre.setIdentity();
+
+    updateOperator();
+}
+
+
+//*************************************************************************************************************
+
+void RtSpharaOperator::addBaseFunctions(const QString& sSystem, const MatrixXd& matBaseFct, const VectorXi& vecIndices, int iSkip)
+{
+    m_qMapBaseFcts[sSystem].append(matBaseFct);
+    m_qMapIndices[sSystem].append(vecIndices);
+    m_qMapSkip[sSystem].append(iSkip > 0 ? iSkip : 0);
+
+    //Drop the cached factors of this system, they do not contain the new group
+    QString sPrefix = sSystem + "/";
+    QMutableMapIterator<QString, MatrixXd> itFactor(m_qMapFactorCache);
+    while(itFactor.hasNext()) {
+        itFactor.next();
+        if(itFactor.key().startsWith(sPrefix))
+            itFactor.remove();
+    }
+
+    QMutableMapIterator<QString, VectorXd> itMask(m_qMapMaskCache);
+    while(itMask.hasNext()) {
+        itMask.next();
+        if(itMask.key().startsWith(sPrefix))
+            itMask.remove();
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool RtSpharaOperator::setSystem(const QString& sSystem, int iNBaseFctsFirst, int iNBaseFctsSecond)
+{
+    QString sKey = QString("%1/%2/%3").arg(sSystem).arg(iNBaseFctsFirst).arg(iNBaseFctsSecond);
+
+    bool bResult = true;
+
+    if(m_qMapFactorCache.contains(sKey)) {
+        m_matFactor = m_qMapFactorCache[sKey];
+        m_vecMask = m_qMapMaskCache[sKey];
+    } else if(buildFactor(sSystem, iNBaseFctsFirst, iNBaseFctsSecond, m_matFactor, m_vecMask)) {
+        m_qMapFactorCache.insert(sKey, m_matFactor);
+        m_qMapMaskCache.insert(sKey, m_vecMask);
+    } else {
+        m_matFactor = MatrixXd(m_iNumChannels, 0);
+        m_vecMask = VectorXd::Ones(m_iNumChannels);
+        bResult = false;
+    }
+
+    updateOperator();
+
+    return bResult;
+}
+
+
+//*************************************************************************************************************
+
+void RtSpharaOperator::setPreOperator(const SparseMatrix<double>& matPreOperator)
+{
+    if(matPreOperator.rows() != m_iNumChannels || matPreOperator.cols() != m_iNumChannels) {
+        qWarning() << "RtSpharaOperator::setPreOperator - Dimensions do not match the number of channels. Returning.";
+        return;
+    }
+
+    m_matSparsePre = matPreOperator;
+
+    updateOperator();
+}
+
+
+//*************************************************************************************************************
+
+void RtSpharaOperator::setBadChannels(const QList<int>& lBadChannels)
+{
+    if(lBadChannels == m_lBadChannels)
+        return;
+
+    m_lBadChannels = lBadChannels;
+
+    updateOperator();
+}
+
+
+//*************************************************************************************************************
+
+void RtSpharaOperator::apply(const MatrixXd& matData, MatrixXd& matDataOut) const
+{
+    if(matData.rows() != m_iNumChannels) {
+        qWarning() << "RtSpharaOperator::apply - Number of rows does not match the number of channels. Data is passed through.";
+        matDataOut = matData;
+        return;
+    }
+
+    //The coefficients are computed first, so that matData and matDataOut may be the same matrix
+    if(m_matFactor.cols() > 0) {
+        MatrixXd matCoeff = m_matFactorPre * matData;
+        matDataOut = m_matSparseRestPre * matData;
+        matDataOut.noalias() += m_matFactor * matCoeff;
+    } else {
+        matDataOut = m_matSparseRestPre * matData;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtSpharaOperator::applySphara(const MatrixXd& matData, MatrixXd& matDataOut) const
+{
+    if(matData.rows() != m_iNumChannels) {
+        qWarning() << "RtSpharaOperator::applySphara - Number of rows does not match the number of channels. Data is passed through.";
+        matDataOut = matData;
+        return;
+    }
+
+    if(m_matFactor.cols() > 0) {
+        MatrixXd matCoeff = m_matFactorSphara * matData;
+        matDataOut = m_vecMaskBad.asDiagonal() * matData;
+        matDataOut.noalias() += m_matFactor * matCoeff;
+    } else {
+        matDataOut = m_vecMaskBad.asDiagonal() * matData;
+    }
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtSpharaOperator::applySphara(const MatrixXd& matData) const
+{
+    MatrixXd matDataOut;
+    applySphara(matData, matDataOut);
+    return matDataOut;
+}
+
+
+//*************************************************************************************************************
+
+bool RtSpharaOperator::buildFactor(const QString& sSystem, int iNBaseFctsFirst, int iNBaseFctsSecond, MatrixXd& matFactor, VectorXd& vecMask) const
+{
+    if(!m_qMapBaseFcts.contains(sSystem)) {
+        qWarning() << "RtSpharaOperator::buildFactor - No basis functions registered for" << sSystem;
+        return false;
+    }
+
+    const QList<MatrixXd>& lBaseFcts = m_qMapBaseFcts[sSystem];
+    const QList<VectorXi>& lIndices = m_qMapIndices[sSystem];
+    const QList<int>& lSkip = m_qMapSkip[sSystem];
+
+    //Every interleaved sub group gets its own columns, otherwise L * L^T would mix the sub groups
+    QList<int> lNBaseFcts;
+    int iNumCols = 0;
+    for(int g = 0; g < lBaseFcts.size(); ++g) {
+        int iNBaseFcts = g == 0 ? iNBaseFctsFirst : iNBaseFctsSecond;
+        iNBaseFcts = qBound(0, iNBaseFcts, (int)lBaseFcts.at(g).cols());
+        lNBaseFcts.append(iNBaseFcts);
+        iNumCols += iNBaseFcts * (lSkip.at(g) + 1);
+    }
+
+    matFactor = MatrixXd::Zero(m_iNumChannels, iNumCols);
+    vecMask = VectorXd::Ones(m_iNumChannels);
+
+    int iCol = 0;
+    for(int g = 0; g < lBaseFcts.size(); ++g) {
+        const MatrixXd& matBaseFct = lBaseFcts.at(g);
+        const VectorXi& vecIndices = lIndices.at(g);
+        int iSkip = lSkip.at(g);
+        int iNBaseFcts = lNBaseFcts.at(g);
+
+        for(int s = 0; s <= iSkip; ++s) {
+            int iRow = 0;
+
+            for(int r = s; r < vecIndices.rows(); r += 1 + iSkip) {
+                int iChannel = vecIndices(r);
+
+                if(iRow >= matBaseFct.rows() || iChannel < 0 || iChannel >= m_iNumChannels) {
+                    qWarning() << "RtSpharaOperator::buildFactor - Index is out of range for" << sSystem;
+                    return false;
+                }
+
+                matFactor.block(iChannel, iCol, 1, iNBaseFcts) = matBaseFct.block(iRow, 0, 1, iNBaseFcts);
+                vecMask(iChannel) = 0.0;
+
+                ++iRow;
+            }
+
+            iCol += iNBaseFcts;
+        }
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtSpharaOperator::updateOperator()
+{
+    VectorXd vecGood = VectorXd::Ones(m_iNumChannels);
+    for(int i = 0; i < m_lBadChannels.size(); ++i)
+        if(m_lBadChannels.at(i) >= 0 && m_lBadChannels.at(i) < m_iNumChannels)
+            vecGood(m_lBadChannels.at(i)) = 0.0;
+
+    m_vecMaskBad = m_vecMask.cwiseProduct(vecGood);
+
+    m_matFactorSphara = m_matFactor.transpose() * vecGood.asDiagonal();
+    m_matFactorPre = (m_matSparsePre.transpose() * m_matFactorSphara.transpose()).transpose();
+
+    m_matSparseRestPre = m_vecMaskBad.asDiagonal() * m_matSparsePre;
+}
@@ -0,0 +1,249 @@
+//=============================================================================================================
+/**
+* @file     rtspharaoperator.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RtSpharaOperator class declaration.
+*
+*/
+
+#ifndef RTSPHARAOPERATOR_H
+#define RTSPHARAOPERATOR_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtprocessing_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QString>
+#include <QList>
+#include <QMap>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+
+//=============================================================================================================
+/**
+* Streaming SPHARA noise reduction. For each channel group the SPHARA operator is B_k * B_k^T, where B_k are the
+* first k basis functions, and the identity on all other channels. The operator is never built as a dense
+* nchan x nchan matrix. The basis functions of all groups are scattered into one nchan x K factor L, the operator is
+* S = (I - D) + L * L^T with D marking the channels of the groups. An optional sparse pre operator, i.e. SSP and
+* compensators, is folded into the right factor, so that S * Z * Pre is applied in one pass with O(nchan * K) per
+* sample, Z zeroing the bad channels.
+*
+* The factors are cached per system and number of basis functions, switching between settings does not rebuild them.
+* The operator is not thread safe, the caller has to serialize setters and apply.
+*
+* @brief Low-rank SPHARA operator combined with SSP and compensators
+*/
+class RTPROCESSINGSHARED_EXPORT RtSpharaOperator
+{
+public:
+    typedef QSharedPointer<RtSpharaOperator> SPtr;             /**< Shared pointer type for RtSpharaOperator. */
+    typedef QSharedPointer<const RtSpharaOperator> ConstSPtr;  /**< Const shared pointer type for RtSpharaOperator. */
+
+    //=========================================================================================================
+    /**
+    * Creates the operator. Until a system is selected it only applies the pre operator.
+    *
+    * @param [in] iNumChannels  the number of channels of the data, i.e. the number of rows of the blocks.
+    */
+    explicit RtSpharaOperator(int iNumChannels);
+
+    //=========================================================================================================
+    /**
+    * Registers the basis functions of a channel group. Groups of the same system are numbered in the order in which
+    * they are added, the first group uses iNBaseFctsFirst and all following groups iNBaseFctsSecond basis functions.
+    *
+    * @param [in] sSystem       the acquisition system, e.g. VectorView, BabyMEG or EEG.
+    * @param [in] matBaseFct    the SPHARA basis functions, channels of the group x basis functions.
+    * @param [in] vecIndices    the indices of the group channels in the data.
+    * @param [in] iSkip         the number of interleaved sub groups minus one which share the same basis, i.e. 1 for VectorView gradiometer pairs.
+    */
+    void addBaseFunctions(const QString& sSystem, const Eigen::MatrixXd& matBaseFct, const Eigen::VectorXi& vecIndices, int iSkip = 0);
+
+    //=========================================================================================================
+    /**
+    * Selects the system and the number of basis functions. The factors are taken from the cache if available.
+    *
+    * @param [in] sSystem           the acquisition system.
+    * @param [in] iNBaseFctsFirst   the number of basis functions of the first group.
+    * @param [in] iNBaseFctsSecond  the number of basis functions of the following groups.
+    *
+    * @return true if the system is known and all groups match their basis functions, false otherwise. In this case the channels are left untouched by SPHARA.
+    */
+    bool setSystem(const QString& sSystem, int iNBaseFctsFirst, int iNBaseFctsSecond = 0);
+
+    //=========================================================================================================
+    /**
+    * Sets the operator which is applied before SPHARA by apply, i.e. the combined SSP and compensator operator.
+    *
+    * @param [in] matPreOperator    the sparse nchan x nchan pre operator.
+    */
+    void setPreOperator(const Eigen::SparseMatrix<double>& matPreOperator);
+
+    //=========================================================================================================
+    /**
+    * Sets the bad channels which are zeroed before SPHARA so that they do not get smeared into the good ones.
+    *
+    * @param [in] lBadChannels      the indices of the bad channels.
+    */
+    void setBadChannels(const QList<int>& lBadChannels);
+
+    //=========================================================================================================
+    /**
+    * Applies the pre operator and SPHARA in one pass.
+    *
+    * @param [in] matData       the data block, channels x samples.
+    * @param [out] matDataOut   the processed block.
+    */
+    void apply(const Eigen::MatrixXd& matData, Eigen::MatrixXd& matDataOut) const;
+
+    //=========================================================================================================
+    /**
+    * Applies SPHARA only, e.g. when a temporal filter runs between the pre operator and SPHARA.
+    *
+    * @param [in] matData       the data block, channels x samples.
+    * @param [out] matDataOut   the processed block.
+    */
+    void applySphara(const Eigen::MatrixXd& matData, Eigen::MatrixXd& matDataOut) const;
+
+    //=========================================================================================================
+    /**
+    * Applies SPHARA only.
+    *
+    * @param [in] matData       the data block, channels x samples.
+    *
+    * @return the processed block.
+    */
+    Eigen::MatrixXd applySphara(const Eigen::MatrixXd& matData) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of channels.
+    *
+    * @return the number of channels.
+    */
+    inline int getNumChannels() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the total number of basis functions K, i.e. the rank of the SPHARA part of the operator.
+    *
+    * @return the number of basis functions of all groups.
+    */
+    inline int getRank() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Builds the left factor and the channel mask of a system and number of basis functions.
+    *
+    * @param [in] sSystem           the acquisition system.
+    * @param [in] iNBaseFctsFirst   the number of basis functions of the first group.
+    * @param [in] iNBaseFctsSecond  the number of basis functions of the following groups.
+    * @param [out] matFactor        the nchan x K left factor.
+    * @param [out] vecMask          1 for channels outside of all groups, 0 otherwise.
+    *
+    * @return true if all groups could be built.
+    */
+    bool buildFactor(const QString& sSystem, int iNBaseFctsFirst, int iNBaseFctsSecond, Eigen::MatrixXd& matFactor, Eigen::VectorXd& vecMask) const;
+
+    //=========================================================================================================
+    /**
+    * Folds the bad channels and the pre operator into the right factors.
+    */
+    void updateOperator();
+
+    int                                 m_iNumChannels;         /**< The number of channels. */
+
+    QMap<QString, QList<Eigen::MatrixXd> >  m_qMapBaseFcts;     /**< The registered basis functions per system. */
+    QMap<QString, QList<Eigen::VectorXi> >  m_qMapIndices;      /**< The channel indices of the registered groups per system. */
+    QMap<QString, QList<int> >              m_qMapSkip;         /**< The number of interleaved sub groups minus one of the registered groups per system. */
+
+    QMap<QString, Eigen::MatrixXd>      m_qMapFactorCache;      /**< The cached left factors per system and number of basis functions. */
+    QMap<QString, Eigen::VectorXd>      m_qMapMaskCache;        /**< The cached channel masks per system and number of basis functions. */
+
+    QList<int>                          m_lBadChannels;         /**< The bad channels. */
+    Eigen::SparseMatrix<double>         m_matSparsePre;         /**< The pre operator. */
+
+    Eigen::MatrixXd                     m_matFactor;            /**< The left factor L, nchan x K. */
+    Eigen::VectorXd                     m_vecMask;              /**< 1 for channels outside of all groups, 0 otherwise. */
+    Eigen::VectorXd                     m_vecMaskBad;           /**< The channel mask with the bad channels zeroed, i.e. (I - D) * Z. */
+    Eigen::MatrixXd                     m_matFactorSphara;      /**< The right factor L^T * Z. */
+    Eigen::MatrixXd                     m_matFactorPre;         /**< The right factor L^T * Z * Pre. */
+    Eigen::SparseMatrix<double>         m_matSparseRestPre;     /**< (I - D) * Z * Pre. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int RtSpharaOperator::getNumChannels() const
+{
+    return m_iNumChannels;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtSpharaOperator::getRank() const
+{
+    return m_matFactor.cols();
+}
+
+} // NAMESPACE
+
+#endif // RTSPHARAOPERATOR_H
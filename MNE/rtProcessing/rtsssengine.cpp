@@ -0,0 +1,332 @@
+//=============================================================================================================
+/**
+* @file     rtsssengine.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RtSssEngine class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtsssengine.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/SVD>
+#include <Eigen/Eigenvalues>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtSssEngine::RtSssEngine()
+: m_iWindowSamples(0)
+, m_dCorrelationLimit(0.98)
+, m_iWindowFill(0)
+, m_iNumComponents(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+bool RtSssEngine::computeProjectors(const MatrixXd& matBasisIn, const MatrixXd& matBasisOut, const VectorXd& vecCoilScale, MatrixXd& matProjectorIn, MatrixXd& matProjectorOut, double dTolerance)
+{
+    int iNumChannels = matBasisIn.rows();
+    int iNumIn = matBasisIn.cols();
+    int iNumOut = matBasisOut.cols();
+
+    if(iNumChannels == 0 || iNumIn == 0 || matBasisOut.rows() != iNumChannels || vecCoilScale.size() != iNumChannels) {
+        qWarning() << "RtSssEngine::computeProjectors - Basis dimensions do not match.";
+        return false;
+    }
+
+    //Scaled linear equation with normalized columns, the high order moments differ by orders of magnitude
+    MatrixXd matA(iNumChannels, iNumIn + iNumOut);
+    matA << matBasisIn, matBasisOut;
+    matA = vecCoilScale.asDiagonal() * matA;
+
+    VectorXd vecColNorm = matA.colwise().norm().transpose();
+    for(int i = 0; i < vecColNorm.size(); ++i)
+        if(vecColNorm(i) <= 0.0)
+            vecColNorm(i) = 1.0;
+    matA = matA * vecColNorm.cwiseInverse().asDiagonal();
+
+    JacobiSVD<MatrixXd> svd(matA, ComputeThinU | ComputeThinV);
+    const VectorXd& vecS = svd.singularValues();
+
+    double dCutOff = vecS.size() > 0 ? vecS(0) * dTolerance : 0.0;
+    VectorXd vecSInv = VectorXd::Zero(vecS.size());
+    for(int i = 0; i < vecS.size(); ++i)
+        if(vecS(i) > dCutOff)
+            vecSInv(i) = 1.0 / vecS(i);
+
+    //Moments x = D^-1 * V * S^-1 * U^T * C * b, the internal signal is S_in * x_in and the external one S_out * x_out
+    MatrixXd matSInvUtC = vecSInv.asDiagonal() * svd.matrixU().transpose() * vecCoilScale.asDiagonal();
+    MatrixXd matPinvIn = vecColNorm.head(iNumIn).cwiseInverse().asDiagonal() * svd.matrixV().topRows(iNumIn) * matSInvUtC;
+    MatrixXd matPinvOut = vecColNorm.tail(iNumOut).cwiseInverse().asDiagonal() * svd.matrixV().bottomRows(iNumOut) * matSInvUtC;
+
+    matProjectorIn = matBasisIn * matPinvIn;
+    matProjectorOut = matBasisOut * matPinvOut;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtSssEngine::computeProjector(const MatrixXd& matBasisIn, const MatrixXd& matBasisOut, const VectorXd& vecCoilScale, double dTolerance)
+{
+    MatrixXd matProjectorIn, matProjectorOut;
+
+    if(!computeProjectors(matBasisIn, matBasisOut, vecCoilScale, matProjectorIn, matProjectorOut, dTolerance))
+        return MatrixXd();
+
+    return matProjectorIn;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtSssEngine::computeTemporalOperator(const MatrixXd& matGram, const MatrixXd& matProjectorIn, const MatrixXd& matProjectorOut, double dCorrelationLimit, int& iNumComponents)
+{
+    int iNumChannels = matProjectorIn.rows();
+    iNumComponents = 0;
+
+    if(matGram.rows() != iNumChannels || matGram.cols() != iNumChannels || matProjectorOut.rows() != iNumChannels || matProjectorOut.cols() != iNumChannels)
+        return matProjectorIn;
+
+    //Gram matrices of the internal part B_in = P_in * R and the residual B_res = (I - P_in - P_out) * R
+    MatrixXd matResidual = MatrixXd::Identity(iNumChannels, iNumChannels) - matProjectorIn - matProjectorOut;
+    MatrixXd matGramP = matProjectorIn * matGram;
+    MatrixXd matGramIn = matGramP * matProjectorIn.transpose();
+    MatrixXd matGramCross = matGramP * matResidual.transpose();
+    MatrixXd matGramRes = matResidual * matGram * matResidual.transpose();
+
+    //Orthonormal temporal bases Q = B^T * U * L^-1/2 from the eigen decompositions of the Gram matrices
+    SelfAdjointEigenSolver<MatrixXd> eigIn(matGramIn);
+    SelfAdjointEigenSolver<MatrixXd> eigRes(matGramRes);
+
+    const VectorXd& vecLIn = eigIn.eigenvalues();
+    const VectorXd& vecLRes = eigRes.eigenvalues();
+    if(vecLIn.size() == 0 || vecLRes.size() == 0 || vecLIn.maxCoeff() <= 0.0 || vecLRes.maxCoeff() <= 0.0)
+        return matProjectorIn;
+
+    //Eigenvalues are sorted in increasing order
+    double dCutOffIn = vecLIn.maxCoeff() * 1e-8;
+    double dCutOffRes = vecLRes.maxCoeff() * 1e-8;
+    int iRankIn = 0, iRankRes = 0;
+    for(int i = 0; i < vecLIn.size(); ++i)
+        if(vecLIn(i) > dCutOffIn)
+            ++iRankIn;
+    for(int i = 0; i < vecLRes.size(); ++i)
+        if(vecLRes(i) > dCutOffRes)
+            ++iRankRes;
+
+    MatrixXd matUIn = eigIn.eigenvectors().rightCols(iRankIn);
+    VectorXd vecLInSqrt = vecLIn.tail(iRankIn).cwiseSqrt();
+    MatrixXd matURes = eigRes.eigenvectors().rightCols(iRankRes);
+    VectorXd vecLResSqrt = vecLRes.tail(iRankRes).cwiseSqrt();
+
+    //Canonical correlations of the temporal subspaces: Q_in^T * Q_res = L_in^-1/2 U_in^T (B_in B_res^T) U_res L_res^-1/2
+    MatrixXd matC = vecLInSqrt.cwiseInverse().asDiagonal() * matUIn.transpose() * matGramCross * matURes * vecLResSqrt.cwiseInverse().asDiagonal();
+
+    JacobiSVD<MatrixXd> svd(matC, ComputeThinU);
+    const VectorXd& vecCorr = svd.singularValues();
+
+    while(iNumComponents < vecCorr.size() && vecCorr(iNumComponents) > dCorrelationLimit)
+        ++iNumComponents;
+
+    if(iNumComponents == 0)
+        return matProjectorIn;
+
+    //Project the intersecting time courses Q_in * y out of B_in: (I - U_in L_in^1/2 y y^T L_in^-1/2 U_in^T) * P_in
+    MatrixXd matY = svd.matrixU().leftCols(iNumComponents);
+    MatrixXd matLeft = matUIn * vecLInSqrt.asDiagonal() * matY;
+    MatrixXd matRight = matY.transpose() * vecLInSqrt.cwiseInverse().asDiagonal() * matUIn.transpose() * matProjectorIn;
+
+    return matProjectorIn - matLeft * matRight;
+}
+
+
+//*************************************************************************************************************
+
+bool RtSssEngine::setBasis(const MatrixXd& matBasisIn, const MatrixXd& matBasisOut, const VectorXd& vecCoilScale)
+{
+    MatrixXd matProjectorIn, matProjectorOut;
+
+    if(!computeProjectors(matBasisIn, matBasisOut, vecCoilScale, matProjectorIn, matProjectorOut))
+        return false;
+
+    setProjector(matProjectorIn, matProjectorOut);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtSssEngine::setProjector(const MatrixXd& matProjectorIn, const MatrixXd& matProjectorOut)
+{
+    m_matProjectorIn = matProjectorIn;
+    m_matProjectorOut = matProjectorOut;
+
+    //The window which is put out keeps the operator it was cleaned with
+    if(m_iWindowSamples == 0 || m_matWindowOut.size() == 0)
+        m_matOperator = m_matProjectorIn;
+}
+
+
+//*************************************************************************************************************
+
+void RtSssEngine::setTemporalExtension(int iWindowSamples, double dCorrelationLimit)
+{
+    m_iWindowSamples = iWindowSamples > 0 ? iWindowSamples : 0;
+    m_dCorrelationLimit = dCorrelationLimit;
+
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void RtSssEngine::reset()
+{
+    m_matWindow.resize(0, 0);
+    m_matWindowOut.resize(0, 0);
+    m_matGram.resize(0, 0);
+    m_iWindowFill = 0;
+    m_iNumComponents = 0;
+
+    m_matOperator = m_matProjectorIn;
+}
+
+
+//*************************************************************************************************************
+
+void RtSssEngine::apply(const MatrixXd& matData, MatrixXd& matDataOut)
+{
+    if(!isInitialized() || matData.rows() != m_matProjectorIn.cols()) {
+        if(isInitialized())
+            qWarning() << "RtSssEngine::apply - Number of channels does not match the basis, data is passed through.";
+        matDataOut = matData;
+        return;
+    }
+
+    if(matDataOut.rows() != matData.rows() || matDataOut.cols() != matData.cols())
+        matDataOut.resize(matData.rows(), matData.cols());
+
+    if(m_iWindowSamples == 0) {
+        matDataOut.noalias() = m_matOperator * matData;
+        return;
+    }
+
+    int iNumChannels = matData.rows();
+    if(m_matWindow.rows() != iNumChannels || m_matWindow.cols() != m_iWindowSamples) {
+        m_matWindow.resize(iNumChannels, m_iWindowSamples);
+        m_matWindowOut.resize(0, 0);
+        m_matGram = MatrixXd::Zero(iNumChannels, iNumChannels);
+        m_iWindowFill = 0;
+        m_iNumComponents = 0;
+        m_matOperator = m_matProjectorIn;
+    }
+
+    int iOffset = 0;
+    while(iOffset < matData.cols()) {
+        int iNumSamples = qMin((int)matData.cols() - iOffset, m_iWindowSamples - m_iWindowFill);
+
+        //The output is the cleaned previous window at the position which is written in the current one
+        if(m_matWindowOut.size() > 0)
+            matDataOut.middleCols(iOffset, iNumSamples).noalias() = m_matOperator * m_matWindowOut.middleCols(m_iWindowFill, iNumSamples);
+        else
+            matDataOut.middleCols(iOffset, iNumSamples).setZero();
+
+        m_matWindow.middleCols(m_iWindowFill, iNumSamples) = matData.middleCols(iOffset, iNumSamples);
+        m_matGram.selfadjointView<Lower>().rankUpdate(matData.middleCols(iOffset, iNumSamples), 1.0);
+
+        m_iWindowFill += iNumSamples;
+        iOffset += iNumSamples;
+
+        if(m_iWindowFill == m_iWindowSamples)
+            finishWindow();
+    }
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtSssEngine::apply(const MatrixXd& matData)
+{
+    MatrixXd matDataOut;
+    apply(matData, matDataOut);
+    return matDataOut;
+}
+
+
+//*************************************************************************************************************
+
+void RtSssEngine::finishWindow()
+{
+    MatrixXd matGram = m_matGram.selfadjointView<Lower>();
+    m_matOperator = computeTemporalOperator(matGram, m_matProjectorIn, m_matProjectorOut, m_dCorrelationLimit, m_iNumComponents);
+
+    //The complete window is put out next, its storage is reused for the following window
+    m_matWindowOut.swap(m_matWindow);
+    if(m_matWindow.rows() != m_matWindowOut.rows() || m_matWindow.cols() != m_matWindowOut.cols())
+        m_matWindow.resize(m_matWindowOut.rows(), m_matWindowOut.cols());
+
+    m_matGram.setZero();
+    m_iWindowFill = 0;
+}
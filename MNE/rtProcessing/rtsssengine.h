@@ -0,0 +1,290 @@
+//=============================================================================================================
+/**
+* @file     rtsssengine.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     RtSssEngine class declaration.
+*
+*/
+
+#ifndef RTSSSENGINE_H
+#define RTSSSENGINE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtprocessing_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+
+//=============================================================================================================
+/**
+* Streaming signal space separation. The internal SSS projector P_in = S_in * pinv(S_in S_out)_in is built once per
+* basis, i.e. once per head position, and every block is cleaned with a single matrix product out = P_in * in.
+*
+* With the temporal extension (tSSS) enabled the raw data is cut into windows. Once a window is complete the time
+* courses which its internal part P_in * R shares with the residual R - P_in * R - P_out * R are projected out of
+* the internal part over that window. The Gram matrix R * R^T is accumulated with rank-k updates while the window
+* fills, the intersection is then found with n x n operations only and the temporal projection folds into a single
+* channels x channels operator which is applied to the stored window. The output is therefore delayed by one window.
+*
+* The engine is not thread safe, all member functions must be called from the processing thread.
+*
+* @brief Streaming SSS/tSSS projection
+*/
+class RTPROCESSINGSHARED_EXPORT RtSssEngine
+{
+public:
+    typedef QSharedPointer<RtSssEngine> SPtr;             /**< Shared pointer type for RtSssEngine. */
+    typedef QSharedPointer<const RtSssEngine> ConstSPtr;  /**< Const shared pointer type for RtSssEngine. */
+
+    //=========================================================================================================
+    /**
+    * Creates an engine without a basis. Blocks are passed through until setBasis or setProjector was called.
+    */
+    RtSssEngine();
+
+    //=========================================================================================================
+    /**
+    * Computes the internal and the external SSS projectors from the basis. The columns of the scaled basis are
+    * normalized before the pseudo-inverse is computed by SVD, singular values below dTolerance times the largest one
+    * are discarded.
+    *
+    * @param [in] matBasisIn            internal basis, channels x internal moments.
+    * @param [in] matBasisOut           external basis, channels x external moments.
+    * @param [in] vecCoilScale          scaling of each channel in the linear equation, e.g. to balance magnetometers and gradiometers.
+    * @param [out] matProjectorIn       the channels x channels projector onto the internal subspace.
+    * @param [out] matProjectorOut      the channels x channels projector onto the external subspace.
+    * @param [in] dTolerance            relative singular value cut off.
+    *
+    * @return true if the projectors could be computed, false if the dimensions do not match.
+    */
+    static bool computeProjectors(const Eigen::MatrixXd& matBasisIn, const Eigen::MatrixXd& matBasisOut, const Eigen::VectorXd& vecCoilScale, Eigen::MatrixXd& matProjectorIn, Eigen::MatrixXd& matProjectorOut, double dTolerance = 1e-10);
+
+    //=========================================================================================================
+    /**
+    * Computes the internal SSS projector from the basis, see computeProjectors.
+    *
+    * @param [in] matBasisIn    internal basis, channels x internal moments.
+    * @param [in] matBasisOut   external basis, channels x external moments.
+    * @param [in] vecCoilScale  scaling of each channel in the linear equation.
+    * @param [in] dTolerance    relative singular value cut off.
+    *
+    * @return the channels x channels projector onto the internal subspace, an empty matrix if the dimensions do not match.
+    */
+    static Eigen::MatrixXd computeProjector(const Eigen::MatrixXd& matBasisIn, const Eigen::MatrixXd& matBasisOut, const Eigen::VectorXd& vecCoilScale, double dTolerance = 1e-10);
+
+    //=========================================================================================================
+    /**
+    * Computes the tSSS operator of a window. The time courses of the internal part B_in = P_in * R which intersect
+    * with the time courses of the residual B_res = (I - P_in - P_out) * R are projected out of B_in. With the
+    * orthonormal temporal basis Q_in = B_in^T * U_in * L_in^-1/2 and the intersecting vectors Q_in * y this gives
+    * B_in - B_in * Q_in * y * y^T * Q_in^T = (I - U_in * L_in^1/2 * y * y^T * L_in^-1/2 * U_in^T) * P_in * R.
+    *
+    * @param [in] matGram               the Gram matrix R * R^T of the raw data of the window.
+    * @param [in] matProjectorIn        the internal SSS projector.
+    * @param [in] matProjectorOut       the external SSS projector.
+    * @param [in] dCorrelationLimit     subspace correlation above which a time course is treated as intersecting.
+    * @param [out] iNumComponents       the number of intersecting time courses.
+    *
+    * @return the channels x channels operator which maps the raw window to its tSSS cleaned internal part.
+    */
+    static Eigen::MatrixXd computeTemporalOperator(const Eigen::MatrixXd& matGram, const Eigen::MatrixXd& matProjectorIn, const Eigen::MatrixXd& matProjectorOut, double dCorrelationLimit, int& iNumComponents);
+
+    //=========================================================================================================
+    /**
+    * Sets the basis, e.g. after the head moved. With tSSS the new projectors are used from the next complete window on.
+    *
+    * @param [in] matBasisIn    internal basis, channels x internal moments.
+    * @param [in] matBasisOut   external basis, channels x external moments.
+    * @param [in] vecCoilScale  scaling of each channel in the linear equation.
+    *
+    * @return true if the projectors could be computed, false otherwise.
+    */
+    bool setBasis(const Eigen::MatrixXd& matBasisIn, const Eigen::MatrixXd& matBasisOut, const Eigen::VectorXd& vecCoilScale);
+
+    //=========================================================================================================
+    /**
+    * Sets projectors which were computed with computeProjectors, e.g. on a background thread.
+    *
+    * @param [in] matProjectorIn    the channels x channels internal SSS projector.
+    * @param [in] matProjectorOut   the channels x channels external SSS projector.
+    */
+    void setProjector(const Eigen::MatrixXd& matProjectorIn, const Eigen::MatrixXd& matProjectorOut);
+
+    //=========================================================================================================
+    /**
+    * Enables the temporal extension. Resets the windows.
+    *
+    * @param [in] iWindowSamples        length of the tSSS window in samples, 0 disables tSSS.
+    * @param [in] dCorrelationLimit     subspace correlation above which a time course is removed.
+    */
+    void setTemporalExtension(int iWindowSamples, double dCorrelationLimit = 0.98);
+
+    //=========================================================================================================
+    /**
+    * Clears the tSSS windows. The projectors are kept.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Cleans a block. With tSSS the block is stored in the current window and the samples of the previous window
+    * at the same position are returned, i.e. the output is delayed by getDelay samples and zero during the first window.
+    *
+    * @param [in] matData       the raw block, channels x samples.
+    * @param [out] matDataOut   the cleaned block, only resized if its dimensions do not match matData.
+    */
+    void apply(const Eigen::MatrixXd& matData, Eigen::MatrixXd& matDataOut);
+
+    //=========================================================================================================
+    /**
+    * Cleans a block, see apply(const Eigen::MatrixXd&, Eigen::MatrixXd&).
+    *
+    * @param [in] matData       the raw block, channels x samples.
+    *
+    * @return the cleaned block.
+    */
+    Eigen::MatrixXd apply(const Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+    * Returns whether a projector was set.
+    *
+    * @return true if blocks are cleaned, false if they are passed through.
+    */
+    inline bool isInitialized() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the delay of the cleaned blocks.
+    *
+    * @return the delay in samples, the tSSS window length or 0 without tSSS.
+    */
+    inline int getDelay() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of intersecting time courses which were removed from the window which is currently put out.
+    *
+    * @return the number of removed components.
+    */
+    inline int getNumIntersectingComponents() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the operator which is currently applied, P_in without tSSS or the operator of the window which is put out.
+    *
+    * @return the channels x channels operator.
+    */
+    inline const Eigen::MatrixXd& getOperator() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Computes the operator of the complete window and swaps it in as the window which is put out next.
+    */
+    void finishWindow();
+
+    Eigen::MatrixXd     m_matProjectorIn;           /**< Internal SSS projector. */
+    Eigen::MatrixXd     m_matProjectorOut;          /**< External SSS projector. */
+    Eigen::MatrixXd     m_matOperator;              /**< Operator which is applied: P_in, or the tSSS operator of m_matWindowOut. */
+
+    int                 m_iWindowSamples;           /**< Length of the tSSS window in samples, 0 if tSSS is disabled. */
+    double              m_dCorrelationLimit;        /**< Subspace correlation limit of tSSS. */
+
+    Eigen::MatrixXd     m_matWindow;                /**< Raw samples of the window which is filled. */
+    Eigen::MatrixXd     m_matWindowOut;             /**< Raw samples of the previous window, which is put out. */
+    Eigen::MatrixXd     m_matGram;                  /**< Lower triangle of the Gram matrix of the window which is filled. */
+    int                 m_iWindowFill;              /**< Number of samples in the window which is filled. */
+    int                 m_iNumComponents;           /**< Number of intersecting time courses removed from m_matWindowOut. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool RtSssEngine::isInitialized() const
+{
+    return m_matProjectorIn.size() > 0;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtSssEngine::getDelay() const
+{
+    return m_iWindowSamples;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtSssEngine::getNumIntersectingComponents() const
+{
+    return m_iNumComponents;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::MatrixXd& RtSssEngine::getOperator() const
+{
+    return m_matOperator;
+}
+
+} // NAMESPACE
+
+#endif // RTSSSENGINE_H
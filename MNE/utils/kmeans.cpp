@@ -59,6 +59,8 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QVector>
+#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -69,6 +71,61 @@
 using namespace UTILSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Distance of point i to centroid c, evaluated with the same operations as KMeans::distfun so that both give
+* bitwise identical results.
+*/
+template<typename TX>
+inline double pointDist(const TX& X, qint32 i, const MatrixXd& C, qint32 c, bool bSqEuclidean)
+{
+    double dist;
+    if(bSqEuclidean)
+    {
+        dist = pow(X(i,0) - C(c,0), 2.0);
+        for(qint32 j = 1; j < X.cols(); ++j)
+            dist = dist + pow(X(i,j) - C(c,j), 2.0);
+    }
+    else
+    {
+        dist = std::abs(X(i,0) - C(c,0));
+        for(qint32 j = 1; j < X.cols(); ++j)
+            dist += std::abs(X(i,j) - C(c,j));
+    }
+    return dist;
+}
+
+
+//=============================================================================================================
+/**
+* Converts a distance into its metric, for which the triangle inequality holds.
+*/
+inline double toMetric(double dist, bool bSqEuclidean)
+{
+    return bSqEuclidean ? sqrt(dist) : dist;
+}
+
+
+//=============================================================================================================
+/**
+* Metric distance between two centroids - square root for squared euclidean distances.
+*/
+inline double centroidShift(const RowVectorXd& a, const RowVectorXd& b, bool bSqEuclidean)
+{
+    return bSqEuclidean ? (a - b).norm() : (a - b).cwiseAbs().sum();
+}
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -81,6 +138,10 @@ KMeans::KMeans(QString distance, QString start, qint32 replicates, QString empty
 , m_sEmptyact(emptyact)
 , m_iMaxit(maxit)
 , m_bOnline(online)
+, m_bSeedSet(false)
+, m_iSeed(0)
+, m_bParallel(true)
+, m_iRandState(0)
 , emptyErrCnt(0)
 , iter(0)
 , k(0)
@@ -102,9 +163,6 @@ bool KMeans::calculate( MatrixXd X, qint32 kClusters, VectorXi& idx, MatrixXd& C
     if (kClusters < 1)
         return false;
 
-    //Init random generator
-    srand ( time(NULL) );
-
 // n points in p dimensional space
     k = kClusters;
     n = X.rows();
@@ -155,175 +213,232 @@ bool KMeans::calculate( MatrixXd X, qint32 kClusters, VectorXi& idx, MatrixXd& C
     //
     // Done with input argument processing, begin clustering
     //
-    if (m_bOnline)
+
+    // Every replicate draws from its own generator derived from this seed
+    m_iRandState = m_bSeedSet ? m_iSeed : (quint32)time(NULL);
+
+    QVector<Replicate> t_qVecReplicates(m_iReps);
+    for(qint32 rep = 0; rep < m_iReps; ++rep)
     {
-        Del = MatrixXd(n,k);
-        Del.fill(std::numeric_limits<double>::quiet_NaN());// reassignment criterion
+        t_qVecReplicates[rep].pKMeans = this;
+        t_qVecReplicates[rep].pX = &X;
+        t_qVecReplicates[rep].pXmins = &Xmins;
+        t_qVecReplicates[rep].pXmaxs = &Xmaxs;
+        t_qVecReplicates[rep].rep = rep;
+        t_qVecReplicates[rep].bSuccess = false;
+        t_qVecReplicates[rep].totsumD = std::numeric_limits<double>::max();
     }
 
+    if(m_bParallel && m_iReps > 1)
+        QtConcurrent::blockingMap(t_qVecReplicates, &KMeans::runReplicate);
+    else
+        for(qint32 rep = 0; rep < m_iReps; ++rep)
+            runReplicate(t_qVecReplicates[rep]);
+
+    // Pick the best solution - first replicate wins on ties, as in the serial order
     double totsumDBest = std::numeric_limits<double>::max();
+    qint32 repBest = -1;
     emptyErrCnt = 0;
 
-    VectorXi idxBest;
-    MatrixXd Cbest;
-    VectorXd sumDBest;
-    MatrixXd Dbest;
-
     for(qint32 rep = 0; rep < m_iReps; ++rep)
     {
-        if (m_sStart.compare("uniform") == 0)
+        if(!t_qVecReplicates[rep].bSuccess)
         {
-            C = MatrixXd::Zero(k,p);
-            for(qint32 i = 0; i < k; ++i)
-                for(qint32 j = 0; j < p; ++j)
-                    C(i,j) = unifrnd(Xmins[j], Xmaxs[j]);
-            // For 'cosine' and 'correlation', these are uniform inside a subset
-            // of the unit hypersphere.  Still need to center them for
-            // 'correlation'.  (Re)normalization for 'cosine'/'correlation' is
-            // done at each iteration.
-            if (m_sDistance.compare("correlation") == 0)
-                C.array() -= (C.array().rowwise().sum()/p).replicate(1, p).array();
+            // If an empty cluster error occurred in one of multiple replicates, move on to
+            // the next replicate.  Error only when all replicates fail.
+            ++emptyErrCnt;
+            continue;
         }
-        else if (m_sStart.compare("sample") == 0)
+
+        if (t_qVecReplicates[rep].totsumD < totsumDBest)
         {
-            C = MatrixXd::Zero(k,p);
-            for(qint32 i = 0; i < k; ++i)
-                C.block(i,0,1,p) = X.block(rand() % n, 0, 1, p);
-            // DEBUG
-//            C.block(0,0,1,p) = X.block(2, 0, 1, p);
-//            C.block(1,0,1,p) = X.block(7, 0, 1, p);
-//            C.block(2,0,1,p) = X.block(17, 0, 1, p);
+            totsumDBest = t_qVecReplicates[rep].totsumD;
+            repBest = rep;
         }
-    //    else if (start.compare("cluster") == 0)
-    //    {
-    //        Xsubset = X(randsample(n,floor(.1*n)),:);
-    //        [dum, C] = kmeans(Xsubset, k, varargin{:}, 'start','sample', 'replicates',1);
-    //    }
-    //    else if (start.compare("numeric") == 0)
-    //    {
-    //        C = CC(:,:,rep);
-    //    }
-
-        // Compute the distance from every point to each cluster centroid and the
-        // initial assignment of points to clusters
-        D = distfun(X, C);//, 0);
-        idx = VectorXi::Zero(D.rows());
-        d = VectorXd::Zero(D.rows());
+    }
 
-        for(qint32 i = 0; i < D.rows(); ++i)
-            d[i] = D.row(i).minCoeff(&idx[i]);
+    if(emptyErrCnt == m_iReps)
+        return false;
 
-        m = VectorXi::Zero(k);
-        for(qint32 i = 0; i < k; ++i)
-            for (qint32 j = 0; j < idx.rows(); ++j)
-                if(idx[j] == i)
-                    ++ m[i];
+    // Return the best solution
+    if(repBest >= 0)
+    {
+        idx = t_qVecReplicates[repBest].idx;
+        C = t_qVecReplicates[repBest].C;
+        sumD = t_qVecReplicates[repBest].sumD;
+        D = t_qVecReplicates[repBest].D;
+        totsumD = t_qVecReplicates[repBest].totsumD;
+    }
 
-        try // catch empty cluster errors and move on to next rep
-        {
-            // Begin phase one:  batch reassignments
-            bool converged = batchUpdate(X, C, idx);
+//if hadNaNs
+//    idx = statinsertnan(wasnan, idx);
+//end
+    return true;
+}
 
-            // Begin phase two:  single reassignments
-            if (m_bOnline)
-                converged = onlineUpdate(X, C, idx);
 
-            if (!converged)
-                printf("Failed To Converge during replicate %d\n", rep);
+//*************************************************************************************************************
 
-            // Calculate cluster-wise sums of distances
-            VectorXi nonempties = VectorXi::Zero(m.rows());
-            quint32 count = 0;
-            for(qint32 i = 0; i < m.rows(); ++i)
-            {
-                if(m[i] > 0)
-                {
-                    nonempties[i] = 1;
-                    ++count;
-                }
-            }
-            MatrixXd C_tmp(count,C.cols());
-            count = 0;
-            for(qint32 i = 0; i < nonempties.rows(); ++i)
-            {
-                if(nonempties[i])
-                {
-                    C_tmp.row(count) = C.row(i);
-                    ++count;
-                }
-            }
+void KMeans::setSeed(quint32 seed)
+{
+    m_bSeedSet = true;
+    m_iSeed = seed;
+}
 
-            MatrixXd D_tmp = distfun(X, C_tmp);//, iter);
-            count = 0;
-            for(qint32 i = 0; i < nonempties.rows(); ++i)
-            {
-                if(nonempties[i])
-                {
-                    D.col(i) = D_tmp.col(count);
-                    C.row(i) = C_tmp.row(count);
-                    ++count;
-                }
-            }
 
-            d = VectorXd::Zero(n);
-            for(qint32 i = 0; i < n; ++i)
-                d[i] += D.array()(idx[i]*n+i);//Colum Major
+//*************************************************************************************************************
 
-            sumD = VectorXd::Zero(k);
-            for(qint32 i = 0; i < k; ++i)
-                for (qint32 j = 0; j < idx.rows(); ++j)
-                    if(idx[j] == i)
-                        sumD[i] += d[j];
+void KMeans::setParallelReplicates(bool parallel)
+{
+    m_bParallel = parallel;
+}
 
-            totsumD = sumD.array().sum();
 
-//            printf("%d iterations, total sum of distances = %f\n", iter, totsumD);
+//*************************************************************************************************************
+
+void KMeans::runReplicate(Replicate& replicate)
+{
+    // Own copy of configuration and iteration state
+    KMeans t_worker(*replicate.pKMeans);
+    t_worker.m_iRandState = replicate.pKMeans->m_iRandState + Q_UINT64_C(0x9E3779B97F4A7C15) * (quint64)(replicate.rep + 1);
+
+    replicate.bSuccess = t_worker.replicate(replicate.rep, *replicate.pX, *replicate.pXmins, *replicate.pXmaxs, replicate.idx, replicate.C, replicate.sumD, replicate.D);
+    if(replicate.bSuccess)
+        replicate.totsumD = t_worker.totsumD;
+}
+
+
+//*************************************************************************************************************
+
+bool KMeans::replicate(qint32 rep, const MatrixXd& X, const RowVectorXd& Xmins, const RowVectorXd& Xmaxs, VectorXi& idx, MatrixXd& C, VectorXd& sumD, MatrixXd& D)
+{
+    if (m_bOnline)
+    {
+        Del = MatrixXd(n,k);
+        Del.fill(std::numeric_limits<double>::quiet_NaN());// reassignment criterion
+    }
+
+    if (m_sStart.compare("uniform") == 0)
+    {
+        C = MatrixXd::Zero(k,p);
+        for(qint32 i = 0; i < k; ++i)
+            for(qint32 j = 0; j < p; ++j)
+                C(i,j) = unifrnd(Xmins[j], Xmaxs[j]);
+        // For 'cosine' and 'correlation', these are uniform inside a subset
+        // of the unit hypersphere.  Still need to center them for
+        // 'correlation'.  (Re)normalization for 'cosine'/'correlation' is
+        // done at each iteration.
+        if (m_sDistance.compare("correlation") == 0)
+            C.array() -= (C.array().rowwise().sum()/p).replicate(1, p).array();
+    }
+    else if (m_sStart.compare("sample") == 0)
+    {
+        C = MatrixXd::Zero(k,p);
+        for(qint32 i = 0; i < k; ++i)
+            C.block(i,0,1,p) = X.block(randi(n), 0, 1, p);
+        // DEBUG
+//            C.block(0,0,1,p) = X.block(2, 0, 1, p);
+//            C.block(1,0,1,p) = X.block(7, 0, 1, p);
+//            C.block(2,0,1,p) = X.block(17, 0, 1, p);
+    }
+//    else if (start.compare("cluster") == 0)
+//    {
+//        Xsubset = X(randsample(n,floor(.1*n)),:);
+//        [dum, C] = kmeans(Xsubset, k, varargin{:}, 'start','sample', 'replicates',1);
+//    }
+//    else if (start.compare("numeric") == 0)
+//    {
+//        C = CC(:,:,rep);
+//    }
+
+    // Compute the distance from every point to each cluster centroid and the
+    // initial assignment of points to clusters
+    D = distfun(X, C);//, 0);
+    idx = VectorXi::Zero(D.rows());
+    d = VectorXd::Zero(D.rows());
+
+    for(qint32 i = 0; i < D.rows(); ++i)
+        d[i] = D.row(i).minCoeff(&idx[i]);
 
-            // Save the best solution so far
-            if (totsumD < totsumDBest)
+    m = VectorXi::Zero(k);
+    for(qint32 i = 0; i < k; ++i)
+        for (qint32 j = 0; j < idx.rows(); ++j)
+            if(idx[j] == i)
+                ++ m[i];
+
+    try // catch empty cluster errors and move on to next rep
+    {
+        // Begin phase one:  batch reassignments
+        bool converged;
+        if (m_sDistance.compare("sqeuclidean") == 0 || m_sDistance.compare("cityblock") == 0)
+            converged = batchUpdatePruned(X, C, idx);
+        else
+            converged = batchUpdate(X, C, idx);
+
+        // Begin phase two:  single reassignments
+        if (m_bOnline)
+            converged = onlineUpdate(X, C, idx);
+
+        if (!converged)
+            printf("Failed To Converge during replicate %d\n", rep);
+
+        // Calculate cluster-wise sums of distances
+        VectorXi nonempties = VectorXi::Zero(m.rows());
+        quint32 count = 0;
+        for(qint32 i = 0; i < m.rows(); ++i)
+        {
+            if(m[i] > 0)
             {
-                totsumDBest = totsumD;
-                idxBest = idx;
-                Cbest = C;
-                sumDBest = sumD;
-                Dbest = D;
+                nonempties[i] = 1;
+                ++count;
             }
         }
-        catch (int e)
+        MatrixXd C_tmp(count,C.cols());
+        count = 0;
+        for(qint32 i = 0; i < nonempties.rows(); ++i)
         {
-            if(e == 0)
+            if(nonempties[i])
             {
-                // If an empty cluster error occurred in one of multiple replicates, catch
-                // it, warn, and move on to next replicate.  Error only when all replicates
-                // fail.  Rethrow an other kind of error.
-                if (m_iReps == 1)
-                    return false;
-                else
-                {
-                    emptyErrCnt = emptyErrCnt + 1;
-//                    printf("Replicate %d terminated: empty cluster created at iteration %d.\n", rep, iter);
-                    if (emptyErrCnt == m_iReps)
-                    {
-//                        error(message('EmptyClusterAllReps'));
-                        return false;
-                    }
+                C_tmp.row(count) = C.row(i);
+                ++count;
+            }
+        }
 
-                }
+        MatrixXd D_tmp = distfun(X, C_tmp);//, iter);
+        count = 0;
+        for(qint32 i = 0; i < nonempties.rows(); ++i)
+        {
+            if(nonempties[i])
+            {
+                D.col(i) = D_tmp.col(count);
+                C.row(i) = C_tmp.row(count);
+                ++count;
             }
-        } // catch
+        }
 
-    } // replicates
+        d = VectorXd::Zero(n);
+        for(qint32 i = 0; i < n; ++i)
+            d[i] += D.array()(idx[i]*n+i);//Colum Major
 
-    // Return the best solution
-    idx = idxBest;
-    C = Cbest;
-    sumD = sumDBest;
-    D = Dbest;
+        sumD = VectorXd::Zero(k);
+        for(qint32 i = 0; i < k; ++i)
+            for (qint32 j = 0; j < idx.rows(); ++j)
+                if(idx[j] == i)
+                    sumD[i] += d[j];
 
-//if hadNaNs
-//    idx = statinsertnan(wasnan, idx);
-//end
-    return true;
+        totsumD = sumD.array().sum();
+
+//            printf("%d iterations, total sum of distances = %f\n", iter, totsumD);
+
+        return true;
+    }
+    catch (int e)
+    {
+        // An empty cluster error occurred, the replicate is dropped
+//        printf("Replicate terminated: empty cluster created at iteration %d.\n", iter);
+        Q_UNUSED(e);
+        return false;
+    } // catch
 }
 
 
@@ -515,6 +630,193 @@ bool KMeans::batchUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
 
 
 
+//*************************************************************************************************************
+
+bool KMeans::batchUpdatePruned(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
+{
+    const bool bSqEuclidean = m_sDistance.compare("sqeuclidean") == 0;
+
+    // Points are visited one by one - keep their coordinates contiguous
+    const Matrix<double, Dynamic, Dynamic, RowMajor> Xr = X;
+
+    // Every point moved, every cluster will need an update
+    qint32 i = 0;
+    VectorXi changed(k);
+    for(i = 0; i < k; ++i)
+        changed[i] = i;
+
+    previdx = VectorXi::Zero(n);
+
+    prevtotsumD = std::numeric_limits<double>::max();//max double
+
+    VectorXd dOwn = VectorXd::Zero(n);      // Distance of every point to its own centroid, equals D(i,idx(i))
+    Matrix<double, Dynamic, Dynamic, RowMajor> lower(n, k);    // Lower bounds (metric) of the point to centroid distances
+    bool bBounds = false;                   // Bounds are valid after the first full assignment pass
+
+    VectorXd shift(k);
+    VectorXi isChanged(k);
+    RowVectorXd rowD(k);
+
+    //
+    // Begin phase one:  batch reassignments
+    //
+    iter = 0;
+    bool converged = false;
+    while(true)
+    {
+        ++iter;
+
+        // Calculate the new cluster centroids and counts, track how far each centroid moved
+        MatrixXd C_new;
+        VectorXi m_new;
+        KMeans::gcentroids(X, idx, changed, C_new, m_new);
+
+        shift.setZero();
+        isChanged.setZero();
+        for(qint32 i = 0; i < changed.rows(); ++i)
+        {
+            shift[changed[i]] = centroidShift(C.row(changed[i]), C_new.row(i), bSqEuclidean);
+            isChanged[changed[i]] = 1;
+            C.row(changed[i]) = C_new.row(i);
+            m[changed[i]] = m_new[i];
+        }
+
+        // Empty (NaN) centroids invalidate the bounds - fall back to full assignment passes
+        if(!(C.array() == C.array()).all())
+            bBounds = false;
+
+        // Deal with clusters that have just lost all their members
+        VectorXi empties = VectorXi::Zero(changed.rows());
+        for(qint32 i = 0; i < changed.rows(); ++i)
+            if(m(i) == 0)
+                empties[i] = 1;
+
+        if (empties.sum() > 0)
+        {
+            if (m_sEmptyact.compare("error") == 0)
+            {
+                return converged;
+//                throw 0;
+            }
+        }
+
+        // Update the distances to the own centroids and compute the total sum of distances
+        totsumD = 0;
+        for(qint32 i = 0; i < n; ++i)
+        {
+            if(isChanged[idx[i]])
+                dOwn[i] = pointDist(Xr, i, C, idx[i], bSqEuclidean);
+            totsumD += dOwn[i];
+        }
+
+        // Test for a cycle: if objective is not decreased, back out
+        // the last step and move on to the single update phase
+        if(prevtotsumD <= totsumD)
+        {
+            idx = previdx;
+            MatrixXd C_new;
+            VectorXi m_new;
+            gcentroids(X, idx, changed, C_new, m_new);
+            C.block(0,0,k,C.cols()) = C_new;
+            m.block(0,0,k,1) = m_new;
+            --iter;
+            break;
+        }
+
+        if (iter >= m_iMaxit)
+            break;
+
+        // Determine closest cluster for each point and reassign points to clusters
+        previdx = idx;
+        prevtotsumD = totsumD;
+
+        // Centroids moved by at most their shift - reduce the lower bounds accordingly
+        if(bBounds)
+            lower.rowwise() -= shift.transpose();
+
+        VectorXi nidx(n);
+        VectorXi moved(n);
+        qint32 count = 0;
+        for(qint32 i = 0; i < n; ++i)
+        {
+            if(bBounds)
+            {
+                // Only centroids which are not provably farther away than the own one need a distance
+                // (the margin covers rounding errors). The own distance is always exact, so the minimum
+                // and its first index equal the ones of the full distance row.
+                double dBound = toMetric(dOwn[i], bSqEuclidean) * (1.0 + 1e-10);
+                nidx[i] = -1;
+                for(qint32 c = 0; c < k; ++c)
+                {
+                    if(c == idx[i])
+                        rowD[c] = dOwn[i];
+                    else if(lower(i,c) > dBound)
+                        continue;
+                    else
+                    {
+                        rowD[c] = pointDist(Xr, i, C, c, bSqEuclidean);
+                        lower(i,c) = toMetric(rowD[c], bSqEuclidean);
+                    }
+
+                    if(nidx[i] < 0 || rowD[c] < d[i])
+                    {
+                        d[i] = rowD[c];
+                        nidx[i] = c;
+                    }
+                }
+            }
+            else
+            {
+                for(qint32 c = 0; c < k; ++c)
+                {
+                    rowD[c] = c == idx[i] ? dOwn[i] : pointDist(Xr, i, C, c, bSqEuclidean);
+                    lower(i,c) = toMetric(rowD[c], bSqEuclidean);
+                }
+                d[i] = rowD.minCoeff(&nidx[i]);
+            }
+
+            // Resolve ties in favor of not moving
+            if(nidx[i] != previdx[i] && rowD[previdx[i]] > d[i])
+            {
+                moved[count] = i;
+                ++count;
+                dOwn[i] = d[i];
+            }
+        }
+        moved.conservativeResize(count);
+        bBounds = true;
+
+        if (moved.rows() == 0)
+        {
+            converged = true;
+            break;
+        }
+
+        for(qint32 i = 0; i < moved.rows(); ++i)
+            idx[ moved[i] ] = nidx[ moved[i] ];
+
+        // Find clusters that gained or lost members
+        std::vector<int> tmp;
+        for(qint32 i = 0; i < moved.rows(); ++i)
+            tmp.push_back(idx[moved[i]]);
+        for(qint32 i = 0; i < moved.rows(); ++i)
+            tmp.push_back(previdx[moved[i]]);
+
+        std::sort(tmp.begin(),tmp.end());
+
+        std::vector<int>::iterator it;
+        it = std::unique(tmp.begin(),tmp.end());
+        tmp.resize( it - tmp.begin() );
+
+        changed.conservativeResize(tmp.size());
+
+        for(quint32 i = 0; i < tmp.size(); ++i)
+            changed[i] = tmp[i];
+    } // phase one
+    return converged;
+}
+
+
 //*************************************************************************************************************
 
 bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
@@ -946,23 +1248,25 @@ void KMeans::gcentroids(const MatrixXd& X, const VectorXi& index, const VectorXi
     centroids.fill(std::numeric_limits<double>::quiet_NaN());
     counts = VectorXi::Zero(num);
 
+    // Collect the members of all requested clusters in a single pass over the points
+    VectorXi clustPos = VectorXi::Constant(k > 0 ? k : 1, -1);
+    for(qint32 i = 0; i < num; ++i)
+        if(clusts[i] >= 0 && clusts[i] < clustPos.rows())
+            clustPos[clusts[i]] = i;
+
+    std::vector< std::vector<qint32> > memberLists(num);
+    for(qint32 j = 0; j < index.rows(); ++j)
+        if(index[j] >= 0 && index[j] < clustPos.rows() && clustPos[index[j]] >= 0)
+            memberLists[clustPos[index[j]]].push_back(j);
+
     VectorXi members;
 
     qint32 c;
 
     for(qint32 i = 0; i < num; ++i)
     {
-        c = 0;
-        members = VectorXi::Zero(index.rows());
-        for(qint32 j = 0; j < index.rows(); ++j)
-        {
-            if(index[j] == clusts[i])
-            {
-                members[c] = j;
-                ++c;
-            }
-        }
-        members.conservativeResize(c);
+        c = memberLists[i].size();
+        members = Map<VectorXi>(memberLists[i].data(), c);
         if (c > 0)
         {
             counts[i] = c;
@@ -980,16 +1284,9 @@ void KMeans::gcentroids(const MatrixXd& X, const VectorXi& index, const VectorXi
                 // Separate out sorted coords for points in i'th cluster,
                 // and use to compute a fast median, component-wise
                 MatrixXd Xsorted(counts[i],p);
-                c = 0;
 
-                for(qint32 j = 0; j < index.rows(); ++j)
-                {
-                    if(index[j] == clusts[i])
-                    {
-                        Xsorted.row(c) = X.row(j);
-                        ++c;
-                    }
-                }
+                for(qint32 j = 0; j < members.rows(); ++j)
+                    Xsorted.row(j) = X.row(members[j]);
 
                 for(qint32 j = 0; j < Xsorted.cols(); ++j)
                     std::sort(Xsorted.col(j).data(),Xsorted.col(j).data()+Xsorted.rows());
@@ -1027,7 +1324,21 @@ double KMeans::unifrnd(double a, double b)
     double mu = a2+b2;
     double sig = b2-a2;
 
-    double r = mu + sig * (2.0* (rand() % 1000)/1000 -1.0);
+    double r = mu + sig * (2.0* randi(1000)/1000 -1.0);
 
     return r;
 }
+
+
+//*************************************************************************************************************
+
+qint32 KMeans::randi(qint32 n)
+{
+    // splitmix64
+    quint64 z = (m_iRandState += Q_UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+    z = z ^ (z >> 31);
+
+    return (qint32)(z % (quint64)n);
+}
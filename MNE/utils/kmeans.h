@@ -119,8 +119,70 @@ public:
     */
     bool calculate( MatrixXd X, qint32 kClusters, VectorXi& idx, MatrixXd& C, VectorXd& sumD, MatrixXd& D);
 
+    //=========================================================================================================
+    /**
+    * Sets the seed of the random initialization. Each replicate draws from its own generator seeded with
+    * the seed and the replicate number, so results are identical whether the replicates run in parallel or
+    * one after another. By default the seed is taken from the current time.
+    *
+    * @param[in] seed   The random seed
+    */
+    void setSeed(quint32 seed);
+
+    //=========================================================================================================
+    /**
+    * Sets whether the replicates are calculated in parallel. Default is true.
+    *
+    * @param[in] parallel   Whether to run the replicates in parallel
+    */
+    void setParallelReplicates(bool parallel);
+
 
 private:
+    //=========================================================================================================
+    /**
+    * Input and result of a single replicate, used for the parallel replicate calculation.
+    */
+    struct Replicate
+    {
+        const KMeans* pKMeans;      /**< The KMeans configuration to run with */
+        const MatrixXd* pX;         /**< Input data */
+        const RowVectorXd* pXmins;  /**< Column minimums of the input data (uniform start) */
+        const RowVectorXd* pXmaxs;  /**< Column maximums of the input data (uniform start) */
+        qint32 rep;                 /**< Replicate number */
+        bool bSuccess;              /**< Whether the replicate finished without an empty cluster error */
+        VectorXi idx;               /**< The cluster indeces */
+        MatrixXd C;                 /**< Cluster centroids */
+        VectorXd sumD;              /**< Summation of the distances to the centroid within one cluster */
+        MatrixXd D;                 /**< Cluster distances to the centroid */
+        double totsumD;             /**< Total sum of centroid distances */
+    };
+
+    //=========================================================================================================
+    /**
+    * Runs a replicate on its own copy of the KMeans object. Used by QtConcurrent.
+    *
+    * @param[in, out] replicate     The replicate to calculate
+    */
+    static void runReplicate(Replicate& replicate);
+
+    //=========================================================================================================
+    /**
+    * Calculates a single replicate.
+    *
+    * @param[in] rep        Number of the replicate, used for messages
+    * @param[in] X          Input data
+    * @param[in] Xmins      Column minimums of the input data (uniform start)
+    * @param[in] Xmaxs      Column maximums of the input data (uniform start)
+    * @param[out] idx       The cluster indeces
+    * @param[out] C         Cluster centroids
+    * @param[out] sumD      Summation of the distances to the centroid within one cluster
+    * @param[out] D         Cluster distances to the centroid
+    *
+    * @return true if succeeded, false if an empty cluster error occured
+    */
+    bool replicate(qint32 rep, const MatrixXd& X, const RowVectorXd& Xmins, const RowVectorXd& Xmaxs, VectorXi& idx, MatrixXd& C, VectorXd& sumD, MatrixXd& D);
+
     //=========================================================================================================
     /**
     * Calculate point to cluster centroid distances.
@@ -144,6 +206,21 @@ private:
     */
     bool batchUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx);
 
+    //=========================================================================================================
+    /**
+    * Batch update for the metric distances "sqeuclidean" and "cityblock" with Elkan pruning: the exact
+    * distance of each point to its own centroid is kept together with lower bounds on the distances to all
+    * other centroids, which are reduced by the centroid shifts of each iteration. Distances to centroids whose
+    * bound exceeds the own distance are skipped. Gives the same result as batchUpdate.
+    *
+    * @param[in] X          Input data
+    * @param[in, out] C     Cluster centroids
+    * @param[in, out] idx   The cluster indeces to which cluster the input points belong to
+    *
+    * @return true if converged, false otherwise
+    */
+    bool batchUpdatePruned(const MatrixXd& X, MatrixXd& C, VectorXi& idx);
+
     //=========================================================================================================
     /**
     * Centroids and counts stratified by group.
@@ -181,6 +258,16 @@ private:
     */
     double unifrnd(double a, double b);
 
+    //=========================================================================================================
+    /**
+    * Random integer of the replicate's generator in the intervall [0, n)
+    *
+    * @param[in] n      upper boundary (exclusive)
+    *
+    * @return random number
+    */
+    qint32 randi(qint32 n);
+
 
     QString m_sDistance;    /**< Distance measurement to use: "sqeuclidean" (default), "cityblock" , "cosine", "correlation", "hamming". */
     QString m_sStart;       /**< Initialization to use: "sample" (default), "uniform", "cluster". */
@@ -188,6 +275,10 @@ private:
     QString m_sEmptyact;    /**< What should be done if a cluster wents empty: "error" (default), "drop", "singleton" */
     qint32 m_iMaxit;        /**< Maximal number of iterations per replicate */
     bool m_bOnline;         /**< If online update should be performed */
+    bool m_bSeedSet;        /**< If a seed was set by setSeed */
+    quint32 m_iSeed;        /**< Seed of the random initialization */
+    bool m_bParallel;       /**< If replicates are calculated in parallel */
+    quint64 m_iRandState;   /**< State of the replicate's random generator */
 
     qint32 emptyErrCnt;     /**< Counts the occurence of empty errors */
 
@@ -146,6 +146,12 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
         gabor_Atom->energy = 0;
         qreal phase = 0;
 
+        //
+        // coarse dyadic grid: the envelope spectra are calculated once per scale, all scale and modulation pairs are
+        // searched in parallel and reduced afterwards in the order of the serial search
+        //
+        QList<VectorXcd> fft_envelopes;
+        QList<grid_point> grid_points;
         while(s < sample_count)
         {
             k = 0;                               //for modulation 2*pi*k/N
@@ -153,83 +159,71 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
             VectorXd envelope = GaborAtom::gauss_function(sample_count, s, p);
             VectorXcd fft_envelope = RowVectorXcd::Zero(sample_count);
             fft.fwd(fft_envelope, envelope);
+            fft_envelopes.append(fft_envelope);
 
             while(k < sample_count/2)
             {
-                p = floor(sample_count/2);
-                VectorXcd modulation = modulation_function(sample_count, k);
-                VectorXcd modulated_resid = VectorXcd::Zero(sample_count);
-                VectorXcd fft_modulated_resid = VectorXcd::Zero(sample_count);
-                VectorXcd fft_m_e_resid = VectorXcd::Zero(sample_count);
-                VectorXd corr_coeffs = VectorXd::Zero(sample_count);
-
-                //iteration for multichannel, depending on boost setting
-                for(qint32 chn = 0; chn < channel_count; chn++)
-                {
-                    qint32 max_index = 0;
-                    qreal maximum = 0;
-                    phase = 0;
-                    p = floor(sample_count/2);//here is difference to dr. gratkowski´s code (he didn´t reset parameter p)
-
-                    //complex correlation of signal and sinus-modulated gaussfunction
-                    for(qint32 l = 0; l< sample_count; l++)
-                        modulated_resid[l] = residuum(l, chn) * modulation[l];
-
-                    fft.fwd(fft_modulated_resid, modulated_resid);
+                grid_point current_grid_point;
+                current_grid_point.residuum = &residuum;
+                current_grid_point.fft_envelope = NULL;     //set below, fft_envelopes must not grow anymore
+                current_grid_point.sample_count = sample_count;
+                current_grid_point.channel_count = channel_count;
+                current_grid_point.scale = s;
+                current_grid_point.translation = p;
+                current_grid_point.modulation = k;
+                current_grid_point.fix_phase = fix_phase;
+                grid_points.append(current_grid_point);
 
-                    for( qint32 m = 0; m < sample_count; m++)
-                        fft_m_e_resid[m] = fft_modulated_resid[m] * conj(fft_envelope[m]);
+                k += pow(2.0,(-j))*sample_count/2;
+            }
+            j++;
+            s = pow(2.0,j);
+        }
 
-                    fft.inv(corr_coeffs, fft_m_e_resid);
-                    maximum = corr_coeffs[0];
+        qint32 scale_index = -1;
+        for(qint32 i = 0; i < grid_points.length(); i++)
+        {
+            if(i == 0 || grid_points[i].scale != grid_points[i-1].scale)
+                scale_index++;
+            grid_points[i].fft_envelope = &fft_envelopes.at(scale_index);
+        }
 
-                    //find index of maximum correlation-coefficient to use in translation
-                    for(qint32 i = 1; i < corr_coeffs.rows(); i++)
-                        if(maximum < corr_coeffs[i])
-                        {
-                            maximum = corr_coeffs[i];
-                            max_index = i;
-                        }
+        QList<QList<VectorXd> > grid_results = QtConcurrent::blockingMapped<QList<QList<VectorXd> > >(grid_points, &grid_point::parallel_grid_search);
 
-                    //adapting translation p to create atomtranslation correctly
-                    if(max_index >= p) p = max_index - p + 1;
-                    else p = max_index + p;
+        for(qint32 i = 0; i < grid_results.length(); i++)
+        {
+            //iteration for multichannel, depending on boost setting
+            for(qint32 chn = 0; chn < channel_count; chn++)
+            {
+                const VectorXd& atom_parameters = grid_results.at(i).at(chn);
+                qreal temp_scalar_product = 0;
+                if(trial_separation) temp_scalar_product = max_scalar_product[chn];
+                else temp_scalar_product = max_scalar_product[0];
 
-                    VectorXd atom_parameters = calculate_atom(sample_count, s, p, k, chn, residuum, RETURNPARAMETERS, fix_phase);
-                    qreal temp_scalar_product = 0;
-                    if(trial_separation) temp_scalar_product = max_scalar_product[chn];
-                    else temp_scalar_product = max_scalar_product[0];
+                if(abs(atom_parameters[4]) >= abs(temp_scalar_product))
+                {
+                    //set highest scalarproduct, in comparison to best matching atom
+                    gabor_Atom->scale              = atom_parameters[0];
+                    gabor_Atom->translation        = atom_parameters[1];
+                    gabor_Atom->modulation         = atom_parameters[2];
+                    gabor_Atom->phase              = atom_parameters[3];
+                    gabor_Atom->max_scalar_product = atom_parameters[4];
+                    gabor_Atom->bm_channel         = chn;
 
-                    if(abs(atom_parameters[4]) >= abs(temp_scalar_product))
+                    if(trial_separation)
                     {
-                        //set highest scalarproduct, in comparison to best matching atom
-                        gabor_Atom->scale              = atom_parameters[0];
-                        gabor_Atom->translation        = atom_parameters[1];
-                        gabor_Atom->modulation         = atom_parameters[2];
-                        gabor_Atom->phase              = atom_parameters[3];
-                        gabor_Atom->max_scalar_product = atom_parameters[4];
-                        gabor_Atom->bm_channel         = chn;
-
-                        if(trial_separation)
-                        {
-                            max_scalar_product[chn]    = atom_parameters[4];
-
-                            if(atoms_in_chns.length() < channel_count)
-                                atoms_in_chns.append(*gabor_Atom);
-                            else
-                                atoms_in_chns.replace(chn, *gabor_Atom);
-                        }
-                        else
-                            max_scalar_product[0]      = atom_parameters[4];
+                        max_scalar_product[chn]    = atom_parameters[4];
 
+                        if(atoms_in_chns.length() < channel_count)
+                            atoms_in_chns.append(*gabor_Atom);
+                        else
+                            atoms_in_chns.replace(chn, *gabor_Atom);
                     }
+                    else
+                        max_scalar_product[0]      = atom_parameters[4];
 
                 }
-                k += pow(2.0,(-j))*sample_count/2;
-
             }
-            j++;
-            s = pow(2.0,j);
         }
         std::cout << "\n" << "===============" << " found parameters " << it + 1 << "===============" << ":\n\n"<<
                      "scale: " << gabor_Atom->scale << " trans: " << gabor_Atom->translation <<
@@ -242,14 +236,31 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
         j = floor(log10(sample_count)/log10(2));//log(sample_count) / log(2));
         phase = 0;
 
+        QList<grid_point> no_envelope_points;
+        while(k < sample_count / 2)
+        {
+            grid_point current_grid_point;
+            current_grid_point.residuum = &residuum;
+            current_grid_point.fft_envelope = NULL;
+            current_grid_point.sample_count = sample_count;
+            current_grid_point.channel_count = channel_count;
+            current_grid_point.scale = s;
+            current_grid_point.translation = p;
+            current_grid_point.modulation = k;
+            current_grid_point.fix_phase = fix_phase;
+            no_envelope_points.append(current_grid_point);
+
+            k += pow(2.0,(-j))*sample_count/2;
+        }
+
+        QList<QList<VectorXd> > no_envelope_results = QtConcurrent::blockingMapped<QList<QList<VectorXd> > >(no_envelope_points, &grid_point::parallel_grid_search);
+
         //iteration for multichannel, depending on boost setting
         for(qint32 chn = 0; chn < channel_count; chn++)
         {
-            k = 0;
-
-            while(k < sample_count / 2)
+            for(qint32 i = 0; i < no_envelope_results.length(); i++)
             {
-                VectorXd parameters_no_envelope = calculate_atom(sample_count, s, p, k, chn, residuum, RETURNPARAMETERS, fix_phase);
+                const VectorXd& parameters_no_envelope = no_envelope_results.at(i).at(chn);
 
                 qreal temp_scalar_product = 0;
                 if(trial_separation) temp_scalar_product = max_scalar_product[chn];
@@ -274,10 +285,7 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
                         max_scalar_product[0]      = parameters_no_envelope[4];
 
                 }
-                k += pow(2.0,(-j))*sample_count/2;
-
             }
-
         }
         std::cout << "      after comparison to NoEnvelope " << ":\n"<< "scale: " << gabor_Atom->scale << " trans: " << gabor_Atom->translation <<
                      " modu: " << gabor_Atom->modulation << " phase: " << gabor_Atom->phase << " sclr_prdct: " << gabor_Atom->max_scalar_product << "\n\n";
@@ -286,13 +294,32 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
 
         if(trial_separation && simplex_it != 0)
         {
+            //the channels are optimised independently of each other, run them in parallel
+            QList<simplex_refinement> refinements;
             for(qint32 chn = 0; chn < atoms_in_chns.length(); chn++)
             {
-                *gabor_Atom = atoms_in_chns.at(chn);
-                simplex_maximisation(simplex_it, simplex_reflection, simplex_expansion, simplex_contraction, simplex_full_contraction,
-                                     gabor_Atom, max_scalar_product, sample_count, fix_phase, residuum, trial_separation, chn);
-
+                simplex_refinement current_refinement;
+                current_refinement.adaptive_mp = this;
+                current_refinement.atom = atoms_in_chns.at(chn);
+                current_refinement.max_scalar_product = max_scalar_product;
+                current_refinement.residuum = &residuum;
+                current_refinement.simplex_it = simplex_it;
+                current_refinement.simplex_reflection = simplex_reflection;
+                current_refinement.simplex_expansion = simplex_expansion;
+                current_refinement.simplex_contraction = simplex_contraction;
+                current_refinement.simplex_full_contraction = simplex_full_contraction;
+                current_refinement.sample_count = sample_count;
+                current_refinement.fix_phase = fix_phase;
+                current_refinement.trial_separation = trial_separation;
+                current_refinement.channel = chn;
+                refinements.append(current_refinement);
             }
+
+            QList<GaborAtom> refined_atoms = QtConcurrent::blockingMapped<QList<GaborAtom> >(refinements, &simplex_refinement::parallel_simplex);
+            for(qint32 chn = 0; chn < refined_atoms.length(); chn++)
+                atoms_in_chns.replace(chn, refined_atoms.at(chn));
+            if(!refined_atoms.isEmpty())
+                *gabor_Atom = refined_atoms.last();
         }
         else if(simplex_it != 0)
             simplex_maximisation(simplex_it, simplex_reflection, simplex_expansion, simplex_contraction, simplex_full_contraction,
@@ -399,57 +426,59 @@ VectorXcd AdaptiveMp::modulation_function(qint32 N, qreal k)
 
 //*************************************************************************************************************
 
-VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, MatrixXd residuum, ReturnValue return_value = RETURNATOM, bool fix_phase = false)
+VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, const MatrixXd& residuum, ReturnValue return_value = RETURNATOM, bool fix_phase = false)
 {
-    GaborAtom *gabor_Atom = new GaborAtom();
-    qreal phase = 0;
-    //create complex Gaboratom
-    VectorXcd complex_gabor_atom = gabor_Atom->create_complex(sample_count, scale, translation, modulation);
+    //envelope and modulation are evaluated once and shared by the complex and the real atom; the constant factors of
+    //GaborAtom::create_complex and GaborAtom::create_real cancel in their normalization
+    qreal shift = qreal(quint32(translation));                              //create_complex and create_real take the translation unsigned
+    bool complex_envelope = !(scale == sample_count && quint32(translation) == floor(sample_count / 2));
+    bool real_envelope = !(scale == sample_count);
+
+    VectorXd envelope(sample_count);
+    VectorXd cos_table(sample_count);
+    VectorXd sin_table(sample_count);
+    for(qint32 i = 0; i < sample_count; i++)
+    {
+        qreal t = (qreal(i) - shift) / scale;
+        qreal angle = 2 * PI * modulation / qreal(sample_count) * qreal(i);
+        envelope[i] = exp(-PI * t * t);
+        cos_table[i] = cos(angle);
+        sin_table[i] = sin(angle);
+    }
 
-    //calculate Inner Product: preparation to find the parameter phase
+    //calculate Inner Product: preparation to find the parameter phase, the positive normalization of the complex atom does not change its argument
+    VectorXd complex_re = complex_envelope ? VectorXd(envelope.cwiseProduct(cos_table)) : cos_table;
+    VectorXd complex_im = complex_envelope ? VectorXd(envelope.cwiseProduct(sin_table)) : sin_table;
     std::complex<double> inner_product(0, 0);
 
     if(fix_phase == false)
-    {
-        for(qint32 i = 0; i < sample_count; i++)
-            inner_product += residuum(i, channel) * conj(complex_gabor_atom[i]);
-    }
-    else
-    {
-        for(qint32 chn = 0; chn < residuum.cols(); chn++)
-        {
-            for(qint32 i = 0; i < sample_count; i++)
-                inner_product += residuum(i, chn) * conj(complex_gabor_atom[i]);
-        }
-        if(residuum.cols() != 0)
-            inner_product /= residuum.cols();
-    }
+        inner_product = std::complex<double>(residuum.col(channel).dot(complex_re), -residuum.col(channel).dot(complex_im));
+    else if(residuum.cols() != 0)
+        inner_product = std::complex<double>((residuum.transpose() * complex_re).sum(), -(residuum.transpose() * complex_im).sum()) / qreal(residuum.cols());
 
     //calculate phase to create realGaborAtoms
-    phase = std::arg(inner_product);
+    qreal phase = std::arg(inner_product);
     if (phase < 0) phase = 2 * PI - phase;
-    VectorXd real_gabor_atom = gabor_Atom->create_real(sample_count, scale, translation, modulation, phase);
 
-    delete gabor_Atom;
+    VectorXd real_gabor_atom = cos(phase) * cos_table - sin(phase) * sin_table;
+    if(real_envelope)
+        real_gabor_atom = real_gabor_atom.cwiseProduct(envelope);
+
+    //normalization
+    qreal norm = real_gabor_atom.norm();
+    if(norm != 0) real_gabor_atom /= norm;
 
     switch(return_value)
     {
     case RETURNPARAMETERS:
     {
-
-        qreal scalar_product = 0;
-
-        for(qint32 i = 0; i < sample_count; i++)
-            scalar_product += real_gabor_atom[i] * residuum(i, channel);
-
         VectorXd atom_parameters = VectorXd::Zero(5);
 
         atom_parameters[0] = scale;
         atom_parameters[1] = translation;
         atom_parameters[2] = modulation;
         atom_parameters[3] = phase;
-        atom_parameters[4] = scalar_product;
-
+        atom_parameters[4] = real_gabor_atom.dot(residuum.col(channel));
 
         return atom_parameters;
     }
@@ -462,8 +491,59 @@ VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 tra
 
 //*************************************************************************************************************
 
+QList<VectorXd> AdaptiveMp::grid_point::parallel_grid_search() const
+{
+    Eigen::FFT<double> fft;
+    QList<VectorXd> channel_parameters;
+
+    //modulation is shared by all channels
+    VectorXcd modulation_table(sample_count);
+    if(fft_envelope)
+        for(qint32 n = 0; n < sample_count; n++)
+            modulation_table[n] = std::polar(1 / sqrt(qreal(sample_count)), 2 * PI * modulation / qreal(sample_count) * qreal(n));
+
+    VectorXcd modulated_resid(sample_count);
+    VectorXcd fft_modulated_resid(sample_count);
+    VectorXd corr_coeffs(sample_count);
+
+    for(qint32 chn = 0; chn < channel_count; chn++)
+    {
+        qint32 p = translation;
+
+        if(fft_envelope)
+        {
+            //complex correlation of signal and sinus-modulated gaussfunction
+            modulated_resid = residuum->col(chn).cast<std::complex<double> >().cwiseProduct(modulation_table);
+            fft.fwd(fft_modulated_resid, modulated_resid);
+            fft_modulated_resid = fft_modulated_resid.cwiseProduct(fft_envelope->conjugate());
+            fft.inv(corr_coeffs, fft_modulated_resid);
+
+            //find index of maximum correlation-coefficient to use in translation
+            qint32 max_index = 0;
+            qreal maximum = corr_coeffs[0];
+            for(qint32 i = 1; i < corr_coeffs.rows(); i++)
+                if(maximum < corr_coeffs[i])
+                {
+                    maximum = corr_coeffs[i];
+                    max_index = i;
+                }
+
+            //adapting translation p to create atomtranslation correctly
+            p = floor(sample_count/2);//here is difference to dr. gratkowski´s code (he didn´t reset parameter p)
+            if(max_index >= p) p = max_index - p + 1;
+            else p = max_index + p;
+        }
+
+        channel_parameters.append(AdaptiveMp::calculate_atom(sample_count, scale, p, modulation, chn, *residuum, RETURNPARAMETERS, fix_phase));
+    }
+
+    return channel_parameters;
+}
+
+//*************************************************************************************************************
+
 void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflection, qreal simplex_expansion, qreal simplex_contraction, qreal simplex_full_contraction,
-                                      GaborAtom *gabor_Atom, VectorXd max_scalar_product, qint32 sample_count, bool fix_phase, MatrixXd residuum, bool trial_separation, qint32 chn)
+                                      GaborAtom *gabor_Atom, VectorXd max_scalar_product, qint32 sample_count, bool fix_phase, const MatrixXd& residuum, bool trial_separation, qint32 chn)
 {
     //Maximisation Simplex Algorithm implemented by Botao Jia, adapted to the MP Algorithm by Martin Henfling. Copyright (C) 2010 Botao Jia
     //ToDo: change to clean use of EIGEN, @present its mixed with Namespace std and <vector>
@@ -530,13 +610,7 @@ void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflectio
                 atom_fx = calculate_atom(sample_count, x[i][0], x[i][1], x[i][2], chn, residuum, RETURNATOM, fix_phase);
 
             //create targetfunction of realGaborAtom and Residuum
-            double target = 0;
-            for(qint32 k = 0; k < atom_fx.rows(); k++)
-            {
-                target -=atom_fx[k]*residuum(k, chn); //ToDo: old residuum(k,0)
-            }
-
-            vf[i] = target;
+            vf[i] = -atom_fx.dot(residuum.col(chn)); //ToDo: old residuum(k,0)
         }
 
         x1=0; xn=0; xnp1=0;//find index of max, second max, min of vf.
@@ -585,8 +659,7 @@ void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflectio
             atom_fxr = calculate_atom(sample_count, xr[0], xr[1], xr[2], chn, residuum, RETURNATOM, fix_phase);
 
         //create targetfunction of realGaborAtom and Residuum
-        double fxr = 0;
-        for(qint32 k = 0; k < atom_fxr.rows(); k++) fxr -=atom_fxr[k]*residuum(k,chn);//ToDo: old residuum(k,0)
+        double fxr = -atom_fxr.dot(residuum.col(chn));//ToDo: old residuum(k,0)
 
         //double fxr = target;//record function at xr
 
@@ -608,8 +681,7 @@ void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflectio
                 atom_fxe = calculate_atom(sample_count, xe[0], xe[1], xe[2], chn, residuum, RETURNATOM, fix_phase);
 
             //create targetfunction of realGaborAtom and Residuum
-            double fxe = 0;
-            for(qint32 k = 0; k < atom_fxe.rows(); k++) fxe -=atom_fxe[k]*residuum(k,chn);//ToDo: old residuum(k,0)
+            double fxe = -atom_fxe.dot(residuum.col(chn));//ToDo: old residuum(k,0)
 
             if( fxe < fxr ) std::copy(xe.begin(), xe.end(), x[xnp1].begin() );
             else std::copy(xr.begin(), xr.end(), x[xnp1].begin() );
@@ -631,16 +703,10 @@ void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflectio
 
             VectorXd atom_fxc = gabor_Atom->create_real(gabor_Atom->sample_count, atom_fxc_params[0], atom_fxc_params[1], atom_fxc_params[2], atom_fxc_params[3]);
 
-            atom_fxc_params[4] = 0;
-
-            for(qint32 i = 0; i < sample_count; i++)
-                atom_fxc_params[4] += atom_fxc[i] * residuum(i, chn);
+            atom_fxc_params[4] = atom_fxc.dot(residuum.col(chn));
 
             //create targetfunction of realGaborAtom and Residuum
-            double fxc = 0;
-
-            for(qint32 k = 0; k < atom_fxc.rows(); k++)
-                fxc -=atom_fxc[k]*residuum(k,chn);//ToDo: old residuum(k,0)
+            double fxc = -atom_fxc_params[4];//ToDo: old residuum(k,0)
 
             if( fxc < vf[xnp1] )
                 std::copy(xc.begin(), xc.end(), x[xnp1].begin() );
@@ -676,9 +742,6 @@ void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflectio
             gabor_Atom->modulation         = atom_fxc_params[2];
             gabor_Atom->phase              = atom_fxc_params[3];
             gabor_Atom->max_scalar_product = atom_fxc_params[4];
-
-            if(trial_separation)
-                atoms_in_chns.replace(chn, *gabor_Atom);
         }
 
         if(cnt==iterations)//max number of iteration achieves before tol is satisfied
@@ -65,6 +65,7 @@
 //=============================================================================================================
 
 #include <QThread>
+#include <QList>
 
 
 //*************************************************************************************************************
@@ -193,7 +194,55 @@ public:
     *
     * @return depending on returnValue returning the real atom calculated or the manipulated parameters: scale, translation, modulation, phase, scalarproduct
     */
-    static VectorXd calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, MatrixXd residuum, ReturnValue return_value, bool fix_phase);
+    static VectorXd calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, const MatrixXd& residuum, ReturnValue return_value, bool fix_phase);
+
+    //=========================================================================================================
+    /**
+    * grid search of one scale and modulation of the dyadic dictionary, evaluated for all observed channels
+    */
+    struct grid_point
+    {
+        const MatrixXd* residuum;
+        const VectorXcd* fft_envelope;  /**< spectrum of the envelope of this scale, NULL to use the translation as it is */
+        qint32 sample_count;
+        qint32 channel_count;
+        qreal scale;
+        qint32 translation;
+        qreal modulation;
+        bool fix_phase;
+
+        QList<VectorXd> parallel_grid_search() const;
+    };
+
+    //=========================================================================================================
+    /**
+    * simplex optimisation of one atom, several of them run in parallel
+    */
+    struct simplex_refinement
+    {
+        AdaptiveMp* adaptive_mp;
+        GaborAtom atom;
+        VectorXd max_scalar_product;
+        const MatrixXd* residuum;
+        qint32 simplex_it;
+        qreal simplex_reflection;
+        qreal simplex_expansion;
+        qreal simplex_contraction;
+        qreal simplex_full_contraction;
+        qint32 sample_count;
+        bool fix_phase;
+        bool trial_separation;
+        qint32 channel;
+
+        GaborAtom parallel_simplex() const
+        {
+            GaborAtom refined_atom = this->atom;
+            adaptive_mp->simplex_maximisation(this->simplex_it, this->simplex_reflection, this->simplex_expansion, this->simplex_contraction,
+                                              this->simplex_full_contraction, &refined_atom, this->max_scalar_product, this->sample_count,
+                                              this->fix_phase, *this->residuum, this->trial_separation, this->channel);
+            return refined_atom;
+        }
+    };
 
     //=========================================================================================================
     /**
@@ -217,7 +266,7 @@ public:
     * @return depending on returnValue returning the real atom calculated or the manipulated parameters: scale, translation, modulation, phase, scalarproduct
     */
     void simplex_maximisation(qint32 simplex_it, qreal simplex_reflection, qreal simplex_expansion, qreal simplex_contraction, qreal simplex_full_contraction,
-                              GaborAtom *gabor_Atom, VectorXd max_scalar_product, qint32 sample_count, bool fix_phase, MatrixXd residuum, bool trial_separation, qint32 chn);
+                              GaborAtom *gabor_Atom, VectorXd max_scalar_product, qint32 sample_count, bool fix_phase, const MatrixXd& residuum, bool trial_separation, qint32 chn);
 
     //=========================================================================================================
 
@@ -73,6 +73,7 @@
 #include <QtConcurrent>
 #include <QFuture>
 #include <QFile>
+#include <QFileInfo>
 #include <QStringList>
 
 
@@ -83,6 +84,54 @@
 
 using namespace UTILSLIB;
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+const char bin_dict_magic[4] = {'M', 'P', 'B', 'D'};   /**< Magic bytes of binary dictionary files. */
+const qint32 bin_dict_byte_order = 0x01020304;          /**< Written in host byte order, identifies the byte order. */
+const qint32 bin_dict_version = 1;                      /**< Version of the binary dictionary format. */
+
+template<typename T>
+inline void append_bin_value(QByteArray& buffer, const T& value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline void append_bin_string(QByteArray& buffer, const QString& value)
+{
+    QByteArray utf8 = value.toUtf8();
+    append_bin_value(buffer, (qint32)utf8.size());
+    buffer.append(utf8);
+}
+
+template<typename T>
+inline bool read_bin_value(const uchar*& pos, const uchar* end, T& value)
+{
+    if(end - pos < (qint64)sizeof(T))
+        return false;
+    memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+inline bool read_bin_string(const uchar*& pos, const uchar* end, QString& value)
+{
+    qint32 size = 0;
+    if(!read_bin_value(pos, end, size) || size < 0 || end - pos < size)
+        return false;
+    value = QString::fromUtf8(reinterpret_cast<const char*>(pos), size);
+    pos += size;
+    return true;
+}
+
+} // NAMESPACE
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -145,7 +194,25 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
     bool sample_count_mismatch = false;
 
     this->residuum = signal;
-    parsed_dicts = parse_xml_dict(path);
+    parsed_dicts = parse_dict(path);
+
+    //the atom spectra only depend on the signal length, calculate them once for all iterations
+    QList<QFuture<void> > spectra_futures;
+    for(qint32 i = 0; i < parsed_dicts.length(); i++)
+        spectra_futures.append(QtConcurrent::run(&parsed_dicts[i], &Dictionary::calc_atom_spectra, sample_count));
+    for(qint32 i = 0; i < spectra_futures.length(); i++)
+        spectra_futures[i].waitForFinished();
+
+    //spectra of the residuum, updated with the spectrum of every subtracted atom
+    Eigen::FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+    VectorXcd fft_spectrum;
+    MatrixXcd resid_spectra(sample_count / 2 + 1, channel_count);
+    for(qint32 channel = 0; channel < channel_count; channel++)
+    {
+        fft.fwd(fft_spectrum, this->residuum.col(channel));
+        resid_spectra.col(channel) = fft_spectrum;
+    }
 
     //calculate signal_energy
     for(qint32 channel = 0; channel < channel_count; channel++)
@@ -167,8 +234,9 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
         for(qint32 i = 0; i < parsed_dicts.length(); i++)
         {
             find_best_matching current_best_matching;
-            current_best_matching.pdict = parsed_dicts.at(i);
-            current_best_matching.current_resid = this->residuum;
+            current_best_matching.pdict = &parsed_dicts.at(i);
+            current_best_matching.resid_spectra = &resid_spectra;
+            current_best_matching.sample_count = sample_count;
             current_best_matching.boost = boost;
             list_of_best.append(current_best_matching);
         }
@@ -189,39 +257,19 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
 
         global_best_matching.display_text = create_display_text(global_best_matching);
 
-        VectorXd fitted_atom = VectorXd::Zero(this->residuum.rows());
-        VectorXd resized_atom = VectorXd::Zero(this->residuum.rows());
-
-        if(global_best_matching.atom_samples.rows() > this->residuum.rows())
-            for(qint32 k = 0; k < this->residuum.rows(); k++)    
-                resized_atom[k] = global_best_matching.atom_samples[k + floor(global_best_matching.atom_samples.rows() / 2) - floor(this->residuum.rows() / 2)];
-        else    resized_atom = global_best_matching.atom_samples;
+        VectorXd fitted_atom = fit_atom(global_best_matching.atom_samples, sample_count, global_best_matching.translation);
 
+        //reproject all channels at once
+        VectorXd scalar_products = this->residuum.transpose() * fitted_atom;
+        this->residuum -= fitted_atom * scalar_products.transpose();
 
-        for(qint32 k = 0; k < resized_atom.rows(); k++)
-            if((k + global_best_matching.translation - floor(resized_atom.rows() / 2)) >= 0
-                    && (k + global_best_matching.translation - floor(resized_atom.rows() / 2)) < fitted_atom.rows())
-                    fitted_atom[(k + global_best_matching.translation - floor(resized_atom.rows() / 2))] += resized_atom[k];
+        for(qint32 chn = 0; chn < scalar_products.rows(); chn++)
+            global_best_matching.max_scalar_list.append(scalar_products[chn]);
+        global_best_matching.energy += scalar_products.squaredNorm() * fitted_atom.squaredNorm();
 
-        //normalization
-        qreal norm = 0;
-        norm = fitted_atom.norm();
-        if(norm != 0) fitted_atom /= norm;
-
-        for(qint32 chn = 0; chn < this->residuum.cols(); chn++)
-        {
-            qreal scalarproduct = 0;
-            for(qint32 sample = 0; sample < this->residuum.rows(); sample++)
-                scalarproduct += (this->residuum(sample, chn) * fitted_atom[sample]);
-
-            global_best_matching.max_scalar_list.append(scalarproduct);//residuum(global_best_matching.translation, chn) / fitted_atom[global_best_matching.translation]);
-
-            for(qint32 k = 0; k < fitted_atom.rows(); k++)
-            {
-                this->residuum(k,chn) -= global_best_matching.max_scalar_list.at(chn) * fitted_atom[k];
-                global_best_matching.energy += pow(global_best_matching.max_scalar_list.at(chn) * fitted_atom[k], 2); //  * global_best_matching.max_scalar_list.at(chn) * fitted_atom[k];
-            }
-        }
+        //the correlation is linear, subtract the atom from the residuum spectra instead of transforming the residuum again
+        fft.fwd(fft_spectrum, fitted_atom);
+        resid_spectra -= fft_spectrum * scalar_products.transpose().cast<std::complex<double> >();
 
         global_best_matching.atom_samples = fitted_atom;
 
@@ -285,81 +333,43 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
 //*************************************************************************************************************
 
 // calc scalarproduct of Atom and Signal
-FixDictAtom FixDictMp::correlation(Dictionary current_pdict, MatrixXd current_resid, qint32 boost)
+FixDictAtom FixDictMp::correlation(const Dictionary& current_pdict, const MatrixXcd& resid_spectra, qint32 sample_count, qint32 boost)
 {
-    qint32 channel_count = current_resid.cols() * (boost / 100.0); //reducing the number of observed channels in the algorithm to increase speed performance
+    qint32 channel_count = resid_spectra.cols() * (boost / 100.0); //reducing the number of observed channels in the algorithm to increase speed performance
     if(boost == 0 || channel_count == 0)
         channel_count = 1;
 
     Eigen::FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
     std::ptrdiff_t max_index;
-    VectorXcd fft_atom = VectorXcd::Zero(current_resid.rows());
+
+    VectorXd corr_coeffs(sample_count);
+    VectorXcd fft_sig_atom(resid_spectra.rows());
 
     FixDictAtom best_matching;
     qreal max_scalar_product = 0;
 
     for(qint32 i = 0; i < current_pdict.atoms.length(); i++)
     {
-        VectorXd fitted_atom = VectorXd::Zero(current_resid.rows());
-        qint32 p = floor(current_resid.rows() / 2);//translation
-
-        VectorXd resized_atom = VectorXd::Zero(current_resid.rows());
-
-        if(current_pdict.atoms.at(i).atom_samples.rows() > current_resid.rows())
-            for(qint32 k = 0; k < current_resid.rows(); k++)
-                resized_atom[k] = current_pdict.atoms.at(i).atom_samples[k + floor(current_pdict.atoms.at(i).atom_samples.rows() / 2) - floor(current_resid.rows() / 2)];
-        else resized_atom = current_pdict.atoms.at(i).atom_samples;
-
-        if(resized_atom.rows() < current_resid.rows())
-            for(qint32 k = 0; k < resized_atom.rows(); k++)
-                fitted_atom[(k + p - floor(resized_atom.rows() / 2))] = resized_atom[k];
-        else fitted_atom = resized_atom;
-
-        //normalization
-        qreal norm = 0;
-        norm = fitted_atom.norm();
-        if(norm != 0) fitted_atom /= norm;
-
-        fft.fwd(fft_atom, fitted_atom);
-
         for(qint32 chn = 0; chn < channel_count; chn++)
         {
-            p = floor(current_resid.rows() / 2);//translation
-            VectorXd corr_coeffs = VectorXd::Zero(current_resid.rows());
-            VectorXcd fft_signal = VectorXcd::Zero(current_resid.rows());
-            VectorXcd fft_sig_atom = VectorXcd::Zero(current_resid.rows());
-
-            fft.fwd(fft_signal, current_resid.col(chn));
+            qint32 p = floor(sample_count / 2);//translation
 
-            for( qint32 m = 0; m < current_resid.rows(); m++)
-                fft_sig_atom[m] = fft_signal[m] * conj(fft_atom[m]);
-
-            fft.inv(corr_coeffs, fft_sig_atom);
+            //correlation coefficients of all translations at once
+            fft_sig_atom = resid_spectra.col(chn).cwiseProduct(current_pdict.atom_spectra.col(i));
+            fft.inv(corr_coeffs, fft_sig_atom, sample_count);
 
             //find index of maximum correlation-coefficient to use in translation
             max_scalar_product = corr_coeffs.maxCoeff(&max_index);
 
-            if(i == 0)
+            if((i == 0 && chn == 0) || abs(max_scalar_product) > abs(best_matching.max_scalar_product))
             {
                 best_matching = current_pdict.atoms.at(i);
                 best_matching.max_scalar_product = max_scalar_product;
 
                 //adapting translation p to create atomtranslation correctly
-                if(max_index >= p && current_resid.rows() % (2) == 0) p = max_index - p;
-                else if(max_index >= p && current_resid.rows() % (2) != 0) p = max_index - p - 1;
-                else p = max_index + p;
-
-                best_matching.translation = p;
-            }
-
-            else if(abs(max_scalar_product) > abs(best_matching.max_scalar_product))
-            {
-                best_matching = current_pdict.atoms.at(i);
-                best_matching.max_scalar_product = max_scalar_product;
-
-                //adapting translation p to create atomtranslation correctly
-                if(max_index >= p && current_resid.rows() % (2) == 0) p = max_index - p;
-                else if(max_index >= p && current_resid.rows() % (2) != 0) p = max_index - p - 1;
+                if(max_index >= p && sample_count % (2) == 0) p = max_index - p;
+                else if(max_index >= p && sample_count % (2) != 0) p = max_index - p - 1;
                 else p = max_index + p;
 
                 best_matching.translation = p;
@@ -375,6 +385,64 @@ FixDictAtom FixDictMp::correlation(Dictionary current_pdict, MatrixXd current_re
 }
 
 
+//*************************************************************************************************************
+
+VectorXd FixDictMp::fit_atom(const VectorXd& atom_samples, qint32 signal_length, qint32 translation)
+{
+    VectorXd resized_atom;
+    if(atom_samples.rows() > signal_length)
+        resized_atom = atom_samples.segment(floor(atom_samples.rows() / 2) - floor(signal_length / 2), signal_length);
+    else
+        resized_atom = atom_samples;
+
+    VectorXd fitted_atom = VectorXd::Zero(signal_length);
+    for(qint32 k = 0; k < resized_atom.rows(); k++)
+    {
+        qint32 sample = k + translation - floor(resized_atom.rows() / 2);
+        if(sample >= 0 && sample < signal_length)
+            fitted_atom[sample] += resized_atom[k];
+    }
+
+    //normalization
+    qreal norm = fitted_atom.norm();
+    if(norm != 0) fitted_atom /= norm;
+
+    return fitted_atom;
+}
+
+
+//*************************************************************************************************************
+
+QList<Dictionary> FixDictMp::parse_dict(QString path)
+{
+    QFileInfo xml_info(path);
+    QString bin_path = QString("%1/%2.bdict").arg(xml_info.absolutePath()).arg(xml_info.completeBaseName());
+    QFileInfo bin_info(bin_path);
+
+    QList<Dictionary> parsed_dict;
+    if(bin_info.exists() && bin_info.lastModified() >= xml_info.lastModified())
+        parsed_dict = parse_bin_dict(bin_path);
+
+    if(parsed_dict.isEmpty())
+    {
+        parsed_dict = parse_xml_dict(path);
+        if(!parsed_dict.isEmpty() && !write_bin_dict(bin_path, parsed_dict))
+            std::cout << "could not write binary dictionary " << qPrintable(bin_path) << "\n";
+    }
+    else
+    {
+        for(qint32 i = 0; i < parsed_dict.length(); i++)
+            if(parsed_dict.at(i).sample_count != this->residuum.rows())
+            {
+                emit send_warning(2);
+                break;
+            }
+    }
+
+    return parsed_dict;
+}
+
+
 //*************************************************************************************************************
 
 QList<Dictionary> FixDictMp::parse_xml_dict(QString path)
@@ -425,6 +493,174 @@ QList<Dictionary> FixDictMp::parse_xml_dict(QString path)
 }
 
 
+//*************************************************************************************************************
+
+QList<Dictionary> FixDictMp::parse_bin_dict(QString path)
+{
+    QList<Dictionary> parsed_dict;
+
+    QFile bin_file(path);
+    if(!bin_file.open(QIODevice::ReadOnly))
+        return parsed_dict;
+
+    const uchar* data = bin_file.map(0, bin_file.size());
+    if(!data)
+        return parsed_dict;
+
+    const uchar* pos = data;
+    const uchar* end = data + bin_file.size();
+
+    qint32 byte_order = 0;
+    qint32 version = 0;
+    qint32 dict_count = 0;
+    bool ok = end - pos >= 4 && memcmp(pos, bin_dict_magic, 4) == 0;
+    if(ok)
+    {
+        pos += 4;
+        ok = read_bin_value(pos, end, byte_order) && byte_order == bin_dict_byte_order
+                && read_bin_value(pos, end, version) && version == bin_dict_version
+                && read_bin_value(pos, end, dict_count);
+    }
+
+    for(qint32 d = 0; ok && d < dict_count; d++)
+    {
+        Dictionary current_dict;
+        qint32 type = 0;
+        qint32 atom_count = 0;
+        ok = read_bin_value(pos, end, type)
+                && read_bin_value(pos, end, current_dict.sample_count)
+                && read_bin_value(pos, end, atom_count)
+                && read_bin_string(pos, end, current_dict.source)
+                && read_bin_string(pos, end, current_dict.atom_formula);
+        current_dict.type = (AtomType)type;
+
+        for(qint32 i = 0; ok && i < atom_count; i++)
+        {
+            FixDictAtom current_atom;
+            qint32 atom_sample_count = 0;
+            qreal params[8];
+            ok = read_bin_value(pos, end, current_atom.id)
+                    && read_bin_value(pos, end, atom_sample_count)
+                    && atom_sample_count >= 0
+                    && end - pos >= (qint64)sizeof(params) + (qint64)atom_sample_count * (qint64)sizeof(qreal);
+            if(!ok)
+                break;
+
+            memcpy(params, pos, sizeof(params));
+            pos += sizeof(params);
+            current_atom.atom_samples.resize(atom_sample_count);
+            memcpy(current_atom.atom_samples.data(), pos, atom_sample_count * sizeof(qreal));
+            pos += atom_sample_count * sizeof(qreal);
+
+            if(current_dict.type == GABORATOM)
+            {
+                current_atom.gabor_atom.scale = params[0];
+                current_atom.gabor_atom.modulation = params[1];
+                current_atom.gabor_atom.phase = params[2];
+            }
+            else if(current_dict.type == CHIRPATOM)
+            {
+                current_atom.chirp_atom.scale = params[0];
+                current_atom.chirp_atom.modulation = params[1];
+                current_atom.chirp_atom.phase = params[2];
+                current_atom.chirp_atom.chirp = params[3];
+            }
+            else
+            {
+                current_atom.formula_atom.a = params[0];
+                current_atom.formula_atom.b = params[1];
+                current_atom.formula_atom.c = params[2];
+                current_atom.formula_atom.d = params[3];
+                current_atom.formula_atom.e = params[4];
+                current_atom.formula_atom.f = params[5];
+                current_atom.formula_atom.g = params[6];
+                current_atom.formula_atom.h = params[7];
+            }
+            current_dict.atoms.append(current_atom);
+        }
+        parsed_dict.append(current_dict);
+    }
+
+    bin_file.unmap(const_cast<uchar*>(data));
+    bin_file.close();
+
+    if(!ok)
+    {
+        std::cout << "binary dictionary " << qPrintable(path) << " is invalid\n";
+        parsed_dict.clear();
+    }
+
+    return parsed_dict;
+}
+
+
+//*************************************************************************************************************
+
+bool FixDictMp::write_bin_dict(QString path, const QList<Dictionary>& dicts)
+{
+    QByteArray buffer;
+    buffer.append(bin_dict_magic, 4);
+    append_bin_value(buffer, bin_dict_byte_order);
+    append_bin_value(buffer, bin_dict_version);
+    append_bin_value(buffer, (qint32)dicts.length());
+
+    for(qint32 d = 0; d < dicts.length(); d++)
+    {
+        const Dictionary& current_dict = dicts.at(d);
+        append_bin_value(buffer, (qint32)current_dict.type);
+        append_bin_value(buffer, current_dict.sample_count);
+        append_bin_value(buffer, (qint32)current_dict.atoms.length());
+        append_bin_string(buffer, current_dict.source);
+        append_bin_string(buffer, current_dict.atom_formula);
+
+        for(qint32 i = 0; i < current_dict.atoms.length(); i++)
+        {
+            const FixDictAtom& current_atom = current_dict.atoms.at(i);
+            qreal params[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+            if(current_dict.type == GABORATOM)
+            {
+                params[0] = current_atom.gabor_atom.scale;
+                params[1] = current_atom.gabor_atom.modulation;
+                params[2] = current_atom.gabor_atom.phase;
+            }
+            else if(current_dict.type == CHIRPATOM)
+            {
+                params[0] = current_atom.chirp_atom.scale;
+                params[1] = current_atom.chirp_atom.modulation;
+                params[2] = current_atom.chirp_atom.phase;
+                params[3] = current_atom.chirp_atom.chirp;
+            }
+            else
+            {
+                params[0] = current_atom.formula_atom.a;
+                params[1] = current_atom.formula_atom.b;
+                params[2] = current_atom.formula_atom.c;
+                params[3] = current_atom.formula_atom.d;
+                params[4] = current_atom.formula_atom.e;
+                params[5] = current_atom.formula_atom.f;
+                params[6] = current_atom.formula_atom.g;
+                params[7] = current_atom.formula_atom.h;
+            }
+
+            append_bin_value(buffer, current_atom.id);
+            append_bin_value(buffer, (qint32)current_atom.atom_samples.rows());
+            buffer.append(reinterpret_cast<const char*>(params), sizeof(params));
+            buffer.append(reinterpret_cast<const char*>(current_atom.atom_samples.data()), current_atom.atom_samples.rows() * sizeof(qreal));
+        }
+    }
+
+    QFile bin_file(path);
+    if(!bin_file.open(QIODevice::WriteOnly))
+        return false;
+
+    bool ok = bin_file.write(buffer) == buffer.size();
+    bin_file.close();
+
+    return ok;
+}
+
+
 //*************************************************************************************************************
 
 Dictionary FixDictMp::fill_dict(const QDomNode &pdict)
@@ -585,12 +821,31 @@ qint32 Dictionary::atom_count()
  void Dictionary::clear()
  {
      this->atoms.clear();
+     this->atom_spectra.resize(0, 0);
      this->atom_formula = "";
      this->sample_count = 0;
      this->source = "";
  }
 
 
+ //*************************************************************************************************************
+
+void Dictionary::calc_atom_spectra(qint32 signal_length)
+{
+    Eigen::FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+    VectorXcd fft_atom;
+
+    atom_spectra.resize(signal_length / 2 + 1, atoms.length());
+    for(qint32 i = 0; i < atoms.length(); i++)
+    {
+        VectorXd fitted_atom = FixDictMp::fit_atom(atoms.at(i).atom_samples, signal_length, signal_length / 2);
+        fft.fwd(fft_atom, fitted_atom);
+        atom_spectra.col(i) = fft_atom.conjugate();
+    }
+}
+
+
  //*************************************************************************************************************
 
 /*
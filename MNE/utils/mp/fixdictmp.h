@@ -121,10 +121,24 @@ public:
     QString atom_formula;
     qint32 sample_count;
 
+    MatrixXcd atom_spectra;     /**< conjugated half spectra of the centered, normalized atoms, one column per atom */
+
     qint32 atom_count();
 
     void clear();
 
+    //=========================================================================================================
+    /**
+    * dictionary_calc_atom_spectra
+    *
+    * ### MP toolbox function ###
+    *
+    * calculates atom_spectra for signals of the given length, they stay valid for all iterations of the algorithm
+    *
+    * @param[in] signal_length  number of samples of the signal
+    */
+    void calc_atom_spectra(qint32 signal_length);
+
 };//class
 
 
@@ -180,7 +194,38 @@ public:
 
     //=========================================================================================================
 
-    FixDictAtom correlation(Dictionary current_pdict, MatrixXd current_resid, qint32 boost);
+    /**
+    * fixdictMp_correlation
+    *
+    * ### MP toolbox function ###
+    *
+    * finds the best matching atom of a dictionary and its translation. All translations of an atom are evaluated
+    * with one inverse FFT per channel of the product of the residuum and atom spectra.
+    *
+    * @param[in] current_pdict  dictionary with calculated atom_spectra
+    * @param[in] resid_spectra  half spectra of the residuum, one column per channel
+    * @param[in] sample_count   number of samples of the residuum
+    * @param[in] boost          percentage of channels used to find the best matching atom
+    *
+    * @return best matching atom
+    */
+    FixDictAtom correlation(const Dictionary& current_pdict, const MatrixXcd& resid_spectra, qint32 sample_count, qint32 boost);
+
+    //=========================================================================================================
+    /**
+    * fixdictMp_fit_atom
+    *
+    * ### MP toolbox function ###
+    *
+    * crops or zero pads the atom samples to the signal length, centers them at translation and normalizes them
+    *
+    * @param[in] atom_samples   samples of the atom
+    * @param[in] signal_length  number of samples of the signal
+    * @param[in] translation    sample the atom is centered at
+    *
+    * @return fitted atom
+    */
+    static VectorXd fit_atom(const VectorXd& atom_samples, qint32 signal_length, qint32 translation);
 
     //=========================================================================================================
 
@@ -194,21 +239,68 @@ public:
 
     struct find_best_matching
     {
-        Dictionary pdict;
-        MatrixXd current_resid;
+        const Dictionary* pdict;
+        const MatrixXcd* resid_spectra;
+        qint32 sample_count;
         qint32 boost;
 
         FixDictAtom parallel_correlation() const
         {
             FixDictAtom best_matching;
             FixDictMp fix_dict_mp;
-            best_matching = fix_dict_mp.correlation(this->pdict, this->current_resid, this->boost);
+            best_matching = fix_dict_mp.correlation(*this->pdict, *this->resid_spectra, this->sample_count, this->boost);
             return best_matching;
         }
     };
 
+    //=========================================================================================================
+    /**
+    * fixdictMp_parse_dict
+    *
+    * ### MP toolbox function ###
+    *
+    * loads the dictionaries of a xml dictionary file. They are read from the binary copy next to it (.bdict) if it is
+    * up to date, otherwise the xml file is parsed and the binary copy is (re)written.
+    *
+    * @param[in] path   path of the xml dictionary file
+    *
+    * @return parsed dictionaries
+    */
+    QList<Dictionary> parse_dict(QString path);
+
+    //=========================================================================================================
+
     QList<Dictionary> parse_xml_dict(QString path);
 
+    //=========================================================================================================
+    /**
+    * fixdictMp_parse_bin_dict
+    *
+    * ### MP toolbox function ###
+    *
+    * reads dictionaries from a binary dictionary file, the file is memory mapped while reading
+    *
+    * @param[in] path   path of the binary dictionary file
+    *
+    * @return parsed dictionaries, empty if the file could not be read
+    */
+    QList<Dictionary> parse_bin_dict(QString path);
+
+    //=========================================================================================================
+    /**
+    * fixdictMp_write_bin_dict
+    *
+    * ### MP toolbox function ###
+    *
+    * writes dictionaries to a binary dictionary file
+    *
+    * @param[in] path   path of the binary dictionary file
+    * @param[in] dicts  dictionaries to write
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool write_bin_dict(QString path, const QList<Dictionary>& dicts);
+
     //=========================================================================================================
 
     Dictionary fill_dict(const QDomNode &pdict);
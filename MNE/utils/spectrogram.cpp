@@ -50,6 +50,15 @@
 #include <unsupported/Eigen/FFT>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent>
+#include <QFuture>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -78,35 +87,72 @@ VectorXd Spectrogram::gauss_window (qint32 sample_count, qreal scale, quint32 tr
 
 //-----------------------------------------------------------------------------------------------------------------
 
-MatrixXd Spectrogram::make_spectrogram(VectorXd signal, qint32 window_size = 0)
+MatrixXd Spectrogram::make_spectrogram(const VectorXd& signal, qint32 window_size, qint32 hop_size)
 {
-    if(window_size == 0)
-        window_size = signal.rows()/4;
+    if(window_size < 1)
+        window_size = default_window_size(signal.rows());
+    if(hop_size < 1)
+        hop_size = default_hop_size(window_size);
 
-    Eigen::FFT<double> fft;
-    MatrixXd tf_matrix = MatrixXd::Zero(signal.rows()/2, signal.rows());
+    // the gaussian window is negligible beyond two window sizes from its center
+    qint32 frame_length = 4*window_size;
+    qint32 half_frame = frame_length/2;
+    qint32 sample_count = signal.rows();
 
-    for(qint32 translate = 0; translate < signal.rows(); translate++)
-    {
-        VectorXd envelope = gauss_window(signal.rows(), window_size, translate);
+    VectorXd envelope = gauss_window(frame_length, window_size, half_frame);
 
-        VectorXd windowed_sig = VectorXd::Zero(signal.rows());
-        VectorXcd fft_win_sig = VectorXcd::Zero(signal.rows());
+    qint32 frame_count = (sample_count + hop_size - 1)/hop_size;
+    MatrixXd tf_matrix = MatrixXd::Zero(frame_length/2, frame_count);
 
-        VectorXd real_coeffs = VectorXd::Zero(signal.rows()/2);
+    Eigen::FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
 
-        for(qint32 sample = 0; sample < signal.rows(); sample++)
-            windowed_sig[sample] = signal[sample] * envelope[sample];
+    VectorXd windowed_sig(frame_length);
+    VectorXcd fft_win_sig(frame_length/2+1);
 
-        fft.fwd(fft_win_sig, windowed_sig);
+    for(qint32 frame = 0; frame < frame_count; frame++)
+    {
+        // samples outside of the signal are zero
+        qint32 start = frame*hop_size - half_frame;
+        qint32 first = qMax(start, 0);
+        qint32 last = qMin(start + frame_length, sample_count);
 
-        for(qint32 i= 0; i<signal.rows()/2; i++)
-        {
-            qreal value = pow(abs(fft_win_sig[i]), 2.0);
-            real_coeffs[i] = value;
-        }
+        windowed_sig.setZero();
+        if(last > first)
+            windowed_sig.segment(first - start, last - first) = signal.segment(first, last - first).cwiseProduct(envelope.segment(first - start, last - first));
 
-        tf_matrix.col(translate) = real_coeffs;
+        fft.fwd(fft_win_sig, windowed_sig);
+
+        tf_matrix.col(frame) = fft_win_sig.head(frame_length/2).cwiseAbs2();
     }
     return tf_matrix;
 }
+
+//-----------------------------------------------------------------------------------------------------------------
+
+QList<MatrixXd> Spectrogram::make_spectrograms(const MatrixXd& signals, qint32 window_size, qint32 hop_size)
+{
+    QList<QFuture<MatrixXd> > futures;
+    for(qint32 channel = 0; channel < signals.cols(); channel++)
+        futures.append(QtConcurrent::run(&Spectrogram::make_spectrogram, VectorXd(signals.col(channel)), window_size, hop_size));
+
+    QList<MatrixXd> tf_matrices;
+    for(qint32 channel = 0; channel < futures.size(); channel++)
+        tf_matrices.append(futures[channel].result());
+
+    return tf_matrices;
+}
+
+//-----------------------------------------------------------------------------------------------------------------
+
+qint32 Spectrogram::default_window_size(qint32 sample_count)
+{
+    return qBound(1, sample_count/4, 256);
+}
+
+//-----------------------------------------------------------------------------------------------------------------
+
+qint32 Spectrogram::default_hop_size(qint32 window_size)
+{
+    return qMax(1, window_size/4);
+}
@@ -51,6 +51,14 @@
 #include <Eigen/Core>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QList>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE NAMESPACE UTILSLIB
@@ -76,14 +84,51 @@ public:
     *
      * ### TF plot root function ###
     *
-    * calculates the spectrogram (tf-representation) of a given signal
+    * calculates the spectrogram (tf-representation) of a given signal. The signal is cut into frames of
+    * 4*window_size samples centered every hop_size samples, each frame is tapered with the gaussian window and
+    * transformed with one FFT plan which is shared by all frames. Frame j is centered at sample j*hop_size.
     *
     * @param[in] signal         input-signal to calculate spectrogram of
-    * @param[in] window_size    size of the window which is used (resolution in time an frequency is depending on it)
+    * @param[in] window_size    size of the window which is used (resolution in time an frequency is depending on it), default_window_size if 0
+    * @param[in] hop_size       number of samples between two neighbouring frames, default_hop_size if 0
+    *
+    * @return spectrogram-matrix (tf-representation of the input signal), frequency bins x frames
+    */
+    static MatrixXd make_spectrogram(const VectorXd& signal, qint32 window_size = 0, qint32 hop_size = 0);
+
+    //=========================================================================================================
+    /**
+    * Calculates the spectrograms of several channels in parallel, see make_spectrogram.
+    *
+    * @param[in] signals        input-signals to calculate the spectrograms of, one channel per column
+    * @param[in] window_size    size of the window which is used, default_window_size if 0
+    * @param[in] hop_size       number of samples between two neighbouring frames, default_hop_size if 0
+    *
+    * @return spectrogram-matrices, one per channel
+    */
+    static QList<MatrixXd> make_spectrograms(const MatrixXd& signals, qint32 window_size = 0, qint32 hop_size = 0);
+
+    //=========================================================================================================
+    /**
+    * Returns the window size which make_spectrogram uses by default: a quarter of the signal length, at most
+    * 256 samples, so that the frames stay short for long signals.
+    *
+    * @param[in] sample_count   length of the signal
+    *
+    * @return the window size
+    */
+    static qint32 default_window_size(qint32 sample_count);
+
+    //=========================================================================================================
+    /**
+    * Returns the hop size which make_spectrogram uses by default: a quarter of the window size, the gaussian
+    * overlaps well enough between neighbouring frames.
+    *
+    * @param[in] window_size    size of the window
     *
-    * @return spectrogram-matrix (tf-representation of the input signal)
+    * @return the hop size
     */
-    static MatrixXd make_spectrogram(VectorXd signal, qint32 window_size);
+    static qint32 default_hop_size(qint32 window_size);
 
 private:
 
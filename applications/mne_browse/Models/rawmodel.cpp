@@ -970,9 +970,9 @@ void RawModel::updateProjections()
 //                matSparseProj.setFromTriplets(tripletList.begin(), tripletList.end());
 
             //set projection matrix for upcoming read raw segement calls
-            m_pfiffIO->m_qlistRaw[0]->proj = matProj;
+            m_pfiffIO->m_qlistRaw[0]->setProj(matProj);
         } else {
-            m_pfiffIO->m_qlistRaw[0]->proj.resize(0,0);
+            m_pfiffIO->m_qlistRaw[0]->setProj(MatrixXd());
         }
 
         if(m_iCurAbsScrollPos == 0)
@@ -1006,7 +1006,7 @@ void RawModel::updateCompensator(int to)
         this->m_pFiffInfo->set_current_comp(to);
 
         //set compensator for upcoming read raw segement calls
-        m_pfiffIO->m_qlistRaw[0]->comp = newComp;
+        m_pfiffIO->m_qlistRaw[0]->setComp(newComp);
 
         if(m_iCurAbsScrollPos == 0)
             resetPosition(m_iCurAbsScrollPos + firstSample());
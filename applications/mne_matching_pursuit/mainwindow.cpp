@@ -3290,21 +3290,24 @@ void MainWindow::on_actionTFplot_triggered()
             }
         }
         */
-        tf_sum = Spectrogram::make_spectrogram(_signal_matrix.col(0), 0);
+        // default window and hop, the plots label the time axis with the hop size
+        qint32 window_size = Spectrogram::default_window_size(_signal_matrix.rows());
+        qint32 hop_size = Spectrogram::default_hop_size(window_size);
+        tf_sum = Spectrogram::make_spectrogram(_signal_matrix.col(0), window_size, hop_size);
 
-        TFplot *tfplot = new TFplot(tf_sum, _sample_rate, 0, 600, Jet);
+        TFplot *tfplot = new TFplot(tf_sum, _sample_rate, 0, 600, Jet, hop_size);
         ui->tabWidget->addTab(tfplot, "TF-Overview 0-500Hz");
         ui->tabWidget->setCurrentIndex(1);
         tfplot->resize(ui->tabWidget->size());
 
-        TFplot *tfplot2 = new TFplot(tf_sum, _sample_rate, 0, 100, Jet);
+        TFplot *tfplot2 = new TFplot(tf_sum, _sample_rate, 0, 100, Jet, hop_size);
         ui->tabWidget->addTab(tfplot2, "TF-Overview 0-100Hz");
 
         ui->tabWidget->setCurrentIndex(2);
         tfplot2->resize(ui->tabWidget->size());
 
 
-        TFplot *tfplot3 = new TFplot(tf_sum, _sample_rate, 301, 480, Jet);
+        TFplot *tfplot3 = new TFplot(tf_sum, _sample_rate, 301, 480, Jet, hop_size);
         ui->tabWidget->addTab(tfplot3, "TF-Overview 300-480Hz");
 
         ui->tabWidget->setCurrentIndex(3);
@@ -44,12 +44,30 @@
 #include "mne_rt_server.h"
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// MNE INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_constants.h>
+#include <fiff/fiff_stream.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // STL INCLUDES
 //=============================================================================================================
 
 #include <stdlib.h>
+#include <cstring>
 
 
 //*************************************************************************************************************
@@ -173,6 +191,57 @@ void FiffStreamServer::comStopAll(Command p_command)
 }
 
 
+//*************************************************************************************************************
+
+void FiffStreamServer::comLag(Command p_command)
+{
+    QString t_sOutput("");
+    t_sOutput.append("\tID\tAlias\tQueued\tBytes\tDropped\tLag [ms]\tQueue\r\n");
+    QMap<qint32, FiffStreamThread*>::iterator i;
+    for (i = this->m_qClientList.begin(); i != this->m_qClientList.end(); ++i)
+    {
+        qint32 t_iNumQueued;
+        qint64 t_iNumBytes, t_iNumDropped, t_iLagMs;
+        i.value()->getQueueStatus(t_iNumQueued, t_iNumBytes, t_iNumDropped, t_iLagMs);
+
+        QString str = QString("\t%1\t%2\t%3\t%4\t%5\t%6\t%7\r\n").arg(i.key()).arg(i.value()->getAlias())
+                .arg(t_iNumQueued).arg(t_iNumBytes).arg(t_iNumDropped).arg(t_iLagMs).arg(i.value()->getQueuePolicy());
+        t_sOutput.append(str);
+    }
+    t_sOutput.append("\n");
+    qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["lag"].reply(t_sOutput);
+
+    Q_UNUSED(p_command);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamServer::comQueue(Command p_command)
+{
+    qint32 t_id = -1;
+    QString t_sOutput("");
+    QString t_sAlias(p_command["id"].toString());
+    t_sOutput.append(parseToId(t_sAlias,t_id));
+
+    if(t_id != -1)
+    {
+        qint32 t_iSize = p_command["size"].toInt();
+        QString t_sPolicy = p_command["policy"].toString();
+
+        FiffStreamThread::QueuePolicy t_ePolicy = FiffStreamThread::DropOldest;
+        if(t_sPolicy.compare("disconnect",Qt::CaseInsensitive) == 0)
+            t_ePolicy = FiffStreamThread::DisconnectClient;
+
+        m_qClientList[t_id]->setQueuePolicy(t_iSize, t_ePolicy);
+
+        QString str = QString("\tFiffStreamClient (ID: %1) queue set to %2\r\n\n").arg(t_id).arg(m_qClientList[t_id]->getQueuePolicy());
+        t_sOutput.append(str);
+    }
+    qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["queue"].reply(t_sOutput);
+}
+
+
 //*************************************************************************************************************
 
 void FiffStreamServer::connectCommands()
@@ -185,6 +254,8 @@ void FiffStreamServer::connectCommands()
     QObject::connect(&t_pMNERTServer->getCommandManager()["start"], &Command::executed, this, &FiffStreamServer::comStart);
     QObject::connect(&t_pMNERTServer->getCommandManager()["stop"], &Command::executed, this, &FiffStreamServer::comStop);
     QObject::connect(&t_pMNERTServer->getCommandManager()["stop-all"], &Command::executed, this, &FiffStreamServer::comStopAll);
+    QObject::connect(&t_pMNERTServer->getCommandManager()["lag"], &Command::executed, this, &FiffStreamServer::comLag);
+    QObject::connect(&t_pMNERTServer->getCommandManager()["queue"], &Command::executed, this, &FiffStreamServer::comQueue);
 
 //    t_pMNERTServer->getCommandManager().connectSlot(QString("clist"), this, &FiffStreamServer::comClist);
 //    t_pMNERTServer->getCommandManager().connectSlot(QString("measinfo"), this, &FiffStreamServer::comMeasinfo);
@@ -373,10 +444,127 @@ void FiffStreamServer::forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo)
 
 
 //*************************************************************************************************************
-//ToDo increase preformance --> try inline
+
 void FiffStreamServer::forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
 {
-    emit remitRawBuffer(m_pMatRawData);
+    //
+    // Encode once per requested data format, the implicitly shared blocks are handed to all clients
+    //
+    QByteArray t_qRawBlocks[FIFFV_MNE_RT_DATA_FORMAT_INT24 + 1];
+
+    QMap<qint32, FiffStreamThread*>::iterator i;
+    for (i = this->m_qClientList.begin(); i != this->m_qClientList.end(); ++i)
+    {
+        if(!i.value()->isSendingRawBuffer())
+            continue;
+
+        qint32 t_iDataFormat = i.value()->getDataFormat();
+        if(t_qRawBlocks[t_iDataFormat].isEmpty())
+            t_qRawBlocks[t_iDataFormat] = encodeRawBuffer(*m_pMatRawData, t_iDataFormat);
+
+        i.value()->enqueueRawBuffer(t_qRawBlocks[t_iDataFormat]);
+    }
+}
+
+
+//*************************************************************************************************************
+
+QByteArray FiffStreamServer::encodeRawBuffer(const Eigen::MatrixXf& p_matRawData, qint32 p_iDataFormat)
+{
+    QByteArray t_qBlock;
+
+    if(p_iDataFormat == FIFFV_MNE_RT_DATA_FORMAT_FIFF)
+    {
+        FiffStream t_FiffStreamOut(&t_qBlock, QIODevice::WriteOnly);
+        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER,p_matRawData.data(),p_matRawData.rows()*p_matRawData.cols());
+        return t_qBlock;
+    }
+
+    const qint32 t_iNChan = p_matRawData.rows();
+    const qint32 t_iNSamp = p_matRawData.cols();
+    const qint32 t_iNEl = t_iNChan*t_iNSamp;
+
+    qint32 t_iBytesPerSample = 4;
+    qint32 t_iMaxInt = 0;
+    if(p_iDataFormat == FIFFV_MNE_RT_DATA_FORMAT_INT16)
+    {
+        t_iBytesPerSample = 2;
+        t_iMaxInt = 32767;
+    }
+    else if(p_iDataFormat == FIFFV_MNE_RT_DATA_FORMAT_INT24)
+    {
+        t_iBytesPerSample = 3;
+        t_iMaxInt = 8388607;
+    }
+
+    qint32 t_iDataSize = 3*4 + (t_iMaxInt > 0 ? t_iNChan*4 : 0) + t_iNEl*t_iBytesPerSample;
+
+    //
+    // The tag header stays big endian like all other tags on this port
+    //
+    t_qBlock.resize(16 + t_iDataSize);
+    uchar* t_pOut = reinterpret_cast<uchar*>(t_qBlock.data());
+
+    qToBigEndian<qint32>(FIFF_MNE_RT_DATA_BUFFER, t_pOut);
+    qToBigEndian<qint32>(FIFFT_VOID, t_pOut + 4);
+    qToBigEndian<qint32>(t_iDataSize, t_pOut + 8);
+    qToBigEndian<qint32>(FIFFV_NEXT_SEQ, t_pOut + 12);
+    t_pOut += 16;
+
+    qToLittleEndian<qint32>(p_iDataFormat, t_pOut);
+    qToLittleEndian<qint32>(t_iNChan, t_pOut + 4);
+    qToLittleEndian<qint32>(t_iNSamp, t_pOut + 8);
+    t_pOut += 12;
+
+    const float* t_pData = p_matRawData.data();
+
+    if(t_iMaxInt == 0)
+    {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        memcpy(t_pOut, t_pData, t_iNEl*sizeof(float));
+#else
+        for(qint32 i = 0; i < t_iNEl; ++i)
+        {
+            quint32 t_iBits;
+            memcpy(&t_iBits, t_pData + i, sizeof(float));
+            qToLittleEndian<quint32>(t_iBits, t_pOut + 4*i);
+        }
+#endif
+        return t_qBlock;
+    }
+
+    //
+    // Scale every channel such that its maximum in this block maps to the largest integer
+    //
+    Eigen::VectorXf t_vecScale = p_matRawData.cwiseAbs().rowwise().maxCoeff() / (float)t_iMaxInt;
+    Eigen::VectorXf t_vecInvScale(t_iNChan);
+    for(qint32 c = 0; c < t_iNChan; ++c)
+    {
+        if(t_vecScale[c] <= 0.0f)
+            t_vecScale[c] = 1.0f;
+        t_vecInvScale[c] = 1.0f / t_vecScale[c];
+
+        quint32 t_iBits;
+        memcpy(&t_iBits, t_vecScale.data() + c, sizeof(float));
+        qToLittleEndian<quint32>(t_iBits, t_pOut + 4*c);
+    }
+    t_pOut += 4*t_iNChan;
+
+    for(qint32 s = 0; s < t_iNSamp; ++s)
+    {
+        const float* t_pSample = t_pData + s*t_iNChan;
+        for(qint32 c = 0; c < t_iNChan; ++c)
+        {
+            qint32 t_iValue = qBound(-t_iMaxInt, qRound(t_pSample[c]*t_vecInvScale[c]), t_iMaxInt);
+            t_pOut[0] = (uchar)(t_iValue & 0xFF);
+            t_pOut[1] = (uchar)((t_iValue >> 8) & 0xFF);
+            if(t_iBytesPerSample == 3)
+                t_pOut[2] = (uchar)((t_iValue >> 16) & 0xFF);
+            t_pOut += t_iBytesPerSample;
+        }
+    }
+
+    return t_qBlock;
 }
 
 
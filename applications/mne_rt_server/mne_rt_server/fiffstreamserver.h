@@ -123,8 +123,27 @@ public:
 
 //public slots: --> in Qt 5 not anymore declared as slot
     void forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo);
+
+    //=========================================================================================================
+    /**
+    * Encodes the raw buffer once per data format requested by the clients and queues the shared encoded
+    * block to every client which accepts raw buffers.
+    *
+    * @param[in] m_pMatRawData  The raw buffer (nchan x nsamp).
+    */
     void forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
 
+    //=========================================================================================================
+    /**
+    * Encodes a raw buffer as a FIFF_DATA_BUFFER tag or as a packed FIFF_MNE_RT_DATA_BUFFER tag.
+    *
+    * @param[in] p_matRawData   The raw buffer (nchan x nsamp).
+    * @param[in] p_iDataFormat  The data format, FIFFV_MNE_RT_DATA_FORMAT_*.
+    *
+    * @return the encoded tag including its header
+    */
+    static QByteArray encodeRawBuffer(const Eigen::MatrixXf& p_matRawData, qint32 p_iDataFormat);
+
 signals:
     void requestMeasInfo(qint32 ID);
 
@@ -132,7 +151,6 @@ signals:
     void stopMeasFiffStreamClient(qint32 ID);
 
     void remitMeasInfo(qint32 ID, const FIFFLIB::FiffInfo& p_fiffInfo);
-    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf>);
 
     void closeFiffStreamServer();
 
@@ -181,6 +199,22 @@ private:
     */
     void comStopAll(Command p_command);
 
+    //=========================================================================================================
+    /**
+    * Lists the raw buffer queue state, i.e. the lag, of all fiff data clients
+    *
+    * @param[in] p_command  The lag command.
+    */
+    void comLag(Command p_command);
+
+    //=========================================================================================================
+    /**
+    * Sets the raw buffer queue size and the policy applied to a full queue of a client
+    *
+    * @param[in] p_command  The queue command.
+    */
+    void comQueue(Command p_command);
+
     QByteArray parseToId(QString& p_sRawId, qint32& p_iParsedId);
 
     QMap<qint32, FiffStreamThread*> m_qClientList;
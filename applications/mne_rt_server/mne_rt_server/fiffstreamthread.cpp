@@ -60,6 +60,7 @@
 //=============================================================================================================
 
 #include <QtNetwork>
+#include <QDateTime>
 
 
 //*************************************************************************************************************
@@ -82,7 +83,14 @@ FiffStreamThread::FiffStreamThread(qint32 id, int socketDescriptor, QObject *par
 , m_iDataClientId(id)
 , m_sDataClientAlias(QString(""))
 , m_iSocketDescriptor(socketDescriptor)
+, m_iSendOffset(0)
+, m_iQueuedBytes(0)
+, m_iQueuedRawBuffers(0)
+, m_iMaxQueueSize(64)
+, m_eQueuePolicy(DropOldest)
+, m_iNumDroppedBuffers(0)
 , m_bIsSendingRawBuffer(false)
+, m_iDataFormat(FIFFV_MNE_RT_DATA_FORMAT_FIFF)
 , m_bIsRunning(false)
 {
 }
@@ -110,12 +118,12 @@ void FiffStreamThread::startMeas(qint32 ID)
     {
         qDebug() << "Activate raw buffer sending.";
 
-        m_qMutex.lock();
         // ToDo send start meas
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_qBlock;
+        FiffStream t_FiffStreamOut(&t_qBlock, QIODevice::WriteOnly);
         t_FiffStreamOut.start_block(FIFFB_RAW_DATA);
+        enqueueControlBlock(t_qBlock);
         m_bIsSendingRawBuffer = true;
-        m_qMutex.unlock();
     }
 }
 
@@ -129,11 +137,11 @@ void FiffStreamThread::stopMeas(qint32 ID)
     {
         qDebug() << "stop raw buffer sending.";
 
-        m_qMutex.lock();
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
-        t_FiffStreamOut.end_block(FIFFB_RAW_DATA);
         m_bIsSendingRawBuffer = false;
-        m_qMutex.unlock();
+        QByteArray t_qBlock;
+        FiffStream t_FiffStreamOut(&t_qBlock, QIODevice::WriteOnly);
+        t_FiffStreamOut.end_block(FIFFB_RAW_DATA);
+        enqueueControlBlock(t_qBlock);
     }
 }
 
@@ -164,6 +172,29 @@ void FiffStreamThread::parseCommand(FiffTag::SPtr p_pTag)
             printf("FiffStreamClient (ID %d): send client ID %d\r\n\n", m_iDataClientId, m_iDataClientId);
             writeClientId();
         }
+        else if(t_iCmd == MNE_RT_SET_DATA_FORMAT)
+        {
+            //
+            // Select data format, unsupported formats fall back to FIFF tags
+            //
+            qint32 t_iFormat = QString(p_pTag->mid(4, p_pTag->size()-4)).toInt();
+
+            m_qMutex.lock();
+            switch(t_iFormat)
+            {
+                case FIFFV_MNE_RT_DATA_FORMAT_FLOAT32:
+                case FIFFV_MNE_RT_DATA_FORMAT_INT16:
+                case FIFFV_MNE_RT_DATA_FORMAT_INT24:
+                    m_iDataFormat = t_iFormat;
+                    break;
+                default:
+                    m_iDataFormat = FIFFV_MNE_RT_DATA_FORMAT_FIFF;
+            }
+            m_qMutex.unlock();
+            writeDataFormat();
+
+            printf("FiffStreamClient (ID %d): data format = %d\r\n\n", m_iDataClientId, m_iDataFormat);
+        }
         else
         {
             printf("FiffStreamClient (ID %d): unknown command\r\n\n", m_iDataClientId);
@@ -178,24 +209,115 @@ void FiffStreamThread::parseCommand(FiffTag::SPtr p_pTag)
 
 //*************************************************************************************************************
 
-void FiffStreamThread::sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
+qint32 FiffStreamThread::getDataFormat()
+{
+    QMutexLocker t_locker(&m_qMutex);
+    return m_iDataFormat;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStreamThread::enqueueRawBuffer(const QByteArray& p_qRawBlock)
 {
-    if(m_bIsSendingRawBuffer)
+    if(!isSendingRawBuffer())
+        return false;
+
+    QMutexLocker t_locker(&m_qMutex);
+
+    if(m_iQueuedRawBuffers >= m_iMaxQueueSize)
     {
-//        qDebug() << "Send RawBuffer to client";
+        if(m_eQueuePolicy == DisconnectClient)
+        {
+            printf("FiffStreamClient (ID %d): %d raw buffers queued, disconnect slow client\r\n\n", m_iDataClientId, m_iQueuedRawBuffers);
+            m_bIsRunning = false;
+            return false;
+        }
 
-        m_qMutex.lock();
+        //
+        // Drop the oldest raw buffer which is not in flight, the head may be partially written
+        //
+        bool t_bDropped = false;
+        for(qint32 i = 1; i < m_qSendQueue.size(); ++i)
+        {
+            if(m_qSendQueue[i].bIsRawBuffer)
+            {
+                m_iQueuedBytes -= m_qSendQueue[i].qBlock.size();
+                m_qSendQueue.removeAt(i);
+                --m_iQueuedRawBuffers;
+                t_bDropped = true;
+                break;
+            }
+        }
+        ++m_iNumDroppedBuffers;
+        if(!t_bDropped)
+            return false;
+    }
 
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
-        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER,m_pMatRawData->data(),m_pMatRawData->rows()*m_pMatRawData->cols());
+    SendBlock t_block;
+    t_block.qBlock = p_qRawBlock;
+    t_block.bIsRawBuffer = true;
+    t_block.iQueuedAt = QDateTime::currentMSecsSinceEpoch();
+    m_qSendQueue.enqueue(t_block);
+    m_iQueuedBytes += p_qRawBlock.size();
+    ++m_iQueuedRawBuffers;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamThread::enqueueControlBlock(const QByteArray& p_qBlock)
+{
+    SendBlock t_block;
+    t_block.qBlock = p_qBlock;
+    t_block.bIsRawBuffer = false;
+    t_block.iQueuedAt = QDateTime::currentMSecsSinceEpoch();
+
+    QMutexLocker t_locker(&m_qMutex);
+    m_qSendQueue.enqueue(t_block);
+    m_iQueuedBytes += p_qBlock.size();
+}
 
-        m_qMutex.unlock();
 
+//*************************************************************************************************************
+
+void FiffStreamThread::setQueuePolicy(qint32 p_iMaxQueueSize, QueuePolicy p_ePolicy)
+{
+    QMutexLocker t_locker(&m_qMutex);
+    m_iMaxQueueSize = qMax(2, p_iMaxQueueSize);
+    m_eQueuePolicy = p_ePolicy;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamThread::getQueueStatus(qint32& p_iNumQueued, qint64& p_iNumBytes, qint64& p_iNumDropped, qint64& p_iLagMs)
+{
+    QMutexLocker t_locker(&m_qMutex);
+    p_iNumQueued = m_iQueuedRawBuffers;
+    p_iNumBytes = m_iQueuedBytes - m_iSendOffset;
+    p_iNumDropped = m_iNumDroppedBuffers;
+    p_iLagMs = 0;
+
+    for(qint32 i = 0; i < m_qSendQueue.size(); ++i)
+    {
+        if(m_qSendQueue[i].bIsRawBuffer)
+        {
+            p_iLagMs = QDateTime::currentMSecsSinceEpoch() - m_qSendQueue[i].iQueuedAt;
+            break;
+        }
     }
-//    else
-//    {
-//        qDebug() << "Send RawBuffer is not activated";
-//    }
+}
+
+
+//*************************************************************************************************************
+
+QString FiffStreamThread::getQueuePolicy()
+{
+    QMutexLocker t_locker(&m_qMutex);
+    return QString("%1 %2").arg(m_iMaxQueueSize).arg(m_eQueuePolicy == DropOldest ? "drop" : "disconnect");
 }
 
 
@@ -225,9 +347,8 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 {
     if(ID == m_iDataClientId)
     {
-        m_qMutex.lock();
-
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_qBlock;
+        FiffStream t_FiffStreamOut(&t_qBlock, QIODevice::WriteOnly);
 
 //        qint32 init_info[2];
 //        init_info[0] = FIFF_MNE_RT_CLIENT_ID;
@@ -238,9 +359,9 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 //FiffStream::start_writing_raw
 
         p_fiffInfo.writeToStream(&t_FiffStreamOut);
-        m_qMutex.unlock();
+        enqueueControlBlock(t_qBlock);
 
-//        qDebug() << "MeasInfo Blocksize: " << m_qSendBlock.size();
+//        qDebug() << "MeasInfo Blocksize: " << t_qBlock.size();
     }
 }
 
@@ -249,9 +370,26 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 
 void FiffStreamThread::writeClientId()
 {
-    FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+    QByteArray t_qBlock;
+    FiffStream t_FiffStreamOut(&t_qBlock, QIODevice::WriteOnly);
 
     t_FiffStreamOut.write_int(FIFF_MNE_RT_CLIENT_ID, &m_iDataClientId);
+
+    enqueueControlBlock(t_qBlock);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamThread::writeDataFormat()
+{
+    QByteArray t_qBlock;
+    FiffStream t_FiffStreamOut(&t_qBlock, QIODevice::WriteOnly);
+
+    qint32 t_iDataFormat = getDataFormat();
+    t_FiffStreamOut.write_int(FIFF_MNE_RT_DATA_FORMAT, &t_iDataFormat);
+
+    enqueueControlBlock(t_qBlock);
 }
 
 
@@ -302,8 +440,6 @@ void FiffStreamThread::run()
 
     connect(t_pParentServer, &FiffStreamServer::remitMeasInfo,
             this, &FiffStreamThread::sendMeasurementInfo);
-    connect(t_pParentServer, &FiffStreamServer::remitRawBuffer,
-            this, &FiffStreamThread::sendRawBuffer);
     connect(t_pParentServer, &FiffStreamServer::startMeasFiffStreamClient,
             this, &FiffStreamThread::startMeas);
     connect(t_pParentServer, &FiffStreamServer::stopMeasFiffStreamClient,
@@ -328,28 +464,40 @@ void FiffStreamThread::run()
     while(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState && m_bIsRunning)
     {
         //
-        // Write available data
+        // Write the blocks queued so far, the shared raw buffers are only referenced, never copied
         //
         m_qMutex.lock();
-        qint32 t_iBlockSize = m_qSendBlock.size();
-//        qDebug() << "data available" << t_iBlockSize;
-        if(t_iBlockSize > 0)
+        qint32 t_iNumBlocks = m_qSendQueue.size();
+        m_qMutex.unlock();
+
+        for(qint32 i = 0; i < t_iNumBlocks && m_bIsRunning; ++i)
         {
-            qint32 t_iBytesWritten = t_qTcpSocket.write(m_qSendBlock);
-//            qDebug() << ++i<< "[wrote bytes] " << t_iBytesWritten;
+            m_qMutex.lock();
+            QByteArray t_qBlock = m_qSendQueue.head().qBlock;
+            qint32 t_iOffset = m_iSendOffset;
+            m_qMutex.unlock();
+
+            qint64 t_iBytesWritten = t_qTcpSocket.write(t_qBlock.constData() + t_iOffset, t_qBlock.size() - t_iOffset);
             t_qTcpSocket.waitForBytesWritten();
-            if(t_iBytesWritten == t_iBlockSize)
-            {
-                m_qSendBlock.clear();
-            }
-            else
+
+            m_qMutex.lock();
+            if(t_iBytesWritten > 0)
+                m_iSendOffset += t_iBytesWritten;
+            bool t_bCompleted = m_iSendOffset >= t_qBlock.size();
+            if(t_bCompleted)
             {
-                //we have to store bytes which were not written to the socket, due to writing limit
-                //m_qSendBlock = m_qSendBlock.mid(t_iBytesWritten, t_iBlockSize-t_iBytesWritten);
-                m_qSendBlock.remove(0,t_iBytesWritten); //higher performance then mid
+                SendBlock t_block = m_qSendQueue.dequeue();
+                m_iQueuedBytes -= t_block.qBlock.size();
+                if(t_block.bIsRawBuffer)
+                    --m_iQueuedRawBuffers;
+                m_iSendOffset = 0;
             }
+            m_qMutex.unlock();
+
+            //we have to keep the bytes which were not written to the socket, due to writing limit
+            if(!t_bCompleted)
+                break;
         }
-        m_qMutex.unlock();
 
         //
         // Read: Wait 10ms for incomming tag header, read and continue
@@ -54,6 +54,7 @@
 #include <QTcpSocket>
 #include <QMutex>
 #include <QSharedPointer>
+#include <QQueue>
 
 
 //*************************************************************************************************************
@@ -81,6 +82,16 @@ class FiffStreamThread : public QThread
 {
     Q_OBJECT
 public:
+    //=========================================================================================================
+    /**
+    * What happens when the raw buffer queue of a client is full.
+    */
+    enum QueuePolicy
+    {
+        DropOldest,         /**< Discard the oldest queued raw buffer. */
+        DisconnectClient    /**< Disconnect the client, it is too slow to keep up. */
+    };
+
     FiffStreamThread(qint32 id, int socketDescriptor, QObject *parent);
 
     ~FiffStreamThread();
@@ -98,22 +109,98 @@ public:
 
     void writeClientId();
 
+    void writeDataFormat();
+
+    //=========================================================================================================
+    /**
+    * Returns the negotiated raw buffer format of this client.
+    *
+    * @return the data format, FIFFV_MNE_RT_DATA_FORMAT_*
+    */
+    qint32 getDataFormat();
+
+    //=========================================================================================================
+    /**
+    * Returns whether this client currently accepts raw buffers.
+    *
+    * @return true when the measurement was started for this client
+    */
+    inline bool isSendingRawBuffer();
+
+    //=========================================================================================================
+    /**
+    * Queues an already encoded raw buffer. The block is shared with all other clients using the same data
+    * format and is never modified. When the queue is full the queue policy is applied.
+    *
+    * @param[in] p_qRawBlock    The encoded raw buffer tag.
+    *
+    * @return false if the block was dropped or the client got disconnected
+    */
+    bool enqueueRawBuffer(const QByteArray& p_qRawBlock);
+
+    //=========================================================================================================
+    /**
+    * Sets the maximal number of queued raw buffers and what to do when the queue is full.
+    *
+    * @param[in] p_iMaxQueueSize    Maximal number of queued raw buffers, at least 2.
+    * @param[in] p_ePolicy          The queue policy.
+    */
+    void setQueuePolicy(qint32 p_iMaxQueueSize, QueuePolicy p_ePolicy);
+
+    //=========================================================================================================
+    /**
+    * Returns the state of the raw buffer queue.
+    *
+    * @param[out] p_iNumQueued      Number of queued raw buffers.
+    * @param[out] p_iNumBytes       Number of queued bytes, including control tags.
+    * @param[out] p_iNumDropped     Number of raw buffers dropped since the client connected.
+    * @param[out] p_iLagMs          Age of the oldest queued raw buffer in ms.
+    */
+    void getQueueStatus(qint32& p_iNumQueued, qint64& p_iNumBytes, qint64& p_iNumDropped, qint64& p_iLagMs);
+
+    //=========================================================================================================
+    /**
+    * Returns the queue policy description, i.e. size and policy.
+    *
+    * @return the queue policy description
+    */
+    QString getQueuePolicy();
+
 //    void sendData(QTcpSocket& p_qTcpSocket);
 
 signals:
     void error(QTcpSocket::SocketError socketError);
 
 private:
+    //=========================================================================================================
+    /**
+    * A queued block, either a shared raw buffer or a client specific control tag.
+    */
+    struct SendBlock
+    {
+        QByteArray  qBlock;         /**< The encoded tags. */
+        bool        bIsRawBuffer;   /**< Whether the block may be dropped. */
+        qint64      iQueuedAt;      /**< Time the block was queued, ms since epoch. */
+    };
+
     qint32 m_iDataClientId;
     QString m_sDataClientAlias;
 
     int m_iSocketDescriptor;
 
     QMutex m_qMutex;
-    QByteArray m_qSendBlock;
+    QQueue<SendBlock> m_qSendQueue;     /**< Blocks waiting to be written to the socket, the head is in flight. */
+    qint32 m_iSendOffset;               /**< Bytes of the queue head already written. */
+    qint64 m_iQueuedBytes;              /**< Bytes in the send queue. */
+    qint32 m_iQueuedRawBuffers;         /**< Raw buffers in the send queue. */
+    qint32 m_iMaxQueueSize;             /**< Maximal number of queued raw buffers. */
+    QueuePolicy m_eQueuePolicy;         /**< What happens when the queue is full. */
+    qint64 m_iNumDroppedBuffers;        /**< Raw buffers dropped since the client connected. */
 
     bool m_bIsSendingRawBuffer;
 
+    qint32 m_iDataFormat;   /**< Negotiated transport format of the raw buffers, FIFFV_MNE_RT_DATA_FORMAT_* */
+
     bool m_bIsRunning;
 
     void startMeas(qint32 ID);
@@ -122,7 +209,7 @@ private:
 
     void sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo);
 
-    void sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
+    void enqueueControlBlock(const QByteArray& p_qBlock);
     //void readToBuffer1();
 //    void readProc(QTcpSocket& p_qTcpSocket);
 };
@@ -140,6 +227,12 @@ inline QString FiffStreamThread::getAlias()
 }
 
 
+inline bool FiffStreamThread::isSendingRawBuffer()
+{
+    return m_bIsSendingRawBuffer && m_bIsRunning;
+}
+
+
 } // NAMESPACE
 
 #endif //FIFFSTREAMTHREAD_H
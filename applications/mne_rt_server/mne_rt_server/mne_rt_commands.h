@@ -51,6 +51,7 @@ namespace RTSERVER
 
 #define MNE_RT_GET_CLIENT_ID        1       /**< Request client id at mne_rt_server */
 #define MNE_RT_SET_CLIENT_ALIAS     2       /**< Set client alias at mne_rt_server */
+#define MNE_RT_SET_DATA_FORMAT      3       /**< Select the transport format of the data port, answered with FIFF_MNE_RT_DATA_FORMAT */
 
 } // NAMESPACE
 
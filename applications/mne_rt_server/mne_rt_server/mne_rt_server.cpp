@@ -332,6 +332,10 @@ void MNERTServer::init()
             "           \"description\": \"Prints and sends this list.\","
             "           \"parameters\": {}"
             "        },"
+            "       \"lag\": {"
+            "           \"description\": \"Prints and sends the raw buffer queue state and lag of all FiffStreamClients.\","
+            "           \"parameters\": {}"
+            "        },"
             "       \"measinfo\": {"
             "           \"description\": \"Sends the measurement info to the specified FiffStreamClient.\","
             "           \"parameters\": {"
@@ -341,6 +345,23 @@ void MNERTServer::init()
             "               }"
             "           }"
             "       },"
+            "       \"queue\": {"
+            "           \"description\": \"Sets the raw buffer queue size of the specified FiffStreamClient and whether a full queue drops the oldest buffer or disconnects the client.\","
+            "           \"parameters\": {"
+            "               \"id\": {"
+            "                   \"description\": \"ID/Alias\","
+            "                   \"type\": \"QString\" "
+            "               },"
+            "               \"size\": {"
+            "                   \"description\": \"Maximal number of queued raw buffers\","
+            "                   \"type\": \"int\" "
+            "               },"
+            "               \"policy\": {"
+            "                   \"description\": \"drop or disconnect\","
+            "                   \"type\": \"QString\" "
+            "               }"
+            "           }"
+            "        },"
             "       \"selcon\": {"
             "           \"description\": \"Selects a new connector, if a measurement is running it will be stopped.\","
             "           \"parameters\": {"
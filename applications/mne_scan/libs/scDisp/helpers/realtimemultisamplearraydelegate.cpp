@@ -551,6 +551,51 @@ void RealTimeMultiSampleArrayDelegate::createPlotPath(const QModelIndex &index,
         path.moveTo(qSamplePosition);
     }
 
+    //Several samples per pixel column: draw the min/max envelope of each column instead of every sample
+    qint32 iWidth = option.rect.width();
+    if(t_pModel->updateEnvelopes(iWidth)) {
+        const float* pEnvelopeMin = t_pModel->getEnvelopeMin(index.row());
+        const float* pEnvelopeMax = t_pModel->getEnvelopeMax(index.row());
+        float x0 = path.currentPosition().x();
+        float firstValue = *(data.first);
+
+        for(qint32 c = 0; c < iWidth; ++c) {
+            qint32 iFrom = t_pModel->getEnvelopeColumnStart(c);
+            qint32 iTo = t_pModel->getEnvelopeColumnStart(c+1);
+            float minValue, maxValue;
+
+            if(iFrom < currentSampleIndex && iTo > currentSampleIndex) {
+                //This column holds new and old data which are plotted with different offsets
+                minValue = maxValue = *(data.first+iFrom) - firstValue;
+                for(qint32 j = iFrom+1; j < iTo; ++j) {
+                    float val = j<currentSampleIndex ? *(data.first+j) - firstValue : *(data.first+j) - lastFirstValue;
+                    minValue = qMin(minValue, val);
+                    maxValue = qMax(maxValue, val);
+                }
+            } else {
+                float offset = iFrom<currentSampleIndex ? firstValue : lastFirstValue;
+                minValue = pEnvelopeMin[c] - offset;
+                maxValue = pEnvelopeMax[c] - offset;
+            }
+
+            float x = x0 + iTo*fDx;
+            path.lineTo(x, y_base-minValue*fScaleY);
+            path.lineTo(x, y_base-maxValue*fScaleY);
+        }
+
+        //Create ellipse position
+        qint32 j = (qint32)(m_markerPosition.x()/fDx);
+        if(j >= 0 && j < data.second) {
+            float val = *(data.first+j) - (j<currentSampleIndex ? firstValue : lastFirstValue);
+            ellipsePos.setX(x0+(j+2)*fDx);
+            ellipsePos.setY(y_base-val*fScaleY);
+
+            amplitude = QString::number(*(data.first+j));
+        }
+
+        return;
+    }
+
     float val;
 
     for(qint32 j=0; j < data.second; ++j)
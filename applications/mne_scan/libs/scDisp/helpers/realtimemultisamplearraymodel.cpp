@@ -49,6 +49,7 @@
 
 using namespace SCDISPLIB;
 using namespace UTILSLIB;
+using namespace RTPROCESSINGLIB;
 
 
 //*************************************************************************************************************
@@ -78,6 +79,10 @@ RealTimeMultiSampleArrayModel::RealTimeMultiSampleArrayModel(QObject *parent)
 , m_iDetectedTriggers(0)
 , m_iCurrentSampleFreeze(0)
 , m_iCurrentTriggerChIndex(0)
+, m_bEnvelopeDirty(false)
+, m_iEnvelopeWidth(0)
+, m_iEnvelopeSamples(0)
+, m_pEnvelopeSource(0)
 {
     init();
 }
@@ -281,6 +286,12 @@ void RealTimeMultiSampleArrayModel::initSphara()
         }
     }
 
+    //Register the basis functions, the operators are built and cached on demand
+    m_pRtSpharaOperator->addBaseFunctions("VectorView", m_matSpharaVVGradLoaded, m_vecIndicesFirstVV, 1); //GRADIOMETERS
+    m_pRtSpharaOperator->addBaseFunctions("VectorView", m_matSpharaVVMagLoaded, m_vecIndicesSecondVV, 0); //Magnetometers
+    m_pRtSpharaOperator->addBaseFunctions("BabyMEG", m_matSpharaBabyMEGInnerLoaded, m_vecIndicesFirstBabyMEG, 0); //InnerLayer
+    m_pRtSpharaOperator->addBaseFunctions("EEG", m_matSpharaEEGLoaded, m_vecIndicesFirstEEG, 0);
+
     //Create Sphara operator for the first time
     updateSpharaOptions("BabyMEG", 270, 105);
 
@@ -333,14 +344,14 @@ void RealTimeMultiSampleArrayModel::setFiffInfo(FiffInfo::SPtr& p_pFiffInfo)
 
         m_matOverlap.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxFilterLength);
 
+        invalidateEnvelopes();
+
         m_matSparseProjMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
         m_matSparseCompMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
-        m_matSparseSpharaMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
         m_matSparseProjCompMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
 
         m_matSparseProjMult.setIdentity();
         m_matSparseCompMult.setIdentity();
-        m_matSparseSpharaMult.setIdentity();
         m_matSparseProjCompMult.setIdentity();
 
         //Create the initial Compensator projector
@@ -367,6 +378,7 @@ void RealTimeMultiSampleArrayModel::setFiffInfo(FiffInfo::SPtr& p_pFiffInfo)
 //        }
 
         //Init the sphara operators
+        m_pRtSpharaOperator = RtSpharaOperator::SPtr(new RtSpharaOperator(m_pFiffInfo->chs.size()));
         initSphara();
     }
     else {
@@ -396,13 +408,15 @@ void RealTimeMultiSampleArrayModel::setSamplingInfo(float sps, int T)
     if(m_iCurrentSample>m_iMaxSamples)
         m_iCurrentSample = 0;
 
+    invalidateEnvelopes();
+
     endResetModel();
 }
 
 
 //*************************************************************************************************************
 
-void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
+void RealTimeMultiSampleArrayModel::addData(const QList<MatrixBlock> &data)
 {
     //SSP
     bool doProj = m_bProjActivated && m_matDataRaw.cols() > 0 && m_matDataRaw.rows() == m_matProj.cols() ? true : false;
@@ -411,12 +425,16 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
     bool doComp = m_bCompActivated && m_matDataRaw.cols() > 0 && m_matDataRaw.rows() == m_matComp.cols() ? true : false;
 
     //SPHARA
-    bool doSphara = m_bSpharaActivated && m_matSparseSpharaMult.cols() > 0 && m_matDataRaw.rows() == m_matSparseSpharaMult.cols() ? true : false;
+    bool doSphara = m_bSpharaActivated && m_pRtSpharaOperator && m_matDataRaw.rows() == m_pRtSpharaOperator->getNumChannels() ? true : false;
+
+    //The overlap add of the filter also rewrites samples before and after the current block
+    qint32 iEnvelopeMargin = m_filterData.isEmpty() ? 0 : m_iMaxFilterLength;
 
     //Copy new data into the global data matrix
     for(qint32 b = 0; b < data.size(); ++b) {
-        int nCol = data.at(b).cols();
-        int nRow = data.at(b).rows();
+        const MatrixXd& matBlock = *data.at(b);
+        int nCol = matBlock.cols();
+        int nRow = matBlock.rows();
 
         if(nRow != m_matDataRaw.rows()) {
             std::cout<<"incoming data does not match internal data row size. Returning..."<<std::endl;
@@ -439,22 +457,24 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
             if(doComp) {
                 if(doProj) {
                     //Comp + Proj
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjCompMult * data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjCompMult * matBlock.block(0,0,nRow,m_iResidual);
                 } else {
                     //Comp
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseCompMult * data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseCompMult * matBlock.block(0,0,nRow,m_iResidual);
                 }
             } else {
                 if(doProj)
                 {
                     //Proj
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjMult * data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjMult * matBlock.block(0,0,nRow,m_iResidual);
                 } else {
                     //None - Raw
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = matBlock.block(0,0,nRow,m_iResidual);
                 }
             }
 
+            markEnvelopeDirty(m_iCurrentSample - iEnvelopeMargin, m_matDataRaw.cols());
+
             m_iCurrentSample = 0;
 
             if(!m_bIsFreezed) {
@@ -482,18 +502,18 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
         if(doComp) {
             if(doProj) {
                 //Comp + Proj
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjCompMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjCompMult * matBlock;
             } else {
                 //Comp
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseCompMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseCompMult * matBlock;
             }
         } else {
             if(doProj) {
                 //Proj
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjMult * matBlock;
             } else {
                 //None - Raw
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = matBlock;
             }
         }
 
@@ -504,13 +524,13 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
             //Perform SPHARA on filtered data after actual filtering - SPHARA should be applied on the best possible data
             if(doSphara) {
                 if(m_iCurrentSample-m_iMaxFilterLength/2 >= 0) {
-                    m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol);
+                    m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol) = m_pRtSpharaOperator->applySphara(m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol));
                 }
                 else {
                     if(m_iCurrentSample-m_iMaxFilterLength/2 < 0) {
-                        m_matDataFiltered.block(0, 0, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, 0, nRow, nCol);
+                        m_matDataFiltered.block(0, 0, nRow, nCol) = m_pRtSpharaOperator->applySphara(m_matDataFiltered.block(0, 0, nRow, nCol));
                         int iResidual = m_iResidual+m_iMaxFilterLength/2;
-                        m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual);
+                        m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual) = m_pRtSpharaOperator->applySphara(m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual));
                     }
                 }
             }
@@ -519,10 +539,12 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
 
             //Perform SPHARA on raw data data
             if(doSphara) {
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseSpharaMult * m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_pRtSpharaOperator->applySphara(m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol));
             }
         }
 
+        markEnvelopeDirty(m_iCurrentSample - iEnvelopeMargin, m_iCurrentSample + nCol + iEnvelopeMargin);
+
         m_iCurrentSample += nCol;
         m_iCurrentBlockSize = nCol;
 
@@ -530,8 +552,8 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
         if(m_bTriggerDetectionActive) {
             int iOldDetectedTriggers = m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].size();
 
-            QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksMax(data.at(b), m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, true);
-            //QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksGrad(data.at(b), m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, false, "Rising");
+            QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksMax(matBlock, m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, true);
+            //QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksGrad(matBlock, m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, false, "Rising");
 
             //Append results to already found triggers
             m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].append(qMapDetectedTrigger);
@@ -554,6 +576,18 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
 }
 
 
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
+{
+    QList<MatrixBlock> qListBlocks;
+    for(qint32 b = 0; b < data.size(); ++b)
+        qListBlocks.append(MatrixBlockPool::wrap(data.at(b)));
+
+    addData(qListBlocks);
+}
+
+
 //*************************************************************************************************************
 
 fiff_int_t RealTimeMultiSampleArrayModel::getKind(qint32 row) const
@@ -597,6 +631,54 @@ fiff_int_t RealTimeMultiSampleArrayModel::getCoil(qint32 row) const
 }
 
 
+//*************************************************************************************************************
+
+bool RealTimeMultiSampleArrayModel::updateEnvelopes(qint32 iWidth) const
+{
+    //Envelopes are computed from the same data data() hands out
+    const MatrixXdR* pData;
+    if(m_bIsFreezed)
+        pData = m_filterData.isEmpty() ? &m_matDataRawFreeze : &m_matDataFilteredFreeze;
+    else
+        pData = m_filterData.isEmpty() ? &m_matDataRaw : &m_matDataFiltered;
+
+    qint32 iSamples = pData->cols();
+
+    if(iWidth <= 0 || iSamples < 2*iWidth)
+        return false;
+
+    if(iWidth != m_iEnvelopeWidth || iSamples != m_iEnvelopeSamples || pData->data() != m_pEnvelopeSource || pData->rows() != m_matEnvelopeMin.rows()) {
+        m_iEnvelopeWidth = iWidth;
+        m_iEnvelopeSamples = iSamples;
+        m_pEnvelopeSource = pData->data();
+
+        m_matEnvelopeMin.resize(pData->rows(), iWidth);
+        m_matEnvelopeMax.resize(pData->rows(), iWidth);
+        m_qEnvelopeDirty.fill(true, iWidth);
+        m_bEnvelopeDirty = true;
+    }
+
+    if(!m_bEnvelopeDirty)
+        return true;
+
+    for(qint32 c = 0; c < iWidth; ++c) {
+        if(!m_qEnvelopeDirty.testBit(c))
+            continue;
+
+        qint32 iFrom = getEnvelopeColumnStart(c);
+        qint32 iCount = getEnvelopeColumnStart(c+1) - iFrom;
+
+        m_matEnvelopeMin.col(c) = pData->block(0, iFrom, pData->rows(), iCount).rowwise().minCoeff().cast<float>();
+        m_matEnvelopeMax.col(c) = pData->block(0, iFrom, pData->rows(), iCount).rowwise().maxCoeff().cast<float>();
+    }
+
+    m_qEnvelopeDirty.fill(false);
+    m_bEnvelopeDirty = false;
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 void RealTimeMultiSampleArrayModel::selectRows(const QList<qint32> &selection)
@@ -666,6 +748,8 @@ void RealTimeMultiSampleArrayModel::toggleFreeze(const QModelIndex &)
         m_iCurrentSampleFreeze = m_iCurrentSample;
     }
 
+    invalidateEnvelopes();
+
     //Update data content
     QModelIndex topLeft = this->index(0,1);
     QModelIndex bottomRight = this->index(m_qListChInfo.size()-1,1);
@@ -812,78 +896,11 @@ void RealTimeMultiSampleArrayModel::updateSpharaActivation(bool state)
 
 void RealTimeMultiSampleArrayModel::updateSpharaOptions(const QString& sSytemType, int nBaseFctsFirst, int nBaseFctsSecond)
 {
-    if(m_pFiffInfo) {
+    if(m_pFiffInfo && m_pRtSpharaOperator) {
         qDebug()<<"RealTimeMultiSampleArrayModel::updateSpharaOptions - Creating SPHARA operator for"<<sSytemType;
 
-        MatrixXd matSpharaMultFirst = MatrixXd::Identity(m_pFiffInfo->chs.size(), m_pFiffInfo->chs.size());
-        MatrixXd matSpharaMultSecond = MatrixXd::Identity(m_pFiffInfo->chs.size(), m_pFiffInfo->chs.size());
-
-        if(sSytemType == "VectorView") {
-            matSpharaMultFirst = Sphara::makeSpharaProjector(m_matSpharaVVGradLoaded, m_vecIndicesFirstVV, m_pFiffInfo->nchan, nBaseFctsFirst, 1); //GRADIOMETERS
-            matSpharaMultSecond = Sphara::makeSpharaProjector(m_matSpharaVVMagLoaded, m_vecIndicesSecondVV, m_pFiffInfo->nchan, nBaseFctsSecond, 0); //Magnetometers
-        }
-
-        if(sSytemType == "BabyMEG") {
-            matSpharaMultFirst = Sphara::makeSpharaProjector(m_matSpharaBabyMEGInnerLoaded, m_vecIndicesFirstBabyMEG, m_pFiffInfo->nchan, nBaseFctsFirst, 0); //InnerLayer
-        }
-
-        if(sSytemType == "EEG") {
-            matSpharaMultFirst = Sphara::makeSpharaProjector(m_matSpharaEEGLoaded, m_vecIndicesFirstEEG, m_pFiffInfo->nchan, nBaseFctsFirst, 0); //InnerLayer
-        }
-
-        //Write final operator matrices to file
-//        IOUtils::write_eigen_matrix(matSpharaMultFirst, QString(QCoreApplication::applicationDirPath() + "/mne_scan_plugins/resources/noisereduction/SPHARA/matSpharaMultFirst.txt"));
-//        IOUtils::write_eigen_matrix(matSpharaMultSecond, QString(QCoreApplication::applicationDirPath() + "/mne_scan_plugins/resources/noisereduction/SPHARA/matSpharaMultSecond.txt"));
-//        IOUtils::write_eigen_matrix(m_matSpharaEEGLoaded, QString(QCoreApplication::applicationDirPath() + "/mne_scan_plugins/resources/noisereduction/SPHARA/m_matSpharaEEGLoaded.txt"));
-
-        //
-        // Make operators sparse
-        //
-        qint32 nchan = this->m_pFiffInfo->nchan;
-        qint32 i, k;
-
-        typedef Eigen::Triplet<double> T;
-        std::vector<T> tripletList;
-        tripletList.reserve(nchan);
-
-        //First operator
-        tripletList.clear();
-        tripletList.reserve(matSpharaMultFirst.rows()*matSpharaMultFirst.cols());
-        for(i = 0; i < matSpharaMultFirst.rows(); ++i) {
-            for(k = 0; k < matSpharaMultFirst.cols(); ++k) {
-                if(matSpharaMultFirst(i,k) != 0) {
-                    tripletList.push_back(T(i, k, matSpharaMultFirst(i,k)));
-                }
-            }
-        }
-
-        Eigen::SparseMatrix<double> matSparseSpharaMultFirst = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
-
-        matSparseSpharaMultFirst = SparseMatrix<double>(matSpharaMultFirst.rows(),matSpharaMultFirst.cols());
-        if(tripletList.size() > 0) {
-            matSparseSpharaMultFirst.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-
-        //Second operator
-        tripletList.clear();
-        tripletList.reserve(matSpharaMultSecond.rows()*matSpharaMultSecond.cols());
-
-        for(i = 0; i < matSpharaMultSecond.rows(); ++i) {
-            for(k = 0; k < matSpharaMultSecond.cols(); ++k) {
-                if(matSpharaMultSecond(i,k) != 0) {
-                    tripletList.push_back(T(i, k, matSpharaMultSecond(i,k)));
-                }
-            }
-        }
-
-        Eigen::SparseMatrix<double>matSparseSpharaMultSecond = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
-
-        if(tripletList.size() > 0) {
-            matSparseSpharaMultSecond.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-
-        //Create full multiplication matrix
-        m_matSparseSpharaMult = matSparseSpharaMultFirst * matSparseSpharaMultSecond;
+        //The factors are cached per system and number of base functions, switching back to an earlier setting is free
+        m_pRtSpharaOperator->setSystem(sSytemType, nBaseFctsFirst, nBaseFctsSecond);
     }
 }
 
@@ -906,6 +923,8 @@ void RealTimeMultiSampleArrayModel::filterChanged(QList<FilterData> filterData)
 
     m_bDrawFilterFront = false;
 
+    invalidateEnvelopes();
+
     //Filter all visible data channels at once
     //filterChannelsConcurrently();
 }
@@ -1183,6 +1202,8 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently()
         m_vecLastBlockFirstValuesFiltered = m_matDataFiltered.col(0);
     }
 
+    invalidateEnvelopes();
+
     //std::cout<<"END RealTimeMultiSampleArrayModel::filterChannelsConcurrently"<<std::endl;
 }
 
@@ -1302,6 +1323,40 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently(const MatrixXd &d
 }
 
 
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayModel::markEnvelopeDirty(qint32 iFrom, qint32 iTo)
+{
+    if(m_iEnvelopeWidth <= 0 || m_iEnvelopeSamples <= 0)
+        return;
+
+    if(iFrom < 0) {
+        markEnvelopeDirty(m_iEnvelopeSamples + iFrom, m_iEnvelopeSamples);
+        iFrom = 0;
+    }
+
+    iTo = qMin(iTo, m_iEnvelopeSamples);
+
+    if(iFrom >= iTo)
+        return;
+
+    qint32 iFirstColumn = (qint32)((qint64)iFrom*m_iEnvelopeWidth / m_iEnvelopeSamples);
+    qint32 iLastColumn = (qint32)((qint64)(iTo-1)*m_iEnvelopeWidth / m_iEnvelopeSamples);
+
+    m_qEnvelopeDirty.fill(true, iFirstColumn, iLastColumn+1);
+    m_bEnvelopeDirty = true;
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayModel::invalidateEnvelopes()
+{
+    //Forces a rebuild of all columns with the next updateEnvelopes call
+    m_iEnvelopeWidth = 0;
+}
+
+
 //*************************************************************************************************************
 
 void RealTimeMultiSampleArrayModel::clearModel()
@@ -1316,6 +1371,8 @@ void RealTimeMultiSampleArrayModel::clearModel()
     m_vecLastBlockFirstValuesRaw.setZero();
     m_matOverlap.setZero();
 
+    invalidateEnvelopes();
+
     endResetModel();
 
     qDebug("RealTimeMultiSampleArrayModel cleared.");
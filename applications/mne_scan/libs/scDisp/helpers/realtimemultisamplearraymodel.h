@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include <scMeas/realtimesamplearraychinfo.h>
+#include <scMeas/matrixblockpool.h>
 #include <fiff/fiff_types.h>
 #include <fiff/fiff_info.h>
 
@@ -52,6 +53,8 @@
 #include <utils/ioutils.h>
 #include <utils/filterTools/sphara.h>
 
+#include <rtProcessing/rtspharaoperator.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -63,6 +66,7 @@
 #include <QtConcurrent/QtConcurrent>
 #include <QFuture>
 #include <QColor>
+#include <QBitArray>
 
 
 //*************************************************************************************************************
@@ -101,6 +105,7 @@ using namespace UTILSLIB;
 
 typedef QPair<const double*,qint32> RowVectorPair;
 typedef Matrix<double,Dynamic,Dynamic,RowMajor> MatrixXdR;
+typedef Matrix<float,Dynamic,Dynamic,RowMajor> MatrixXfR;
 
 //=============================================================================================================
 /**
@@ -199,6 +204,14 @@ public:
     */
     void addData(const QList<MatrixXd> &data);
 
+    //=========================================================================================================
+    /**
+    * Adds multiple time points for a channel set from shared blocks. The blocks are only read.
+    *
+    * @param[in] data       data blocks to add (Time points of channel samples)
+    */
+    void addData(const QList<MatrixBlock> &data);
+
     //=========================================================================================================
     /**
     * Returns the kind of a given channel number
@@ -255,6 +268,48 @@ public:
     */
     inline double getLastBlockFirstValue(int row) const;
 
+    //=========================================================================================================
+    /**
+    * Brings the per pixel column min/max envelopes of the displayed data up to date. Only the columns touched
+    * by addData since the last call are recomputed. All columns are rebuilt when the plot width or the
+    * displayed data (raw, filtered, freezed) changes.
+    *
+    * @param[in] iWidth     Number of pixel columns of the plot.
+    *
+    * @return false if there are less than two samples per pixel column, the samples are then plotted directly
+    */
+    bool updateEnvelopes(qint32 iWidth) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the minimum of every pixel column for the given row. Valid after updateEnvelopes returned true.
+    *
+    * @param[in] row    row for which the envelope is to be returned
+    *
+    * @return pointer to the iWidth column minima
+    */
+    inline const float* getEnvelopeMin(int row) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the maximum of every pixel column for the given row. Valid after updateEnvelopes returned true.
+    *
+    * @param[in] row    row for which the envelope is to be returned
+    *
+    * @return pointer to the iWidth column maxima
+    */
+    inline const float* getEnvelopeMax(int row) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the first sample which belongs to the given envelope column.
+    *
+    * @param[in] iColumn    the pixel column, iColumn == width returns the number of samples
+    *
+    * @return the first sample of the column
+    */
+    inline qint32 getEnvelopeColumnStart(qint32 iColumn) const;
+
     //=========================================================================================================
     /**
     * Returns a map which conatins the channel idx and its corresponding selection status
@@ -538,6 +593,22 @@ private:
     */
     void clearModel();
 
+    //=========================================================================================================
+    /**
+    * Marks the envelope columns covering the samples [iFrom, iTo) as changed. Negative sample indices refer
+    * to the end of the display window.
+    *
+    * @param[in] iFrom  First changed sample.
+    * @param[in] iTo    One past the last changed sample.
+    */
+    void markEnvelopeDirty(qint32 iFrom, qint32 iTo);
+
+    //=========================================================================================================
+    /**
+    * Marks all envelope columns as changed.
+    */
+    void invalidateEnvelopes();
+
     bool                                m_bProjActivated;                           /**< Projections activated */
     bool                                m_bCompActivated;                           /**< Compensator activated */
     bool                                m_bSpharaActivated;                         /**< Sphara activated */
@@ -573,13 +644,21 @@ private:
     MatrixXdR                           m_matDataFilteredFreeze;                    /**< The raw filtered data in freeze mode */
     MatrixXd                            m_matOverlap;                               /**< Last overlap block for the back */
 
+    mutable MatrixXfR                   m_matEnvelopeMin;                           /**< Minimum of every channel per pixel column */
+    mutable MatrixXfR                   m_matEnvelopeMax;                           /**< Maximum of every channel per pixel column */
+    mutable QBitArray                   m_qEnvelopeDirty;                           /**< Pixel columns which need to be recomputed */
+    mutable bool                        m_bEnvelopeDirty;                           /**< Whether any pixel column needs to be recomputed */
+    mutable qint32                      m_iEnvelopeWidth;                           /**< Number of pixel columns of the envelopes */
+    mutable qint32                      m_iEnvelopeSamples;                         /**< Number of samples covered by the envelopes */
+    mutable const double*               m_pEnvelopeSource;                          /**< The data the envelopes were computed from */
+
     Eigen::VectorXi                     m_vecIndicesFirstVV;                        /**< The indices of the channels to pick for the first SPHARA operator in case of a VectorView system.*/
     Eigen::VectorXi                     m_vecIndicesSecondVV;                       /**< The indices of the channels to pick for the second SPHARA operator in case of a VectorView system.*/
     Eigen::VectorXi                     m_vecIndicesFirstBabyMEG;                   /**< The indices of the channels to pick for the first SPHARA operator in case of a BabyMEG system.*/
     Eigen::VectorXi                     m_vecIndicesSecondBabyMEG;                  /**< The indices of the channels to pick for the second SPHARA operator in case of a BabyMEG system.*/
     Eigen::VectorXi                     m_vecIndicesFirstEEG;                       /**< The indices of the channels to pick for the second SPHARA operator in case of an EEG system.*/
 
-    Eigen::SparseMatrix<double>         m_matSparseSpharaMult;                      /**< The final sparse SPHARA operator .*/
+    RTPROCESSINGLIB::RtSpharaOperator::SPtr m_pRtSpharaOperator;                /**< The cached low-rank SPHARA operator.*/
     Eigen::SparseMatrix<double>         m_matSparseProjCompMult;                    /**< The final sparse projection + compensator operator.*/
     Eigen::SparseMatrix<double>         m_matSparseProjMult;                        /**< The final sparse SSP projector */
     Eigen::SparseMatrix<double>         m_matSparseCompMult;                        /**< The final sparse compensator matrix */
@@ -674,6 +753,31 @@ inline double RealTimeMultiSampleArrayModel::getLastBlockFirstValue(int row) con
 }
 
 
+//*************************************************************************************************************
+
+inline const float* RealTimeMultiSampleArrayModel::getEnvelopeMin(int row) const
+{
+    return m_matEnvelopeMin.data() + m_qMapIdxRowSelection.value(row,0)*m_matEnvelopeMin.cols();
+}
+
+
+//*************************************************************************************************************
+
+inline const float* RealTimeMultiSampleArrayModel::getEnvelopeMax(int row) const
+{
+    return m_matEnvelopeMax.data() + m_qMapIdxRowSelection.value(row,0)*m_matEnvelopeMax.cols();
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 RealTimeMultiSampleArrayModel::getEnvelopeColumnStart(qint32 iColumn) const
+{
+    //ceil(iColumn*samples/width), sample s belongs to column floor(s*width/samples)
+    return (qint32)(((qint64)iColumn*m_iEnvelopeSamples + m_iEnvelopeWidth - 1) / m_iEnvelopeWidth);
+}
+
+
 //*************************************************************************************************************
 
 inline const QMap<qint32,qint32>& RealTimeMultiSampleArrayModel::getIdxSelMap() const
@@ -0,0 +1,244 @@
+//=============================================================================================================
+/**
+* @file     matrixblock.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+*
+* @brief    Contains the declaration of the MatrixBlock class.
+*
+*/
+
+#ifndef MATRIXBLOCK_H
+#define MATRIXBLOCK_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "scmeas_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCMEASLIB
+//=============================================================================================================
+
+namespace SCMEASLIB
+{
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS MatrixBlock
+*
+* @brief The MatrixBlock class is an immutable, reference counted data block which is handed to all consumers
+*        without copying. Each block carries the acquisition timestamp and the sequence number of its data, so
+*        the stamp stays with the block while it waits in the queue of a consumer.
+*/
+class MatrixBlock
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a null block.
+    */
+    inline MatrixBlock();
+
+    //=========================================================================================================
+    /**
+    * Constructs a block which shares the given data.
+    *
+    * @param[in] pData              The shared data.
+    * @param[in] iTimestamp         Acquisition timestamp in microseconds of the pipeline clock, -1 if not stamped.
+    * @param[in] uiSequenceNumber   Sequence number assigned by the acquiring stage.
+    */
+    inline explicit MatrixBlock(const QSharedPointer<const Eigen::MatrixXd>& pData, qint64 iTimestamp = -1, quint64 uiSequenceNumber = 0);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the block holds no data.
+    *
+    * @return true if the block is null.
+    */
+    inline bool isNull() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the block holds no data.
+    *
+    * @return true if the block is null.
+    */
+    inline bool operator!() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the data of the block.
+    *
+    * @return the data.
+    */
+    inline const Eigen::MatrixXd& operator*() const;
+
+    //=========================================================================================================
+    /**
+    * Provides access to the data of the block.
+    *
+    * @return pointer to the data.
+    */
+    inline const Eigen::MatrixXd* operator->() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the acquisition timestamp of the block.
+    *
+    * @return the timestamp in microseconds of the pipeline clock, -1 if the block was not stamped yet.
+    */
+    inline qint64 getTimestamp() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the sequence number of the block.
+    *
+    * @return the sequence number assigned by the acquiring stage.
+    */
+    inline quint64 getSequenceNumber() const;
+
+    //=========================================================================================================
+    /**
+    * Stamps the block.
+    *
+    * @param[in] iTimestamp         Acquisition timestamp in microseconds of the pipeline clock.
+    * @param[in] uiSequenceNumber   Sequence number assigned by the acquiring stage.
+    */
+    inline void setStamp(qint64 iTimestamp, quint64 uiSequenceNumber);
+
+private:
+    QSharedPointer<const Eigen::MatrixXd>   m_pData;            /**< The shared data. */
+    qint64                                  m_iTimestamp;       /**< Acquisition timestamp in microseconds, -1 if not stamped. */
+    quint64                                 m_uiSequenceNumber; /**< Sequence number of the block. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline MatrixBlock::MatrixBlock()
+: m_iTimestamp(-1)
+, m_uiSequenceNumber(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+inline MatrixBlock::MatrixBlock(const QSharedPointer<const Eigen::MatrixXd>& pData, qint64 iTimestamp, quint64 uiSequenceNumber)
+: m_pData(pData)
+, m_iTimestamp(iTimestamp)
+, m_uiSequenceNumber(uiSequenceNumber)
+{
+}
+
+
+//*************************************************************************************************************
+
+inline bool MatrixBlock::isNull() const
+{
+    return m_pData.isNull();
+}
+
+
+//*************************************************************************************************************
+
+inline bool MatrixBlock::operator!() const
+{
+    return m_pData.isNull();
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::MatrixXd& MatrixBlock::operator*() const
+{
+    return *m_pData;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::MatrixXd* MatrixBlock::operator->() const
+{
+    return m_pData.data();
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 MatrixBlock::getTimestamp() const
+{
+    return m_iTimestamp;
+}
+
+
+//*************************************************************************************************************
+
+inline quint64 MatrixBlock::getSequenceNumber() const
+{
+    return m_uiSequenceNumber;
+}
+
+
+//*************************************************************************************************************
+
+inline void MatrixBlock::setStamp(qint64 iTimestamp, quint64 uiSequenceNumber)
+{
+    m_iTimestamp = iTimestamp;
+    m_uiSequenceNumber = uiSequenceNumber;
+}
+
+} // NAMESPACE
+
+#endif // MATRIXBLOCK_H
@@ -0,0 +1,159 @@
+//=============================================================================================================
+/**
+* @file     matrixblockbuffer.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+*
+* @brief    Contains the implementation of the MatrixBlockBuffer class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "matrixblockbuffer.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCMEASLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MatrixBlockBuffer::MatrixBlockBuffer(unsigned int uiMaxNumBlocks)
+: m_uiMaxNumBlocks(uiMaxNumBlocks)
+, m_bPopReleased(false)
+, m_bPushReleased(false)
+{
+}
+
+
+//*************************************************************************************************************
+
+void MatrixBlockBuffer::push(const MatrixBlock& block)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    while((unsigned int)m_qQueueBlocks.size() >= m_uiMaxNumBlocks) {
+        if(m_bPushReleased) {
+            m_bPushReleased = false;
+            return;
+        }
+        m_condFree.wait(&m_qMutex, 100);
+    }
+
+    m_qQueueBlocks.enqueue(block);
+
+    //New data is available, a released pop does not need to return a null block anymore
+    m_bPopReleased = false;
+    m_condUsed.wakeAll();
+}
+
+
+//*************************************************************************************************************
+
+MatrixBlock MatrixBlockBuffer::pop()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    while(m_qQueueBlocks.isEmpty()) {
+        if(m_bPopReleased) {
+            m_bPopReleased = false;
+            return MatrixBlock();
+        }
+        m_condUsed.wait(&m_qMutex, 100);
+    }
+
+    MatrixBlock block = m_qQueueBlocks.dequeue();
+
+    //Space is available, a released push does not need to drop its block anymore
+    m_bPushReleased = false;
+    m_condFree.wakeAll();
+
+    return block;
+}
+
+
+//*************************************************************************************************************
+
+void MatrixBlockBuffer::clear()
+{
+    QMutexLocker locker(&m_qMutex);
+    m_qQueueBlocks.clear();
+    m_condFree.wakeAll();
+}
+
+
+//*************************************************************************************************************
+
+quint32 MatrixBlockBuffer::count() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_qQueueBlocks.size();
+}
+
+
+//*************************************************************************************************************
+
+bool MatrixBlockBuffer::releaseFromPop()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(m_qQueueBlocks.isEmpty()) {
+        m_bPopReleased = true;
+        m_condUsed.wakeAll();
+        return true;
+    }
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+bool MatrixBlockBuffer::releaseFromPush()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if((unsigned int)m_qQueueBlocks.size() >= m_uiMaxNumBlocks) {
+        m_bPushReleased = true;
+        m_condFree.wakeAll();
+        return true;
+    }
+
+    return false;
+}
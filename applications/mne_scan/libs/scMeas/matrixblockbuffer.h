@@ -0,0 +1,147 @@
+//=============================================================================================================
+/**
+* @file     matrixblockbuffer.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+*
+* @brief    Contains the declaration of the MatrixBlockBuffer class.
+*
+*/
+
+#ifndef MATRIXBLOCKBUFFER_H
+#define MATRIXBLOCKBUFFER_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "scmeas_global.h"
+#include "matrixblockpool.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCMEASLIB
+//=============================================================================================================
+
+namespace SCMEASLIB
+{
+
+//=============================================================================================================
+/**
+* DECLARE CLASS MatrixBlockBuffer
+*
+* @brief The MatrixBlockBuffer class is a bounded producer consumer queue of shared data blocks. It replaces a
+*        CircularMatrixBuffer where the consumer only reads the data, the blocks are queued without copying.
+*/
+class SCMEASSHARED_EXPORT MatrixBlockBuffer
+{
+public:
+    typedef QSharedPointer<MatrixBlockBuffer> SPtr;               /**< Shared pointer type for MatrixBlockBuffer. */
+    typedef QSharedPointer<const MatrixBlockBuffer> ConstSPtr;    /**< Const shared pointer type for MatrixBlockBuffer. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a MatrixBlockBuffer.
+    *
+    * @param[in] uiMaxNumBlocks     Maximal number of queued blocks, push blocks when reached.
+    */
+    explicit MatrixBlockBuffer(unsigned int uiMaxNumBlocks);
+
+    //=========================================================================================================
+    /**
+    * Queues a block, waits while the buffer is full.
+    *
+    * @param[in] block  The block to queue.
+    */
+    void push(const MatrixBlock& block);
+
+    //=========================================================================================================
+    /**
+    * Returns the oldest block, waits while the buffer is empty.
+    *
+    * @return the oldest block or a null block if the pop was released
+    */
+    MatrixBlock pop();
+
+    //=========================================================================================================
+    /**
+    * Drops all queued blocks.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of queued blocks.
+    *
+    * @return the number of queued blocks
+    */
+    quint32 count() const;
+
+    //=========================================================================================================
+    /**
+    * Releases a waiting pop, it returns a null block.
+    *
+    * @return true if the buffer was empty and a pop is released
+    */
+    bool releaseFromPop();
+
+    //=========================================================================================================
+    /**
+    * Releases a waiting push, its block is dropped.
+    *
+    * @return true if the buffer was full and a push is released
+    */
+    bool releaseFromPush();
+
+private:
+    mutable QMutex          m_qMutex;           /**< Guards the queue. */
+    QWaitCondition          m_condFree;         /**< Signaled when a block was taken. */
+    QWaitCondition          m_condUsed;         /**< Signaled when a block was queued. */
+    QQueue<MatrixBlock>     m_qQueueBlocks;     /**< The queued blocks. */
+    unsigned int            m_uiMaxNumBlocks;   /**< Maximal number of queued blocks. */
+    bool                    m_bPopReleased;     /**< The next waiting pop returns a null block. */
+    bool                    m_bPushReleased;    /**< The next waiting push drops its block. */
+};
+
+} // NAMESPACE
+
+#endif // MATRIXBLOCKBUFFER_H
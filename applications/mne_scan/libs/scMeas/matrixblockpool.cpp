@@ -0,0 +1,159 @@
+//=============================================================================================================
+/**
+* @file     matrixblockpool.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+*
+* @brief    Contains the implementation of the MatrixBlockPool class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "matrixblockpool.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCMEASLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE STATIC METHODS
+//=============================================================================================================
+
+static void noDeleteMatrix(const MatrixXd*)
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MatrixBlockPool::MatrixBlockPool(int iMaxFree)
+: m_iMaxFree(iMaxFree)
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixBlockPool::SPtr MatrixBlockPool::create(int iMaxFree)
+{
+    SPtr pPool(new MatrixBlockPool(iMaxFree));
+    pPool->m_pSelf = pPool;
+    return pPool;
+}
+
+
+//*************************************************************************************************************
+
+MatrixBlockPool::~MatrixBlockPool()
+{
+    qDeleteAll(m_qListFree);
+}
+
+
+//*************************************************************************************************************
+
+MatrixBlock MatrixBlockPool::acquire(const MatrixXd& mat)
+{
+    MatrixXd* pMatrix = 0;
+
+    m_qMutex.lock();
+    //Prefer a matrix of the same size, resizing it would reallocate
+    for(int i = 0; i < m_qListFree.size(); ++i) {
+        if(m_qListFree[i]->size() == mat.size()) {
+            pMatrix = m_qListFree.takeAt(i);
+            break;
+        }
+    }
+    if(!pMatrix && !m_qListFree.isEmpty())
+        pMatrix = m_qListFree.takeLast();
+    m_qMutex.unlock();
+
+    if(!pMatrix)
+        pMatrix = new MatrixXd(mat);
+    else
+        *pMatrix = mat;
+
+    Recycler recycler;
+    recycler.pPool = m_pSelf.toStrongRef();
+
+    return MatrixBlock(QSharedPointer<const MatrixXd>(pMatrix, recycler));
+}
+
+
+//*************************************************************************************************************
+
+MatrixBlock MatrixBlockPool::wrap(const MatrixXd& mat)
+{
+    return MatrixBlock(QSharedPointer<const MatrixXd>(&mat, noDeleteMatrix));
+}
+
+
+//*************************************************************************************************************
+
+int MatrixBlockPool::numFree() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_qListFree.size();
+}
+
+
+//*************************************************************************************************************
+
+void MatrixBlockPool::recycle(MatrixXd* pMatrix)
+{
+    m_qMutex.lock();
+    if(m_qListFree.size() < m_iMaxFree) {
+        m_qListFree.append(pMatrix);
+        pMatrix = 0;
+    }
+    m_qMutex.unlock();
+
+    delete pMatrix;
+}
+
+
+//*************************************************************************************************************
+
+void MatrixBlockPool::Recycler::operator()(MatrixXd* pMatrix) const
+{
+    pPool->recycle(pMatrix);
+}
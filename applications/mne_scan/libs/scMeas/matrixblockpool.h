@@ -0,0 +1,170 @@
+//=============================================================================================================
+/**
+* @file     matrixblockpool.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+*
+* @brief    Contains the declaration of the MatrixBlockPool class.
+*
+*/
+
+#ifndef MATRIXBLOCKPOOL_H
+#define MATRIXBLOCKPOOL_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "scmeas_global.h"
+#include "matrixblock.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QWeakPointer>
+#include <QList>
+#include <QMutex>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCMEASLIB
+//=============================================================================================================
+
+namespace SCMEASLIB
+{
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS MatrixBlockPool
+*
+* @brief The MatrixBlockPool class hands out immutable data blocks and recycles their storage once every consumer released them.
+*/
+class SCMEASSHARED_EXPORT MatrixBlockPool
+{
+public:
+    typedef QSharedPointer<MatrixBlockPool> SPtr;               /**< Shared pointer type for MatrixBlockPool. */
+    typedef QSharedPointer<const MatrixBlockPool> ConstSPtr;    /**< Const shared pointer type for MatrixBlockPool. */
+
+    //=========================================================================================================
+    /**
+    * Creates a MatrixBlockPool. Pools are always held by a shared pointer, the handed out blocks keep their pool alive.
+    *
+    * @param[in] iMaxFree   Maximal number of released matrices which are kept for recycling.
+    *
+    * @return the new pool
+    */
+    static SPtr create(int iMaxFree = 16);
+
+    //=========================================================================================================
+    /**
+    * Destroys the MatrixBlockPool and frees all recycled matrices.
+    */
+    ~MatrixBlockPool();
+
+    //=========================================================================================================
+    /**
+    * Copies the given matrix into recycled storage and returns it as immutable block.
+    *
+    * @param[in] mat    The data to store.
+    *
+    * @return the block holding a copy of mat
+    */
+    MatrixBlock acquire(const Eigen::MatrixXd& mat);
+
+    //=========================================================================================================
+    /**
+    * Wraps a matrix which is owned and kept alive by the caller as block. Nothing is copied and nothing is recycled.
+    * Use this to pass existing matrices to functions taking blocks.
+    *
+    * @param[in] mat    The data to wrap.
+    *
+    * @return the non owning block
+    */
+    static MatrixBlock wrap(const Eigen::MatrixXd& mat);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of released matrices which are waiting for recycling.
+    *
+    * @return the number of free matrices
+    */
+    int numFree() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns the storage of a released block to the pool.
+    */
+    struct Recycler
+    {
+        SPtr pPool;     /**< Keeps the pool alive as long as the block exists. */
+
+        void operator()(Eigen::MatrixXd* pMatrix) const;
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a MatrixBlockPool, use create().
+    *
+    * @param[in] iMaxFree   Maximal number of released matrices which are kept for recycling.
+    */
+    explicit MatrixBlockPool(int iMaxFree);
+
+    //=========================================================================================================
+    /**
+    * Stores the released matrix for recycling or deletes it if enough matrices are kept.
+    *
+    * @param[in] pMatrix    The released matrix.
+    */
+    void recycle(Eigen::MatrixXd* pMatrix);
+
+    mutable QMutex                  m_qMutex;       /**< Guards the free list, blocks are released from any consumer thread. */
+    QList<Eigen::MatrixXd*>         m_qListFree;    /**< Released matrices waiting for recycling. */
+    int                             m_iMaxFree;     /**< Maximal number of kept matrices. */
+    QWeakPointer<MatrixBlockPool>   m_pSelf;        /**< This pool, handed to the recyclers. */
+};
+
+} // NAMESPACE
+
+#endif // MATRIXBLOCKPOOL_H
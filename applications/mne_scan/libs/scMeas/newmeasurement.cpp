@@ -58,6 +58,8 @@ NewMeasurement::NewMeasurement(int type, QObject *parent)
 : QObject(parent)
 , m_iMetaTypeId(type)
 , m_bVisibility(true)
+, m_iTimestamp(-1)
+, m_uiSequenceNumber(0)
 {
 //    qWarning() << "QMetaType" << type;
 }
@@ -125,6 +125,40 @@ public:
     */
     inline int type() const;
 
+    //=========================================================================================================
+    /**
+    * Returns the acquisition timestamp of the block which is currently held by the Measurement. The stamp is
+    * only valid while the Measurement is dispatched, data which is queued by a consumer has to keep its own
+    * stamp, see MatrixBlock.
+    *
+    * @return the acquisition timestamp in microseconds of the pipeline clock, -1 if the block was not stamped.
+    */
+    inline qint64 getTimestamp() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the acquisition timestamp of the block which is currently held by the Measurement.
+    *
+    * @param[in] iTimestamp     the acquisition timestamp in microseconds of the pipeline clock.
+    */
+    inline void setTimestamp(qint64 iTimestamp);
+
+    //=========================================================================================================
+    /**
+    * Returns the sequence number of the block which is currently held by the Measurement.
+    *
+    * @return the sequence number assigned by the acquiring stage.
+    */
+    inline quint64 getSequenceNumber() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the sequence number of the block which is currently held by the Measurement.
+    *
+    * @param[in] uiSequenceNumber   the sequence number assigned by the acquiring stage.
+    */
+    inline void setSequenceNumber(quint64 uiSequenceNumber);
+
 signals:
     void notify();
 
@@ -142,6 +176,8 @@ private:
     int     m_iMetaTypeId;      /**< QMetaType id of the Measurement */
     QString m_qString_Name;     /**< Name of the Measurement */
     bool    m_bVisibility;      /**< Visibility status */
+    qint64  m_iTimestamp;       /**< Acquisition timestamp of the current block in microseconds, -1 if not stamped */
+    quint64 m_uiSequenceNumber; /**< Sequence number of the current block */
 };
 
 
@@ -201,6 +237,42 @@ inline int NewMeasurement::type() const
     return m_iMetaTypeId;
 }
 
+
+//*************************************************************************************************************
+
+inline qint64 NewMeasurement::getTimestamp() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iTimestamp;
+}
+
+
+//*************************************************************************************************************
+
+inline void NewMeasurement::setTimestamp(qint64 iTimestamp)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_iTimestamp = iTimestamp;
+}
+
+
+//*************************************************************************************************************
+
+inline quint64 NewMeasurement::getSequenceNumber() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_uiSequenceNumber;
+}
+
+
+//*************************************************************************************************************
+
+inline void NewMeasurement::setSequenceNumber(quint64 uiSequenceNumber)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_uiSequenceNumber = uiSequenceNumber;
+}
+
 } //NAMESPACE
 
 Q_DECLARE_METATYPE(SCMEASLIB::NewMeasurement::SPtr)
@@ -69,6 +69,7 @@ NewRealTimeMultiSampleArray::NewRealTimeMultiSampleArray(QObject *parent)
 , m_dSamplingRate(0)
 , m_iMultiArraySize(10)
 , m_bChInfoIsInit(false)
+, m_pBlockPool(MatrixBlockPool::create())
 {
     m_slDisplayFlag << "compensators" << "projections" << "filter" << "view" << "triggerdetection" << "scaling" << "sphara" << "colors";
 }
@@ -257,13 +258,41 @@ void NewRealTimeMultiSampleArray::setValue(const MatrixXd& mat)
 //    }
 
     //Store
-    m_matSamples.push_back(mat);
+    m_qListBlocks.push_back(m_pBlockPool->acquire(mat));
 
     m_qMutex.unlock();
-    if(m_matSamples.size() >= m_iMultiArraySize)
+    if(m_qListBlocks.size() >= m_iMultiArraySize)
     {
         emit notify();
         m_qMutex.lock();
+        m_qListBlocks.clear();
+        m_matSamples.clear();
+        m_qMutex.unlock();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void NewRealTimeMultiSampleArray::setValue(const MatrixBlock& block)
+{
+    if(!m_bChInfoIsInit || !block)
+        return;
+
+    m_qMutex.lock();
+    //check vector size
+    if(block->rows() != m_qListChInfo.size())
+        qCritical() << "Error Occured in RealTimeMultiSampleArrayNew::setValue: Block size does not match the number of channels! ";
+
+    //Store
+    m_qListBlocks.push_back(block);
+
+    m_qMutex.unlock();
+    if(m_qListBlocks.size() >= m_iMultiArraySize)
+    {
+        emit notify();
+        m_qMutex.lock();
+        m_qListBlocks.clear();
         m_matSamples.clear();
         m_qMutex.unlock();
     }
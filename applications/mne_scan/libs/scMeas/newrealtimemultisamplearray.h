@@ -45,6 +45,7 @@
 #include "scmeas_global.h"
 #include "newmeasurement.h"
 #include "realtimesamplearraychinfo.h"
+#include "matrixblockpool.h"
 
 #include <fiff/fiff_info.h>
 
@@ -223,12 +224,31 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns the gathered multi sample array.
+    * Returns the gathered multi sample array. The matrices are copied from the shared blocks on the first call
+    * after a notify, consumers which only read the data should use getMultiSampleArrayBlocks instead.
     *
     * @return the current multi sample array.
     */
     inline const QList< MatrixXd >& getMultiSampleArray();
 
+    //=========================================================================================================
+    /**
+    * Returns the gathered multi sample array as immutable shared blocks. Consumers may keep the blocks beyond the
+    * notify call, the storage is recycled once all of them released their blocks.
+    *
+    * @return the current multi sample array blocks.
+    */
+    inline const QList<MatrixBlock>& getMultiSampleArrayBlocks() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the gathered multi sample array blocks for stamping. Only the emitting stage may change the stamps,
+    * and only before the blocks are handed to the consumers.
+    *
+    * @return the current multi sample array blocks.
+    */
+    inline QList<MatrixBlock>& getMultiSampleArrayBlocks();
+
     //=========================================================================================================
     /**
     * Attaches a value to the sample array list.
@@ -237,6 +257,14 @@ public:
     */
     virtual void setValue(const MatrixXd& mat);
 
+    //=========================================================================================================
+    /**
+    * Attaches a shared block to the sample array list without copying it.
+    *
+    * @param [in] block the block which is attached to the sample array list.
+    */
+    void setValue(const MatrixBlock& block);
+
     //=========================================================================================================
     /**
     * Attaches a value to the sample array vector.
@@ -255,7 +283,9 @@ private:
     double                      m_dSamplingRate;    /**< Sampling rate of the RealTimeSampleArray.*/
 //    MatrixXd                    m_vecValue;         /**< The current attached sample vector.*/
     qint32                      m_iMultiArraySize; /**< Sample size of the multi sample array.*/
-    QList< MatrixXd >           m_matSamples;       /**< The multi sample array.*/
+    QList< MatrixXd >           m_matSamples;       /**< The multi sample array, copied from m_qListBlocks on request.*/
+    QList<MatrixBlock>          m_qListBlocks;      /**< The multi sample array blocks.*/
+    MatrixBlockPool::SPtr       m_pBlockPool;       /**< Recycles the storage of released blocks.*/
     QList<RealTimeSampleArrayChInfo> m_qListChInfo; /**< Channel info list.*/
     bool                        m_bChInfoIsInit;    /**< If channel info is initialized.*/
 };
@@ -270,6 +300,7 @@ inline void NewRealTimeMultiSampleArray::clear()
 {
     QMutexLocker locker(&m_qMutex);
     m_matSamples.clear();
+    m_qListBlocks.clear();
 }
 
 
@@ -389,9 +420,31 @@ qint32 NewRealTimeMultiSampleArray::getMultiArraySize() const
 
 inline const QList< MatrixXd >& NewRealTimeMultiSampleArray::getMultiSampleArray()
 {
+    QMutexLocker locker(&m_qMutex);
+    if(m_matSamples.size() != m_qListBlocks.size()) {
+        m_matSamples.clear();
+        for(qint32 i = 0; i < m_qListBlocks.size(); ++i)
+            m_matSamples.append(*m_qListBlocks[i]);
+    }
     return m_matSamples;
 }
 
+
+//*************************************************************************************************************
+
+inline const QList<MatrixBlock>& NewRealTimeMultiSampleArray::getMultiSampleArrayBlocks() const
+{
+    return m_qListBlocks;
+}
+
+
+//*************************************************************************************************************
+
+inline QList<MatrixBlock>& NewRealTimeMultiSampleArray::getMultiSampleArrayBlocks()
+{
+    return m_qListBlocks;
+}
+
 } // NAMESPACE
 
 Q_DECLARE_METATYPE(SCMEASLIB::NewRealTimeMultiSampleArray::SPtr)
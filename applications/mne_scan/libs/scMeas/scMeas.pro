@@ -87,7 +87,9 @@ SOURCES += \
     realtimeevoked.cpp \
     realtimeevokedset.cpp \
     realtimecov.cpp \
-    frequencyspectrum.cpp
+    frequencyspectrum.cpp \
+    matrixblockpool.cpp \
+    matrixblockbuffer.cpp
 
 
 HEADERS += \
@@ -102,7 +104,10 @@ HEADERS += \
     realtimeevoked.h \
     realtimeevokedset.h \
     realtimecov.h \
-    frequencyspectrum.h
+    frequencyspectrum.h \
+    matrixblock.h \
+    matrixblockpool.h \
+    matrixblockbuffer.h
 
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
@@ -196,6 +196,15 @@ public:
     */
     virtual QWidget* setupWidget() = 0; //setup()
 
+    //=========================================================================================================
+    /**
+    * Returns the number of data blocks which wait in the internal buffer of the plugin. The pipeline statistics
+    * sample it whenever the plugin handles an input, emits an output or reports its processing.
+    *
+    * @return the number of waiting blocks, -1 if the plugin does not buffer its data.
+    */
+    virtual inline int getQueueDepth() const;
+
 
     inline InputConnectorList& getInputConnectors(){return m_inputConnectors;}
     inline OutputConnectorList& getOutputConnectors(){return m_outputConnectors;}
@@ -236,6 +245,14 @@ inline bool IPlugin::multiInstanceAllowed() const
 }
 
 
+//*************************************************************************************************************
+
+inline int IPlugin::getQueueDepth() const
+{
+    return -1;
+}
+
+
 //*************************************************************************************************************
 
 inline QList< QAction* > IPlugin::getPluginActions()
@@ -0,0 +1,151 @@
+//=============================================================================================================
+/**
+* @file     latencyhistogram.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the implementation of the LatencyHistogram class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "latencyhistogram.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// PREPROCESSOR DEFINES
+//=============================================================================================================
+
+#define LATENCYHISTOGRAM_BINS_PER_OCTAVE    4
+#define LATENCYHISTOGRAM_NUM_BINS           130     // Bin 0 holds durations below 1 us, the last bin everything above one hour
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+LatencyHistogram::LatencyHistogram()
+: m_vecBins(LATENCYHISTOGRAM_NUM_BINS, 0)
+, m_uiCount(0)
+, m_dSum(0.0)
+, m_iMin(0)
+, m_iMax(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void LatencyHistogram::add(qint64 iMicroSeconds)
+{
+    if(iMicroSeconds < 0)
+        iMicroSeconds = 0;
+
+    int iBin = 0;
+    if(iMicroSeconds >= 1) {
+        iBin = 1 + (int)qFloor(LATENCYHISTOGRAM_BINS_PER_OCTAVE * qLn((double)iMicroSeconds) / M_LN2);
+        if(iBin >= LATENCYHISTOGRAM_NUM_BINS)
+            iBin = LATENCYHISTOGRAM_NUM_BINS - 1;
+    }
+    ++m_vecBins[iBin];
+
+    if(m_uiCount == 0 || iMicroSeconds < m_iMin)
+        m_iMin = iMicroSeconds;
+    if(iMicroSeconds > m_iMax)
+        m_iMax = iMicroSeconds;
+
+    ++m_uiCount;
+    m_dSum += iMicroSeconds;
+}
+
+
+//*************************************************************************************************************
+
+void LatencyHistogram::clear()
+{
+    m_vecBins.fill(0);
+    m_uiCount = 0;
+    m_dSum = 0.0;
+    m_iMin = 0;
+    m_iMax = 0;
+}
+
+
+//*************************************************************************************************************
+
+qint64 LatencyHistogram::percentile(double dPercentile) const
+{
+    if(m_uiCount == 0)
+        return 0;
+
+    //Rank of the requested entry, at least the first one
+    quint64 uiRank = (quint64)qCeil(qBound(0.0, dPercentile, 100.0) / 100.0 * m_uiCount);
+    if(uiRank < 1)
+        uiRank = 1;
+
+    quint64 uiCumulated = 0;
+    for(int i = 0; i < m_vecBins.size(); ++i) {
+        uiCumulated += m_vecBins[i];
+        if(uiCumulated >= uiRank)
+            return i + 1 < m_vecBins.size() ? qMin(binLowerEdge(i + 1), m_iMax) : m_iMax;
+    }
+
+    return m_iMax;
+}
+
+
+//*************************************************************************************************************
+
+qint64 LatencyHistogram::binLowerEdge(int iBin)
+{
+    if(iBin <= 0)
+        return 0;
+
+    return (qint64)qCeil(qPow(2.0, (double)(iBin - 1) / LATENCYHISTOGRAM_BINS_PER_OCTAVE));
+}
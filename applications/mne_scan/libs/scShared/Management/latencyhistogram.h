@@ -0,0 +1,206 @@
+//=============================================================================================================
+/**
+* @file     latencyhistogram.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the LatencyHistogram class.
+*
+*/
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+//=============================================================================================================
+/**
+* Histogram of durations in microseconds. The bins are spaced logarithmically with four bins per octave, which
+* keeps the relative error of the percentile estimates below 19% from one microsecond up to one hour while the
+* memory stays constant.
+*
+* @brief Logarithmic duration histogram
+*/
+class SCSHAREDSHARED_EXPORT LatencyHistogram
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs an empty LatencyHistogram.
+    */
+    LatencyHistogram();
+
+    //=========================================================================================================
+    /**
+    * Adds a duration to the histogram. Negative durations are counted as zero.
+    *
+    * @param[in] iMicroSeconds  the duration in microseconds.
+    */
+    void add(qint64 iMicroSeconds);
+
+    //=========================================================================================================
+    /**
+    * Removes all entries.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Estimates a percentile from the bin edges. The estimate is the upper edge of the bin which holds the
+    * percentile, limited to the largest added duration.
+    *
+    * @param[in] dPercentile    the percentile in the range of 0 to 100.
+    *
+    * @return the estimated percentile in microseconds, 0 if the histogram is empty.
+    */
+    qint64 percentile(double dPercentile) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the lower edge of a bin.
+    *
+    * @param[in] iBin   the bin index.
+    *
+    * @return the lower edge of the bin in microseconds.
+    */
+    static qint64 binLowerEdge(int iBin);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of added durations.
+    *
+    * @return the number of added durations.
+    */
+    inline quint64 count() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the mean of the added durations.
+    *
+    * @return the mean in microseconds, 0 if the histogram is empty.
+    */
+    inline double mean() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the smallest added duration.
+    *
+    * @return the minimum in microseconds, 0 if the histogram is empty.
+    */
+    inline qint64 min() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the largest added duration.
+    *
+    * @return the maximum in microseconds, 0 if the histogram is empty.
+    */
+    inline qint64 max() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the bin counts.
+    *
+    * @return the bin counts, bin i holds the durations in [binLowerEdge(i), binLowerEdge(i+1)).
+    */
+    inline const QVector<quint64>& getBins() const;
+
+private:
+    QVector<quint64>    m_vecBins;      /**< Bin counts. */
+    quint64             m_uiCount;      /**< Number of added durations. */
+    double              m_dSum;         /**< Sum of the added durations in microseconds. */
+    qint64              m_iMin;         /**< Smallest added duration in microseconds. */
+    qint64              m_iMax;         /**< Largest added duration in microseconds. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline quint64 LatencyHistogram::count() const
+{
+    return m_uiCount;
+}
+
+
+//*************************************************************************************************************
+
+inline double LatencyHistogram::mean() const
+{
+    return m_uiCount > 0 ? m_dSum / m_uiCount : 0.0;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 LatencyHistogram::min() const
+{
+    return m_uiCount > 0 ? m_iMin : 0;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 LatencyHistogram::max() const
+{
+    return m_iMax;
+}
+
+
+//*************************************************************************************************************
+
+inline const QVector<quint64>& LatencyHistogram::getBins() const
+{
+    return m_vecBins;
+}
+
+} // NAMESPACE
+
+#endif // LATENCYHISTOGRAM_H
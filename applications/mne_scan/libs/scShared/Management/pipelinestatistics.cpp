@@ -0,0 +1,455 @@
+//=============================================================================================================
+/**
+* @file     pipelinestatistics.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the implementation of the PipelineStatistics class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "pipelinestatistics.h"
+#include "../Interfaces/IPlugin.h"
+
+#include <scMeas/newrealtimemultisamplearray.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+using namespace SCMEASLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+static QElapsedTimer startPipelineClock()
+{
+    QElapsedTimer timer;
+    timer.start();
+    return timer;
+}
+
+
+//*************************************************************************************************************
+
+static QString escapeJson(const QString& sText)
+{
+    QString sEscaped = sText;
+    sEscaped.replace("\\", "\\\\");
+    sEscaped.replace("\"", "\\\"");
+    return sEscaped;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+PipelineStatistics::PipelineStatistics(QObject *parent)
+: QObject(parent)
+, m_iEnabled(1)
+, m_iMaxTraceEvents(200000)
+{
+}
+
+
+//*************************************************************************************************************
+
+PipelineStatistics* PipelineStatistics::instance()
+{
+    static PipelineStatistics s_pipelineStatistics;
+    return &s_pipelineStatistics;
+}
+
+
+//*************************************************************************************************************
+
+qint64 PipelineStatistics::now()
+{
+    static const QElapsedTimer s_clock = startPipelineClock();
+    return s_clock.nsecsElapsed() / 1000;
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatistics::setEnabled(bool bEnabled)
+{
+    m_iEnabled.storeRelease(bEnabled ? 1 : 0);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatistics::reset()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    m_qHashStageIndex.clear();
+    m_qListStages.clear();
+    m_qListConsumedTimestamp.clear();
+    m_qListConsumedSequence.clear();
+    m_qListQueuedConsumption.clear();
+    m_qListNextSequence.clear();
+    m_qQueueTraceEvents.clear();
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatistics::recordInput(const IPlugin* pPlugin, const NewMeasurement* pMeasurement, qint64 iStart, qint64 iEnd)
+{
+    if(!isEnabled() || !pPlugin || !pMeasurement)
+        return;
+
+    qint64 iTimestamp = pMeasurement->getTimestamp();
+    quint64 uiSequence = pMeasurement->getSequenceNumber();
+
+    //The depth is queried before locking, the plugins guard their buffers with their own mutex
+    int iQueueDepth = pPlugin->getQueueDepth();
+
+    //Data blocks carry their own stamps
+    QList<MatrixBlock> qListBlocks;
+    const NewRealTimeMultiSampleArray* pRTMSA = dynamic_cast<const NewRealTimeMultiSampleArray*>(pMeasurement);
+    if(pRTMSA)
+        qListBlocks = pRTMSA->getMultiSampleArrayBlocks();
+
+    QMutexLocker locker(&m_qMutex);
+    int iStage = stageIndex(pPlugin);
+    StageStatistics& stage = m_qListStages[iStage];
+
+    ++stage.uiNumInputs;
+    stage.histInput.add(iEnd - iStart);
+    updateQueueDepth(stage, iQueueDepth);
+
+    for(int i = 0; i < qListBlocks.size(); ++i) {
+        if(qListBlocks[i].getTimestamp() >= 0) {
+            iTimestamp = qListBlocks[i].getTimestamp();
+            uiSequence = qListBlocks[i].getSequenceNumber();
+            stage.histInputLatency.add(iStart - iTimestamp);
+        }
+    }
+
+    qint64 iLatency = -1;
+    if(iTimestamp >= 0) {
+        iLatency = iStart - iTimestamp;
+        if(qListBlocks.isEmpty())
+            stage.histInputLatency.add(iLatency);
+
+        //Stages which don't report their queued blocks consume the newest block in their input handler
+        if(!m_qListQueuedConsumption[iStage]) {
+            m_qListConsumedTimestamp[iStage] = iTimestamp;
+            m_qListConsumedSequence[iStage] = uiSequence;
+        }
+    }
+
+    TraceEvent event = {iStage, TraceInput, iStart, iEnd - iStart, uiSequence, iLatency};
+    appendTraceEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatistics::stampOutput(const IPlugin* pPlugin, NewMeasurement* pMeasurement)
+{
+    if(!isEnabled() || !pPlugin || !pMeasurement)
+        return;
+
+    NewRealTimeMultiSampleArray* pRTMSA = dynamic_cast<NewRealTimeMultiSampleArray*>(pMeasurement);
+
+    qint64 iTimestamp = -1;
+    quint64 uiSequence = 0;
+    {
+        QMutexLocker locker(&m_qMutex);
+        int iStage = stageIndex(pPlugin);
+
+        //Pass on the stamp of the block this stage consumed, an acquiring stage stamps the current time
+        bool bAcquiring = m_qListConsumedTimestamp[iStage] < 0;
+
+        if(pRTMSA) {
+            QList<MatrixBlock>& qListBlocks = pRTMSA->getMultiSampleArrayBlocks();
+            for(int i = 0; i < qListBlocks.size(); ++i) {
+                if(qListBlocks[i].getTimestamp() < 0) {
+                    if(bAcquiring)
+                        qListBlocks[i].setStamp(now(), m_qListNextSequence[iStage]++);
+                    else
+                        qListBlocks[i].setStamp(m_qListConsumedTimestamp[iStage], m_qListConsumedSequence[iStage]);
+                }
+
+                iTimestamp = qListBlocks[i].getTimestamp();
+                uiSequence = qListBlocks[i].getSequenceNumber();
+            }
+        }
+
+        if(iTimestamp < 0) {
+            if(bAcquiring) {
+                iTimestamp = now();
+                uiSequence = m_qListNextSequence[iStage]++;
+            }
+            else {
+                iTimestamp = m_qListConsumedTimestamp[iStage];
+                uiSequence = m_qListConsumedSequence[iStage];
+            }
+        }
+    }
+
+    //The stamp of the measurement is the one of its newest block, it is only valid during the dispatch
+    pMeasurement->setTimestamp(iTimestamp);
+    pMeasurement->setSequenceNumber(uiSequence);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatistics::recordOutput(const IPlugin* pPlugin, const NewMeasurement* pMeasurement, qint64 iStart, qint64 iEnd)
+{
+    if(!isEnabled() || !pPlugin || !pMeasurement)
+        return;
+
+    qint64 iTimestamp = pMeasurement->getTimestamp();
+    quint64 uiSequence = pMeasurement->getSequenceNumber();
+    int iQueueDepth = pPlugin->getQueueDepth();
+
+    QMutexLocker locker(&m_qMutex);
+    int iStage = stageIndex(pPlugin);
+    StageStatistics& stage = m_qListStages[iStage];
+
+    ++stage.uiNumOutputs;
+    stage.uiLastSequence = uiSequence;
+    stage.histDispatch.add(iEnd - iStart);
+    updateQueueDepth(stage, iQueueDepth);
+
+    qint64 iLatency = -1;
+    if(iTimestamp >= 0) {
+        iLatency = iStart - iTimestamp;
+        stage.histOutputLatency.add(iEnd - iTimestamp);
+    }
+
+    TraceEvent event = {iStage, TraceOutput, iStart, iEnd - iStart, uiSequence, iLatency};
+    appendTraceEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatistics::recordProcessing(const IPlugin* pPlugin, qint64 iStart, qint64 iEnd)
+{
+    if(!isEnabled() || !pPlugin)
+        return;
+
+    int iQueueDepth = pPlugin->getQueueDepth();
+
+    QMutexLocker locker(&m_qMutex);
+    int iStage = stageIndex(pPlugin);
+
+    m_qListStages[iStage].histProcessing.add(iEnd - iStart);
+    updateQueueDepth(m_qListStages[iStage], iQueueDepth);
+
+    TraceEvent event = {iStage, TraceProcessing, iStart, iEnd - iStart, m_qListConsumedSequence[iStage], -1};
+    appendTraceEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatistics::recordProcessing(const IPlugin* pPlugin, const MatrixBlock& block, qint64 iStart, qint64 iEnd)
+{
+    if(!isEnabled() || !pPlugin)
+        return;
+
+    int iQueueDepth = pPlugin->getQueueDepth();
+
+    QMutexLocker locker(&m_qMutex);
+    int iStage = stageIndex(pPlugin);
+
+    m_qListStages[iStage].histProcessing.add(iEnd - iStart);
+    updateQueueDepth(m_qListStages[iStage], iQueueDepth);
+
+    //From now on the input handler does not decide the stamp of the outputs anymore
+    m_qListQueuedConsumption[iStage] = true;
+
+    qint64 iLatency = -1;
+    if(block.getTimestamp() >= 0) {
+        iLatency = iStart - block.getTimestamp();
+        m_qListConsumedTimestamp[iStage] = block.getTimestamp();
+        m_qListConsumedSequence[iStage] = block.getSequenceNumber();
+    }
+
+    TraceEvent event = {iStage, TraceProcessing, iStart, iEnd - iStart, block.getSequenceNumber(), iLatency};
+    appendTraceEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatistics::setQueueDepth(const IPlugin* pPlugin, int iQueueDepth)
+{
+    if(!isEnabled() || !pPlugin)
+        return;
+
+    QMutexLocker locker(&m_qMutex);
+    updateQueueDepth(m_qListStages[stageIndex(pPlugin)], iQueueDepth);
+}
+
+
+//*************************************************************************************************************
+
+QList<StageStatistics> PipelineStatistics::getStageStatistics() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_qListStages;
+}
+
+
+//*************************************************************************************************************
+
+bool PipelineStatistics::exportTrace(const QString& sFileName) const
+{
+    QFile file(sFileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "PipelineStatistics::exportTrace - Could not open" << sFileName;
+        return false;
+    }
+
+    QMutexLocker locker(&m_qMutex);
+
+    const char* sKindNames[TraceNumKinds] = {"input", "output", "processing"};
+
+    QTextStream out(&file);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    //Name the rows, each stage gets one row per event kind
+    bool bFirst = true;
+    for(int i = 0; i < m_qListStages.size(); ++i) {
+        for(int k = 0; k < TraceNumKinds; ++k) {
+            if(!bFirst)
+                out << ",\n";
+            bFirst = false;
+
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i * TraceNumKinds + k
+                << ",\"args\":{\"name\":\"" << escapeJson(m_qListStages[i].sName) << " " << sKindNames[k] << "\"}}";
+        }
+    }
+
+    //Complete events with start and duration
+    for(int i = 0; i < m_qQueueTraceEvents.size(); ++i) {
+        const TraceEvent& event = m_qQueueTraceEvents[i];
+
+        if(!bFirst)
+            out << ",\n";
+        bFirst = false;
+
+        out << "{\"name\":\"" << sKindNames[event.eKind] << " #" << event.uiSequence
+            << "\",\"cat\":\"" << sKindNames[event.eKind]
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.iStage * TraceNumKinds + event.eKind
+            << ",\"ts\":" << event.iStart
+            << ",\"dur\":" << event.iDuration
+            << ",\"args\":{\"seq\":" << event.uiSequence;
+        if(event.iLatency >= 0)
+            out << ",\"latency_us\":" << event.iLatency;
+        out << "}}";
+    }
+
+    out << "\n]}\n";
+    out.flush();
+
+    return file.error() == QFile::NoError;
+}
+
+
+//*************************************************************************************************************
+
+int PipelineStatistics::stageIndex(const IPlugin* pPlugin)
+{
+    QHash<const IPlugin*, int>::const_iterator it = m_qHashStageIndex.constFind(pPlugin);
+    if(it != m_qHashStageIndex.constEnd())
+        return it.value();
+
+    StageStatistics stage;
+    stage.sName = pPlugin->getName();
+    stage.uiNumInputs = 0;
+    stage.uiNumOutputs = 0;
+    stage.uiLastSequence = 0;
+    stage.iQueueDepth = 0;
+    stage.iMaxQueueDepth = 0;
+
+    int iStage = m_qListStages.size();
+    m_qListStages.append(stage);
+    m_qListConsumedTimestamp.append(-1);
+    m_qListConsumedSequence.append(0);
+    m_qListQueuedConsumption.append(false);
+    m_qListNextSequence.append(0);
+    m_qHashStageIndex.insert(pPlugin, iStage);
+
+    return iStage;
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatistics::appendTraceEvent(const TraceEvent& event)
+{
+    m_qQueueTraceEvents.enqueue(event);
+
+    while(m_qQueueTraceEvents.size() > m_iMaxTraceEvents)
+        m_qQueueTraceEvents.dequeue();
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatistics::updateQueueDepth(StageStatistics& stage, int iQueueDepth)
+{
+    if(iQueueDepth < 0)
+        return;
+
+    stage.iQueueDepth = iQueueDepth;
+    if(iQueueDepth > stage.iMaxQueueDepth)
+        stage.iMaxQueueDepth = iQueueDepth;
+}
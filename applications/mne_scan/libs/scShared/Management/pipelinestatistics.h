@@ -0,0 +1,331 @@
+//=============================================================================================================
+/**
+* @file     pipelinestatistics.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the PipelineStatistics class.
+*
+*/
+
+#ifndef PIPELINESTATISTICS_H
+#define PIPELINESTATISTICS_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+#include "latencyhistogram.h"
+
+#include <scMeas/newmeasurement.h>
+#include <scMeas/matrixblock.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QObject>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QQueue>
+#include <QElapsedTimer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class IPlugin;
+
+
+//=============================================================================================================
+/**
+* Statistics of one stage of the plugin graph. All durations are in microseconds.
+*/
+struct StageStatistics
+{
+    QString             sName;              /**< Name of the plugin. */
+    quint64             uiNumInputs;        /**< Number of blocks received at the input connectors. */
+    quint64             uiNumOutputs;       /**< Number of blocks emitted at the output connectors. */
+    quint64             uiLastSequence;     /**< Sequence number of the last emitted block. */
+    int                 iQueueDepth;        /**< Last reported number of blocks waiting in the plugin. */
+    int                 iMaxQueueDepth;     /**< Largest reported number of blocks waiting in the plugin. */
+    LatencyHistogram    histInput;          /**< Time spent in the input handlers of the stage. */
+    LatencyHistogram    histProcessing;     /**< Time the stage spent processing on its own thread. */
+    LatencyHistogram    histDispatch;       /**< Time the stage was blocked until all connected displays and plugins took a block. */
+    LatencyHistogram    histInputLatency;   /**< Time from acquisition until a block arrived at the stage. */
+    LatencyHistogram    histOutputLatency;  /**< Time from acquisition until all receivers took a block of the stage. */
+};
+
+
+//=============================================================================================================
+/**
+* Collects per stage queue depth, processing time and end-to-end latency of the plugin graph.
+*
+* Sensor stages stamp every emitted data block with the acquisition time and a sequence number. The stamp is
+* carried by the MatrixBlock, so it stays with the data while it waits in the queue of a consumer. Outputs of a
+* stage with inputs are stamped with the stamp of the block the stage consumed last: stages which process in
+* their input handler consume the newest received block, stages which process queued blocks on their own thread
+* report the consumed block through recordProcessing. The connectors record inputs and outputs automatically and
+* sample the queue depth which the plugins report through IPlugin::getQueueDepth, plugins which process on their
+* own thread report their processing time through recordProcessing.
+* The recorded events can be exported as a trace file in the Chrome trace event format (chrome://tracing).
+*
+* @brief Latency and throughput instrumentation of the plugin graph
+*/
+class SCSHAREDSHARED_EXPORT PipelineStatistics : public QObject
+{
+    Q_OBJECT
+public:
+    //=========================================================================================================
+    /**
+    * Returns the statistics instance which is shared by all connectors of the application.
+    *
+    * @return the statistics instance.
+    */
+    static PipelineStatistics* instance();
+
+    //=========================================================================================================
+    /**
+    * Returns the current time of the pipeline clock. The clock is monotonic and starts with the first call.
+    *
+    * @return the current time in microseconds.
+    */
+    static qint64 now();
+
+    //=========================================================================================================
+    /**
+    * Enables or disables the recording. Disabled recording costs a single flag check per block.
+    *
+    * @param[in] bEnabled   whether statistics and trace events are recorded.
+    */
+    void setEnabled(bool bEnabled);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the recording is enabled.
+    *
+    * @return true if statistics are recorded.
+    */
+    inline bool isEnabled() const;
+
+    //=========================================================================================================
+    /**
+    * Removes all statistics and trace events, e.g. when a new measurement is started.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Records a block which arrived at an input connector of a plugin.
+    *
+    * @param[in] pPlugin        the receiving plugin.
+    * @param[in] pMeasurement   the received measurement.
+    * @param[in] iStart         the time at which the plugin started to handle the block.
+    * @param[in] iEnd           the time at which the plugin returned from handling the block.
+    */
+    void recordInput(const IPlugin* pPlugin, const SCMEASLIB::NewMeasurement* pMeasurement, qint64 iStart, qint64 iEnd);
+
+    //=========================================================================================================
+    /**
+    * Stamps a measurement and its unstamped data blocks before it is emitted at an output connector of a plugin.
+    * Plugins which already consumed a block pass on the stamp of that block, all other plugins stamp the current
+    * time and a new sequence number. Blocks which are passed on unchanged keep their stamp.
+    *
+    * @param[in] pPlugin        the emitting plugin.
+    * @param[in] pMeasurement   the measurement to stamp.
+    */
+    void stampOutput(const IPlugin* pPlugin, SCMEASLIB::NewMeasurement* pMeasurement);
+
+    //=========================================================================================================
+    /**
+    * Records a block which was emitted at an output connector of a plugin.
+    *
+    * @param[in] pPlugin        the emitting plugin.
+    * @param[in] pMeasurement   the emitted measurement.
+    * @param[in] iStart         the time at which the block was emitted.
+    * @param[in] iEnd           the time at which all receivers returned.
+    */
+    void recordOutput(const IPlugin* pPlugin, const SCMEASLIB::NewMeasurement* pMeasurement, qint64 iStart, qint64 iEnd);
+
+    //=========================================================================================================
+    /**
+    * Records processing which a plugin carried out on its own thread.
+    *
+    * @param[in] pPlugin    the processing plugin.
+    * @param[in] iStart     the start of the processing, see now().
+    * @param[in] iEnd       the end of the processing, see now().
+    */
+    void recordProcessing(const IPlugin* pPlugin, qint64 iStart, qint64 iEnd);
+
+    //=========================================================================================================
+    /**
+    * Records the processing of a queued block which a plugin carried out on its own thread. The outputs which the
+    * plugin emits afterwards are stamped with the stamp of this block.
+    *
+    * @param[in] pPlugin    the processing plugin.
+    * @param[in] block      the consumed block.
+    * @param[in] iStart     the start of the processing, see now().
+    * @param[in] iEnd       the end of the processing, see now().
+    */
+    void recordProcessing(const IPlugin* pPlugin, const SCMEASLIB::MatrixBlock& block, qint64 iStart, qint64 iEnd);
+
+    //=========================================================================================================
+    /**
+    * Reports the number of blocks which wait in the internal buffer of a plugin. The depth is also sampled through
+    * IPlugin::getQueueDepth whenever a block of the plugin is recorded.
+    *
+    * @param[in] pPlugin        the plugin.
+    * @param[in] iQueueDepth    the number of waiting blocks.
+    */
+    void setQueueDepth(const IPlugin* pPlugin, int iQueueDepth);
+
+    //=========================================================================================================
+    /**
+    * Returns a copy of the statistics of all stages in the order in which they were first seen.
+    *
+    * @return the stage statistics.
+    */
+    QList<StageStatistics> getStageStatistics() const;
+
+    //=========================================================================================================
+    /**
+    * Writes the recorded events to a JSON trace file which can be opened with chrome://tracing.
+    *
+    * @param[in] sFileName  the file to write.
+    *
+    * @return true if the file was written, false otherwise.
+    */
+    bool exportTrace(const QString& sFileName) const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Event kinds of the trace. Each kind of a stage is shown on its own trace row.
+    */
+    enum TraceEventKind
+    {
+        TraceInput = 0,     /**< A block was handled at an input connector. */
+        TraceOutput,        /**< A block was emitted at an output connector. */
+        TraceProcessing,    /**< The plugin processed on its own thread. */
+        TraceNumKinds
+    };
+
+    //=========================================================================================================
+    /**
+    * A recorded trace event.
+    */
+    struct TraceEvent
+    {
+        int             iStage;         /**< Index into m_qListStages. */
+        TraceEventKind  eKind;          /**< Kind of the event. */
+        qint64          iStart;         /**< Start in microseconds of the pipeline clock. */
+        qint64          iDuration;      /**< Duration in microseconds. */
+        quint64         uiSequence;     /**< Sequence number of the block, if any. */
+        qint64          iLatency;       /**< Latency of the block at the start of the event, -1 if unknown. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Private constructor, use instance().
+    */
+    explicit PipelineStatistics(QObject *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Returns the index of the stage which belongs to the plugin and creates it if necessary.
+    * The mutex has to be locked by the caller.
+    *
+    * @param[in] pPlugin    the plugin.
+    *
+    * @return the index into m_qListStages.
+    */
+    int stageIndex(const IPlugin* pPlugin);
+
+    //=========================================================================================================
+    /**
+    * Appends a trace event and drops the oldest events if the maximum number is exceeded.
+    * The mutex has to be locked by the caller.
+    *
+    * @param[in] event  the event to append.
+    */
+    void appendTraceEvent(const TraceEvent& event);
+
+    //=========================================================================================================
+    /**
+    * Updates the current and the largest queue depth of a stage.
+    * The mutex has to be locked by the caller.
+    *
+    * @param[in] stage          the stage.
+    * @param[in] iQueueDepth    the number of waiting blocks, negative values are ignored.
+    */
+    static void updateQueueDepth(StageStatistics& stage, int iQueueDepth);
+
+    mutable QMutex                  m_qMutex;                   /**< Guards all statistics. */
+    QAtomicInt                      m_iEnabled;                 /**< Whether statistics are recorded, read without the mutex on every block. */
+
+    QHash<const IPlugin*, int>      m_qHashStageIndex;          /**< Maps the plugins to their stage index. */
+    QList<StageStatistics>          m_qListStages;              /**< Statistics of each stage. */
+    QList<qint64>                   m_qListConsumedTimestamp;   /**< Stamp of the block each stage consumed last, -1 if none. */
+    QList<quint64>                  m_qListConsumedSequence;    /**< Sequence number of the block each stage consumed last. */
+    QList<bool>                     m_qListQueuedConsumption;   /**< Whether a stage reports its consumed blocks through recordProcessing. */
+    QList<quint64>                  m_qListNextSequence;        /**< Next sequence number of each acquiring stage. */
+
+    QQueue<TraceEvent>              m_qQueueTraceEvents;        /**< The most recent trace events. */
+    int                             m_iMaxTraceEvents;          /**< Maximal number of kept trace events. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool PipelineStatistics::isEnabled() const
+{
+    return m_iEnabled.loadAcquire() != 0;
+}
+
+} // NAMESPACE
+
+#endif // PIPELINESTATISTICS_H
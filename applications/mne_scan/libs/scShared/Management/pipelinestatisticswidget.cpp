@@ -0,0 +1,221 @@
+//=============================================================================================================
+/**
+* @file     pipelinestatisticswidget.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the implementation of the PipelineStatisticsWidget class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "pipelinestatisticswidget.h"
+#include "pipelinestatistics.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QMessageBox>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+static QString toMilliSeconds(double dMicroSeconds)
+{
+    return QString::number(dMicroSeconds / 1000.0, 'f', 1);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+PipelineStatisticsWidget::PipelineStatisticsWidget(QWidget *parent, int iRefreshMSec)
+: QWidget(parent)
+{
+    QStringList slHeader;
+    slHeader << tr("Stage")
+             << tr("In")
+             << tr("Out")
+             << tr("Queue (max)")
+             << tr("Input handler mean / p95 [ms]")
+             << tr("Processing mean / p95 [ms]")
+             << tr("Dispatch p95 [ms]")
+             << tr("Input latency p50 / p95 [ms]")
+             << tr("Output latency p50 / p95 / max [ms]");
+
+    m_pTableWidget = new QTableWidget(0, slHeader.size(), this);
+    m_pTableWidget->setHorizontalHeaderLabels(slHeader);
+    m_pTableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidget->setSelectionMode(QAbstractItemView::NoSelection);
+    m_pTableWidget->verticalHeader()->hide();
+    m_pTableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    m_pCheckBoxEnabled = new QCheckBox(tr("Record"), this);
+    m_pCheckBoxEnabled->setChecked(PipelineStatistics::instance()->isEnabled());
+    connect(m_pCheckBoxEnabled, &QCheckBox::toggled,
+            this, &PipelineStatisticsWidget::onEnabledToggled);
+
+    m_pPushButtonReset = new QPushButton(tr("Reset"), this);
+    connect(m_pPushButtonReset, &QPushButton::clicked,
+            this, &PipelineStatisticsWidget::onReset);
+
+    m_pPushButtonExport = new QPushButton(tr("Export trace..."), this);
+    m_pPushButtonExport->setToolTip(tr("Exports the recorded events to a file which can be opened with chrome://tracing"));
+    connect(m_pPushButtonExport, &QPushButton::clicked,
+            this, &PipelineStatisticsWidget::onExportTrace);
+
+    QGridLayout *layout = new QGridLayout;
+    layout->setMargin(5);
+    layout->addWidget(m_pTableWidget, 0, 0, 1, 4);
+    layout->addWidget(m_pCheckBoxEnabled, 1, 0);
+    layout->setColumnStretch(1, 1);
+    layout->addWidget(m_pPushButtonReset, 1, 2);
+    layout->addWidget(m_pPushButtonExport, 1, 3);
+    this->setLayout(layout);
+
+    m_qTimer.setInterval(iRefreshMSec);
+    connect(&m_qTimer, &QTimer::timeout,
+            this, &PipelineStatisticsWidget::refresh);
+}
+
+
+//*************************************************************************************************************
+
+PipelineStatisticsWidget::~PipelineStatisticsWidget()
+{
+    m_qTimer.stop();
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatisticsWidget::refresh()
+{
+    QList<StageStatistics> qListStages = PipelineStatistics::instance()->getStageStatistics();
+
+    m_pTableWidget->setRowCount(qListStages.size());
+
+    for(int i = 0; i < qListStages.size(); ++i) {
+        const StageStatistics& stage = qListStages[i];
+
+        QStringList slRow;
+        slRow << stage.sName
+              << QString::number(stage.uiNumInputs)
+              << QString::number(stage.uiNumOutputs)
+              << QString("%1 (%2)").arg(stage.iQueueDepth).arg(stage.iMaxQueueDepth)
+              << QString("%1 / %2").arg(toMilliSeconds(stage.histInput.mean())).arg(toMilliSeconds(stage.histInput.percentile(95)))
+              << QString("%1 / %2").arg(toMilliSeconds(stage.histProcessing.mean())).arg(toMilliSeconds(stage.histProcessing.percentile(95)))
+              << toMilliSeconds(stage.histDispatch.percentile(95))
+              << QString("%1 / %2").arg(toMilliSeconds(stage.histInputLatency.percentile(50))).arg(toMilliSeconds(stage.histInputLatency.percentile(95)))
+              << QString("%1 / %2 / %3").arg(toMilliSeconds(stage.histOutputLatency.percentile(50))).arg(toMilliSeconds(stage.histOutputLatency.percentile(95))).arg(toMilliSeconds(stage.histOutputLatency.max()));
+
+        for(int j = 0; j < slRow.size(); ++j) {
+            QTableWidgetItem* pItem = m_pTableWidget->item(i, j);
+            if(!pItem) {
+                pItem = new QTableWidgetItem;
+                if(j > 0)
+                    pItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                m_pTableWidget->setItem(i, j, pItem);
+            }
+            pItem->setText(slRow[j]);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatisticsWidget::showEvent(QShowEvent* event)
+{
+    refresh();
+    m_qTimer.start();
+
+    QWidget::showEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatisticsWidget::hideEvent(QHideEvent* event)
+{
+    m_qTimer.stop();
+
+    QWidget::hideEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatisticsWidget::onExportTrace()
+{
+    QString sFileName = QFileDialog::getSaveFileName(this, tr("Export pipeline trace"), "mne_scan_trace.json", tr("Trace files (*.json)"));
+    if(sFileName.isEmpty())
+        return;
+
+    if(!PipelineStatistics::instance()->exportTrace(sFileName))
+        QMessageBox::warning(this, tr("Export pipeline trace"), tr("Could not write %1.").arg(sFileName));
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatisticsWidget::onReset()
+{
+    PipelineStatistics::instance()->reset();
+    refresh();
+}
+
+
+//*************************************************************************************************************
+
+void PipelineStatisticsWidget::onEnabledToggled(bool bEnabled)
+{
+    PipelineStatistics::instance()->setEnabled(bEnabled);
+}
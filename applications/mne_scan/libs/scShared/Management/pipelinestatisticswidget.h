@@ -0,0 +1,146 @@
+//=============================================================================================================
+/**
+* @file     pipelinestatisticswidget.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the PipelineStatisticsWidget class.
+*
+*/
+
+#ifndef PIPELINESTATISTICSWIDGET_H
+#define PIPELINESTATISTICSWIDGET_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QTimer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+
+//=============================================================================================================
+/**
+* Table view of the PipelineStatistics which is refreshed periodically. Meant to be placed in a dock widget.
+*
+* @brief The PipelineStatisticsWidget class shows queue depth, processing time and latency of each plugin stage
+*/
+class SCSHAREDSHARED_EXPORT PipelineStatisticsWidget : public QWidget
+{
+    Q_OBJECT
+public:
+
+    //=========================================================================================================
+    /**
+    * Constructs a PipelineStatisticsWidget which is a child of parent.
+    *
+    * @param [in] parent        pointer to parent widget.
+    * @param [in] iRefreshMSec  refresh interval of the table in milliseconds.
+    */
+    PipelineStatisticsWidget(QWidget *parent = 0, int iRefreshMSec = 1000);
+
+    //=========================================================================================================
+    /**
+    * Destructor
+    */
+    ~PipelineStatisticsWidget();
+
+    //=========================================================================================================
+    /**
+    * Refreshes the table from the current statistics.
+    */
+    void refresh();
+
+protected:
+    //=========================================================================================================
+    /**
+    * Starts the refresh timer when the widget is shown.
+    *
+    * @param [in] event     the show event.
+    */
+    virtual void showEvent(QShowEvent* event);
+
+    //=========================================================================================================
+    /**
+    * Stops the refresh timer when the widget is hidden.
+    *
+    * @param [in] event     the hide event.
+    */
+    virtual void hideEvent(QHideEvent* event);
+
+private:
+    //=========================================================================================================
+    /**
+    * Asks for a file name and exports the trace events.
+    */
+    void onExportTrace();
+
+    //=========================================================================================================
+    /**
+    * Removes all recorded statistics.
+    */
+    void onReset();
+
+    //=========================================================================================================
+    /**
+    * Enables or disables the recording.
+    *
+    * @param [in] bEnabled  whether the recording is enabled.
+    */
+    void onEnabledToggled(bool bEnabled);
+
+    QTableWidget*   m_pTableWidget;         /**< Holds one row per stage. */
+    QPushButton*    m_pPushButtonExport;    /**< Exports the trace file. */
+    QPushButton*    m_pPushButtonReset;     /**< Resets the statistics. */
+    QCheckBox*      m_pCheckBoxEnabled;     /**< Enables the recording. */
+    QTimer          m_qTimer;               /**< Refresh timer. */
+};
+
+} // NAMESPACE
+
+#endif // PIPELINESTATISTICSWIDGET_H
@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "plugininputconnector.h"
+#include "pipelinestatistics.h"
 #include "../Interfaces/IPlugin.h"
 
 
@@ -81,5 +82,9 @@ bool PluginInputConnector::isOutputConnector() const
 
 void PluginInputConnector::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 {
+    qint64 iStart = PipelineStatistics::now();
+
     emit notify(pMeasurement);
+
+    PipelineStatistics::instance()->recordInput(m_pPlugin, pMeasurement.data(), iStart, PipelineStatistics::now());
 }
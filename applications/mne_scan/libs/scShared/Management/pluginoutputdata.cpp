@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "pluginoutputdata.h"
+#include "pipelinestatistics.h"
 
 #include <scMeas/newmeasurement.h>
 
@@ -90,7 +91,16 @@ PluginOutputData<T>::PluginOutputData(IPlugin *parent, const QString &name, cons
 template <class T>
 void PluginOutputData<T>::update()
 {
-    emit notify(qSharedPointerDynamicCast<SCMEASLIB::NewMeasurement>(m_pMeasurement));
+    SCMEASLIB::NewMeasurement::SPtr pMeasurement = qSharedPointerDynamicCast<SCMEASLIB::NewMeasurement>(m_pMeasurement);
+
+    PipelineStatistics* pStatistics = PipelineStatistics::instance();
+    pStatistics->stampOutput(m_pPlugin, pMeasurement.data());
+
+    qint64 iStart = PipelineStatistics::now();
+
+    emit notify(pMeasurement);
+
+    pStatistics->recordOutput(m_pPlugin, pMeasurement.data(), iStart, PipelineStatistics::now());
 }
 
 }//Namespace
@@ -92,7 +92,10 @@ SOURCES += \
     Management/pluginconnectorconnection.cpp \
     Management/pluginconnectorconnectionwidget.cpp \
     Management/pluginscenemanager.cpp \
-    Management/displaymanager.cpp
+    Management/displaymanager.cpp \
+    Management/latencyhistogram.cpp \
+    Management/pipelinestatistics.cpp \
+    Management/pipelinestatisticswidget.cpp
 
 HEADERS += \
     scshared_global.h \
@@ -109,7 +112,10 @@ HEADERS += \
     Management/pluginconnectorconnection.h \
     Management/pluginconnectorconnectionwidget.h \
     Management/pluginscenemanager.h \
-    Management/displaymanager.h
+    Management/displaymanager.h \
+    Management/latencyhistogram.h \
+    Management/pipelinestatistics.h \
+    Management/pipelinestatisticswidget.h
 
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
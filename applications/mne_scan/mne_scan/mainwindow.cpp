@@ -41,6 +41,8 @@
 #include <scShared/Management/pluginmanager.h>
 #include <scShared/Management/pluginscenemanager.h>
 #include <scShared/Management/displaymanager.h>
+#include <scShared/Management/pipelinestatistics.h>
+#include <scShared/Management/pipelinestatisticswidget.h>
 
 //GUI
 #include "mainwindow.h"
@@ -123,6 +125,7 @@ MainWindow::MainWindow(QWidget *parent)
     createToolBars();
     createPluginDockWindow();
     createLogDockWindow();
+    createStatisticsDockWindow();
 
 //    //ToDo Debug Startup
 //    writeToLog(tr("Test normal message, Max"), _LogKndMessage, _LogLvMax);
@@ -585,6 +588,25 @@ void MainWindow::createLogDockWindow()
 }
 
 
+//*************************************************************************************************************
+
+void MainWindow::createStatisticsDockWindow()
+{
+    m_pDockWidget_Statistics = new QDockWidget(tr("Pipeline Statistics"), this);
+
+    m_pPipelineStatisticsWidget = new SCSHAREDLIB::PipelineStatisticsWidget(m_pDockWidget_Statistics);
+
+    m_pDockWidget_Statistics->setWidget(m_pPipelineStatisticsWidget);
+
+    m_pDockWidget_Statistics->setAllowedAreas(Qt::BottomDockWidgetArea | Qt::RightDockWidgetArea);
+    addDockWidget(Qt::BottomDockWidgetArea, m_pDockWidget_Statistics);
+
+    m_pDockWidget_Statistics->hide();
+
+    m_pMenuView->addAction(m_pDockWidget_Statistics->toggleViewAction());
+}
+
+
 //*************************************************************************************************************
 //Plugin stuff
 void MainWindow::updatePluginWidget(SCSHAREDLIB::IPlugin::SPtr pPlugin)
@@ -688,6 +710,8 @@ void MainWindow::startMeasurement()
 {
     writeToLog(tr("Starting real-time measurement..."), _LogKndMessage, _LogLvMin);
 
+    SCSHAREDLIB::PipelineStatistics::instance()->reset();
+
     if(!m_pPluginSceneManager->startPlugins())
     {
         QMessageBox::information(0, tr("MNE Scan - Start"), QString(QObject::tr("Not able to start at least one sensor plugin!")), QMessageBox::Ok);
@@ -82,6 +82,7 @@ class PluginManager;
 class PluginSceneManager;
 class PluginConnectorConnection;
 class DisplayManager;
+class PipelineStatisticsWidget;
 }
 
 
@@ -245,6 +246,7 @@ private:
 
     void createPluginDockWindow();                          /**< Creates plugin dock widget.*/
     void createLogDockWindow();                             /**< Creates log dock widget.*/
+    void createStatisticsDockWindow();                      /**< Creates pipeline statistics dock widget.*/
 
     //Plugin Management
     QDockWidget*                        m_pPluginGuiDockWidget;         /**< Dock widget which holds the plugin gui. */
@@ -256,6 +258,10 @@ private:
     QDockWidget*                        m_pDockWidget_Log;              /**< Holds the dock widget containing the log.*/
     QTextBrowser*                       m_pTextBrowser_Log;             /**< Holds the text browser for the log.*/
 
+    //Pipeline statistics
+    QDockWidget*                                m_pDockWidget_Statistics;       /**< Holds the dock widget containing the pipeline statistics.*/
+    SCSHAREDLIB::PipelineStatisticsWidget*      m_pPipelineStatisticsWidget;    /**< Holds the pipeline statistics view.*/
+
     LogLevel                            m_eLogLevelCurrent;             /**< Holds the current log level.*/
 
     QSharedPointer<QWidget>             m_pAboutWindow;                 /**< Holds the widget containing the about information.*/
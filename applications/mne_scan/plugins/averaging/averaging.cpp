@@ -48,6 +48,8 @@
 #include <scMeas/realtimeevokedset.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 
+#include <scShared/Management/pipelinestatistics.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -91,7 +93,7 @@ using namespace RTPROCESSINGLIB;
 Averaging::Averaging()
 : m_pAveragingInput(NULL)
 //, m_pAveragingOutput(NULL)
-, m_pAveragingBuffer(CircularMatrixBuffer<double>::SPtr())
+, m_pAveragingBuffer(MatrixBlockBuffer::SPtr())
 , m_bIsRunning(false)
 , m_bProcessData(false)
 , m_iPreStimSeconds(100)
@@ -255,6 +257,14 @@ QWidget* Averaging::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int Averaging::getQueueDepth() const
+{
+    return m_pAveragingBuffer ? (int)m_pAveragingBuffer->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void Averaging::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
@@ -264,7 +274,7 @@ void Averaging::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(pRTMSA) {
         //Check if buffer initialized
         if(!m_pAveragingBuffer) {
-            m_pAveragingBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pAveragingBuffer = MatrixBlockBuffer::SPtr(new MatrixBlockBuffer(64));
         }
 
         //Fiff information
@@ -287,11 +297,12 @@ void Averaging::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
         if(m_bProcessData)
         {
-            for(qint32 i = 0; i < pRTMSA->getMultiSampleArray().size(); ++i)
+            const QList<MatrixBlock>& t_qListBlocks = pRTMSA->getMultiSampleArrayBlocks();
+            for(qint32 i = 0; i < t_qListBlocks.size(); ++i)
             {
-                MatrixXd t_mat = pRTMSA->getMultiSampleArray()[i];
-
 #ifdef DEBUG_AVERAGING
+                MatrixXd t_mat = *t_qListBlocks[i];
+
                 qsrand(time(NULL)+m_iTestCount);
 
                 t_mat = MatrixXd::Zero(t_mat.rows(), t_mat.cols());
@@ -310,8 +321,11 @@ void Averaging::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
                     ++m_iTestCount2;
                 }
                 ++m_iTestCount;
+
+                m_pAveragingBuffer->push(MatrixBlock(QSharedPointer<const MatrixXd>(new MatrixXd(t_mat)), t_qListBlocks[i].getTimestamp(), t_qListBlocks[i].getSequenceNumber()));
+#else
+                m_pAveragingBuffer->push(t_qListBlocks[i]);
 #endif
-                m_pAveragingBuffer->push(&t_mat);
             }
         }
     }
@@ -362,7 +376,7 @@ void Averaging::init()
 
     //Delete Buffer - will be initialized with first incoming data
     if(!m_pAveragingBuffer.isNull())
-        m_pAveragingBuffer = CircularMatrixBuffer<double>::SPtr();
+        m_pAveragingBuffer = MatrixBlockBuffer::SPtr();
 }
 
 
@@ -634,9 +648,15 @@ void Averaging::run()
         if(doProcessing)
         {
             /* Dispatch the inputs */
-            MatrixXd rawSegment = m_pAveragingBuffer->pop();
+            MatrixBlock rawSegment = m_pAveragingBuffer->pop();
+            if(!rawSegment)
+                continue;
+
+            qint64 iStart = PipelineStatistics::now();
+
+            m_pRtAve->append(*rawSegment);
 
-            m_pRtAve->append(rawSegment);
+            PipelineStatistics::instance()->recordProcessing(this, rawSegment, iStart, PipelineStatistics::now());
 
             m_qMutex.lock();
             if(m_qVecEvokedData.size() > 0)
@@ -45,8 +45,8 @@
 #include "averaging_global.h"
 
 #include <scShared/Interfaces/IAlgorithm.h>
-#include <generics/circularmatrixbuffer.h>
 #include <rtProcessing/rtave.h>
+#include <scMeas/matrixblockbuffer.h>
 
 
 //*************************************************************************************************************
@@ -136,6 +136,7 @@ public:
     virtual SCSHAREDLIB::IPlugin::PluginType getType() const;
     virtual QString getName() const;
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
     void update(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
 
     //=========================================================================================================
@@ -195,7 +196,7 @@ private:
     SCSHAREDLIB::PluginInputData<SCMEASLIB::NewRealTimeMultiSampleArray>::SPtr  m_pAveragingInput;      /**< The RealTimeSampleArray of the Averaging input.*/
     SCSHAREDLIB::PluginOutputData<SCMEASLIB::RealTimeEvokedSet>::SPtr           m_pAveragingOutput;     /**< The RealTimeEvoked of the Averaging output.*/
 
-    IOBUFFER::CircularMatrixBuffer<double>::SPtr    m_pAveragingBuffer;             /**< Holds incoming data.*/
+    SCMEASLIB::MatrixBlockBuffer::SPtr              m_pAveragingBuffer;             /**< Holds incoming data blocks.*/
 
     QSharedPointer<AveragingSettingsWidget>         m_pAveragingWidget;
 
@@ -726,6 +726,14 @@ QWidget* BabyMEG::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int BabyMEG::getQueueDepth() const
+{
+    return m_pRawMatrixBuffer ? (int)m_pRawMatrixBuffer->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void BabyMEG::run()
@@ -739,7 +747,7 @@ void BabyMEG::run()
         if(m_pRawMatrixBuffer)
         {
             //pop matrix
-            matValue = m_pRawMatrixBuffer->pop();
+            m_pRawMatrixBuffer->popInto(matValue);
 
             //create digital trigger information
             //QElapsedTimer time;
@@ -241,6 +241,14 @@ public:
     */
     virtual QWidget* setupWidget();
 
+    //=========================================================================================================
+    /**
+    * Returns the number of data blocks which wait in the buffer of the plugin.
+    *
+    * @return the number of waiting blocks.
+    */
+    virtual int getQueueDepth() const;
+
     //=========================================================================================================
     /**
     * Sets the Fiff Info.
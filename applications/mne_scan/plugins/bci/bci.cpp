@@ -349,6 +349,20 @@ QWidget* BCI::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int BCI::getQueueDepth() const
+{
+    int iQueueDepth = 0;
+    if(m_pBCIBuffer_Sensor)
+        iQueueDepth += m_pBCIBuffer_Sensor->count();
+    if(m_pBCIBuffer_Source)
+        iQueueDepth += m_pBCIBuffer_Source->count();
+
+    return iQueueDepth;
+}
+
+
 //*************************************************************************************************************
 
 void BCI::updateSensor(XMEASLIB::NewMeasurement::SPtr pMeasurement)
@@ -157,6 +157,7 @@ public:
     virtual QString getName() const;
 
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
 protected:
     /**
@@ -409,6 +409,14 @@ QWidget* BrainAMP::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int BrainAMP::getQueueDepth() const
+{
+    return m_pRawMatrixBuffer_In ? (int)m_pRawMatrixBuffer_In->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void BrainAMP::onUpdateCardinalPoints(const QString& sLPA, double dLPA, const QString& sRPA, double dRPA, const QString& sNasion, double dNasion)
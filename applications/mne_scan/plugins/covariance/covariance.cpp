@@ -72,7 +72,7 @@ Covariance::Covariance()
 , m_bProcessData(false)
 , m_pCovarianceInput(NULL)
 , m_pCovarianceOutput(NULL)
-, m_pCovarianceBuffer(CircularMatrixBuffer<double>::SPtr())
+, m_pCovarianceBuffer(MatrixBlockBuffer::SPtr())
 , m_iEstimationSamples(5000)
 {
     m_pActionShowAdjustment = new QAction(QIcon(":/images/covadjustments.png"), tr("Covariance Adjustments"),this);
@@ -126,7 +126,7 @@ void Covariance::init()
 
     //Delete Buffer - will be initailzed with first incoming data
     if(!m_pCovarianceBuffer.isNull())
-        m_pCovarianceBuffer = CircularMatrixBuffer<double>::SPtr();
+        m_pCovarianceBuffer = MatrixBlockBuffer::SPtr();
 }
 
 
@@ -209,6 +209,14 @@ QWidget* Covariance::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int Covariance::getQueueDepth() const
+{
+    return m_pCovarianceBuffer ? (int)m_pCovarianceBuffer->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void Covariance::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
@@ -219,7 +227,7 @@ void Covariance::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     {
         //Check if buffer initialized
         if(!m_pCovarianceBuffer)
-            m_pCovarianceBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pCovarianceBuffer = MatrixBlockBuffer::SPtr(new MatrixBlockBuffer(64));
 
         //Fiff information
         if(!m_pFiffInfo)
@@ -231,13 +239,9 @@ void Covariance::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
         if(m_bProcessData)
         {
-            MatrixXd t_mat;
-
-            for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i)
-            {
-                t_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pCovarianceBuffer->push(&t_mat);
-            }
+            const QList<MatrixBlock>& t_qListBlocks = pRTMSA->getMultiSampleArrayBlocks();
+            for(qint32 i = 0; i < t_qListBlocks.size(); ++i)
+                m_pCovarianceBuffer->push(t_qListBlocks[i]);
         }
     }
 }
@@ -299,10 +303,12 @@ void Covariance::run()
         if(m_bProcessData)
         {
             /* Dispatch the inputs */
-            MatrixXd t_mat = m_pCovarianceBuffer->pop();
+            MatrixBlock t_block = m_pCovarianceBuffer->pop();
+            if(!t_block)
+                continue;
 
             //Add to covariance estimation
-            m_pRtCov->append(t_mat);
+            m_pRtCov->append(*t_block);
 
             if(m_qVecCovData.size() > 0)
             {
@@ -45,7 +45,7 @@
 #include "covariance_global.h"
 
 #include <scShared/Interfaces/IAlgorithm.h>
-#include <generics/circularmatrixbuffer.h>
+#include <scMeas/matrixblockbuffer.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 #include <scMeas/realtimecov.h>
 #include <rtProcessing/rtcov.h>
@@ -151,6 +151,7 @@ public:
     virtual QString getName() const;
 
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
     void update(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
 
@@ -178,7 +179,7 @@ private:
 
     FiffInfo::SPtr  m_pFiffInfo;                                /**< Fiff measurement info.*/
 
-    CircularMatrixBuffer<double>::SPtr   m_pCovarianceBuffer;   /**< Holds incoming data.*/
+    MatrixBlockBuffer::SPtr              m_pCovarianceBuffer;   /**< Holds incoming data blocks.*/
 
     RtCov::SPtr m_pRtCov;                       /**< Real-time covariance. */
 
@@ -49,7 +49,6 @@
 using namespace DummyToolboxPlugin;
 using namespace SCSHAREDLIB;
 using namespace SCMEASLIB;
-using namespace IOBUFFER;
 
 
 //*************************************************************************************************************
@@ -61,7 +60,7 @@ DummyToolbox::DummyToolbox()
 : m_bIsRunning(false)
 , m_pDummyInput(NULL)
 , m_pDummyOutput(NULL)
-, m_pDummyBuffer(CircularMatrixBuffer<double>::SPtr())
+, m_pDummyBuffer(MatrixBlockBuffer::SPtr())
 {
     //Add action which will be visible in the plugin's toolbar
     m_pActionShowYourWidget = new QAction(QIcon(":/images/options.png"), tr("Your Toolbar Widget"),this);
@@ -107,7 +106,7 @@ void DummyToolbox::init()
 
     //Delete Buffer - will be initailzed with first incoming data
     if(!m_pDummyBuffer.isNull())
-        m_pDummyBuffer = CircularMatrixBuffer<double>::SPtr();
+        m_pDummyBuffer = MatrixBlockBuffer::SPtr();
 }
 
 
@@ -176,6 +175,14 @@ QWidget* DummyToolbox::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int DummyToolbox::getQueueDepth() const
+{
+    return m_pDummyBuffer ? (int)m_pDummyBuffer->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void DummyToolbox::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
@@ -185,7 +192,7 @@ void DummyToolbox::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(pRTMSA) {
         //Check if buffer initialized
         if(!m_pDummyBuffer) {
-            m_pDummyBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pDummyBuffer = MatrixBlockBuffer::SPtr(new MatrixBlockBuffer(64));
         }
 
         //Fiff information
@@ -198,11 +205,9 @@ void DummyToolbox::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
             m_pDummyOutput->data()->setVisibility(true);
         }
 
-        MatrixXd t_mat;
-
-        for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = pRTMSA->getMultiSampleArray()[i];
-            m_pDummyBuffer->push(&t_mat);
+        const QList<MatrixBlock>& t_qListBlocks = pRTMSA->getMultiSampleArrayBlocks();
+        for(qint32 i = 0; i < t_qListBlocks.size(); ++i) {
+            m_pDummyBuffer->push(t_qListBlocks[i]);
         }
     }
 }
@@ -222,13 +227,15 @@ void DummyToolbox::run()
     while(m_bIsRunning)
     {
         //Dispatch the inputs
-        MatrixXd t_mat = m_pDummyBuffer->pop();
+        MatrixBlock t_block = m_pDummyBuffer->pop();
+        if(!t_block)
+            continue;
 
         //ToDo: Implement your algorithm here
 
         //Send the data to the connected plugins and the online display
         //Unocmment this if you also uncommented the m_pDummyOutput in the constructor above
-        m_pDummyOutput->data()->setValue(t_mat);
+        m_pDummyOutput->data()->setValue(*t_block);
     }
 }
 
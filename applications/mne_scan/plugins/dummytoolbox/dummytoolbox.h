@@ -45,7 +45,7 @@
 #include "dummytoolbox_global.h"
 
 #include <scShared/Interfaces/IAlgorithm.h>
-#include <generics/circularmatrixbuffer.h>
+#include <scMeas/matrixblockbuffer.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 #include "FormFiles/dummysetupwidget.h"
 #include "FormFiles/dummyyourwidget.h"
@@ -122,6 +122,7 @@ public:
     virtual IPlugin::PluginType getType() const;
     virtual QString getName() const;
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
     //=========================================================================================================
     /**
@@ -147,7 +148,7 @@ private:
     QSharedPointer<DummyYourWidget>                 m_pYourWidget;          /**< flag whether thread is running.*/
     QAction*                                        m_pActionShowYourWidget;/**< flag whether thread is running.*/
 
-    IOBUFFER::CircularMatrixBuffer<double>::SPtr    m_pDummyBuffer;         /**< Holds incoming data.*/
+    SCMEASLIB::MatrixBlockBuffer::SPtr              m_pDummyBuffer;         /**< Holds incoming data blocks.*/
 
     PluginInputData<SCMEASLIB::NewRealTimeMultiSampleArray>::SPtr      m_pDummyInput;      /**< The NewRealTimeMultiSampleArray of the DummyToolbox input.*/
     PluginOutputData<SCMEASLIB::NewRealTimeMultiSampleArray>::SPtr     m_pDummyOutput;     /**< The NewRealTimeMultiSampleArray of the DummyToolbox output.*/
@@ -614,6 +614,14 @@ QWidget* EEGoSports::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int EEGoSports::getQueueDepth() const
+{
+    return m_pRawMatrixBuffer_In ? (int)m_pRawMatrixBuffer_In->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void EEGoSports::onUpdateCardinalPoints(const QString& sLPA, double dLPA, const QString& sRPA, double dRPA, const QString& sNasion, double dNasion)
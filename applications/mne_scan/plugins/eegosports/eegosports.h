@@ -191,6 +191,7 @@ public:
     virtual QString getName() const;
 
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
 protected slots:
     //=========================================================================================================
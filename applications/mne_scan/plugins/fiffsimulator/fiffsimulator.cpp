@@ -388,6 +388,14 @@ QWidget* FiffSimulator::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int FiffSimulator::getQueueDepth() const
+{
+    return m_pRawMatrixBuffer_In ? (int)m_pRawMatrixBuffer_In->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void FiffSimulator::run()
@@ -401,7 +409,7 @@ void FiffSimulator::run()
                 break;
         }
         //pop matrix
-        matValue = m_pRawMatrixBuffer_In->pop();
+        m_pRawMatrixBuffer_In->popInto(matValue);
 
         //emit values
         m_pRTMSA_FiffSimulator->data()->setValue(matValue.cast<double>());
@@ -166,6 +166,7 @@ public:
     virtual QString getName() const;
 
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
 //slots:
     //=========================================================================================================
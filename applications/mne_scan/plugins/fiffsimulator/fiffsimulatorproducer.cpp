@@ -109,6 +109,11 @@ void FiffSimulatorProducer::connectDataClient(QString p_sRtSeverIP)
             //
             m_pRtDataClient->setClientAlias(m_pFiffSimulator->m_sFiffSimulatorClientAlias); // used in option 2 later on
 
+            //
+            // request native float buffers, older servers keep sending fiff tags
+            //
+            m_pRtDataClient->setDataFormat(FIFFV_MNE_RT_DATA_FORMAT_FLOAT32);
+
             //
             // set new state
             //
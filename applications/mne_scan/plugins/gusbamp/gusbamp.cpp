@@ -331,6 +331,14 @@ QWidget* GUSBAmp::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int GUSBAmp::getQueueDepth() const
+{
+    return m_pRawMatrixBuffer_In ? (int)m_pRawMatrixBuffer_In->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void GUSBAmp::run()
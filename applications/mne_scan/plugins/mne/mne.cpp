@@ -42,6 +42,8 @@
 
 #include "FormFiles/mnesetupwidget.h"
 
+#include <scShared/Management/pipelinestatistics.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -356,6 +358,14 @@ QWidget* MNE::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int MNE::getQueueDepth() const
+{
+    return m_pMatrixDataBuffer ? (int)m_pMatrixDataBuffer->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void MNE::updateRTMSA(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
@@ -365,7 +375,7 @@ void MNE::updateRTMSA(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(pRTMSA && m_bReceiveData) {
         //Check if buffer initialized
         if(!m_pMatrixDataBuffer)
-            m_pMatrixDataBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pMatrixDataBuffer = MatrixBlockBuffer::SPtr(new MatrixBlockBuffer(64));
 
         //Fiff Information of the evoked
         if(!m_pFiffInfoInput) {
@@ -376,12 +386,10 @@ void MNE::updateRTMSA(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
         if(m_bProcessData)
         {
-            for(qint32 i = 0; i < pRTMSA->getMultiSampleArray().size(); ++i)
-            {
-                MatrixXd t_mat = pRTMSA->getMultiSampleArray()[i];
-
-                m_pMatrixDataBuffer->push(&t_mat);
-            }
+            //The blocks are shared with all other consumers of the measurement, no copy is made here
+            const QList<MatrixBlock>& t_qListBlocks = pRTMSA->getMultiSampleArrayBlocks();
+            for(qint32 i = 0; i < t_qListBlocks.size(); ++i)
+                m_pMatrixDataBuffer->push(t_qListBlocks[i]);
         }
     }
 }
@@ -564,19 +572,26 @@ void MNE::run()
             //qDebug()<<"MNE::run - Processing RTMSA data";
             if(m_pMinimumNorm && ((skip_count % m_iDownSample) == 0))
             {
-                MatrixXd rawSegment = m_pMatrixDataBuffer->pop();
+                MatrixBlock rawSegment = m_pMatrixDataBuffer->pop();
+                if(!rawSegment)
+                    continue;
 
                 float tmin = 1 / m_pFiffInfo->sfreq;
                 float tstep = 1 / m_pFiffInfo->sfreq;
 
                 m_qMutex.lock();
 
+                qint64 iStart = PipelineStatistics::now();
+
                 //TODO: Add picking here. See evoked part as input.
-                MNESourceEstimate sourceEstimate = m_pMinimumNorm->calculateInverse(rawSegment, tmin, tstep);
+                bool bSucceeded = m_pMinimumNorm->calculateInverse(*rawSegment, tmin, tstep, m_sourceEstimate);
+
+                PipelineStatistics::instance()->recordProcessing(this, rawSegment, iStart, PipelineStatistics::now());
 
                 m_qMutex.unlock();
 
-                m_pRTSEOutput->data()->setValue(sourceEstimate);
+                if(bSucceeded)
+                    m_pRTSEOutput->data()->setValue(m_sourceEstimate);
             }
             else
             {
@@ -605,11 +620,12 @@ void MNE::run()
 
                 t_fiffEvoked = t_fiffEvoked.pick_channels(m_pInvOp->noise_cov->names);
 
-                MNESourceEstimate sourceEstimate = m_pMinimumNorm->calculateInverse(t_fiffEvoked.data, tmin, tstep);
+                bool bSucceeded = m_pMinimumNorm->calculateInverse(t_fiffEvoked.data, tmin, tstep, m_sourceEstimate);
 
                 m_qMutex.unlock();
 
-                m_pRTSEOutput->data()->setValue(sourceEstimate);
+                if(bSucceeded)
+                    m_pRTSEOutput->data()->setValue(m_sourceEstimate);
             }
             else
             {
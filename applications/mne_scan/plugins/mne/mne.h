@@ -58,6 +58,7 @@
 
 #include <scMeas/realtimesourceestimate.h>
 #include <scMeas/newrealtimemultisamplearray.h>
+#include <scMeas/matrixblockbuffer.h>
 #include <scMeas/realtimecov.h>
 #include <scMeas/realtimeevokedset.h>
 
@@ -160,6 +161,7 @@ public:
     virtual QString getName() const;
 
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
     //=========================================================================================================
     /**
@@ -214,7 +216,7 @@ private:
 
     PluginOutputData<RealTimeSourceEstimate>::SPtr          m_pRTSEOutput;          /**< The RealTimeSourceEstimate output.*/
 
-    CircularMatrixBuffer<double>::SPtr                      m_pMatrixDataBuffer;    /**< Holds incoming RealTimeMultiSampleArray data.*/
+    SCMEASLIB::MatrixBlockBuffer::SPtr                      m_pMatrixDataBuffer;    /**< Holds incoming RealTimeMultiSampleArray data blocks.*/
 
     QMutex m_qMutex;
 
@@ -250,6 +252,7 @@ private:
     MNEInverseOperator::SPtr    m_pInvOp;           /**< The inverse operator. */
 
     MinimumNorm::SPtr           m_pMinimumNorm;     /**< Minimum Norm Estimation. */
+    MNESourceEstimate           m_sourceEstimate;   /**< Source estimate whose buffers are reused by every inverse calculation. */
     qint32                      m_iDownSample;      /**< Sampling rate */
 
     QString                     m_sAvrType;         /**< The average type */
@@ -390,6 +390,14 @@ QWidget* Neuromag::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int Neuromag::getQueueDepth() const
+{
+    return m_pRawMatrixBuffer_In ? (int)m_pRawMatrixBuffer_In->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 bool Neuromag::readHeader()
@@ -442,7 +450,7 @@ void Neuromag::run()
     while(m_bIsRunning)
     {
         //pop matrix
-        matValue = m_pRawMatrixBuffer_In->pop();
+        m_pRawMatrixBuffer_In->popInto(matValue);
 
         //emit values
         m_pRTMSA_Neuromag->data()->setValue(matValue.cast<double>());
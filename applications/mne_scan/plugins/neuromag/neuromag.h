@@ -167,6 +167,7 @@ public:
     virtual QString getName() const;
 
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
 //slots:
     //=========================================================================================================
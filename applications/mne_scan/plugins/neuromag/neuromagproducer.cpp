@@ -102,6 +102,11 @@ void NeuromagProducer::connectDataClient(QString p_sRtSeverIP)
             //
             m_pRtDataClient->setClientAlias(m_pNeuromag->m_sNeuromagClientAlias); // used in option 2 later on
 
+            //
+            // request native float buffers, older servers keep sending fiff tags
+            //
+            m_pRtDataClient->setDataFormat(FIFFV_MNE_RT_DATA_FORMAT_FLOAT32);
+
             //
             // set new state
             //
@@ -70,7 +70,7 @@ NoiseEstimate::NoiseEstimate()
 , m_bProcessData(false)
 , m_pRTMSAInput(NULL)
 , m_pFSOutput(NULL)
-, m_pBuffer(CircularMatrixBuffer<double>::SPtr())
+, m_pBuffer(MatrixBlockBuffer::SPtr())
 , m_Fs(600)
 , m_iFFTlength(16384)
 , m_DataLen(6)
@@ -127,7 +127,7 @@ void NoiseEstimate::init()
 
     //Delete Buffer - will be initailzed with first incoming data
     if(!m_pBuffer.isNull())
-        m_pBuffer = CircularMatrixBuffer<double>::SPtr();
+        m_pBuffer = MatrixBlockBuffer::SPtr();
 
 }
 
@@ -241,6 +241,14 @@ QWidget* NoiseEstimate::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int NoiseEstimate::getQueueDepth() const
+{
+    return m_pBuffer ? (int)m_pBuffer->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void NoiseEstimate::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
@@ -254,7 +262,7 @@ void NoiseEstimate::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
         m_qMutex.lock();
         if(!m_pBuffer)
         {
-            m_pBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pBuffer = MatrixBlockBuffer::SPtr(new MatrixBlockBuffer(8));
         }
 
         //Fiff information
@@ -267,13 +275,9 @@ void NoiseEstimate::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
         if(m_bProcessData)
         {
-            MatrixXd t_mat;
-
-            for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i)
-            {
-                t_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pBuffer->push(&t_mat);
-            }
+            const QList<MatrixBlock>& t_qListBlocks = pRTMSA->getMultiSampleArrayBlocks();
+            for(qint32 i = 0; i < t_qListBlocks.size(); ++i)
+                m_pBuffer->push(t_qListBlocks[i]);
         }
     }
 }
@@ -338,21 +342,28 @@ void NoiseEstimate::run()
         if(m_bProcessData)
         {
             /* Dispatch the inputs */
-            MatrixXd t_mat = m_pBuffer->pop();
+            MatrixBlock t_block = m_pBuffer->pop();
+            if(!t_block)
+                continue;
 
-            //ToDo: Implement your algorithm here
-            m_pRtNoise->append(t_mat);
+            m_pRtNoise->append(*t_block);
 
-           if(m_qVecSpecData.size() > 0)
-           {
-               m_qMutex.lock();
-               qDebug()<<"%%%%%%%%%%%%%%%% send spectrum for display %%%%%%%%%%%%%%%%%%%";
-                //send spectrum to the output data
-               m_pFSOutput->data()->setValue(m_qVecSpecData[0]);
-               m_qVecSpecData.pop_front();
-               m_qMutex.unlock();
+            //only the latest spectrum is displayed, older ones queued in the meantime are dropped
+            bool bNewSpectrum = false;
+            MatrixXd t_matSpec;
 
+            m_qMutex.lock();
+            if(!m_qVecSpecData.isEmpty())
+            {
+                t_matSpec = m_qVecSpecData.last();
+                m_qVecSpecData.clear();
+                bNewSpectrum = true;
             }
+            m_qMutex.unlock();
+
+            //send spectrum to the output data
+            if(bNewSpectrum)
+                m_pFSOutput->data()->setValue(t_matSpec);
         }//m_bProcessData
     }//m_bIsRunning
     qDebug()<<"noise estimation [Run] is done!";
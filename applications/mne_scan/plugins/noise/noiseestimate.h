@@ -46,7 +46,7 @@
 #include "noiseestimate_global.h"
 
 #include <scShared/Interfaces/IAlgorithm.h>
-#include <generics/circularmatrixbuffer.h>
+#include <scMeas/matrixblockbuffer.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 #include <scMeas/frequencyspectrum.h>
 #include <rtProcessing/rtnoise.h>
@@ -156,6 +156,7 @@ public:
     virtual QString getName() const;
 
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
     void update(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
 
@@ -193,7 +194,7 @@ private:
 
     FiffInfo::SPtr  m_pFiffInfo;                        /**< Fiff measurement info.*/
 
-    CircularMatrixBuffer<double>::SPtr   m_pBuffer;     /**< Holds incoming data.*/
+    MatrixBlockBuffer::SPtr              m_pBuffer;     /**< Holds incoming data blocks.*/
 
     RtNoise::SPtr m_pRtNoise;                       /**< Real-time Noise Estimation. */
     //RtNoise * m_pRtNoise;                       /**< Real-time Noise Estimation. */
@@ -50,7 +50,6 @@ using namespace NoiseReductionPlugin;
 using namespace SCSHAREDLIB;
 using namespace SCMEASLIB;
 using namespace UTILSLIB;
-using namespace IOBUFFER;
 using namespace Eigen;
 using namespace DISPLIB;
 using namespace RTPROCESSINGLIB;
@@ -65,7 +64,7 @@ NoiseReduction::NoiseReduction()
 : m_bIsRunning(false)
 , m_pNoiseReductionInput(NULL)
 , m_pNoiseReductionOutput(NULL)
-, m_pNoiseReductionBuffer(CircularMatrixBuffer<double>::SPtr())
+, m_pNoiseReductionBuffer(MatrixBlockBuffer::SPtr())
 , m_iMaxFilterTapSize(0)
 , m_bSpharaActive(false)
 , m_bFilterActivated(false)
@@ -162,7 +161,7 @@ void NoiseReduction::init()
 
     //Delete Buffer - will be initailzed with first incoming data
     if(!m_pNoiseReductionBuffer.isNull())
-        m_pNoiseReductionBuffer = CircularMatrixBuffer<double>::SPtr();
+        m_pNoiseReductionBuffer = MatrixBlockBuffer::SPtr();
 
     //Handle projections
     connect(m_pOptionsWidget.data(), &NoiseReductionOptionsWidget::projSelectionChanged,
@@ -239,6 +238,14 @@ QWidget* NoiseReduction::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int NoiseReduction::getQueueDepth() const
+{
+    return m_pNoiseReductionBuffer ? (int)m_pNoiseReductionBuffer->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void NoiseReduction::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
@@ -250,7 +257,7 @@ void NoiseReduction::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(m_pRTMSA) {
         //Check if buffer initialized
         if(!m_pNoiseReductionBuffer) {
-            m_pNoiseReductionBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, m_pRTMSA->getNumChannels(), m_pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pNoiseReductionBuffer = MatrixBlockBuffer::SPtr(new MatrixBlockBuffer(64));
         }
 
         //Fiff information
@@ -260,16 +267,16 @@ void NoiseReduction::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
             //Init the multiplication matrices
             m_matSparseProjMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
             m_matSparseCompMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
-            m_matSparseSpharaMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
             m_matSparseProjCompMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
             m_matSparseFull = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
 
             m_matSparseProjMult.setIdentity();
             m_matSparseCompMult.setIdentity();
-            m_matSparseSpharaMult.setIdentity();
             m_matSparseProjCompMult.setIdentity();
             m_matSparseFull.setIdentity();
 
+            m_pRtSpharaOperator = RtSpharaOperator::SPtr(new RtSpharaOperator(m_pFiffInfo->chs.size()));
+
             m_pOptionsWidget->setFiffInfo(m_pFiffInfo);
 
             //Init output - Unocmment this if you also uncommented the m_pNoiseReductionOutput in the constructor above
@@ -278,15 +285,13 @@ void NoiseReduction::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
             m_pNoiseReductionOutput->data()->setVisibility(true);            
 
             //Init the filter
-            m_iMaxFilterTapSize = m_pRTMSA->getMultiSampleArray().at(m_pRTMSA->getMultiSampleArray().size()-1).cols();
+            m_iMaxFilterTapSize = m_pRTMSA->getMultiSampleArrayBlocks().last()->cols();
             initFilter();
         }
 
-        MatrixXd t_mat;
-
-        for(unsigned char i = 0; i < m_pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = m_pRTMSA->getMultiSampleArray()[i];
-            m_pNoiseReductionBuffer->push(&t_mat);
+        const QList<MatrixBlock>& t_qListBlocks = m_pRTMSA->getMultiSampleArrayBlocks();
+        for(qint32 i = 0; i < t_qListBlocks.size(); ++i) {
+            m_pNoiseReductionBuffer->push(t_qListBlocks[i]);
         }
     }
 }
@@ -389,6 +394,8 @@ void NoiseReduction::updateProjection()
         m_matSparseProjCompMult = m_matSparseProjMult * m_matSparseCompMult;
 
         m_matSparseFull = m_matSparseProjMult * m_matSparseCompMult;
+
+        updateSpharaPreOperator();
         m_mutex.unlock();
     }
 }
@@ -448,6 +455,8 @@ void NoiseReduction::updateCompensator(int to)
         m_matSparseProjCompMult = m_matSparseProjMult * m_matSparseCompMult;
 
         m_matSparseFull = m_matSparseProjMult * m_matSparseCompMult;
+
+        updateSpharaPreOperator();
     }
 }
 
@@ -561,6 +570,14 @@ void NoiseReduction::initSphara()
         }
     }
 
+    //Register the basis functions, the operators are built and cached on demand
+    if(m_pRtSpharaOperator) {
+        m_pRtSpharaOperator->addBaseFunctions("VectorView", m_matSpharaVVGradLoaded, m_vecIndicesFirstVV, 1); //GRADIOMETERS
+        m_pRtSpharaOperator->addBaseFunctions("VectorView", m_matSpharaVVMagLoaded, m_vecIndicesSecondVV, 0); //Magnetometers
+        m_pRtSpharaOperator->addBaseFunctions("BabyMEG", m_matSpharaBabyMEGInnerLoaded, m_vecIndicesFirstBabyMEG, 0); //InnerLayer
+        m_pRtSpharaOperator->addBaseFunctions("EEG", m_matSpharaEEGLoaded, m_vecIndicesFirstEEG, 0);
+    }
+
 //    qDebug()<<"NoiseReduction::createSpharaOperator - Read VectorView mag matrix "<<m_matSpharaVVMagLoaded.rows()<<m_matSpharaVVMagLoaded.cols()<<"and grad matrix"<<m_matSpharaVVGradLoaded.rows()<<m_matSpharaVVGradLoaded.cols();
 //    qDebug()<<"NoiseReduction::createSpharaOperator - Read BabyMEG inner layer matrix "<<m_matSpharaBabyMEGInnerLoaded.rows()<<m_matSpharaBabyMEGInnerLoaded.cols()<<"and outer layer matrix"<<m_matSpharaBabyMEGOuterFull.rows()<<m_matSpharaBabyMEGOuterFull.cols();
 }
@@ -638,77 +655,35 @@ void NoiseReduction::createSpharaOperator()
 
     m_mutex.lock();
 
-    MatrixXd matSpharaMultFirst = MatrixXd::Identity(m_pFiffInfo->chs.size(), m_pFiffInfo->chs.size());
-    MatrixXd matSpharaMultSecond = MatrixXd::Identity(m_pFiffInfo->chs.size(), m_pFiffInfo->chs.size());
-
-    if(m_sCurrentSystem == "VectorView") {
-        matSpharaMultFirst = Sphara::makeSpharaProjector(m_matSpharaVVGradLoaded, m_vecIndicesFirstVV, m_pFiffInfo->nchan, m_iNBaseFctsFirst, 1); //GRADIOMETERS
-        matSpharaMultSecond = Sphara::makeSpharaProjector(m_matSpharaVVMagLoaded, m_vecIndicesSecondVV, m_pFiffInfo->nchan, m_iNBaseFctsSecond, 0); //Magnetometers
+    if(m_pRtSpharaOperator) {
+        //Only the base function factors are kept, they are reused when switching back to an earlier setting
+        m_pRtSpharaOperator->setSystem(m_sCurrentSystem, m_iNBaseFctsFirst, m_iNBaseFctsSecond);
+        updateSpharaPreOperator();
     }
 
-    if(m_sCurrentSystem == "BabyMEG") {
-        matSpharaMultFirst = Sphara::makeSpharaProjector(m_matSpharaBabyMEGInnerLoaded, m_vecIndicesFirstBabyMEG, m_pFiffInfo->nchan, m_iNBaseFctsFirst, 0); //InnerLayer
-    }
-
-    if(m_sCurrentSystem == "EEG") {
-        matSpharaMultFirst = Sphara::makeSpharaProjector(m_matSpharaEEGLoaded, m_vecIndicesFirstEEG, m_pFiffInfo->nchan, m_iNBaseFctsFirst, 0); //InnerLayer
-    }
-
-    //Write final operator matrices to file
-//    IOUtils::write_eigen_matrix(matSpharaMultFirst, QString(QCoreApplication::applicationDirPath() + "/mne_scan_plugins/resources/noisereduction/SPHARA/matSpharaMultFirst.txt"));
-//    IOUtils::write_eigen_matrix(matSpharaMultSecond, QString(QCoreApplication::applicationDirPath() + "/mne_scan_plugins/resources/noisereduction/SPHARA/matSpharaMultSecond.txt"));
-
-    //
-    // Make operators sparse
-    //
-    qint32 nchan = this->m_pFiffInfo->nchan;
-    qint32 i, k;
-
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(nchan);
-
-    //First operator
-    tripletList.clear();
-    tripletList.reserve(matSpharaMultFirst.rows()*matSpharaMultFirst.cols());
-    for(i = 0; i < matSpharaMultFirst.rows(); ++i) {
-        for(k = 0; k < matSpharaMultFirst.cols(); ++k) {
-            if(matSpharaMultFirst(i,k) != 0) {
-                tripletList.push_back(T(i, k, matSpharaMultFirst(i,k)));
-            }
-        }
-    }
+    m_matSparseFull = m_matSparseProjMult * m_matSparseCompMult;
 
-    SparseMatrix<double> matSparseSpharaMultFirst = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
+    m_mutex.unlock();
+}
 
-    if(tripletList.size() > 0) {
-        matSparseSpharaMultFirst.setFromTriplets(tripletList.begin(), tripletList.end());
-    }
 
-    //Second operator
-    tripletList.clear();
-    tripletList.reserve(matSpharaMultSecond.rows()*matSpharaMultSecond.cols());
+//*************************************************************************************************************
 
-    for(i = 0; i < matSpharaMultSecond.rows(); ++i) {
-        for(k = 0; k < matSpharaMultSecond.cols(); ++k) {
-            if(matSpharaMultSecond(i,k) != 0) {
-                tripletList.push_back(T(i, k, matSpharaMultSecond(i,k)));
-            }
-        }
+void NoiseReduction::updateSpharaPreOperator()
+{
+    if(!m_pRtSpharaOperator) {
+        return;
     }
 
-    SparseMatrix<double>matSparseSpharaMultSecond = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
-
-    if(tripletList.size() > 0) {
-        matSparseSpharaMultSecond.setFromTriplets(tripletList.begin(), tripletList.end());
+    if(m_bCompActivated) {
+        m_pRtSpharaOperator->setPreOperator(m_bProjActivated ? m_matSparseProjCompMult : m_matSparseCompMult);
+    } else if(m_bProjActivated) {
+        m_pRtSpharaOperator->setPreOperator(m_matSparseProjMult);
+    } else {
+        SparseMatrix<double> matSparseIdentity(m_pRtSpharaOperator->getNumChannels(), m_pRtSpharaOperator->getNumChannels());
+        matSparseIdentity.setIdentity();
+        m_pRtSpharaOperator->setPreOperator(matSparseIdentity);
     }
-
-    //Create full multiplication matrix
-    m_matSparseSpharaMult = matSparseSpharaMultFirst * matSparseSpharaMultSecond;
-
-    m_matSparseFull = m_matSparseProjMult * m_matSparseCompMult;
-
-    m_mutex.unlock();
 }
 
 
@@ -733,45 +708,63 @@ void NoiseReduction::run()
     while(m_bIsRunning)
     {
         //Dispatch the inputs
-        MatrixXd t_mat = m_pNoiseReductionBuffer->pop();
+        MatrixBlock t_block = m_pNoiseReductionBuffer->pop();
+        if(!t_block)
+            continue;
+
+        //The data is filtered in place, the shared block is copied once
+        MatrixXd t_mat = *t_block;
 
         m_mutex.lock();
 
-        //Do SSP's and compensators here
-        if(m_bCompActivated) {
-            if(m_bProjActivated) {
-                //Comp + Proj
-                t_mat = m_matSparseProjCompMult * t_mat;
-            } else {
-                //Comp
-                t_mat = m_matSparseCompMult * t_mat;
+        if(m_bSpharaActive) {
+            //Set bad channels to zero so they do not get smeared into
+            QList<int> lBadChannels;
+            for(int i = 0; i < m_pFiffInfo->bads.size(); ++i) {
+                int index = m_pFiffInfo->ch_names.indexOf(m_pFiffInfo->bads.at(i));
+                if(index >= 0) {
+                    lBadChannels << index;
+                }
             }
+
+            m_pRtSpharaOperator->setBadChannels(lBadChannels);
+        }
+
+        if(m_bSpharaActive && !m_bFilterActivated) {
+            //Do SSP's, compensators and SPHARA in one pass
+            m_pRtSpharaOperator->apply(t_mat, t_mat);
         } else {
-            if(m_bProjActivated) {
-                //Proj
-                t_mat = m_matSparseProjMult * t_mat;
+            //Do SSP's and compensators here
+            if(m_bCompActivated) {
+                if(m_bProjActivated) {
+                    //Comp + Proj
+                    t_mat = m_matSparseProjCompMult * t_mat;
+                } else {
+                    //Comp
+                    t_mat = m_matSparseCompMult * t_mat;
+                }
             } else {
-                //None - Raw
+                if(m_bProjActivated) {
+                    //Proj
+                    t_mat = m_matSparseProjMult * t_mat;
+                } else {
+                    //None - Raw
+                }
             }
-        }
 
-        //Do temporal filtering here
-        if(m_bFilterActivated) {
-            t_mat = m_pRtFilter->filterChannelsConcurrently(t_mat, m_iMaxFilterLength, m_lFilterChannelList, m_filterData);
-        }
+            //Do temporal filtering here
+            if(m_bFilterActivated) {
+                t_mat = m_pRtFilter->filterChannelsConcurrently(t_mat, m_iMaxFilterLength, m_lFilterChannelList, m_filterData);
+            }
 
-//        qDebug()<<"t_mat dim:"<<t_mat.rows()<<"x"<<t_mat.cols();
-//        qDebug()<<"m_lFilterChannelList.size():"<<m_lFilterChannelList.size();
-//        qDebug()<<"m_filterData.size():"<<m_filterData.size();
+//            qDebug()<<"t_mat dim:"<<t_mat.rows()<<"x"<<t_mat.cols();
+//            qDebug()<<"m_lFilterChannelList.size():"<<m_lFilterChannelList.size();
+//            qDebug()<<"m_filterData.size():"<<m_filterData.size();
 
-        //Do SPHARA here
-        if(m_bSpharaActive) {
-            //Set bad channels to zero so they do not get smeared into
-            for(int i = 0; i < m_pFiffInfo->bads.size(); ++i) {
-                t_mat.row(m_pFiffInfo->ch_names.indexOf(m_pFiffInfo->bads.at(i))).setZero();
+            //Do SPHARA here
+            if(m_bSpharaActive) {
+                m_pRtSpharaOperator->applySphara(t_mat, t_mat);
             }
-
-            t_mat = m_matSparseSpharaMult * t_mat;
         }
 
 //        //Common average
@@ -52,8 +52,9 @@
 #include <scShared/Interfaces/IAlgorithm.h>
 
 #include <rtProcessing/rtfilter.h>
+#include <rtProcessing/rtspharaoperator.h>
 
-#include <generics/circularmatrixbuffer.h>
+#include <scMeas/matrixblockbuffer.h>
 
 #include <scMeas/newrealtimemultisamplearray.h>
 
@@ -144,6 +145,7 @@ public:
     virtual IPlugin::PluginType getType() const;
     virtual QString getName() const;
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
     //=========================================================================================================
     /**
@@ -249,6 +251,12 @@ protected:
     */
     void createSpharaOperator();
 
+    //=========================================================================================================
+    /**
+    * Hands the currently active SSP and compensator operator to the SPHARA operator. Call with the mutex locked.
+    */
+    void updateSpharaPreOperator();
+
     //=========================================================================================================
     /**
     * IAlgorithm function
@@ -281,7 +289,6 @@ private:
     Eigen::VectorXi                 m_vecIndicesSecondBabyMEG;                  /**< The indices of the channels to pick for the second SPHARA oerpator in case of a BabyMEG system.*/
     Eigen::VectorXi                 m_vecIndicesFirstEEG;                       /**< The indices of the channels to pick for the second SPHARA operator in case of an EEG system.*/
 
-    Eigen::SparseMatrix<double>     m_matSparseSpharaMult;                      /**< The final sparse SPHARA operator .*/
     Eigen::SparseMatrix<double>     m_matSparseProjCompMult;                    /**< The final sparse projection + compensator operator.*/
     Eigen::SparseMatrix<double>     m_matSparseProjMult;                        /**< The final sparse SSP projector */
     Eigen::SparseMatrix<double>     m_matSparseCompMult;                        /**< The final sparse compensator matrix */
@@ -297,13 +304,14 @@ private:
 
     FIFFLIB::FiffInfo::SPtr                         m_pFiffInfo;                /**< Fiff measurement info.*/
 
-    IOBUFFER::CircularMatrixBuffer<double>::SPtr    m_pNoiseReductionBuffer;    /**< Holds incoming data.*/
+    SCMEASLIB::MatrixBlockBuffer::SPtr              m_pNoiseReductionBuffer;    /**< Holds incoming data blocks.*/
 
     NoiseReductionOptionsWidget::SPtr               m_pOptionsWidget;           /**< The noise reduction option widget object.*/
     QAction*                                        m_pActionShowOptionsWidget; /**< The noise reduction option widget action.*/
 
     DISPLIB::FilterWindow::SPtr                     m_pFilterWindow;            /**< Filter window. */
     RTPROCESSINGLIB::RtFilter::SPtr                       m_pRtFilter;                /**< Real time filter object. */
+    RTPROCESSINGLIB::RtSpharaOperator::SPtr               m_pRtSpharaOperator;        /**< The cached low-rank SPHARA operator, combined with SSP and compensators. */
 
     SCMEASLIB::NewRealTimeMultiSampleArray::SPtr     m_pRTMSA;                   /**< the real time multi sample array object. */
 
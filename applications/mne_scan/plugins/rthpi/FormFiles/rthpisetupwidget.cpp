@@ -73,7 +73,10 @@ RtHpiSetupWidget::RtHpiSetupWidget(RtHpi* toolbox, QWidget *parent)
 {
     ui.setupUi(this);
 
+    ui.m_qSpinBox_LocalizationRate->setValue(m_pRtHpi->getLocalizationRate());
+
     connect(ui.m_qPushButton_About, SIGNAL(released()), this, SLOT(showAboutDialog()));
+    connect(ui.m_qSpinBox_LocalizationRate, SIGNAL(valueChanged(int)), this, SLOT(setLocalizationRate(int)));
 //    connect(ui.bn_PolhemusLoadFile, SIGNAL(released()), this, SLOT(bnLoadPolhemusFile()));
 
 }
@@ -96,5 +99,13 @@ void RtHpiSetupWidget::showAboutDialog()
 }
 
 
+//*************************************************************************************************************
+
+void RtHpiSetupWidget::setLocalizationRate(int iRate)
+{
+    m_pRtHpi->setLocalizationRate(iRate);
+}
+
+
 
 
@@ -127,6 +127,14 @@ private slots:
     *
     */
     void showAboutDialog();
+
+    //=========================================================================================================
+    /**
+    * Forwards the number of coil localizations per second to the RtHpi
+    *
+    * @param[in] iRate      The number of localizations per second.
+    */
+    void setLocalizationRate(int iRate);
 //    //=========================================================================================================
 //    /**
 //    * Load a Polhemus file
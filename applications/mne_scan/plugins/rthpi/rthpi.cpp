@@ -77,7 +77,8 @@ RtHpi::RtHpi()
 , m_bProcessData(false)
 , m_pRTMSAInput(NULL)
 , m_pRTMSAOutput(NULL)
-, m_pRtHpiBuffer(CircularMatrixBuffer<double>::SPtr())
+, m_pRtHpiBuffer(MatrixBlockBuffer::SPtr())
+, m_iLocalizationRate(1)
 {
 }
 
@@ -125,7 +126,7 @@ void RtHpi::init()
 
     //Delete Buffer - will be initailzed with first incoming data
     if(!m_pRtHpiBuffer.isNull())
-        m_pRtHpiBuffer = CircularMatrixBuffer<double>::SPtr();
+        m_pRtHpiBuffer = MatrixBlockBuffer::SPtr();
 }
 
 
@@ -214,6 +215,14 @@ QWidget* RtHpi::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int RtHpi::getQueueDepth() const
+{
+    return m_pRtHpiBuffer ? (int)m_pRtHpiBuffer->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void RtHpi::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
@@ -225,7 +234,7 @@ void RtHpi::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
         m_qMutex.lock();
         //Check if buffer initialized
         if(!m_pRtHpiBuffer)
-            m_pRtHpiBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pRtHpiBuffer = MatrixBlockBuffer::SPtr(new MatrixBlockBuffer(8));
 
         //Fiff information
         if(!m_pFiffInfo)
@@ -237,19 +246,32 @@ void RtHpi::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
         m_qMutex.unlock();
         if(m_bProcessData)
         {
-            MatrixXd t_mat;
-
-            for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i)
-            {
-                t_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pRtHpiBuffer->push(&t_mat);
-            }
+            const QList<MatrixBlock>& t_qListBlocks = pRTMSA->getMultiSampleArrayBlocks();
+            for(qint32 i = 0; i < t_qListBlocks.size(); ++i)
+                m_pRtHpiBuffer->push(t_qListBlocks[i]);
         }
     }
 }
 
 
 
+//*************************************************************************************************************
+
+void RtHpi::setLocalizationRate(int iRate)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_iLocalizationRate = iRate > 0 ? iRate : 1;
+}
+
+
+//*************************************************************************************************************
+
+int RtHpi::getLocalizationRate() const
+{
+    return m_iLocalizationRate;
+}
+
+
 //*************************************************************************************************************
 
 void RtHpi::run()
@@ -276,14 +298,19 @@ void RtHpi::run()
 
     m_pRtHPIS = RtHPIS::SPtr(new RtHPIS(m_pFiffInfo));
 
+    m_qMutex.lock();
+    m_pRtHPIS->setLocalizationRate(m_iLocalizationRate);
+    m_qMutex.unlock();
+
     // Start HPI estimation
     m_pRtHPIS->start();
 
 
     while (m_bIsRunning) {
         if(m_bProcessData) {
-            MatrixXd t_mat = m_pRtHpiBuffer->pop();
-            m_pRtHPIS->append(t_mat);
+            MatrixBlock t_block = m_pRtHpiBuffer->pop();
+            if(t_block)
+                m_pRtHPIS->append(*t_block);
         }
         msleep(1);
     }
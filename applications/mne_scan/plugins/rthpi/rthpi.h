@@ -46,7 +46,7 @@
 #include "rthpi_global.h"
 
 #include <scShared/Interfaces/IAlgorithm.h>
-#include <generics/circularmatrixbuffer.h>
+#include <scMeas/matrixblockbuffer.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 #include <rtProcessing/rthpis.h>
 
@@ -160,9 +160,26 @@ public:
     virtual QString getName() const;
 
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
     void update(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
 
+    //=========================================================================================================
+    /**
+    * Sets the number of coil localizations per second. Takes effect with the next start.
+    *
+    * @param[in] iRate      The number of localizations per second.
+    */
+    void setLocalizationRate(int iRate);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of coil localizations per second.
+    *
+    * @return the number of localizations per second.
+    */
+    int getLocalizationRate() const;
+
 
 
 signals:
@@ -188,12 +205,14 @@ private:
 
     FiffInfo::SPtr  m_pFiffInfo;                            /**< Fiff measurement info.*/
 
-    CircularMatrixBuffer<double>::SPtr   m_pRtHpiBuffer;    /**< Holds incoming data.*/
+    MatrixBlockBuffer::SPtr              m_pRtHpiBuffer;    /**< Holds incoming data blocks.*/
 
     bool m_bIsRunning;      /**< If source lab is running */
     bool m_bProcessData;    /**< If data should be received for processing */
     QMutex m_qMutex;       /**< mutex for hpi */
 
+    int m_iLocalizationRate;    /**< Number of coil localizations per second. */
+
     RtHPIS::SPtr m_pRtHPIS;                       /**< Real-time HPI Estimation. */
 
 
@@ -78,6 +78,8 @@ RtSssSetupWidget::RtSssSetupWidget(RtSss* toolbox, QWidget *parent)
     connect(ui.m_qSpinBox_LoutRR, SIGNAL(valueChanged (int)), this, SLOT(setNewLoutRR(int)));
     connect(ui.m_qSpinBox_Lin, SIGNAL(valueChanged (int)), this, SLOT(setNewLin(int)));
     connect(ui.m_qSpinBox_Lout, SIGNAL(valueChanged (int)), this, SLOT(setNewLout(int)));
+    connect(ui.m_qDoubleSpinBox_TSssBuffer, SIGNAL(valueChanged (double)), this, SLOT(setNewTSssBuffer(double)));
+    connect(ui.m_qDoubleSpinBox_TSssCorrLimit, SIGNAL(valueChanged (double)), this, SLOT(setNewTSssCorrLimit(double)));
 }
 
 
@@ -115,6 +117,16 @@ void RtSssSetupWidget::setNewLout(int val)
     emit signalNewLout(val);
 }
 
+void RtSssSetupWidget::setNewTSssBuffer(double val)
+{
+    emit signalNewTSssBuffer(val);
+}
+
+void RtSssSetupWidget::setNewTSssCorrLimit(double val)
+{
+    emit signalNewTSssCorrLimit(val);
+}
+
 
 //*************************************************************************************************************
 
@@ -138,6 +150,16 @@ int RtSssSetupWidget::getLout()
     return ui.m_qSpinBox_Lout->value();
 }
 
+double RtSssSetupWidget::getTSssBuffer()
+{
+    return ui.m_qDoubleSpinBox_TSssBuffer->value();
+}
+
+double RtSssSetupWidget::getTSssCorrLimit()
+{
+    return ui.m_qDoubleSpinBox_TSssCorrLimit->value();
+}
+
 
 //*************************************************************************************************************
 
@@ -109,12 +109,16 @@ public:
     int getLoutRR();
     int getLin();
     int getLout();
+    double getTSssBuffer();
+    double getTSssCorrLimit();
 
 signals:
     void signalNewLinRR(int val);
     void signalNewLoutRR(int val);
     void signalNewLin(int val);
     void signalNewLout(int val);
+    void signalNewTSssBuffer(double val);
+    void signalNewTSssCorrLimit(double val);
 
 private slots:
     //=========================================================================================================
@@ -127,6 +131,8 @@ private slots:
     void setNewLoutRR(int);
     void setNewLin(int);
     void setNewLout(int);
+    void setNewTSssBuffer(double);
+    void setNewTSssCorrLimit(double);
 
 private:
 
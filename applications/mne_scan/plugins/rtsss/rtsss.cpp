@@ -42,6 +42,8 @@
 #include "rtsssalgo.h"
 #include "FormFiles/rtssssetupwidget.h"
 
+#include <rtProcessing/rthpis.h>
+
 //*************************************************************************************************************
 //=============================================================================================================
 // QT INCLUDES
@@ -51,9 +53,12 @@
 #include <QDebug>
 #include <QFuture>
 #include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QSettings>
+#include <QMutex>
 
 RtSssAlgo rsss;
+QMutex rsssMutex;   /**< Guards rsss, the basis is rebuilt in the background. */
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -64,6 +69,7 @@ using namespace RtSssPlugin;
 using namespace FIFFLIB;
 using namespace SCSHAREDLIB;
 using namespace SCMEASLIB;
+using namespace RTPROCESSINGLIB;
 
 
 //*************************************************************************************************************
@@ -79,6 +85,8 @@ RtSss::RtSss()
 , LoutRR(0)
 , Lin(0)
 , Lout(0)
+, m_dTSssBuffer(0.0)
+, m_dTSssCorrLimit(0.98)
 {
 }
 
@@ -112,7 +120,7 @@ void RtSss::init()
 
     //Delete Buffer - will be initailzed with first incoming data
     if(!m_pRtSssBuffer.isNull())
-        m_pRtSssBuffer = CircularMatrixBuffer<double>::SPtr();
+        m_pRtSssBuffer = MatrixBlockBuffer::SPtr();
 
     // Input
     m_pRTMSAInput = PluginInputData<NewRealTimeMultiSampleArray>::create(this, "RtSssIn", "RtSss input data");
@@ -184,6 +192,8 @@ bool RtSss::stop()
 
     m_qMutex.unlock();
 
+    m_futureProjector.waitForFinished();
+
     return true;
 }
 
@@ -216,16 +226,28 @@ QWidget* RtSss::setupWidget()
     connect(widget, &RtSssSetupWidget::signalNewLoutRR, this, &RtSss::setLoutRR);
     connect(widget, &RtSssSetupWidget::signalNewLin, this, &RtSss::setLin);
     connect(widget, &RtSssSetupWidget::signalNewLout, this, &RtSss::setLout);
+    connect(widget, &RtSssSetupWidget::signalNewTSssBuffer, this, &RtSss::setTSssBuffer);
+    connect(widget, &RtSssSetupWidget::signalNewTSssCorrLimit, this, &RtSss::setTSssCorrLimit);
 
     LinRR = widget->getLinRR();
     LoutRR = widget->getLoutRR();
     Lin = widget->getLin();
     Lout = widget->getLout();
+    m_dTSssBuffer = widget->getTSssBuffer();
+    m_dTSssCorrLimit = widget->getTSssCorrLimit();
 
     return widget;
 }
 
 
+//*************************************************************************************************************
+
+int RtSss::getQueueDepth() const
+{
+    return m_pRtSssBuffer ? (int)m_pRtSssBuffer->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void RtSss::setLinRR(int val)
@@ -262,6 +284,22 @@ void RtSss::setLout(int val)
 }
 
 
+//*************************************************************************************************************
+
+void RtSss::setTSssBuffer(double val)
+{
+    m_dTSssBuffer = val;
+}
+
+
+//*************************************************************************************************************
+
+void RtSss::setTSssCorrLimit(double val)
+{
+    m_dTSssCorrLimit = val;
+}
+
+
 //*************************************************************************************************************
 
 void RtSss::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
@@ -274,7 +312,7 @@ void RtSss::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     {
         //Check if buffer initialized
         if(!m_pRtSssBuffer)
-            m_pRtSssBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(32, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pRtSssBuffer = MatrixBlockBuffer::SPtr(new MatrixBlockBuffer(32));
 
         //Fiff information
         if(!m_pFiffInfo)
@@ -282,12 +320,9 @@ void RtSss::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
         if(m_bProcessData)
         {
-            MatrixXd in_mat;
-            for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i)
-            {
-                in_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pRtSssBuffer->push(&in_mat);
-            }
+            const QList<MatrixBlock>& t_qListBlocks = pRTMSA->getMultiSampleArrayBlocks();
+            for(qint32 i = 0; i < t_qListBlocks.size(); ++i)
+                m_pRtSssBuffer->push(t_qListBlocks[i]);
         }
     }
 }
@@ -297,12 +332,39 @@ void RtSss::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
 MatrixXd rt_sss(const MatrixXd &p_mat)
 {
+    QMutexLocker locker(&rsssMutex);
     MatrixXd out;
     out = rsss.getSSSRR(p_mat);
     return out;
 }
 
 
+//*************************************************************************************************************
+
+QList<MatrixXd> rebuild_projector(const Vector3d &origin)
+{
+    // Build into a local copy, the shared object is replaced once the new basis is complete
+    rsssMutex.lock();
+    RtSssAlgo t_rsss = rsss;
+    rsssMutex.unlock();
+
+    t_rsss.setOrigin(origin);
+    MatrixXd lineqn = t_rsss.buildLinearEqn();
+    QList<MatrixXd> eqn = t_rsss.getLinEqn();
+
+    QList<MatrixXd> projectors;
+    MatrixXd matProjectorIn, matProjectorOut;
+    if(RtSssEngine::computeProjectors(eqn[0], eqn[1], lineqn.diagonal(), matProjectorIn, matProjectorOut))
+        projectors << matProjectorIn << matProjectorOut;
+
+    rsssMutex.lock();
+    rsss = t_rsss;
+    rsssMutex.unlock();
+
+    return projectors;
+}
+
+
 //*************************************************************************************************************
 
 void RtSss::run()
@@ -403,33 +465,67 @@ void RtSss::run()
 
     //qDebug() << "..finished !!";
 
+    // The projector is computed once per head position, every block is then cleaned by a single matrix product
+    QList<MatrixXd> eqn = rsss.getLinEqn();
+    if(!m_rtSssEngine.setBasis(eqn[0], eqn[1], lineqn.diagonal()))
+        qWarning() << "RtSss::run - Could not compute the SSS projector, data is passed through.";
+
+    // tSSS window, the output is delayed by one window
+    m_rtSssEngine.setTemporalExtension((int)(m_dTSssBuffer * m_pFiffInfo->sfreq), m_dTSssCorrLimit);
+
+    // The channels which are not cleaned are delayed by the same number of samples
+    int iDelay = m_rtSssEngine.getDelay();
+    MatrixXd matDelay;
+    int iDelayPos = 0;
+
+    // Keep the expansion origin fixed with respect to the head
+    bool bTrackHead = m_pFiffInfo->dev_head_t.from == FIFFV_COORD_DEVICE && m_pFiffInfo->dev_head_t.to == FIFFV_COORD_HEAD;
+    Vector3d vecOriginDevice = rsss.getOrigin();
+    Vector3d vecOriginHead = vecOriginDevice;
+    if(bTrackHead) {
+        Matrix4d matDevHead = RtHPIS::getDevHeadTrans(*m_pFiffInfo);
+        vecOriginHead = matDevHead.topLeftCorner(3,3) * vecOriginDevice + matDevHead.topRightCorner(3,1);
+    }
+    bool bProjectorPending = false;
+
     // start processing data
     m_bProcessData = true;
-    qint32 HEADMOV_COR_cnt = 15 ;
-    qint32 cnt=0;
     //qDebug() << "rtSSS started.....";
 
-    bool m_bIsHeadMov = true;
-
     while(m_bIsRunning)
     {
-//        if (m_bIsHeadMov)
-//        {
-//            lineqn = rsss.buildLinearEqn();
-            //qDebug() << "rebuilt SSS linear equation .....";
-//            m_bIsHeadMov = false;
-//        }
-//        else
-//        {
-//            m_bIsHeadMov = true;
-//        }
+        // Install a projector which was rebuilt in the background, the previous one stays active until then
+        if(bProjectorPending && m_futureProjector.isFinished())
+        {
+            QList<MatrixXd> projectors = m_futureProjector.result();
+            if(projectors.size() == 2 && projectors[0].rows() == nmegchanused)
+                m_rtSssEngine.setProjector(projectors[0], projectors[1]);
+            bProjectorPending = false;
+        }
+
+        // Rebuild the basis when the head moved by more than 2 mm. The head tracking only updates trans.
+        if(bTrackHead && !bProjectorPending)
+        {
+            Matrix4d matHeadDev = RtHPIS::getDevHeadTrans(*m_pFiffInfo).inverse();
+            Vector3d vecOrigin = matHeadDev.topLeftCorner(3,3) * vecOriginHead + matHeadDev.topRightCorner(3,1);
 
-        qint16 nrows = m_pRtSssBuffer->rows();
+            if((vecOrigin - vecOriginDevice).norm() > 0.002)
+            {
+                //qDebug() << "rebuilding SSS linear equation .....";
+                m_futureProjector = QtConcurrent::run(rebuild_projector, vecOrigin);
+                vecOriginDevice = vecOrigin;
+                bProjectorPending = true;
+            }
+        }
 
-        if(nrows > 0) // check if init
+        MatrixBlock in_block;
+        if(m_pRtSssBuffer) // check if init
+            in_block = m_pRtSssBuffer->pop();
+
+        if(in_block)
         {
-            // * Dispatch the inputs * //
-            MatrixXd in_mat = m_pRtSssBuffer->pop();
+            // * Dispatch the inputs, the channels are replaced in place hence the shared block is copied * //
+            MatrixXd in_mat = *in_block;
 //            qDebug() << "size of in_mat (run): " << in_mat.rows() << " x " << in_mat.cols();
 
             //Generate new matrix from picked channels
@@ -449,7 +545,23 @@ void RtSss::run()
 //                }
 //            in_mat_used = in_mat.block(0,0,nmegchanused,in_mat.cols());
 
-           in_mat_used = rt_sss(in_mat_used);
+            MatrixXd in_mat_sss;
+            m_rtSssEngine.apply(in_mat_used, in_mat_sss);
+
+            // Swap the block with the delay line, in_mat then holds the samples from iDelay samples ago
+            if(iDelay > 0) {
+                if(matDelay.rows() != in_mat.rows()) {
+                    matDelay = MatrixXd::Zero(in_mat.rows(), iDelay);
+                    iDelayPos = 0;
+                }
+
+                for(qint32 iOffset = 0; iOffset < in_mat.cols(); ) {
+                    qint32 iNumSamples = qMin((qint32)in_mat.cols() - iOffset, iDelay - iDelayPos);
+                    in_mat.middleCols(iOffset, iNumSamples).swap(matDelay.middleCols(iDelayPos, iNumSamples));
+                    iDelayPos = (iDelayPos + iNumSamples) % iDelay;
+                    iOffset += iNumSamples;
+                }
+            }
 
             // Implement Concurrent mapreduced for parallel processing
             // divide the in_mat_used into 2 or 4 matrices, which renders 50ms or 25ms data
@@ -475,7 +587,7 @@ void RtSss::run()
 
             // Replace raw signal by SSS signal
             for(qint32 i = 0; i < in_mat_used.rows(); ++i) {
-                in_mat.row(pickedChannels(i)) = in_mat_used.row(i);
+                in_mat.row(pickedChannels(i)) = in_mat_sss.row(i);
 //                qDebug() <<    in_mat.row(pickedChannels(i));
             }
 
@@ -487,6 +599,8 @@ void RtSss::run()
         }
     }
 
+    m_futureProjector.waitForFinished();
+
     m_bProcessData = false;
     m_bReceiveData = false;
     //qDebug() << "rtSSS stopped.";
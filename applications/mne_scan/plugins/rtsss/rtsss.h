@@ -46,7 +46,7 @@
 
 #include <scShared/Interfaces/IAlgorithm.h>
 #include <generics/circularbuffer.h>
-#include <generics/circularmatrixbuffer.h>
+#include <scMeas/matrixblockbuffer.h>
 
 #include <scMeas/newrealtimesamplearray.h>
 #include <scMeas/newrealtimemultisamplearray.h>
@@ -55,6 +55,8 @@
 #include <fiff/fiff_info.h>
 #include <fiff/fiff_evoked.h>
 
+#include <rtProcessing/rtsssengine.h>
+
 #include <Eigen/Dense>
 
 //*************************************************************************************************************
@@ -63,6 +65,7 @@
 //=============================================================================================================
 
 #include <QtWidgets>
+#include <QFuture>
 
 
 //*************************************************************************************************************
@@ -83,6 +86,7 @@ using namespace SCSHAREDLIB;
 using namespace FIFFLIB;
 using namespace SCMEASLIB;
 using namespace IOBUFFER;
+using namespace RTPROCESSINGLIB;
 
 
 //*************************************************************************************************************
@@ -144,6 +148,7 @@ public:
     virtual QString getName() const;
 
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
     void update(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
 
@@ -151,6 +156,8 @@ public:
     void setLoutRR(int);
     void setLin(int);
     void setLout(int);
+    void setTSssBuffer(double);
+    void setTSssCorrLimit(double);
 
 protected:
     virtual void run();
@@ -171,10 +178,16 @@ private:
 
     FiffInfo::SPtr              m_pFiffInfo;        /**< Fiff information. */
 
-    CircularMatrixBuffer<double>::SPtr m_pRtSssBuffer;   /**< Holds incoming rt server data.*/
+    MatrixBlockBuffer::SPtr m_pRtSssBuffer;   /**< Holds incoming rt server data blocks.*/
 
     int LinRR, LoutRR, Lin, Lout;
 
+    double m_dTSssBuffer;       /**< Length of the tSSS window in seconds, 0 disables tSSS. The output is delayed by one window. */
+    double m_dTSssCorrLimit;    /**< Subspace correlation limit of tSSS. */
+
+    RtSssEngine m_rtSssEngine;              /**< Applies the SSS/tSSS operator to the incoming blocks. */
+    QFuture<QList<Eigen::MatrixXd> > m_futureProjector;    /**< Internal and external projector which are rebuilt in the background after a head movement. */
+
     QMutex m_qMutex;
 
     //    dBuffer::SPtr   m_pRtSssBuffer;      /**< Holds incoming data.*/
@@ -1053,6 +1053,17 @@ qint32 RtSssAlgo::getNumMEGBadChan()
     return NumBadCoil;
 }
 
+// Set origin of the expansion in device coordinates, e.g. after the head moved
+void RtSssAlgo::setOrigin(const Vector3d& origin)
+{
+    Origin = origin;
+}
+
+Vector3d RtSssAlgo::getOrigin()
+{
+    return Origin;
+}
+
 // Set MEG signal
 //void RtSssAlgo::setMEGsignal(MatrixXd megfrombuffer)
 //{
@@ -116,6 +116,9 @@ public:
     qint32 getNumMEGBadChan();
     VectorXi getBadChan();
 
+    void setOrigin(const Vector3d& origin);
+    Vector3d getOrigin();
+
 private:
     void getCoilInfoVectorView();
     void getCoilInfoVectorView4Sim();
@@ -279,6 +279,20 @@ QWidget* SsvepBci::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int SsvepBci::getQueueDepth() const
+{
+    int iQueueDepth = 0;
+    if(m_pBCIBuffer_Sensor)
+        iQueueDepth += m_pBCIBuffer_Sensor->count();
+    if(m_pBCIBuffer_Source)
+        iQueueDepth += m_pBCIBuffer_Source->count();
+
+    return iQueueDepth;
+}
+
+
 //*************************************************************************************************************
 
 void SsvepBci::updateSensor(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
@@ -601,6 +601,14 @@ QWidget* TMSI::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+int TMSI::getQueueDepth() const
+{
+    return m_pRawMatrixBuffer_In ? (int)m_pRawMatrixBuffer_In->count() : 0;
+}
+
+
 //*************************************************************************************************************
 
 void TMSI::setKeyboardTriggerType(int type)
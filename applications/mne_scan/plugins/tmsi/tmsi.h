@@ -184,6 +184,7 @@ public:
     virtual QString getName() const;
 
     virtual QWidget* setupWidget();
+    virtual int getQueueDepth() const;
 
     void setKeyboardTriggerType(int type);
 
@@ -0,0 +1,271 @@
+//=============================================================================================================
+/**
+* @file     test_circularmatrixbuffer.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Checks wrap-around, producer/consumer ordering and concurrent clear() of the CircularMatrixBuffer
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <generics/circularmatrixbuffer.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace IOBUFFER;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestCircularMatrixBuffer
+*
+* @brief The TestCircularMatrixBuffer class checks the ordering of the lock-free CircularMatrixBuffer
+*
+*/
+class TestCircularMatrixBuffer: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestCircularMatrixBuffer();
+
+private slots:
+    void initTestCase();
+    void checkWrapAround();
+    void checkProducerConsumer();
+    void checkConcurrentClear();
+    void cleanupTestCase();
+
+private:
+    MatrixXd sequenceMatrix(int iValue) const;
+    bool isSequenceMatrix(const MatrixXd& matrix, int iValue) const;
+
+    int m_iRows;
+    int m_iCols;
+};
+
+
+//*************************************************************************************************************
+
+TestCircularMatrixBuffer::TestCircularMatrixBuffer()
+: m_iRows(3)
+, m_iCols(5)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularMatrixBuffer::initTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularMatrixBuffer::checkWrapAround()
+{
+    //A capacity which is not a power of two, many times around the ring and around the counter range
+    for(unsigned int uiCapacity = 1; uiCapacity <= 7; ++uiCapacity)
+    {
+        CircularMatrixBuffer<double> buffer(uiCapacity, m_iRows, m_iCols);
+
+        int iNextPush = 0;
+        int iNextPop = 0;
+        for(int iRound = 0; iRound < 50; ++iRound)
+        {
+            //vary the fill level, so the read and write counters wrap at different times
+            int iNumPush = 1 + (iRound % uiCapacity);
+            for(int i = 0; i < iNumPush; ++i)
+            {
+                MatrixXd matrix = sequenceMatrix(iNextPush++);
+                buffer.push(&matrix);
+            }
+            QVERIFY(buffer.count() == (quint32)(iNextPush - iNextPop));
+
+            for(int i = 0; i < iNumPush; ++i)
+                QVERIFY(isSequenceMatrix(buffer.pop(), iNextPop++));
+            QVERIFY(buffer.count() == 0);
+        }
+
+        //Full ring: a released push drops the matrix instead of overwriting the oldest one
+        for(unsigned int i = 0; i < uiCapacity; ++i)
+        {
+            MatrixXd matrix = sequenceMatrix(iNextPush++);
+            buffer.push(&matrix);
+        }
+        QVERIFY(buffer.count() == uiCapacity);
+        QVERIFY(buffer.releaseFromPush());
+        MatrixXd dropped = sequenceMatrix(-1);
+        buffer.push(&dropped);
+        for(unsigned int i = 0; i < uiCapacity; ++i)
+            QVERIFY(isSequenceMatrix(buffer.pop(), iNextPop++));
+
+        //Released pop on the empty ring returns zeros
+        QVERIFY(buffer.releaseFromPop());
+        QVERIFY(buffer.pop().isZero(0));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularMatrixBuffer::checkProducerConsumer()
+{
+    const int iNumMatrices = 200000;
+    CircularMatrixBuffer<double> buffer(5, m_iRows, m_iCols);
+
+    QFuture<void> producer = QtConcurrent::run([&]() {
+        for(int i = 0; i < iNumMatrices; ++i)
+        {
+            MatrixXd matrix = sequenceMatrix(i);
+            buffer.push(&matrix);
+        }
+    });
+
+    //Every matrix arrives once, complete and in order
+    int iErrors = 0;
+    MatrixXd matrix;
+    for(int i = 0; i < iNumMatrices; ++i)
+    {
+        buffer.popInto(matrix);
+        if(!isSequenceMatrix(matrix, i))
+            ++iErrors;
+    }
+    producer.waitForFinished();
+
+    QVERIFY(iErrors == 0);
+    QVERIFY(buffer.count() == 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularMatrixBuffer::checkConcurrentClear()
+{
+    const int iNumMatrices = 100000;
+    CircularMatrixBuffer<double> buffer(3, m_iRows, m_iCols);
+    QAtomicInt iProducerDone(0);
+
+    QFuture<void> producer = QtConcurrent::run([&]() {
+        for(int i = 0; i < iNumMatrices; ++i)
+        {
+            MatrixXd matrix = sequenceMatrix(i);
+            buffer.push(&matrix);
+        }
+        iProducerDone.storeRelease(1);
+    });
+
+    QFuture<void> clearer = QtConcurrent::run([&]() {
+        while(!iProducerDone.loadAcquire())
+        {
+            buffer.clear();
+            QThread::yieldCurrentThread();
+        }
+    });
+
+    //Matrices may be dropped by clear(), but the ones which arrive are complete and strictly increasing
+    int iErrors = 0;
+    int iLast = -1;
+    MatrixXd matrix;
+    while(iLast < iNumMatrices - 1)
+    {
+        buffer.releaseFromPop();
+        buffer.popInto(matrix);
+        if(matrix.isZero(0))
+        {
+            if(iProducerDone.loadAcquire() && buffer.count() == 0)
+                break;
+            continue;
+        }
+
+        int iValue = (int)matrix(0,0) - 1;
+        if(iValue <= iLast || !isSequenceMatrix(matrix, iValue))
+            ++iErrors;
+        iLast = iValue;
+    }
+    producer.waitForFinished();
+    clearer.waitForFinished();
+
+    QVERIFY(iErrors == 0);
+    QVERIFY(buffer.count() <= buffer.size());
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularMatrixBuffer::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestCircularMatrixBuffer::sequenceMatrix(int iValue) const
+{
+    //Offset by one, so a zero matrix of a released pop is never a valid sequence matrix
+    return MatrixXd::Constant(m_iRows, m_iCols, iValue + 1);
+}
+
+
+//*************************************************************************************************************
+
+bool TestCircularMatrixBuffer::isSequenceMatrix(const MatrixXd& matrix, int iValue) const
+{
+    return matrix.rows() == m_iRows && matrix.cols() == m_iCols && (matrix.array() == (double)(iValue + 1)).all();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestCircularMatrixBuffer)
+#include "test_circularmatrixbuffer.moc"
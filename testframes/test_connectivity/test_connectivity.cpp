@@ -0,0 +1,207 @@
+//=============================================================================================================
+/**
+* @file     test_connectivity.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the FFT based all-pairs cross correlation with a direct evaluation
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <connectivity/connectivitymeasures.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace CONNECTIVITYLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestConnectivity
+*
+* @brief The TestConnectivity class compares the FFT based all-pairs cross correlation with a direct evaluation
+*
+*/
+class TestConnectivity: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestConnectivity();
+
+private slots:
+    void initTestCase();
+    void comparePeaks();
+    void compareDelayedCopy();
+    void compareNormalizedMatrix();
+    void cleanupTestCase();
+
+private:
+    double epsilon;
+
+    MatrixXd m_matData;
+    MatrixXd m_matPeakValueRef;
+    MatrixXi m_matPeakLagRef;
+    qint32 m_iDelay;
+};
+
+
+//*************************************************************************************************************
+
+TestConnectivity::TestConnectivity()
+: epsilon(0.000000001)
+, m_iDelay(5)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestConnectivity::initTestCase()
+{
+    //
+    //   More rows than one tile, so full and partial tiles are involved
+    //
+    std::srand(42);
+    m_matData = MatrixXd::Random(70, 64);
+
+    //
+    //   Row 1 follows row 0 by a few samples
+    //
+    m_matData.row(1).setZero();
+    m_matData.row(1).tail(m_matData.cols() - m_iDelay) = m_matData.row(0).head(m_matData.cols() - m_iDelay);
+
+    //
+    //   Direct evaluation of c(k) = sum_n x_i[n+k] x_j[n] for all lags -(N-1)..N-1
+    //
+    int iNumRows = m_matData.rows();
+    int N = m_matData.cols();
+    m_matPeakValueRef = MatrixXd::Zero(iNumRows, iNumRows);
+    m_matPeakLagRef = MatrixXi::Zero(iNumRows, iNumRows);
+
+    for(int i = 0; i < iNumRows; ++i) {
+        for(int j = 0; j < iNumRows; ++j) {
+            double dMax = -std::numeric_limits<double>::max();
+            int iLag = 0;
+            for(int k = -(N-1); k < N; ++k) {
+                double dCorr = 0;
+                for(int n = std::max(0, -k); n < std::min(N, N - k); ++n)
+                    dCorr += m_matData(i, n + k) * m_matData(j, n);
+                if(dCorr > dMax) {
+                    dMax = dCorr;
+                    iLag = k;
+                }
+            }
+            m_matPeakValueRef(i, j) = dMax;
+            m_matPeakLagRef(i, j) = iLag;
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestConnectivity::comparePeaks()
+{
+    MatrixXd matPeakValue;
+    MatrixXi matPeakLag;
+    ConnectivityMeasures::crossCorrelation(m_matData, matPeakValue, matPeakLag);
+
+    std::cout << "[1] Peak values\n";
+    QVERIFY( matPeakValue.rows() == m_matPeakValueRef.rows() && matPeakValue.cols() == m_matPeakValueRef.cols() );
+    QVERIFY( (matPeakValue - m_matPeakValueRef).cwiseAbs().maxCoeff() < epsilon * m_matPeakValueRef.cwiseAbs().maxCoeff() );
+
+    std::cout << "[2] Peak lags\n";
+    QVERIFY( matPeakLag == m_matPeakLagRef );
+}
+
+
+//*************************************************************************************************************
+
+void TestConnectivity::compareDelayedCopy()
+{
+    MatrixXd matPeakValue;
+    MatrixXi matPeakLag;
+    ConnectivityMeasures::crossCorrelation(m_matData, matPeakValue, matPeakLag);
+
+    QVERIFY( matPeakLag(1, 0) == m_iDelay );
+    QVERIFY( matPeakLag(0, 1) == -m_iDelay );
+    QVERIFY( matPeakLag(0, 0) == 0 );
+}
+
+
+//*************************************************************************************************************
+
+void TestConnectivity::compareNormalizedMatrix()
+{
+    MatrixXd matDist = ConnectivityMeasures::crossCorrelation(m_matData);
+
+    //
+    //   Upper triangle of the peak values, scaled by their maximum
+    //
+    MatrixXd matDistRef = m_matPeakValueRef.triangularView<Upper>();
+    matDistRef /= matDistRef.maxCoeff();
+
+    QVERIFY( (matDist - matDistRef).cwiseAbs().maxCoeff() < epsilon );
+}
+
+
+//*************************************************************************************************************
+
+void TestConnectivity::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestConnectivity)
+#include "test_connectivity.moc"
@@ -78,9 +78,14 @@ private slots:
     void compareData();
     void compareTimes();
     void compareInfo();
+    void compareSegmentOperator();
+    void compareMappedSegment();
+    void compareRawBufferBytes();
     void cleanupTestCase();
 
 private:
+    bool isClose(const MatrixXd& matA, const MatrixXd& matB) const;
+
     double epsilon;
 
     FiffRawData first_in_raw;
@@ -319,6 +324,239 @@ void TestFiffRWR::compareInfo()
     }
 }
 
+//*************************************************************************************************************
+
+void TestFiffRWR::compareSegmentOperator()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    FiffRawData raw(t_fileIn);
+
+    fiff_int_t from = raw.first_samp;
+    fiff_int_t to = raw.first_samp + (fiff_int_t)raw.info.sfreq - 1;
+
+    //
+    //   Calibrated reference without projection, compensation and selection
+    //
+    MatrixXd data_cal, times;
+    QVERIFY( raw.read_raw_segment(data_cal, times, from, to) );
+
+    //
+    //   Selection: MEG + STI 014 - bad channels
+    //
+    QStringList include;
+    include << "STI 014";
+    MatrixXi picks = raw.info.pick_types(true, false, false, include, raw.info.bads);
+    QVERIFY( picks.cols() > 0 );
+    RowVectorXi sel = picks.row(0);
+
+    //
+    //   SSP projector of the file and an artificial compensator which couples a few channels
+    //
+    qint32 nchan = raw.info.nchan;
+    MatrixXd matProj;
+    QVERIFY( raw.info.make_projector(matProj) > 0 );
+    raw.setProj(matProj);
+
+    FiffCtfComp comp;
+    comp.kind = 101;
+    comp.data = FiffNamedMatrix::SDPtr(new FiffNamedMatrix());
+    comp.data->data = MatrixXd::Identity(nchan, nchan);
+    comp.data->data(0, 5) = -0.1;
+    comp.data->data(10, 20) = 0.05;
+    comp.data->data(sel[1], sel[2]) = 0.2;
+    raw.setComp(comp);
+
+    //
+    //   The dense operator as it was applied before: rows sel of proj * comp, applied to the calibrated data
+    //
+    std::cout << "[1] Projection, compensation and selection\n";
+    MatrixXd data, data_ref;
+    MatrixXd mult = raw.proj * raw.comp.data->data;
+    data_ref = MatrixXd(sel.size(), data_cal.cols());
+    for(qint32 i = 0; i < sel.size(); ++i)
+        data_ref.row(i) = mult.row(sel[i]) * data_cal;
+
+    QVERIFY( raw.read_raw_segment(data, times, from, to, sel) );
+    QVERIFY( isClose(data, data_ref) );
+
+    //
+    //   Changing the factors through the setters has to rebuild the cached operator
+    //
+    std::cout << "[2] Projector changed\n";
+    matProj(sel[0], sel[0]) *= 0.5;
+    raw.setProj(matProj);
+    mult = raw.proj * raw.comp.data->data;
+    for(qint32 i = 0; i < sel.size(); ++i)
+        data_ref.row(i) = mult.row(sel[i]) * data_cal;
+
+    QVERIFY( raw.read_raw_segment(data, times, from, to, sel) );
+    QVERIFY( isClose(data, data_ref) );
+
+    std::cout << "[3] Compensator changed\n";
+    comp.data->data(sel[1], sel[2]) = -0.3;
+    raw.setComp(comp);
+    mult = raw.proj * raw.comp.data->data;
+    for(qint32 i = 0; i < sel.size(); ++i)
+        data_ref.row(i) = mult.row(sel[i]) * data_cal;
+
+    QVERIFY( raw.read_raw_segment(data, times, from, to, sel) );
+    QVERIFY( isClose(data, data_ref) );
+
+    std::cout << "[4] Compensator only, no selection\n";
+    raw.setProj(MatrixXd());
+    data_ref = raw.comp.data->data * data_cal;
+
+    QVERIFY( raw.read_raw_segment(data, times, from, to) );
+    QVERIFY( isClose(data, data_ref) );
+
+    std::cout << "[5] Compensator removed\n";
+    comp.kind = -1;
+    raw.setComp(comp);
+
+    QVERIFY( raw.read_raw_segment(data, times, from, to) );
+    QVERIFY( isClose(data, data_cal) );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareMappedSegment()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    FiffRawData raw(t_fileIn);
+
+    fiff_int_t from = raw.first_samp + 100;
+    fiff_int_t to = raw.first_samp + 2*(fiff_int_t)raw.info.sfreq;
+
+    MatrixXd data, times, data_mapped, times_mapped;
+
+    //
+    //   Plain calibrated read, spanning several raw buffers
+    //
+    std::cout << "[1] Calibration only\n";
+    QVERIFY( raw.read_raw_segment(data, times, from, to) );
+    QVERIFY( raw.read_raw_segment_mapped(data_mapped, times_mapped, from, to) );
+    QVERIFY( isClose(data_mapped, data) );
+    QVERIFY( isClose(times_mapped, times) );
+
+    //
+    //   Projection and selection
+    //
+    std::cout << "[2] Projection and selection\n";
+    QStringList include;
+    include << "STI 014";
+    MatrixXi picks = raw.info.pick_types(true, false, false, include, raw.info.bads);
+    RowVectorXi sel = picks.row(0);
+    raw.info.make_projector(raw.proj);
+
+    QVERIFY( raw.read_raw_segment(data, times, from, to, sel) );
+    QVERIFY( raw.read_raw_segment_mapped(data_mapped, times_mapped, from, to, sel) );
+    QVERIFY( isClose(data_mapped, data) );
+
+    //
+    //   The mapping is created again after it was released
+    //
+    std::cout << "[3] Remapped\n";
+    raw.unmap();
+    QVERIFY( raw.read_raw_segment_mapped(data_mapped, times_mapped, from, to, sel) );
+    QVERIFY( isClose(data_mapped, data) );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareRawBufferBytes()
+{
+    const MatrixXd& buf = first_in_data;
+    const RowVectorXd& cals = first_in_raw.cals;
+    QVERIFY( buf.rows() == cals.cols() );
+
+    //
+    //   Calibration: the tag written before was the float cast of diag(1/cals) * buf
+    //
+    std::cout << "[1] Calibration vector\n";
+    QByteArray baNew, baOld;
+    {
+        FiffStream t_streamNew(&baNew, QIODevice::WriteOnly);
+        QVERIFY( t_streamNew.write_raw_buffer(buf, cals) );
+
+        typedef Eigen::Triplet<double> T;
+        std::vector<T> tripletList;
+        tripletList.reserve(cals.cols());
+        for(qint32 i = 0; i < cals.cols(); ++i)
+            tripletList.push_back(T(i, i, 1.0/cals[i]));
+        SparseMatrix<double> inv_calsMat(cals.cols(), cals.cols());
+        inv_calsMat.setFromTriplets(tripletList.begin(), tripletList.end());
+
+        FiffStream t_streamOld(&baOld, QIODevice::WriteOnly);
+        MatrixXf tmp = (inv_calsMat*buf).cast<float>();
+        t_streamOld.write_float(FIFF_DATA_BUFFER, tmp.data(), tmp.rows()*tmp.cols());
+    }
+    QVERIFY( baNew.size() == 16 + 4*buf.rows()*buf.cols() );
+    QVERIFY( baNew == baOld );
+
+    //
+    //   Sparse multiplication matrix: the stored values are inverted
+    //
+    std::cout << "[2] Multiplication matrix\n";
+    baNew.clear();
+    baOld.clear();
+    {
+        SparseMatrix<double> mult = MatrixXd(cals.transpose().asDiagonal()).sparseView();
+
+        FiffStream t_streamNew(&baNew, QIODevice::WriteOnly);
+        QVERIFY( t_streamNew.write_raw_buffer(buf, mult) );
+
+        SparseMatrix<double> inv_mult(mult.rows(), mult.cols());
+        for (int k = 0; k < mult.outerSize(); ++k)
+            for (SparseMatrix<double>::InnerIterator it(mult, k); it; ++it)
+                inv_mult.coeffRef(it.row(), it.col()) = 1/it.value();
+
+        FiffStream t_streamOld(&baOld, QIODevice::WriteOnly);
+        MatrixXf tmp = (inv_mult*buf).cast<float>();
+        t_streamOld.write_float(FIFF_DATA_BUFFER, tmp.data(), tmp.rows()*tmp.cols());
+    }
+    QVERIFY( baNew == baOld );
+
+    //
+    //   Unscaled
+    //
+    std::cout << "[3] Unscaled\n";
+    baNew.clear();
+    baOld.clear();
+    {
+        FiffStream t_streamNew(&baNew, QIODevice::WriteOnly);
+        QVERIFY( t_streamNew.write_raw_buffer(buf) );
+
+        FiffStream t_streamOld(&baOld, QIODevice::WriteOnly);
+        MatrixXf tmp = buf.cast<float>();
+        t_streamOld.write_float(FIFF_DATA_BUFFER, tmp.data(), tmp.rows()*tmp.cols());
+    }
+    QVERIFY( baNew == baOld );
+
+    //
+    //   The staging buffer is reused, a smaller buffer after a larger one must not carry stale bytes
+    //
+    std::cout << "[4] Staging buffer reuse\n";
+    baNew.clear();
+    baOld.clear();
+    {
+        MatrixXd bufSmall = buf.leftCols(buf.cols()/2);
+
+        FiffStream t_streamNew(&baNew, QIODevice::WriteOnly);
+        t_streamNew.write_raw_buffer(buf);
+        t_streamNew.write_raw_buffer(bufSmall);
+
+        FiffStream t_streamOld(&baOld, QIODevice::WriteOnly);
+        MatrixXf tmp = buf.cast<float>();
+        t_streamOld.write_float(FIFF_DATA_BUFFER, tmp.data(), tmp.rows()*tmp.cols());
+        tmp = bufSmall.cast<float>();
+        t_streamOld.write_float(FIFF_DATA_BUFFER, tmp.data(), tmp.rows()*tmp.cols());
+    }
+    QVERIFY( baNew == baOld );
+}
+
+
 //*************************************************************************************************************
 
 void TestFiffRWR::cleanupTestCase()
@@ -326,6 +564,17 @@ void TestFiffRWR::cleanupTestCase()
 }
 
 
+//*************************************************************************************************************
+
+bool TestFiffRWR::isClose(const MatrixXd& matA, const MatrixXd& matB) const
+{
+    if(matA.rows() != matB.rows() || matA.cols() != matB.cols())
+        return false;
+
+    return (matA - matB).cwiseAbs().maxCoeff() <= epsilon * matB.cwiseAbs().maxCoeff();
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // MAIN
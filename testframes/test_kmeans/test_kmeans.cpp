@@ -0,0 +1,312 @@
+//=============================================================================================================
+/**
+* @file     test_kmeans.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Verifies the pruned and parallel KMeans clustering
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/kmeans.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestKMeans
+*
+* @brief The TestKMeans class verifies the pruned and parallel KMeans clustering
+*
+*/
+class TestKMeans: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestKMeans();
+
+private slots:
+    void initTestCase();
+    void compareSeparatedClusters();
+    void compareFixedPoint();
+    void compareCityblock();
+    void compareParallelReplicates();
+    void cleanupTestCase();
+
+private:
+    MatrixXd distances(const MatrixXd& X, const MatrixXd& C, bool bCityblock) const;
+    bool isNearestAssignment(const MatrixXd& X, const VectorXi& idx, const MatrixXd& C, bool bCityblock) const;
+
+    double epsilon;
+
+    MatrixXd m_matBlobs;
+    MatrixXd m_matUniform;
+    qint32 m_iBlobSize;
+};
+
+
+//*************************************************************************************************************
+
+TestKMeans::TestKMeans()
+: epsilon(0.000000001)
+, m_iBlobSize(50)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::initTestCase()
+{
+    std::srand(42);
+
+    //
+    //   Four well separated blobs in 3D
+    //
+    MatrixXd matCenters = MatrixXd::Zero(4, 3);
+    matCenters(1, 0) = 10.0;
+    matCenters(2, 1) = 10.0;
+    matCenters(3, 2) = 10.0;
+
+    m_matBlobs = MatrixXd::Random(4*m_iBlobSize, 3);
+    for(qint32 b = 0; b < 4; ++b)
+        m_matBlobs.block(b*m_iBlobSize, 0, m_iBlobSize, 3).rowwise() += matCenters.row(b);
+
+    //
+    //   Unstructured data, where the replicates end up in different local optima
+    //
+    m_matUniform = MatrixXd::Random(300, 4);
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::compareSeparatedClusters()
+{
+    KMeans kMeans(QString("sqeuclidean"), QString("sample"), 5);
+    kMeans.setSeed(1);
+
+    VectorXi idx;
+    MatrixXd C, D;
+    VectorXd sumD;
+    QVERIFY( kMeans.calculate(m_matBlobs, 4, idx, C, sumD, D) );
+
+    //
+    //   Every blob is one cluster of its own
+    //
+    QList<int> lClusters;
+    for(qint32 b = 0; b < 4; ++b) {
+        int iCluster = idx[b*m_iBlobSize];
+        for(qint32 i = 0; i < m_iBlobSize; ++i)
+            QVERIFY( idx[b*m_iBlobSize + i] == iCluster );
+        QVERIFY( !lClusters.contains(iCluster) );
+        lClusters.append(iCluster);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::compareFixedPoint()
+{
+    //
+    //   Batch only and with the online phase: the result is a fixed point of the Lloyd iteration
+    //
+    for(int iOnline = 0; iOnline < 2; ++iOnline) {
+        std::cout << "Online update " << iOnline << std::endl;
+
+        KMeans kMeans(QString("sqeuclidean"), QString("sample"), 3, QString("error"), iOnline == 1);
+        kMeans.setSeed(7);
+
+        VectorXi idx;
+        MatrixXd C, D;
+        VectorXd sumD;
+        QVERIFY( kMeans.calculate(m_matUniform, 6, idx, C, sumD, D) );
+
+        QVERIFY( isNearestAssignment(m_matUniform, idx, C, false) );
+
+        MatrixXd matDist = distances(m_matUniform, C, false);
+        QVERIFY( (D - matDist).cwiseAbs().maxCoeff() < epsilon * matDist.maxCoeff() );
+
+        for(qint32 c = 0; c < C.rows(); ++c) {
+            RowVectorXd vecMean = RowVectorXd::Zero(C.cols());
+            double dSumD = 0;
+            qint32 iCount = 0;
+            for(qint32 i = 0; i < idx.rows(); ++i) {
+                if(idx[i] == c) {
+                    vecMean += m_matUniform.row(i);
+                    dSumD += matDist(i, c);
+                    ++iCount;
+                }
+            }
+            QVERIFY( iCount > 0 );
+            vecMean /= iCount;
+
+            QVERIFY( (C.row(c) - vecMean).cwiseAbs().maxCoeff() < epsilon );
+            QVERIFY( std::abs(sumD[c] - dSumD) < epsilon * dSumD );
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::compareCityblock()
+{
+    KMeans kMeans(QString("cityblock"), QString("sample"), 3, QString("error"), false);
+    kMeans.setSeed(3);
+
+    VectorXi idx;
+    MatrixXd C, D;
+    VectorXd sumD;
+    QVERIFY( kMeans.calculate(m_matUniform, 5, idx, C, sumD, D) );
+
+    QVERIFY( isNearestAssignment(m_matUniform, idx, C, true) );
+
+    //
+    //   The centroids are the component-wise medians of their members
+    //
+    for(qint32 c = 0; c < C.rows(); ++c) {
+        std::vector<qint32> vecMembers;
+        for(qint32 i = 0; i < idx.rows(); ++i)
+            if(idx[i] == c)
+                vecMembers.push_back(i);
+        QVERIFY( !vecMembers.empty() );
+
+        qint32 iCount = vecMembers.size();
+        for(qint32 j = 0; j < C.cols(); ++j) {
+            std::vector<double> vecValues;
+            for(qint32 i = 0; i < iCount; ++i)
+                vecValues.push_back(m_matUniform(vecMembers[i], j));
+            std::sort(vecValues.begin(), vecValues.end());
+
+            double dMedian = iCount % 2 == 0 ? 0.5*(vecValues[iCount/2 - 1] + vecValues[iCount/2]) : vecValues[iCount/2];
+            QVERIFY( std::abs(C(c, j) - dMedian) < epsilon );
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::compareParallelReplicates()
+{
+    VectorXi idxParallel, idxSerial, idxAgain;
+    MatrixXd CParallel, CSerial, CAgain, D;
+    VectorXd sumDParallel, sumDSerial, sumDAgain;
+
+    KMeans kMeansParallel(QString("sqeuclidean"), QString("sample"), 8);
+    kMeansParallel.setSeed(11);
+    QVERIFY( kMeansParallel.calculate(m_matUniform, 6, idxParallel, CParallel, sumDParallel, D) );
+
+    KMeans kMeansSerial(QString("sqeuclidean"), QString("sample"), 8);
+    kMeansSerial.setSeed(11);
+    kMeansSerial.setParallelReplicates(false);
+    QVERIFY( kMeansSerial.calculate(m_matUniform, 6, idxSerial, CSerial, sumDSerial, D) );
+
+    //
+    //   Seeded replicates give the same result regardless of their scheduling and on a second run
+    //
+    std::cout << "[1] Parallel and serial replicates\n";
+    QVERIFY( idxParallel == idxSerial );
+    QVERIFY( CParallel == CSerial );
+    QVERIFY( sumDParallel == sumDSerial );
+
+    std::cout << "[2] Second run\n";
+    QVERIFY( kMeansParallel.calculate(m_matUniform, 6, idxAgain, CAgain, sumDAgain, D) );
+    QVERIFY( idxParallel == idxAgain );
+    QVERIFY( CParallel == CAgain );
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestKMeans::distances(const MatrixXd& X, const MatrixXd& C, bool bCityblock) const
+{
+    MatrixXd matDist(X.rows(), C.rows());
+
+    for(qint32 i = 0; i < X.rows(); ++i)
+        for(qint32 c = 0; c < C.rows(); ++c)
+            matDist(i, c) = bCityblock ? (X.row(i) - C.row(c)).cwiseAbs().sum() : (X.row(i) - C.row(c)).squaredNorm();
+
+    return matDist;
+}
+
+
+//*************************************************************************************************************
+
+bool TestKMeans::isNearestAssignment(const MatrixXd& X, const VectorXi& idx, const MatrixXd& C, bool bCityblock) const
+{
+    MatrixXd matDist = distances(X, C, bCityblock);
+
+    for(qint32 i = 0; i < X.rows(); ++i)
+        if(matDist(i, idx[i]) > matDist.row(i).minCoeff() + epsilon)
+            return false;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestKMeans)
+#include "test_kmeans.moc"
@@ -0,0 +1,383 @@
+//=============================================================================================================
+/**
+* @file     test_matrixblockpool.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Checks the block recycling of MatrixBlockPool and the queueing of MatrixBlockBuffer
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <scMeas/matrixblockpool.h>
+#include <scMeas/matrixblockbuffer.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCMEASLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMatrixBlockPool
+*
+* @brief The TestMatrixBlockPool class checks the block recycling of MatrixBlockPool and the queueing of MatrixBlockBuffer
+*
+*/
+class TestMatrixBlockPool: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMatrixBlockPool();
+
+private slots:
+    void initTestCase();
+    void checkReuseAfterRelease();
+    void checkSharedRelease();
+    void checkSizePreference();
+    void checkPoolExhaustion();
+    void checkPoolLifetime();
+    void checkWrap();
+    void checkBufferOrder();
+    void checkBufferRelease();
+    void checkBufferProducerConsumer();
+    void cleanupTestCase();
+
+private:
+    int m_iNumBlocks;
+};
+
+
+//*************************************************************************************************************
+
+TestMatrixBlockPool::TestMatrixBlockPool()
+: m_iNumBlocks(10000)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMatrixBlockPool::initTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMatrixBlockPool::checkReuseAfterRelease()
+{
+    MatrixBlockPool::SPtr pPool = MatrixBlockPool::create(4);
+
+    MatrixXd matFirst = MatrixXd::Random(8, 16);
+    MatrixBlock block = pPool->acquire(matFirst);
+    QVERIFY(!block.isNull());
+    QVERIFY(*block == matFirst);
+    QCOMPARE(pPool->numFree(), 0);
+
+    const MatrixXd* pStorage = block.operator->();
+
+    //
+    //   Releasing the last reference returns the storage, the next block of the same size reuses it
+    //
+    block = MatrixBlock();
+    QCOMPARE(pPool->numFree(), 1);
+
+    MatrixXd matSecond = MatrixXd::Random(8, 16);
+    block = pPool->acquire(matSecond);
+    QCOMPARE(pPool->numFree(), 0);
+    QVERIFY(block.operator->() == pStorage);
+    QVERIFY(*block == matSecond);
+}
+
+
+//*************************************************************************************************************
+
+void TestMatrixBlockPool::checkSharedRelease()
+{
+    MatrixBlockPool::SPtr pPool = MatrixBlockPool::create(4);
+
+    MatrixXd mat = MatrixXd::Random(4, 4);
+    MatrixBlock block = pPool->acquire(mat);
+    MatrixBlock blockConsumer = block;
+
+    //
+    //   The storage is only recycled once every consumer released the block
+    //
+    block = MatrixBlock();
+    QCOMPARE(pPool->numFree(), 0);
+    QVERIFY(*blockConsumer == mat);
+
+    blockConsumer = MatrixBlock();
+    QCOMPARE(pPool->numFree(), 1);
+}
+
+
+//*************************************************************************************************************
+
+void TestMatrixBlockPool::checkSizePreference()
+{
+    MatrixBlockPool::SPtr pPool = MatrixBlockPool::create(4);
+
+    MatrixBlock blockSmall = pPool->acquire(MatrixXd::Zero(2, 3));
+    MatrixBlock blockLarge = pPool->acquire(MatrixXd::Zero(20, 30));
+    const MatrixXd* pSmall = blockSmall.operator->();
+    const MatrixXd* pLarge = blockLarge.operator->();
+
+    blockSmall = MatrixBlock();
+    blockLarge = MatrixBlock();
+    QCOMPARE(pPool->numFree(), 2);
+
+    //
+    //   A free matrix of matching size is preferred over the most recently released one
+    //
+    MatrixBlock block = pPool->acquire(MatrixXd::Ones(2, 3));
+    QVERIFY(block.operator->() == pSmall);
+
+    //
+    //   Without a matching size any free matrix is resized
+    //
+    MatrixXd matOther = MatrixXd::Ones(5, 5);
+    MatrixBlock blockOther = pPool->acquire(matOther);
+    QVERIFY(blockOther.operator->() == pLarge);
+    QVERIFY(*blockOther == matOther);
+    QCOMPARE(pPool->numFree(), 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMatrixBlockPool::checkPoolExhaustion()
+{
+    const int iMaxFree = 3;
+    MatrixBlockPool::SPtr pPool = MatrixBlockPool::create(iMaxFree);
+
+    //
+    //   An empty pool allocates new storage for every block
+    //
+    QList<MatrixBlock> lBlocks;
+    QSet<const MatrixXd*> setStorage;
+    for(int i = 0; i < 2 * iMaxFree; ++i) {
+        lBlocks.append(pPool->acquire(MatrixXd::Constant(3, 3, i)));
+        setStorage.insert(lBlocks.last().operator->());
+        QCOMPARE(pPool->numFree(), 0);
+    }
+    QCOMPARE(setStorage.size(), 2 * iMaxFree);
+
+    for(int i = 0; i < lBlocks.size(); ++i) {
+        QVERIFY(*lBlocks[i] == MatrixXd::Constant(3, 3, i));
+    }
+
+    //
+    //   Only iMaxFree matrices are kept for recycling, the others are freed
+    //
+    lBlocks.clear();
+    QCOMPARE(pPool->numFree(), iMaxFree);
+
+    for(int i = 0; i < iMaxFree; ++i) {
+        lBlocks.append(pPool->acquire(MatrixXd::Zero(3, 3)));
+        QVERIFY(setStorage.contains(lBlocks.last().operator->()));
+    }
+    QCOMPARE(pPool->numFree(), 0);
+
+    lBlocks.append(pPool->acquire(MatrixXd::Zero(3, 3)));
+    QCOMPARE(pPool->numFree(), 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMatrixBlockPool::checkPoolLifetime()
+{
+    MatrixBlockPool::SPtr pPool = MatrixBlockPool::create(4);
+    QWeakPointer<MatrixBlockPool> pWeakPool = pPool;
+
+    MatrixXd mat = MatrixXd::Random(6, 6);
+    MatrixBlock block = pPool->acquire(mat);
+
+    //
+    //   Blocks keep their pool alive, the pool is destroyed with the last block
+    //
+    pPool.clear();
+    QVERIFY(!pWeakPool.isNull());
+    QVERIFY(*block == mat);
+
+    block = MatrixBlock();
+    QVERIFY(pWeakPool.isNull());
+}
+
+
+//*************************************************************************************************************
+
+void TestMatrixBlockPool::checkWrap()
+{
+    MatrixBlockPool::SPtr pPool = MatrixBlockPool::create(4);
+
+    MatrixXd mat = MatrixXd::Random(3, 7);
+    MatrixBlock block = MatrixBlockPool::wrap(mat);
+    QVERIFY(block.operator->() == &mat);
+
+    block = MatrixBlock();
+    QCOMPARE(pPool->numFree(), 0);
+    QVERIFY(mat.rows() == 3 && mat.cols() == 7);
+}
+
+
+//*************************************************************************************************************
+
+void TestMatrixBlockPool::checkBufferOrder()
+{
+    MatrixBlockPool::SPtr pPool = MatrixBlockPool::create(4);
+    MatrixBlockBuffer buffer(4);
+
+    QList<const MatrixXd*> lStorage;
+    for(int i = 0; i < 4; ++i) {
+        MatrixBlock block = pPool->acquire(MatrixXd::Constant(2, 2, i));
+        lStorage.append(block.operator->());
+        buffer.push(block);
+    }
+    QCOMPARE(buffer.count(), (quint32)4);
+
+    //
+    //   Blocks are queued without copying and popped in order
+    //
+    for(int i = 0; i < 4; ++i) {
+        MatrixBlock block = buffer.pop();
+        QVERIFY(block.operator->() == lStorage[i]);
+        QVERIFY(*block == MatrixXd::Constant(2, 2, i));
+    }
+    QCOMPARE(buffer.count(), (quint32)0);
+    QCOMPARE(pPool->numFree(), 4);
+
+    //
+    //   Cleared blocks are released to the pool
+    //
+    buffer.push(pPool->acquire(MatrixXd::Zero(2, 2)));
+    buffer.push(pPool->acquire(MatrixXd::Zero(2, 2)));
+    QCOMPARE(pPool->numFree(), 2);
+    buffer.clear();
+    QCOMPARE(buffer.count(), (quint32)0);
+    QCOMPARE(pPool->numFree(), 4);
+}
+
+
+//*************************************************************************************************************
+
+void TestMatrixBlockPool::checkBufferRelease()
+{
+    MatrixBlockPool::SPtr pPool = MatrixBlockPool::create(4);
+    MatrixBlockBuffer buffer(1);
+
+    //
+    //   A released pop on an empty buffer returns a null block
+    //
+    QFuture<MatrixBlock> futurePop = QtConcurrent::run(&buffer, &MatrixBlockBuffer::pop);
+    while(!buffer.releaseFromPop()) {
+        QThread::msleep(1);
+    }
+    QVERIFY(futurePop.result().isNull());
+
+    //
+    //   A released push on a full buffer drops its block
+    //
+    buffer.push(pPool->acquire(MatrixXd::Constant(2, 2, 1.0)));
+    MatrixXd matDropped = MatrixXd::Constant(2, 2, 2.0);
+    QFuture<void> futurePush = QtConcurrent::run(&buffer, &MatrixBlockBuffer::push, pPool->acquire(matDropped));
+    QVERIFY(buffer.releaseFromPush());
+    futurePush.waitForFinished();
+
+    QCOMPARE(buffer.count(), (quint32)1);
+    QVERIFY(*buffer.pop() == MatrixXd::Constant(2, 2, 1.0));
+    QVERIFY(!buffer.releaseFromPush());
+}
+
+
+//*************************************************************************************************************
+
+void TestMatrixBlockPool::checkBufferProducerConsumer()
+{
+    MatrixBlockPool::SPtr pPool = MatrixBlockPool::create(8);
+    MatrixBlockBuffer buffer(4);
+
+    //
+    //   The producer waits while the buffer is full, at most buffer size plus two blocks are in flight
+    //
+    QFuture<void> futureProducer = QtConcurrent::run([&]() {
+        MatrixXd mat(4, 8);
+        for(int i = 0; i < m_iNumBlocks; ++i) {
+            mat.setConstant(i);
+            buffer.push(pPool->acquire(mat));
+        }
+    });
+
+    bool bOrdered = true;
+    for(int i = 0; i < m_iNumBlocks; ++i) {
+        MatrixBlock block = buffer.pop();
+        bOrdered = bOrdered && !block.isNull() && (*block)(0,0) == i && (*block)(3,7) == i;
+    }
+    futureProducer.waitForFinished();
+
+    QVERIFY(bOrdered);
+    QCOMPARE(buffer.count(), (quint32)0);
+    QVERIFY(pPool->numFree() <= 6);
+}
+
+
+//*************************************************************************************************************
+
+void TestMatrixBlockPool::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestMatrixBlockPool)
+#include "test_matrixblockpool.moc"
@@ -0,0 +1,248 @@
+//=============================================================================================================
+/**
+* @file     test_minimumnorm.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the fused double and float apply paths of MinimumNorm with the plain kernel product
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <mne/mne.h>
+#include <inverse/minimumNorm/minimumnorm.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace MNELIB;
+using namespace INVERSELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMinimumNorm
+*
+* @brief The TestMinimumNorm class compares the fused double and float apply paths of MinimumNorm with the
+* plain kernel product
+*
+*/
+class TestMinimumNorm: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMinimumNorm();
+
+private slots:
+    void initTestCase();
+    void compareApplyPaths();
+    void compareConcurrentFloatApply();
+    void cleanupTestCase();
+
+private:
+    MatrixXd referenceInverse(MinimumNorm& minimumNorm, const MatrixXd& matData) const;
+    bool isClose(const MatrixXd& matA, const MatrixXd& matB, double dEpsilon) const;
+
+    double epsilon;
+    double epsilonFloat;
+    float m_fLambda;
+
+    MNEInverseOperator m_invOp;
+    FiffEvoked m_evoked;
+};
+
+
+//*************************************************************************************************************
+
+TestMinimumNorm::TestMinimumNorm()
+: epsilon(0.000000001)
+, epsilonFloat(0.0001)
+, m_fLambda(1.0f/9.0f)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::initTestCase()
+{
+    QFile t_fileFwd("./MNE-sample-data/MEG/sample/sample_audvis-meg-eeg-oct-6-fwd.fif");
+    QFile t_fileCov("./MNE-sample-data/MEG/sample/sample_audvis-cov.fif");
+    QFile t_fileEvoked("./MNE-sample-data/MEG/sample/sample_audvis-ave.fif");
+
+    QPair<QVariant, QVariant> baseline(QVariant(), 0);
+    m_evoked = FiffEvoked(t_fileEvoked, 0, baseline);
+    QVERIFY(!m_evoked.isEmpty());
+
+    MNEForwardSolution t_forwardMeeg(t_fileFwd, false, true);
+    MNEForwardSolution t_forwardMeg = t_forwardMeeg.pick_types(true, false);
+
+    FiffCov noiseCov(t_fileCov);
+    noiseCov = noiseCov.regularize(m_evoked.info, 0.05, 0.05, 0.1, true);
+
+    m_invOp = MNEInverseOperator(m_evoked.info, t_forwardMeg, noiseCov, 0.2f, 0.8f);
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::compareApplyPaths()
+{
+    QStringList lMethods;
+    lMethods << "MNE" << "dSPM" << "sLORETA";
+
+    for(int m = 0; m < lMethods.size(); ++m) {
+        std::cout << "[" << m+1 << "] " << lMethods[m].toLatin1().constData() << "\n";
+
+        MinimumNorm minimumNorm(m_invOp, m_fLambda, lMethods[m]);
+        minimumNorm.setUseFloatKernel(true);
+        minimumNorm.doInverseSetup(m_evoked.nave, false);
+
+        MatrixXd matData = m_evoked.pick_channels(minimumNorm.getPreparedInverseOperator().noise_cov->names).data;
+        MatrixXd matRef = referenceInverse(minimumNorm, matData);
+
+        MatrixXd matSourceDouble;
+        QVERIFY(minimumNorm.calculateInverse(matData, matSourceDouble));
+        QVERIFY(isClose(matSourceDouble, matRef, epsilon));
+
+        MatrixXf matSourceFloat;
+        QVERIFY(minimumNorm.calculateInverse(matData, matSourceFloat));
+        QVERIFY(isClose(matSourceFloat.cast<double>(), matRef, epsilonFloat));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::compareConcurrentFloatApply()
+{
+    MinimumNorm minimumNorm(m_invOp, m_fLambda, "dSPM");
+    minimumNorm.setUseFloatKernel(true);
+    minimumNorm.doInverseSetup(m_evoked.nave, false);
+
+    MatrixXd matData = m_evoked.pick_channels(minimumNorm.getPreparedInverseOperator().noise_cov->names).data;
+
+    //
+    //   Blocks of different lengths applied from several threads on the same const object
+    //
+    QList<QPair<MatrixXd, MatrixXf> > lBlocks;
+    for(int i = 0; i < 16; ++i) {
+        int iCols = 10 + 7*i;
+        lBlocks.append(qMakePair(MatrixXd(matData.leftCols(qMin(iCols, (int)matData.cols()))), MatrixXf()));
+    }
+
+    QList<MatrixXf> lSerial;
+    for(int i = 0; i < lBlocks.size(); ++i) {
+        MatrixXf matSource;
+        QVERIFY(minimumNorm.calculateInverse(lBlocks[i].first, matSource));
+        lSerial.append(matSource);
+    }
+
+    const MinimumNorm& constMinimumNorm = minimumNorm;
+    for(int iRun = 0; iRun < 4; ++iRun) {
+        QtConcurrent::blockingMap(lBlocks, [&constMinimumNorm](QPair<MatrixXd, MatrixXf>& block) {
+            constMinimumNorm.calculateInverse(block.first, block.second);
+        });
+
+        for(int i = 0; i < lBlocks.size(); ++i)
+            QVERIFY(lBlocks[i].second == lSerial[i]);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestMinimumNorm::referenceInverse(MinimumNorm& minimumNorm, const MatrixXd& matData) const
+{
+    const MNEInverseOperator& inv = minimumNorm.getPreparedInverseOperator();
+
+    //apply imaging kernel, pool the free orientations and normalize
+    MatrixXd sol = minimumNorm.getKernel() * matData;
+
+    if(inv.source_ori == FIFFV_MNE_FREE_ORI) {
+        MatrixXd sol1(sol.rows()/3, sol.cols());
+        for(qint32 i = 0; i < sol1.rows(); ++i)
+            sol1.row(i) = (sol.row(3*i).array().square() + sol.row(3*i+1).array().square() + sol.row(3*i+2).array().square()).sqrt();
+        sol = sol1;
+    }
+
+    if(inv.noisenorm.rows() > 0)
+        sol = inv.noisenorm * sol;
+
+    return sol;
+}
+
+
+//*************************************************************************************************************
+
+bool TestMinimumNorm::isClose(const MatrixXd& matA, const MatrixXd& matB, double dEpsilon) const
+{
+    if(matA.rows() != matB.rows() || matA.cols() != matB.cols())
+        return false;
+
+    double dScale = matB.cwiseAbs().maxCoeff();
+    return (matA - matB).cwiseAbs().maxCoeff() <= dEpsilon * (dScale > 0 ? dScale : 1.0);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestMinimumNorm)
+#include "test_minimumnorm.moc"
@@ -0,0 +1,198 @@
+//=============================================================================================================
+/**
+* @file     test_mne_project_to_surface.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the search tree projection of MNEProjectToSurface with the scan over all triangles
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <mne/mne_bem.h>
+#include <mne/mne_project_to_surface.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneProjectToSurface
+*
+* @brief The TestMneProjectToSurface class compares the search tree projection with the scan over all triangles
+*
+*/
+class TestMneProjectToSurface: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneProjectToSurface();
+
+private slots:
+    void initTestCase();
+    void compareRandomPoints();
+    void compareSurfacePoints();
+    void cleanupTestCase();
+
+private:
+    void compareProjections(const MNEProjectToSurface& projectToSurface, const MatrixXf& matPoints) const;
+
+    MNEBem m_bem;
+    int m_iNumPoints;
+};
+
+
+//*************************************************************************************************************
+
+TestMneProjectToSurface::TestMneProjectToSurface()
+: m_iNumPoints(2000)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjectToSurface::initTestCase()
+{
+    std::srand(42);
+
+    QFile t_fileBem("./MNE-sample-data/subjects/sample/bem/sample-5120-5120-5120-bem.fif");
+    m_bem = MNEBem(t_fileBem);
+    QVERIFY(m_bem.size() > 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjectToSurface::compareRandomPoints()
+{
+    for(int s = 0; s < m_bem.size(); ++s) {
+        std::cout << "[" << s+1 << "] Random points around surface " << s << "\n";
+        const MNEBemSurface& surface = m_bem[s];
+        MNEProjectToSurface projectToSurface(surface);
+
+        //
+        //   Uniform points in the bounding box enlarged by half its size, i.e. inside, on and outside the surface
+        //
+        Vector3f vecMin = surface.rr.colwise().minCoeff().transpose();
+        Vector3f vecMax = surface.rr.colwise().maxCoeff().transpose();
+        Vector3f vecCenter = 0.5f*(vecMin + vecMax);
+        Vector3f vecHalf = 0.75f*(vecMax - vecMin);
+
+        MatrixXf matPoints = MatrixXf::Random(m_iNumPoints, 3);
+        for(int i = 0; i < m_iNumPoints; ++i)
+            matPoints.row(i) = (vecCenter + matPoints.row(i).transpose().cwiseProduct(vecHalf)).transpose();
+
+        compareProjections(projectToSurface, matPoints);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjectToSurface::compareSurfacePoints()
+{
+    for(int s = 0; s < m_bem.size(); ++s) {
+        std::cout << "[" << s+1 << "] Vertices and edge midpoints of surface " << s << "\n";
+        const MNEBemSurface& surface = m_bem[s];
+        MNEProjectToSurface projectToSurface(surface);
+
+        //
+        //   Vertices and edge midpoints are equally close to several triangles, the lowest index has to win
+        //
+        int iNumTris = qMin((int)surface.tris.rows(), m_iNumPoints/2);
+        MatrixXf matPoints(2*iNumTris, 3);
+        for(int i = 0; i < iNumTris; ++i) {
+            matPoints.row(2*i) = surface.rr.row(surface.tris(i,0));
+            matPoints.row(2*i+1) = 0.5f*(surface.rr.row(surface.tris(i,1)) + surface.rr.row(surface.tris(i,2)));
+        }
+
+        compareProjections(projectToSurface, matPoints);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjectToSurface::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjectToSurface::compareProjections(const MNEProjectToSurface& projectToSurface, const MatrixXf& matPoints) const
+{
+    MatrixXf matProj, matProjLinear;
+    VectorXi vecNearest, vecNearestLinear;
+    VectorXf vecDist, vecDistLinear;
+
+    QVERIFY(projectToSurface.mne_find_closest_on_surface(matPoints, matPoints.rows(), matProj, vecNearest, vecDist));
+    QVERIFY(projectToSurface.mne_find_closest_on_surface_linear(matPoints, matPoints.rows(), matProjLinear, vecNearestLinear, vecDistLinear));
+
+    //Both evaluate the same triangles with the same arithmetic, so the results have to be identical
+    int iMismatch = 0;
+    for(int i = 0; i < matPoints.rows(); ++i)
+        if(vecNearest[i] != vecNearestLinear[i])
+            ++iMismatch;
+
+    QVERIFY(iMismatch == 0);
+    QVERIFY(vecDist == vecDistLinear);
+    QVERIFY(matProj == matProjLinear);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestMneProjectToSurface)
+#include "test_mne_project_to_surface.moc"
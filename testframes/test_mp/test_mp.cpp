@@ -0,0 +1,452 @@
+//=============================================================================================================
+/**
+* @file     test_mp.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the matching pursuit kernels with their direct evaluation
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/mp/fixdictmp.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMp
+*
+* @brief The TestMp class compares the matching pursuit kernels with their direct evaluation
+*
+*/
+class TestMp: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMp();
+
+private slots:
+    void initTestCase();
+    void compareFixDictCorrelation();
+    void compareBinaryDictionary();
+    void compareCalculateAtom();
+    void compareParallelDecomposition();
+    void cleanupTestCase();
+
+private:
+    FixDictAtom referenceCorrelation(const Dictionary& dict, const MatrixXd& residuum) const;
+    VectorXd referenceCalculateAtom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, const MatrixXd& residuum, bool bParameters, bool fix_phase) const;
+    QList<QList<GaborAtom> > decompose(const MatrixXd& signal, bool trial_separation) const;
+
+    double epsilon;
+
+    Dictionary m_dict;
+};
+
+
+//*************************************************************************************************************
+
+TestMp::TestMp()
+: epsilon(0.000000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMp::initTestCase()
+{
+    //
+    //   Gabor atoms shorter and longer than the signals
+    //
+    m_dict.source = QString("test_mp");
+    m_dict.type = GABORATOM;
+    m_dict.atom_formula = QString("Gaboratom");
+    m_dict.sample_count = 64;
+
+    GaborAtom gabor_atom;
+    QList<qint32> lLengths;
+    lLengths << 32 << 64 << 200 << 127;
+    qint32 id = 0;
+    for(qint32 l = 0; l < lLengths.size(); ++l) {
+        for(qint32 m = 1; m < 4; ++m) {
+            FixDictAtom atom;
+            atom.id = id++;
+            atom.dict_source = m_dict.source;
+            atom.type = GABORATOM;
+            atom.gabor_atom.scale = lLengths[l] / 4.0;
+            atom.gabor_atom.modulation = 3.0 * m;
+            atom.gabor_atom.phase = 0.3 * m;
+            atom.atom_samples = gabor_atom.create_real(lLengths[l], atom.gabor_atom.scale, lLengths[l] / 2, atom.gabor_atom.modulation, atom.gabor_atom.phase);
+            m_dict.atoms.append(atom);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMp::compareFixDictCorrelation()
+{
+    std::srand(42);
+
+    Eigen::FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+
+    //
+    //   Even and odd signal lengths, a dictionary atom at a known position plus noise
+    //
+    QList<qint32> lSignalLengths;
+    lSignalLengths << 128 << 127;
+
+    for(qint32 s = 0; s < lSignalLengths.size(); ++s) {
+        qint32 N = lSignalLengths[s];
+        std::cout << "Signal length " << N << std::endl;
+
+        MatrixXd residuum = 0.1 * MatrixXd::Random(N, 1);
+        residuum.col(0) += 2.0 * FixDictMp::fit_atom(m_dict.atoms.at(4).atom_samples, N, N/3);
+
+        Dictionary dict = m_dict;
+        dict.calc_atom_spectra(N);
+
+        MatrixXcd resid_spectra(N/2 + 1, residuum.cols());
+        VectorXcd fft_resid;
+        for(qint32 chn = 0; chn < residuum.cols(); ++chn) {
+            fft.fwd(fft_resid, VectorXd(residuum.col(chn)));
+            resid_spectra.col(chn) = fft_resid;
+        }
+
+        FixDictMp fix_dict_mp;
+        FixDictAtom best = fix_dict_mp.correlation(dict, resid_spectra, N, 100);
+        FixDictAtom best_ref = referenceCorrelation(dict, residuum);
+
+        QVERIFY( best.id == best_ref.id );
+        QVERIFY( best.translation == best_ref.translation );
+        QVERIFY( std::abs(best.max_scalar_product - best_ref.max_scalar_product) < epsilon * std::abs(best_ref.max_scalar_product) );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMp::compareBinaryDictionary()
+{
+    QString sPath = QDir::tempPath() + QString("/test_mp_dict.bdict");
+    QList<Dictionary> lDicts;
+    lDicts << m_dict;
+
+    FixDictMp fix_dict_mp;
+    QVERIFY( fix_dict_mp.write_bin_dict(sPath, lDicts) );
+
+    QList<Dictionary> lRead = fix_dict_mp.parse_bin_dict(sPath);
+    QFile::remove(sPath);
+
+    QVERIFY( lRead.size() == 1 );
+    QVERIFY( lRead[0].source == m_dict.source );
+    QVERIFY( lRead[0].atom_formula == m_dict.atom_formula );
+    QVERIFY( lRead[0].type == m_dict.type );
+    QVERIFY( lRead[0].sample_count == m_dict.sample_count );
+    QVERIFY( lRead[0].atoms.size() == m_dict.atoms.size() );
+
+    for(qint32 i = 0; i < m_dict.atoms.size(); ++i) {
+        const FixDictAtom& atom = lRead[0].atoms.at(i);
+        const FixDictAtom& atom_ref = m_dict.atoms.at(i);
+        QVERIFY( atom.id == atom_ref.id );
+        QVERIFY( atom.gabor_atom.scale == atom_ref.gabor_atom.scale );
+        QVERIFY( atom.gabor_atom.modulation == atom_ref.gabor_atom.modulation );
+        QVERIFY( atom.gabor_atom.phase == atom_ref.gabor_atom.phase );
+        QVERIFY( atom.atom_samples == atom_ref.atom_samples );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMp::compareCalculateAtom()
+{
+    std::srand(7);
+
+    QList<qint32> lSignalLengths;
+    lSignalLengths << 128 << 127;
+
+    for(qint32 s = 0; s < lSignalLengths.size(); ++s) {
+        qint32 N = lSignalLengths[s];
+        MatrixXd residuum = MatrixXd::Random(N, 3);
+
+        //
+        //   Enveloped atoms, the atom without envelope (scale = N) at and off the center, with and without fixed phase
+        //
+        QList<qreal> lScales;
+        lScales << 4.0 << 16.0 << 50.5 << qreal(N);
+        QList<qint32> lTranslations;
+        lTranslations << 0 << 20 << N/2 << N-1;
+
+        for(int iFixPhase = 0; iFixPhase < 2; ++iFixPhase) {
+            for(qint32 i = 0; i < lScales.size(); ++i) {
+                for(qint32 j = 0; j < lTranslations.size(); ++j) {
+                    for(qreal modulation = 0.5; modulation < N/2; modulation += 7.5) {
+                        qint32 channel = (i + j) % residuum.cols();
+
+                        VectorXd params = AdaptiveMp::calculate_atom(N, lScales[i], lTranslations[j], modulation, channel, residuum, RETURNPARAMETERS, iFixPhase == 1);
+                        VectorXd params_ref = referenceCalculateAtom(N, lScales[i], lTranslations[j], modulation, channel, residuum, true, iFixPhase == 1);
+                        QVERIFY( (params - params_ref).cwiseAbs().maxCoeff() < epsilon );
+
+                        VectorXd atom = AdaptiveMp::calculate_atom(N, lScales[i], lTranslations[j], modulation, channel, residuum, RETURNATOM, iFixPhase == 1);
+                        VectorXd atom_ref = referenceCalculateAtom(N, lScales[i], lTranslations[j], modulation, channel, residuum, false, iFixPhase == 1);
+                        QVERIFY( (atom - atom_ref).cwiseAbs().maxCoeff() < epsilon );
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMp::compareParallelDecomposition()
+{
+    std::srand(11);
+
+    //
+    //   Two channels with a shared gabor atom plus noise
+    //
+    qint32 N = 128;
+    GaborAtom gabor_atom;
+    VectorXd vecAtom = gabor_atom.create_real(N, 12.0, 40, 20.0, 0.5);
+
+    MatrixXd signal = 0.2 * MatrixXd::Random(N, 2);
+    signal.col(0) += 3.0 * vecAtom;
+    signal.col(1) -= 2.0 * vecAtom;
+
+    //
+    //   The parallel grid search and simplex refinements reduce in a fixed order, a single worker thread gives the same atoms
+    //
+    for(int iTrialSeparation = 0; iTrialSeparation < 2; ++iTrialSeparation) {
+        std::cout << "Trial separation " << iTrialSeparation << std::endl;
+
+        QList<QList<GaborAtom> > lAtoms = decompose(signal, iTrialSeparation == 1);
+
+        int iMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+        QThreadPool::globalInstance()->setMaxThreadCount(1);
+        QList<QList<GaborAtom> > lAtomsSerial = decompose(signal, iTrialSeparation == 1);
+        QThreadPool::globalInstance()->setMaxThreadCount(iMaxThreadCount);
+
+        QVERIFY( !lAtoms.isEmpty() );
+        QVERIFY( lAtoms.size() == lAtomsSerial.size() );
+
+        for(qint32 it = 0; it < lAtoms.size(); ++it) {
+            QVERIFY( lAtoms[it].size() == lAtomsSerial[it].size() );
+            for(qint32 chn = 0; chn < lAtoms[it].size(); ++chn) {
+                const GaborAtom& atom = lAtoms[it].at(chn);
+                const GaborAtom& atom_serial = lAtomsSerial[it].at(chn);
+                QVERIFY( atom.scale == atom_serial.scale );
+                QVERIFY( atom.translation == atom_serial.translation );
+                QVERIFY( atom.modulation == atom_serial.modulation );
+                QVERIFY( atom.phase == atom_serial.phase );
+                QVERIFY( atom.max_scalar_product == atom_serial.max_scalar_product );
+            }
+        }
+
+        //
+        //   The first atom explains most of the embedded one
+        //
+        QVERIFY( std::abs(lAtoms[0].at(0).max_scalar_product) > 1.5 );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMp::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+FixDictAtom TestMp::referenceCorrelation(const Dictionary& dict, const MatrixXd& residuum) const
+{
+    //
+    //   Single channel version of the correlation as it was computed before the cached atom spectra: every atom is
+    //   fitted and transformed, the residuum transformed, full spectra
+    //
+    Eigen::FFT<double> fft;
+    std::ptrdiff_t max_index;
+    qint32 N = residuum.rows();
+
+    FixDictAtom best_matching;
+
+    for(qint32 i = 0; i < dict.atoms.length(); i++)
+    {
+        const VectorXd& atom_samples = dict.atoms.at(i).atom_samples;
+        VectorXd fitted_atom = VectorXd::Zero(N);
+        qint32 p = floor(N / 2);
+
+        VectorXd resized_atom = VectorXd::Zero(N);
+        if(atom_samples.rows() > N)
+            for(qint32 k = 0; k < N; k++)
+                resized_atom[k] = atom_samples[k + qint32(floor(atom_samples.rows() / 2)) - qint32(floor(N / 2))];
+        else
+            resized_atom = atom_samples;
+
+        if(resized_atom.rows() < N)
+            for(qint32 k = 0; k < resized_atom.rows(); k++)
+                fitted_atom[k + p - qint32(floor(resized_atom.rows() / 2))] = resized_atom[k];
+        else
+            fitted_atom = resized_atom;
+
+        qreal norm = fitted_atom.norm();
+        if(norm != 0) fitted_atom /= norm;
+
+        VectorXcd fft_atom, fft_signal;
+        fft.fwd(fft_atom, fitted_atom);
+        fft.fwd(fft_signal, VectorXd(residuum.col(0)));
+
+        VectorXcd fft_sig_atom(N);
+        for(qint32 m = 0; m < N; m++)
+            fft_sig_atom[m] = fft_signal[m] * std::conj(fft_atom[m]);
+
+        VectorXd corr_coeffs;
+        fft.inv(corr_coeffs, fft_sig_atom);
+
+        qreal max_scalar_product = corr_coeffs.maxCoeff(&max_index);
+
+        if(i == 0 || std::abs(max_scalar_product) > std::abs(best_matching.max_scalar_product))
+        {
+            best_matching = dict.atoms.at(i);
+            best_matching.max_scalar_product = max_scalar_product;
+
+            if(max_index >= p && N % 2 == 0) p = max_index - p;
+            else if(max_index >= p && N % 2 != 0) p = max_index - p - 1;
+            else p = max_index + p;
+
+            best_matching.translation = p;
+        }
+    }
+
+    return best_matching;
+}
+
+
+//*************************************************************************************************************
+
+VectorXd TestMp::referenceCalculateAtom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, const MatrixXd& residuum, bool bParameters, bool fix_phase) const
+{
+    //
+    //   calculate_atom as it was computed before the shared envelope and modulation tables
+    //
+    GaborAtom gabor_Atom;
+    VectorXcd complex_gabor_atom = gabor_Atom.create_complex(sample_count, scale, translation, modulation);
+
+    std::complex<double> inner_product(0, 0);
+
+    if(fix_phase == false)
+    {
+        for(qint32 i = 0; i < sample_count; i++)
+            inner_product += residuum(i, channel) * std::conj(complex_gabor_atom[i]);
+    }
+    else
+    {
+        for(qint32 chn = 0; chn < residuum.cols(); chn++)
+            for(qint32 i = 0; i < sample_count; i++)
+                inner_product += residuum(i, chn) * std::conj(complex_gabor_atom[i]);
+        if(residuum.cols() != 0)
+            inner_product /= residuum.cols();
+    }
+
+    qreal phase = std::arg(inner_product);
+    if (phase < 0) phase = 2 * PI - phase;
+    VectorXd real_gabor_atom = gabor_Atom.create_real(sample_count, scale, translation, modulation, phase);
+
+    if(!bParameters)
+        return real_gabor_atom;
+
+    qreal scalar_product = 0;
+    for(qint32 i = 0; i < sample_count; i++)
+        scalar_product += real_gabor_atom[i] * residuum(i, channel);
+
+    VectorXd atom_parameters = VectorXd::Zero(5);
+    atom_parameters[0] = scale;
+    atom_parameters[1] = translation;
+    atom_parameters[2] = modulation;
+    atom_parameters[3] = phase;
+    atom_parameters[4] = scalar_product;
+
+    return atom_parameters;
+}
+
+
+//*************************************************************************************************************
+
+QList<QList<GaborAtom> > TestMp::decompose(const MatrixXd& signal, bool trial_separation) const
+{
+    AdaptiveMp adaptive_mp;
+    return adaptive_mp.matching_pursuit(signal, 3, 1.0, false, 100, 1000, 1.0, 0.2, 0.5, 0.5, trial_separation);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMp)
+#include "test_mp.moc"
@@ -0,0 +1,286 @@
+//=============================================================================================================
+/**
+* @file     test_rtave.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the running sum averages of RtAve with averages of the cut epochs
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <rtProcessing/rtave.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtAve
+*
+* @brief The TestRtAve class compares the running sum averages of RtAve with averages of the cut epochs
+*
+*/
+class TestRtAve: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtAve();
+
+public slots:
+    void onEvokedStim(FIFFLIB::FiffEvokedSet::SPtr p_pEvokedStimSet);
+
+private slots:
+    void initTestCase();
+    void compareRunningAverage();
+    void compareCumulativeAverage();
+    void compareStandardError();
+    void cleanupTestCase();
+
+private:
+    void runRtAve(RtAve& rtAve);
+    MatrixXd referenceAverage(int iFirstEpoch, int iNumEpochs) const;
+    bool isClose(const MatrixXd& matA, const MatrixXd& matB) const;
+
+    double epsilon;
+
+    FiffInfo::SPtr m_pFiffInfo;
+    qint32 m_iTriggerIdx;
+    qint32 m_iPreStim;
+    qint32 m_iPostStim;
+    qint32 m_iNumAverages;
+    qint32 m_iBlockSize;
+    MatrixXd m_matData;
+    QList<int> m_lTriggers;
+
+    QMutex m_mutex;
+    QList<MatrixXd> m_lEvokedData;
+    QList<int> m_lEvokedNave;
+};
+
+
+//*************************************************************************************************************
+
+TestRtAve::TestRtAve()
+: epsilon(0.000000001)
+, m_iTriggerIdx(-1)
+, m_iPreStim(30)
+, m_iPostStim(70)
+, m_iNumAverages(4)
+, m_iBlockSize(100)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::onEvokedStim(FiffEvokedSet::SPtr p_pEvokedStimSet)
+{
+    QMutexLocker locker(&m_mutex);
+    m_lEvokedData.append(p_pEvokedStimSet->evoked.at(0).data);
+    m_lEvokedNave.append(p_pEvokedStimSet->evoked.at(0).nave);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::initTestCase()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    FiffRawData raw(t_fileIn);
+    m_pFiffInfo = FiffInfo::SPtr(new FiffInfo(raw.info));
+
+    m_iTriggerIdx = m_pFiffInfo->ch_names.indexOf("STI 014");
+    QVERIFY( m_iTriggerIdx >= 0 );
+
+    //
+    //   Noise with a single sample trigger every 200 samples, the epochs span two blocks
+    //
+    std::srand(42);
+    m_matData = MatrixXd::Random(m_pFiffInfo->nchan, 22*m_iBlockSize);
+    m_matData.row(m_iTriggerIdx).setZero();
+
+    for(int t = 150; t + m_iPostStim <= m_matData.cols(); t += 200) {
+        m_matData(m_iTriggerIdx, t) = 1.0;
+        m_lTriggers.append(t);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::compareRunningAverage()
+{
+    RtAve rtAve(m_iNumAverages, m_iPreStim, m_iPostStim, 0, 0, m_iTriggerIdx, m_pFiffInfo);
+    runRtAve(rtAve);
+
+    QVERIFY( m_lEvokedData.size() == m_lTriggers.size() );
+
+    //
+    //   Mean of the last epochs, also after the ring was cycled through several times
+    //
+    for(int k = 0; k < m_lEvokedData.size(); ++k) {
+        int iNumEpochs = qMin(k + 1, m_iNumAverages);
+        QVERIFY( m_lEvokedNave[k] == iNumEpochs );
+        QVERIFY( isClose(m_lEvokedData[k], referenceAverage(k + 1 - iNumEpochs, iNumEpochs)) );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::compareCumulativeAverage()
+{
+    RtAve rtAve(m_iNumAverages, m_iPreStim, m_iPostStim, 0, 0, m_iTriggerIdx, m_pFiffInfo);
+    rtAve.setAverageMode(1);
+    runRtAve(rtAve);
+
+    QVERIFY( m_lEvokedData.size() == m_lTriggers.size() );
+
+    for(int k = 0; k < m_lEvokedData.size(); ++k)
+        QVERIFY( isClose(m_lEvokedData[k], referenceAverage(0, k + 1)) );
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::compareStandardError()
+{
+    RtAve rtAve(m_iNumAverages, m_iPreStim, m_iPostStim, 0, 0, m_iTriggerIdx, m_pFiffInfo);
+    runRtAve(rtAve);
+
+    MatrixXd matStdErr;
+    QVERIFY( rtAve.getStandardError(1.0, matStdErr) );
+
+    //
+    //   Two pass standard error of the epochs in the last window
+    //
+    int iFirst = m_lTriggers.size() - m_iNumAverages;
+    MatrixXd matMean = referenceAverage(iFirst, m_iNumAverages);
+    MatrixXd matVar = MatrixXd::Zero(matMean.rows(), matMean.cols());
+    for(int i = iFirst; i < m_lTriggers.size(); ++i) {
+        MatrixXd matEpoch = m_matData.block(0, m_lTriggers[i] - m_iPreStim, m_matData.rows(), m_iPreStim + m_iPostStim);
+        matVar.array() += (matEpoch - matMean).array().square();
+    }
+    MatrixXd matStdErrRef = (matVar.array() / ((m_iNumAverages - 1.0) * m_iNumAverages)).sqrt().matrix();
+
+    QVERIFY( (matStdErr - matStdErrRef).cwiseAbs().maxCoeff() < 0.000001 * matStdErrRef.cwiseAbs().maxCoeff() );
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::runRtAve(RtAve& rtAve)
+{
+    m_lEvokedData.clear();
+    m_lEvokedNave.clear();
+
+    connect(&rtAve, &RtAve::evokedStim, this, &TestRtAve::onEvokedStim, Qt::DirectConnection);
+
+    rtAve.start();
+    for(int i = 0; i < m_matData.cols() / m_iBlockSize; ++i)
+        rtAve.append(m_matData.block(0, i*m_iBlockSize, m_matData.rows(), m_iBlockSize));
+
+    QElapsedTimer timer;
+    timer.start();
+    while(timer.elapsed() < 30000) {
+        {
+            QMutexLocker locker(&m_mutex);
+            if(m_lEvokedData.size() >= m_lTriggers.size())
+                break;
+        }
+        QThread::msleep(10);
+    }
+
+    rtAve.stop();
+    rtAve.wait();
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtAve::referenceAverage(int iFirstEpoch, int iNumEpochs) const
+{
+    MatrixXd matAve = MatrixXd::Zero(m_matData.rows(), m_iPreStim + m_iPostStim);
+
+    for(int i = iFirstEpoch; i < iFirstEpoch + iNumEpochs; ++i)
+        matAve += m_matData.block(0, m_lTriggers[i] - m_iPreStim, m_matData.rows(), m_iPreStim + m_iPostStim);
+
+    return matAve / iNumEpochs;
+}
+
+
+//*************************************************************************************************************
+
+bool TestRtAve::isClose(const MatrixXd& matA, const MatrixXd& matB) const
+{
+    if(matA.rows() != matB.rows() || matA.cols() != matB.cols())
+        return false;
+
+    return (matA - matB).cwiseAbs().maxCoeff() <= epsilon * matB.cwiseAbs().maxCoeff();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRtAve)
+#include "test_rtave.moc"
@@ -0,0 +1,280 @@
+//=============================================================================================================
+/**
+* @file     test_rtcov.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the incremental RtCov estimates with covariances computed from scratch
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <rtProcessing/rtcov.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtCov
+*
+* @brief The TestRtCov class compares the incremental RtCov estimates with covariances computed from scratch
+*
+*/
+class TestRtCov: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtCov();
+
+public slots:
+    void onCovCalculated(FIFFLIB::FiffCov::SPtr p_pCov);
+
+private slots:
+    void initTestCase();
+    void compareBlock();
+    void compareSlidingWindow();
+    void cleanupTestCase();
+
+private:
+    QList<FiffCov::SPtr> runRtCov(RtCov::EstimationMode mode, qint32 iEmitInterval, int iNumCovs);
+    FiffCov::SPtr referenceCov(int iFirstBlock, int iNumBlocks) const;
+    bool isClose(const MatrixXd& matA, const MatrixXd& matB) const;
+
+    double epsilon;
+
+    FiffInfo::SPtr m_pFiffInfo;
+    QStringList m_lExclude;
+    QList<MatrixXd> m_lBlocks;
+    qint32 m_iMaxSamples;
+
+    QMutex m_mutex;
+    QList<FiffCov::SPtr> m_lCovs;
+};
+
+
+//*************************************************************************************************************
+
+TestRtCov::TestRtCov()
+: epsilon(0.000001)
+, m_iMaxSamples(500)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtCov::onCovCalculated(FiffCov::SPtr p_pCov)
+{
+    QMutexLocker locker(&m_mutex);
+    m_lCovs.append(p_pCov);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtCov::initTestCase()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    FiffRawData raw(t_fileIn);
+    m_pFiffInfo = FiffInfo::SPtr(new FiffInfo(raw.info));
+
+    for(int i = 0; i < m_pFiffInfo->chs.size(); ++i)
+        if(m_pFiffInfo->chs.at(i).kind == FIFFV_STIM_CH)
+            m_lExclude << m_pFiffInfo->chs.at(i).ch_name;
+
+    //
+    //   Blocks of 100 samples with an offset, so the mean matters
+    //
+    std::srand(42);
+    for(int i = 0; i < 16; ++i) {
+        MatrixXd matBlock = MatrixXd::Random(m_pFiffInfo->nchan, 100);
+        matBlock.array() += 0.5;
+        m_lBlocks.append(1e-11 * matBlock);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtCov::compareBlock()
+{
+    //
+    //   A covariance is emitted as soon as more than the given number of samples was collected, 6 blocks each
+    //
+    QList<FiffCov::SPtr> lCovs = runRtCov(RtCov::Block, m_iMaxSamples, 2);
+    QVERIFY( lCovs.size() >= 2 );
+
+    for(int i = 0; i < 2; ++i) {
+        std::cout << "Block covariance " << i << std::endl;
+        FiffCov::SPtr pRef = referenceCov(6*i, 6);
+        QVERIFY( lCovs[i]->nfree == pRef->nfree );
+        QVERIFY( isClose(lCovs[i]->data, pRef->data) );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtCov::compareSlidingWindow()
+{
+    //
+    //   Window of 5 blocks, emitted every other block: blocks 0-4, 2-6, 4-8, ...
+    //
+    QList<FiffCov::SPtr> lCovs = runRtCov(RtCov::SlidingWindow, 200, 5);
+    QVERIFY( lCovs.size() >= 5 );
+
+    for(int i = 0; i < 5; ++i) {
+        std::cout << "Window covariance " << i << std::endl;
+        FiffCov::SPtr pRef = referenceCov(2*i, 5);
+        QVERIFY( lCovs[i]->nfree == pRef->nfree );
+        QVERIFY( isClose(lCovs[i]->data, pRef->data) );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtCov::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+QList<FiffCov::SPtr> TestRtCov::runRtCov(RtCov::EstimationMode mode, qint32 iEmitInterval, int iNumCovs)
+{
+    m_lCovs.clear();
+
+    RtCov rtCov(m_iMaxSamples, m_pFiffInfo);
+    rtCov.setEstimationMode(mode);
+    rtCov.setEmitInterval(iEmitInterval);
+    connect(&rtCov, &RtCov::covCalculated, this, &TestRtCov::onCovCalculated, Qt::DirectConnection);
+
+    rtCov.start();
+    for(int i = 0; i < m_lBlocks.size(); ++i)
+        rtCov.append(m_lBlocks[i]);
+
+    QElapsedTimer timer;
+    timer.start();
+    while(timer.elapsed() < 30000) {
+        {
+            QMutexLocker locker(&m_mutex);
+            if(m_lCovs.size() >= iNumCovs)
+                break;
+        }
+        QThread::msleep(10);
+    }
+
+    rtCov.stop();
+    rtCov.wait();
+
+    QMutexLocker locker(&m_mutex);
+    return m_lCovs;
+}
+
+
+//*************************************************************************************************************
+
+FiffCov::SPtr TestRtCov::referenceCov(int iFirstBlock, int iNumBlocks) const
+{
+    //
+    //   Plain two pass estimate as it was computed before the running sums
+    //
+    qint32 n_samples = 0;
+    VectorXd mu = VectorXd::Zero(m_pFiffInfo->nchan);
+    for(int i = iFirstBlock; i < iFirstBlock + iNumBlocks; ++i) {
+        mu += m_lBlocks[i].rowwise().sum();
+        n_samples += m_lBlocks[i].cols();
+    }
+    mu /= n_samples;
+
+    FiffCov::SPtr cov(new FiffCov());
+    cov->data = MatrixXd::Zero(m_pFiffInfo->nchan, m_pFiffInfo->nchan);
+    for(int i = iFirstBlock; i < iFirstBlock + iNumBlocks; ++i) {
+        MatrixXd matCentered = m_lBlocks[i].colwise() - mu;
+        cov->data += matCentered * matCentered.transpose();
+    }
+    cov->data /= (n_samples - 1);
+
+    cov->kind = FIFFV_MNE_NOISE_COV;
+    cov->diag = false;
+    cov->dim = cov->data.rows();
+    cov->names = m_pFiffInfo->ch_names;
+    cov->projs = m_pFiffInfo->projs;
+    cov->bads = m_pFiffInfo->bads;
+    cov->nfree = n_samples;
+
+    *cov.data() = cov->regularize(*m_pFiffInfo, 0.05, 0.05, 0.1, true, m_lExclude);
+
+    return cov;
+}
+
+
+//*************************************************************************************************************
+
+bool TestRtCov::isClose(const MatrixXd& matA, const MatrixXd& matB) const
+{
+    if(matA.rows() != matB.rows() || matA.cols() != matB.cols())
+        return false;
+
+    return (matA - matB).cwiseAbs().maxCoeff() <= epsilon * matB.cwiseAbs().maxCoeff();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRtCov)
+#include "test_rtcov.moc"
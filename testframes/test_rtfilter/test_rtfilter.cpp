@@ -0,0 +1,345 @@
+//=============================================================================================================
+/**
+* @file     test_rtfilter.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the streamed RtFilter output with a direct convolution
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <rtProcessing/rtfilter.h>
+#include <utils/filterTools/filterdata.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtFilter
+*
+* @brief The TestRtFilter class compares the streamed overlap-save filtering with a direct convolution
+*
+*/
+class TestRtFilter: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtFilter();
+
+private slots:
+    void initTestCase();
+    void compareLinearPhase();
+    void compareFilterChange();
+    void compareChannelAlignment();
+    void compareMinimumPhase();
+    void cleanupTestCase();
+
+private:
+    MatrixXd convolve(const MatrixXd& matData, const RowVectorXd& vecCoeffs) const;
+    MatrixXd filterBlocks(RtFilter& rtFilter, const MatrixXd& matData, const QVector<int>& vecBlockSizes, int iMaxFilterLength, const QList<FilterData>& lFilterData) const;
+
+    double epsilon;
+
+    MatrixXd m_matData;
+    QVector<int> m_vecFilterChannels;
+    QVector<int> m_vecBlockSizes;
+    QList<FilterData> m_lFilterData;
+    RowVectorXd m_vecCoeffs;
+};
+
+
+//*************************************************************************************************************
+
+TestRtFilter::TestRtFilter()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtFilter::initTestCase()
+{
+    std::srand(42);
+
+    //
+    //   Blocks of changing size, all longer than the delay of the unfiltered channels
+    //
+    m_vecBlockSizes << 100 << 100 << 37 << 250 << 64 << 100 << 1000;
+
+    int iNumSamples = 0;
+    for(int i = 0; i < m_vecBlockSizes.size(); ++i)
+        iNumSamples += m_vecBlockSizes[i];
+
+    m_matData = MatrixXd::Random(6, iNumSamples);
+
+    m_vecFilterChannels << 0 << 2 << 3 << 5;
+
+    //
+    //   Two filters applied one after another
+    //
+    FilterData filterOne, filterTwo;
+    filterOne.m_dCoeffA = RowVectorXd::Random(31);
+    filterTwo.m_dCoeffA = RowVectorXd::Random(11);
+    m_lFilterData << filterOne << filterTwo;
+
+    m_vecCoeffs = RowVectorXd::Zero(31 + 11 - 1);
+    for(int k = 0; k < filterTwo.m_dCoeffA.cols(); ++k)
+        m_vecCoeffs.segment(k, 31) += filterTwo.m_dCoeffA(k) * filterOne.m_dCoeffA;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtFilter::compareLinearPhase()
+{
+    RtFilter rtFilter;
+    int iFilterLength = m_vecCoeffs.cols();
+
+    MatrixXd matOut = filterBlocks(rtFilter, m_matData, m_vecBlockSizes, iFilterLength, m_lFilterData);
+    MatrixXd matRef = convolve(m_matData, m_vecCoeffs);
+
+    std::cout << "[1] Filtered channels\n";
+    for(int i = 0; i < m_vecFilterChannels.size(); ++i) {
+        int c = m_vecFilterChannels[i];
+        QVERIFY( (matOut.row(c) - matRef.row(c)).cwiseAbs().maxCoeff() < epsilon );
+    }
+
+    std::cout << "[2] Unfiltered channels are delayed by half the filter length\n";
+    int iDelay = iFilterLength/2;
+    int iNumSamples = m_matData.cols();
+    QList<int> lPass;
+    lPass << 1 << 4;
+    for(int i = 0; i < lPass.size(); ++i) {
+        int c = lPass[i];
+        QVERIFY( matOut.row(c).head(iDelay).isZero() );
+        QVERIFY( matOut.row(c).tail(iNumSamples - iDelay) == m_matData.row(c).head(iNumSamples - iDelay) );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtFilter::compareFilterChange()
+{
+    RtFilter rtFilter;
+    int iFilterLength = m_vecCoeffs.cols();
+
+    QVector<int> vecFirstBlocks, vecSecondBlocks;
+    vecFirstBlocks << 100 << 100;
+    vecSecondBlocks << 250 << 37 << 100;
+
+    filterBlocks(rtFilter, m_matData.leftCols(200), vecFirstBlocks, iFilterLength, m_lFilterData);
+
+    //
+    //   A different filter resets the signal history
+    //
+    QList<FilterData> lFilterData;
+    lFilterData << m_lFilterData[1];
+
+    MatrixXd matData = m_matData.block(0, 200, m_matData.rows(), 387);
+    MatrixXd matOut = filterBlocks(rtFilter, matData, vecSecondBlocks, iFilterLength, lFilterData);
+    MatrixXd matRef = convolve(matData, lFilterData[0].m_dCoeffA);
+
+    for(int i = 0; i < m_vecFilterChannels.size(); ++i) {
+        int c = m_vecFilterChannels[i];
+        QVERIFY( (matOut.row(c) - matRef.row(c)).cwiseAbs().maxCoeff() < epsilon );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtFilter::compareChannelAlignment()
+{
+    RtFilter rtFilter;
+
+    //
+    //   Two symmetric (linear-phase) filters; the combined group delay (100 + 60)/2 spans several blocks
+    //
+    FilterData filterOne, filterTwo;
+    filterOne.m_dCoeffA = RowVectorXd(101);
+    for(int k = 0; k < filterOne.m_dCoeffA.cols(); ++k)
+        filterOne.m_dCoeffA(k) = std::exp(-0.002*(k-50)*(k-50));
+    filterTwo.m_dCoeffA = RowVectorXd(61);
+    for(int k = 0; k < filterTwo.m_dCoeffA.cols(); ++k)
+        filterTwo.m_dCoeffA(k) = std::exp(-0.005*(k-30)*(k-30));
+    QList<FilterData> lFilterData;
+    lFilterData << filterOne << filterTwo;
+
+    const int iGroupDelay = (100 + 60)/2;
+    const int iImpulse = 13;
+
+    QVector<int> vecBlockSizes;
+    vecBlockSizes << 16 << 7 << 50 << 3 << 100 << 1 << 200 << 31;
+
+    int iNumSamples = 0;
+    for(int i = 0; i < vecBlockSizes.size(); ++i)
+        iNumSamples += vecBlockSizes[i];
+
+    MatrixXd matImpulse = MatrixXd::Zero(6, iNumSamples);
+    matImpulse.col(iImpulse).setOnes();
+
+    //the caller passes the longest single filter, the delay follows from the cascade anyway
+    MatrixXd matOut = filterBlocks(rtFilter, matImpulse, vecBlockSizes, filterOne.m_dCoeffA.cols(), lFilterData);
+
+    std::cout << "[1] Unfiltered channels are delayed by the combined group delay\n";
+    QList<int> lPass;
+    lPass << 1 << 4;
+    for(int i = 0; i < lPass.size(); ++i) {
+        int c = lPass[i];
+        QVERIFY( matOut.row(c).tail(iNumSamples - iGroupDelay) == matImpulse.row(c).head(iNumSamples - iGroupDelay) );
+        QVERIFY( matOut.row(c).head(iGroupDelay).isZero() );
+    }
+
+    std::cout << "[2] Filtered impulse responses peak at the delayed impulse of the unfiltered channels\n";
+    int iPass = -1;
+    matOut.row(1).maxCoeff(&iPass);
+    for(int i = 0; i < m_vecFilterChannels.size(); ++i) {
+        int c = m_vecFilterChannels[i];
+        int iPeak = -1;
+        matOut.row(c).maxCoeff(&iPeak);
+        QVERIFY( iPeak == iPass );
+        for(int k = 1; k <= iGroupDelay; ++k)
+            QVERIFY( std::abs(matOut(c, iPeak + k) - matOut(c, iPeak - k)) < epsilon );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtFilter::compareMinimumPhase()
+{
+    RtFilter rtFilter(RtFilter::MinimumPhase);
+
+    FilterData filter;
+    filter.m_dCoeffA = RowVectorXd(41);
+    for(int k = 0; k < filter.m_dCoeffA.cols(); ++k)
+        filter.m_dCoeffA(k) = std::exp(-0.02*(k-20)*(k-20)) * std::cos(0.3*k);
+    QList<FilterData> lFilterData;
+    lFilterData << filter;
+
+    QVector<int> vecChannels;
+    vecChannels << 0;
+
+    //
+    //   Impulse response; the unfiltered channel is not delayed
+    //
+    MatrixXd matImpulse = MatrixXd::Zero(2, 256);
+    matImpulse(0, 0) = 1.0;
+    matImpulse.row(1) = m_matData.row(1).head(256);
+
+    MatrixXd matOut = rtFilter.filterChannelsConcurrently(matImpulse, filter.m_dCoeffA.cols(), vecChannels, lFilterData);
+
+    std::cout << "[1] Unfiltered channel\n";
+    QVERIFY( matOut.row(1) == matImpulse.row(1) );
+
+    //
+    //   Same energy as the linear-phase filter, but concentrated at the beginning
+    //
+    std::cout << "[2] Energy of the minimum-phase response\n";
+    double dEnergy = filter.m_dCoeffA.squaredNorm();
+    double dEnergyMin = matOut.row(0).squaredNorm();
+    QVERIFY( std::abs(dEnergyMin - dEnergy) < 0.05 * dEnergy );
+
+    int iHead = filter.m_dCoeffA.cols()/4;
+    QVERIFY( matOut.row(0).head(iHead).squaredNorm() >= filter.m_dCoeffA.head(iHead).squaredNorm() );
+}
+
+
+//*************************************************************************************************************
+
+void TestRtFilter::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtFilter::convolve(const MatrixXd& matData, const RowVectorXd& vecCoeffs) const
+{
+    MatrixXd matOut = MatrixXd::Zero(matData.rows(), matData.cols());
+
+    for(int n = 0; n < matData.cols(); ++n)
+        for(int k = 0; k < vecCoeffs.cols() && k <= n; ++k)
+            matOut.col(n) += vecCoeffs(k) * matData.col(n - k);
+
+    return matOut;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtFilter::filterBlocks(RtFilter& rtFilter, const MatrixXd& matData, const QVector<int>& vecBlockSizes, int iMaxFilterLength, const QList<FilterData>& lFilterData) const
+{
+    MatrixXd matOut(matData.rows(), matData.cols());
+    MatrixXd matBlockOut;
+
+    int iFirst = 0;
+    for(int i = 0; i < vecBlockSizes.size(); ++i) {
+        rtFilter.filterChannelsConcurrently(matData.block(0, iFirst, matData.rows(), vecBlockSizes[i]), matBlockOut, iMaxFilterLength, m_vecFilterChannels, lFilterData);
+        matOut.block(0, iFirst, matData.rows(), vecBlockSizes[i]) = matBlockOut;
+        iFirst += vecBlockSizes[i];
+    }
+
+    return matOut;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtFilter)
+#include "test_rtfilter.moc"
@@ -0,0 +1,259 @@
+//=============================================================================================================
+/**
+* @file     test_rthpis.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Checks that the coil fit of RtHPIS recovers known coil positions
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_info.h>
+#include <rtProcessing/rthpis.h>
+
+#include <iostream>
+#include <random>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtHPIS
+*
+* @brief The TestRtHPIS class checks that the Levenberg-Marquardt dipole fit of RtHPIS recovers known coil positions
+*
+*/
+class TestRtHPIS: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtHPIS();
+
+private slots:
+    void initTestCase();
+    void compareColdStartFit();
+    void compareWarmStartFit();
+    void compareNoisyFit();
+    void cleanupTestCase();
+
+private:
+    coilParam initCoils(const MatrixXd& matPos) const;
+    void checkFit(const coilParam& fit, double dPosTol, double dErrorTol) const;
+
+    int m_iNumCoils;
+
+    QSharedPointer<RtHPIS> m_pRtHPIS;
+    struct sens m_sensors;
+    MatrixXd m_matCoilPos;
+    MatrixXd m_matCoilMom;
+    MatrixXd m_matData;
+};
+
+
+//*************************************************************************************************************
+
+TestRtHPIS::TestRtHPIS()
+: m_iNumCoils(4)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtHPIS::initTestCase()
+{
+    m_pRtHPIS = QSharedPointer<RtHPIS>(new RtHPIS(FiffInfo::SPtr(new FiffInfo)));
+
+    //
+    //   Radially oriented magnetometers on a spherical helmet with a radius of 11 cm
+    //
+    const int iNumSensors = 120;
+    const double dGoldenAngle = M_PI * (3.0 - std::sqrt(5.0));
+
+    m_sensors.coilpos.resize(iNumSensors, 3);
+    m_sensors.coilori.resize(iNumSensors, 3);
+    m_sensors.tra = MatrixXd::Identity(iNumSensors, iNumSensors);
+
+    for(int i = 0; i < iNumSensors; ++i) {
+        double z = 1.0 - 1.2 * (i + 0.5) / iNumSensors;
+        double r = std::sqrt(1.0 - z * z);
+        Vector3d dir(r * std::cos(dGoldenAngle * i), r * std::sin(dGoldenAngle * i), z);
+
+        m_sensors.coilpos.row(i) = 0.11 * dir.transpose();
+        m_sensors.coilori.row(i) = dir.transpose();
+    }
+
+    //
+    //   Four coils on the scalp, two preauricular, one nasion and one vertex coil
+    //
+    m_matCoilPos.resize(m_iNumCoils, 3);
+    m_matCoilPos << 0.07, 0.04, 0.02,
+                    -0.07, 0.04, 0.02,
+                    0.0, 0.085, 0.01,
+                    0.0, -0.02, 0.083;
+
+    m_matCoilMom.resize(m_iNumCoils, 3);
+    m_matCoilMom << 0.0, 0.3, 1.0,
+                    0.2, -1.0, 0.1,
+                    1.0, 0.0, -0.4,
+                    -0.3, 0.5, 0.8;
+
+    //
+    //   The coil amplitudes are simulated with the reference lead field implementation
+    //
+    m_matData.resize(iNumSensors, m_iNumCoils);
+    for(int i = 0; i < m_iNumCoils; ++i) {
+        MatrixXd lf = m_pRtHPIS->ft_compute_leadfield(m_matCoilPos.row(i), m_sensors);
+        m_matData.col(i) = lf * m_matCoilMom.row(i).transpose();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtHPIS::compareColdStartFit()
+{
+    coilParam fit = m_pRtHPIS->dipfitLM(initCoils(MatrixXd::Zero(m_iNumCoils, 3)), m_sensors, m_matData, m_iNumCoils);
+
+    checkFit(fit, 1e-9, 1e-12);
+
+    for(int i = 0; i < m_iNumCoils; ++i) {
+        QVERIFY((fit.mom.row(i) - m_matCoilMom.row(i)).norm() < 1e-6 * m_matCoilMom.row(i).norm());
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtHPIS::compareWarmStartFit()
+{
+    //
+    //   Start from the positions of the previous window moved by 5 mm in each direction
+    //
+    MatrixXd matStart = m_matCoilPos;
+    matStart.array() += 0.005;
+
+    coilParam fit = m_pRtHPIS->dipfitLM(initCoils(matStart), m_sensors, m_matData, m_iNumCoils);
+
+    checkFit(fit, 1e-9, 1e-12);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtHPIS::compareNoisyFit()
+{
+    //
+    //   Sensor noise with 1 % of the rms amplitude of each coil may only move the fit by a fraction of a millimeter
+    //
+    std::mt19937 generator(42);
+    std::normal_distribution<double> distribution(0.0, 1.0);
+
+    MatrixXd matNoisy = m_matData;
+    for(int i = 0; i < m_iNumCoils; ++i) {
+        double dStd = 0.01 * m_matData.col(i).norm() / std::sqrt((double)m_matData.rows());
+        for(int j = 0; j < m_matData.rows(); ++j) {
+            matNoisy(j,i) += dStd * distribution(generator);
+        }
+    }
+
+    coilParam fit = m_pRtHPIS->dipfitLM(initCoils(MatrixXd::Zero(m_iNumCoils, 3)), m_sensors, matNoisy, m_iNumCoils);
+
+    checkFit(fit, 5e-4, 1e-3);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtHPIS::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+coilParam TestRtHPIS::initCoils(const MatrixXd& matPos) const
+{
+    coilParam coil;
+    coil.pos = matPos;
+    coil.mom = MatrixXd::Zero(m_iNumCoils, 3);
+    coil.dpfiterror = VectorXd::Zero(m_iNumCoils);
+    coil.dpfitnumitr = VectorXd::Zero(m_iNumCoils);
+    coil.dpfitgof = VectorXd::Zero(m_iNumCoils);
+    coil.dpfittime = 0;
+
+    return coil;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtHPIS::checkFit(const coilParam& fit, double dPosTol, double dErrorTol) const
+{
+    QVERIFY(fit.pos.rows() == m_iNumCoils);
+
+    for(int i = 0; i < m_iNumCoils; ++i) {
+        double dPosError = (fit.pos.row(i) - m_matCoilPos.row(i)).norm();
+        std::cout << "Coil " << i << ": position error " << 1e3 * dPosError << " mm, relative residual " << fit.dpfiterror(i) << ", iterations " << fit.dpfitnumitr(i) << "\n";
+
+        QVERIFY(dPosError < dPosTol);
+        QVERIFY(fit.dpfiterror(i) < dErrorTol);
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtHPIS)
+#include "test_rthpis.moc"
@@ -0,0 +1,251 @@
+//=============================================================================================================
+/**
+* @file     test_rtinvop.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the incremental inverse operator update of RtInvOp with a full rebuild
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <mne/mne.h>
+#include <inverse/minimumNorm/minimumnorm.h>
+#include <rtProcessing/rtinvop.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace MNELIB;
+using namespace INVERSELIB;
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtInvOp
+*
+* @brief The TestRtInvOp class compares the incremental inverse operator update of RtInvOp with a full rebuild
+*
+*/
+class TestRtInvOp: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtInvOp();
+
+public slots:
+    void onInvOperatorCalculated(MNELIB::MNEInverseOperator::SPtr p_pInvOp);
+
+private slots:
+    void initTestCase();
+    void compareIncrementalUpdate();
+    void cleanupTestCase();
+
+private:
+    QList<MNEInverseOperator::SPtr> calculateOperators(RtInvOp::UpdateMode updateMode, const QList<FiffCov>& lNoiseCov);
+    bool isClose(const MatrixXd& matA, const MatrixXd& matB) const;
+
+    double epsilon;
+    float m_fLambda;
+
+    FiffInfo::SPtr m_pFiffInfo;
+    MNEForwardSolution::SPtr m_pFwd;
+    QList<FiffCov> m_lNoiseCov;
+
+    QMutex m_mutex;
+    QList<MNEInverseOperator::SPtr> m_lInvOps;
+};
+
+
+//*************************************************************************************************************
+
+TestRtInvOp::TestRtInvOp()
+: epsilon(0.0001)
+, m_fLambda(1.0f/9.0f)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtInvOp::onInvOperatorCalculated(MNEInverseOperator::SPtr p_pInvOp)
+{
+    QMutexLocker locker(&m_mutex);
+    m_lInvOps.append(p_pInvOp);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtInvOp::initTestCase()
+{
+    QFile t_fileFwd("./MNE-sample-data/MEG/sample/sample_audvis-meg-eeg-oct-6-fwd.fif");
+    QFile t_fileCov("./MNE-sample-data/MEG/sample/sample_audvis-cov.fif");
+    QFile t_fileEvoked("./MNE-sample-data/MEG/sample/sample_audvis-ave.fif");
+
+    QPair<QVariant, QVariant> baseline(QVariant(), 0);
+    FiffEvoked evoked(t_fileEvoked, 0, baseline);
+    QVERIFY(!evoked.isEmpty());
+
+    m_pFiffInfo = FiffInfo::SPtr(new FiffInfo(evoked.info));
+    m_pFwd = MNEForwardSolution::SPtr(new MNEForwardSolution(t_fileFwd, false, true));
+
+    FiffCov noiseCov(t_fileCov);
+    noiseCov = noiseCov.regularize(evoked.info, 0.05, 0.05, 0.1, true);
+
+    //
+    //   A slowly changing covariance: the second update reuses the cached covariance independent parts
+    //
+    FiffCov noiseCovScaled = noiseCov;
+    noiseCovScaled.data *= 1.05;
+    noiseCovScaled.data.diagonal() *= 1.02;
+
+    m_lNoiseCov << noiseCov << noiseCovScaled;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtInvOp::compareIncrementalUpdate()
+{
+    QList<MNEInverseOperator::SPtr> lFull = calculateOperators(RtInvOp::FullRebuild, m_lNoiseCov);
+    QList<MNEInverseOperator::SPtr> lIncremental = calculateOperators(RtInvOp::Incremental, m_lNoiseCov);
+
+    QVERIFY(lFull.size() == m_lNoiseCov.size());
+    QVERIFY(lIncremental.size() == m_lNoiseCov.size());
+
+    //
+    //   The decompositions may differ in sign and order, the imaging kernels have to agree
+    //
+    QStringList lMethods;
+    lMethods << "MNE" << "dSPM" << "sLORETA";
+
+    for(int i = 0; i < m_lNoiseCov.size(); ++i) {
+        std::cout << "[" << i+1 << "] Noise covariance update " << i << "\n";
+        QVERIFY(lIncremental[i]->sing.size() == lFull[i]->sing.size());
+        QVERIFY((lIncremental[i]->sing - lFull[i]->sing).cwiseAbs().maxCoeff() < epsilon * lFull[i]->sing.maxCoeff());
+
+        for(int m = 0; m < lMethods.size(); ++m) {
+            MinimumNorm minimumNormFull(*lFull[i], m_fLambda, lMethods[m]);
+            minimumNormFull.doInverseSetup(1, false);
+
+            MinimumNorm minimumNormIncremental(*lIncremental[i], m_fLambda, lMethods[m]);
+            minimumNormIncremental.doInverseSetup(1, false);
+
+            QVERIFY(isClose(minimumNormIncremental.getKernel(), minimumNormFull.getKernel()));
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtInvOp::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+QList<MNEInverseOperator::SPtr> TestRtInvOp::calculateOperators(RtInvOp::UpdateMode updateMode, const QList<FiffCov>& lNoiseCov)
+{
+    m_mutex.lock();
+    m_lInvOps.clear();
+    m_mutex.unlock();
+
+    RtInvOp rtInvOp(m_pFiffInfo, m_pFwd);
+    rtInvOp.setUpdateMode(updateMode);
+    connect(&rtInvOp, &RtInvOp::invOperatorCalculated, this, &TestRtInvOp::onInvOperatorCalculated, Qt::DirectConnection);
+
+    rtInvOp.start();
+
+    //One covariance at a time, the incremental mode would otherwise skip the ones which piled up
+    for(int i = 0; i < lNoiseCov.size(); ++i) {
+        FiffCov noiseCov = lNoiseCov[i];
+        rtInvOp.appendNoiseCov(noiseCov);
+
+        int iWaited = 0;
+        while(iWaited < 600000) {
+            m_mutex.lock();
+            int iNumInvOps = m_lInvOps.size();
+            m_mutex.unlock();
+            if(iNumInvOps > i)
+                break;
+            QThread::msleep(10);
+            iWaited += 10;
+        }
+    }
+
+    rtInvOp.stop();
+
+    QMutexLocker locker(&m_mutex);
+    return m_lInvOps;
+}
+
+
+//*************************************************************************************************************
+
+bool TestRtInvOp::isClose(const MatrixXd& matA, const MatrixXd& matB) const
+{
+    if(matA.rows() != matB.rows() || matA.cols() != matB.cols())
+        return false;
+
+    double dScale = matB.cwiseAbs().maxCoeff();
+    return (matA - matB).cwiseAbs().maxCoeff() <= epsilon * (dScale > 0 ? dScale : 1.0);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRtInvOp)
+#include "test_rtinvop.moc"
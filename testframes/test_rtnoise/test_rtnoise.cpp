@@ -0,0 +1,261 @@
+//=============================================================================================================
+/**
+* @file     test_rtnoise.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the streamed RtNoise spectra with a batch Welch estimate.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_info.h>
+#include <rtProcessing/rtnoise.h>
+
+#include <iostream>
+#include <random>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtNoise
+*
+* @brief The TestRtNoise class compares the streamed RtNoise spectra with a batch Welch estimate of the same segments
+*
+*/
+class TestRtNoise: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtNoise();
+
+public slots:
+    void onSpecCalculated(Eigen::MatrixXd p_matSpec);
+
+private slots:
+    void initTestCase();
+    void compareWelch();
+    void cleanupTestCase();
+
+private:
+    MatrixXd segmentPsd(int iFirstSample) const;
+
+    double epsilon;
+
+    int m_iNumChannels;
+    int m_iBlockSize;
+    int m_iNumBlocks;
+    int m_iFFTLength;
+    int m_iDataLength;
+    double m_dSFreq;
+
+    FiffInfo::SPtr m_pFiffInfo;
+    MatrixXd m_matData;
+
+    QMutex m_mutex;
+    QList<MatrixXd> m_lSpectra;
+};
+
+
+//*************************************************************************************************************
+
+TestRtNoise::TestRtNoise()
+: epsilon(1e-6)
+, m_iNumChannels(4)
+, m_iBlockSize(100)
+, m_iNumBlocks(60)
+, m_iFFTLength(256)
+, m_iDataLength(10)
+, m_dSFreq(1000.0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtNoise::onSpecCalculated(Eigen::MatrixXd p_matSpec)
+{
+    QMutexLocker locker(&m_mutex);
+    m_lSpectra.append(p_matSpec);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtNoise::initTestCase()
+{
+    m_pFiffInfo = FiffInfo::SPtr(new FiffInfo());
+    m_pFiffInfo->sfreq = m_dSFreq;
+
+    //
+    //   White noise plus a line component whose amplitude differs from channel to channel
+    //
+    std::mt19937 generator(42);
+    std::normal_distribution<double> distribution(0.0, 1.0);
+
+    m_matData.resize(m_iNumChannels, m_iNumBlocks * m_iBlockSize);
+    for(int j = 0; j < m_matData.cols(); ++j)
+        for(int i = 0; i < m_iNumChannels; ++i)
+            m_matData(i,j) = 1e-12 * (distribution(generator) + (i + 1) * std::sin(2.0 * M_PI * 50.0 * j / m_dSFreq));
+}
+
+
+//*************************************************************************************************************
+
+void TestRtNoise::compareWelch()
+{
+    //
+    //   Segments of 256 samples, a hop of one block and 10 blocks of data, i.e. (1000 - 256) / 100 + 1 = 8 segments in
+    //   the average. Every block from the third one on completes one segment and emits one spectrum.
+    //
+    int iHop = m_iBlockSize;
+    int iNumSegments = (m_iDataLength * m_iBlockSize - m_iFFTLength) / iHop + 1;
+    int iNumSpectra = m_iNumBlocks - (m_iFFTLength - 1) / m_iBlockSize;
+
+    RtNoise rtNoise(m_iFFTLength, m_pFiffInfo, m_iDataLength);
+    connect(&rtNoise, &RtNoise::SpecCalculated, this, &TestRtNoise::onSpecCalculated, Qt::DirectConnection);
+
+    rtNoise.start();
+    for(int i = 0; i < m_iNumBlocks; ++i)
+        rtNoise.append(m_matData.middleCols(i * m_iBlockSize, m_iBlockSize));
+
+    QElapsedTimer timer;
+    timer.start();
+    while(timer.elapsed() < 30000) {
+        {
+            QMutexLocker locker(&m_mutex);
+            if(m_lSpectra.size() >= iNumSpectra)
+                break;
+        }
+        QThread::msleep(10);
+    }
+
+    rtNoise.stop();
+    rtNoise.wait();
+
+    QMutexLocker locker(&m_mutex);
+    QVERIFY(m_lSpectra.size() >= iNumSpectra);
+
+    QList<MatrixXd> lSegmentPsd;
+    for(int k = 0; k < iNumSpectra; ++k)
+        lSegmentPsd.append(segmentPsd(k * iHop));
+
+    //
+    //   Spectrum k averages the segments k-7 ... k, it passes the filling phase, the eviction and several resyncs.
+    //   The spectra are compared linearly relative to their maximum, the weak bins far off the line carry the
+    //   rounding errors of the strong ones in dB.
+    //
+    double dMaxError = 0.0;
+    for(int k = 0; k < iNumSpectra; ++k) {
+        int iFirstSegment = qMax(0, k - iNumSegments + 1);
+        MatrixXd matSum = lSegmentPsd[iFirstSegment];
+        for(int j = iFirstSegment + 1; j <= k; ++j)
+            matSum += lSegmentPsd[j];
+        MatrixXd matRef = matSum / (k - iFirstSegment + 1);
+
+        QVERIFY(m_lSpectra[k].rows() == matRef.rows() && m_lSpectra[k].cols() == matRef.cols());
+        MatrixXd matSpec = (m_lSpectra[k] * (std::log(10.0) / 10.0)).array().exp().matrix();
+        dMaxError = qMax(dMaxError, (matSpec - matRef).cwiseAbs().maxCoeff() / matRef.cwiseAbs().maxCoeff());
+    }
+
+    std::cout << "Compared " << iNumSpectra << " spectra, maximal relative deviation " << dMaxError << "\n";
+    QVERIFY(dMaxError < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtNoise::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtNoise::segmentPsd(int iFirstSample) const
+{
+    //
+    //   One-sided periodogram of a Hanning tapered segment by a direct DFT, scaled to a power spectral density
+    //
+    int iNumBins = m_iFFTLength / 2 + 1;
+
+    RowVectorXd vecWin(m_iFFTLength);
+    for(int i = 0; i < m_iFFTLength; ++i)
+        vecWin(i) = 0.5 * (1.0 - std::cos(2.0 * 3.14159265 * (i + 1) / (m_iFFTLength + 1)));
+
+    MatrixXd matPsd(m_iNumChannels, iNumBins);
+    for(int c = 0; c < m_iNumChannels; ++c) {
+        RowVectorXd vecSeg = m_matData.block(c, iFirstSample, 1, m_iFFTLength).cwiseProduct(vecWin);
+
+        for(int f = 0; f < iNumBins; ++f) {
+            double dRe = 0.0, dIm = 0.0;
+            for(int t = 0; t < m_iFFTLength; ++t) {
+                double dPhase = 2.0 * M_PI * f * t / m_iFFTLength;
+                dRe += vecSeg(t) * std::cos(dPhase);
+                dIm -= vecSeg(t) * std::sin(dPhase);
+            }
+
+            double dFactor = (f == 0 || 2 * f == m_iFFTLength) ? 1.0 : 2.0;
+            matPsd(c,f) = dFactor * (dRe * dRe + dIm * dIm) / (m_dSFreq * vecWin.squaredNorm());
+        }
+    }
+
+    return matPsd;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRtNoise)
+#include "test_rtnoise.moc"
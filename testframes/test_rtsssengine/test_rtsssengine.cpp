@@ -0,0 +1,340 @@
+//=============================================================================================================
+/**
+* @file     test_rtsssengine.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Tests the SSS projectors and the streamed tSSS of RtSssEngine.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <rtProcessing/rtsssengine.h>
+
+#include <iostream>
+#include <random>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/SVD>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtSssEngine
+*
+* @brief The TestRtSssEngine class checks the SSS projectors and compares the streamed tSSS output with a tSSS which
+* projects the time courses of each window directly
+*
+*/
+class TestRtSssEngine: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtSssEngine();
+
+private slots:
+    void initTestCase();
+    void checkProjectors();
+    void checkApply();
+    void compareTemporalProjection();
+    void checkProjectorChange();
+    void cleanupTestCase();
+
+private:
+    MatrixXd streamBlocks(RtSssEngine& engine, int iBlockSize) const;
+    MatrixXd temporalBasis(const MatrixXd& matData) const;
+    MatrixXd batchTemporalSss(const MatrixXd& matWindow, int& iNumComponents) const;
+
+    int m_iNumChannels;
+    int m_iWindowSamples;
+    double m_dCorrelationLimit;
+
+    MatrixXd m_matBasisIn;
+    MatrixXd m_matBasisOut;
+    VectorXd m_vecCoilScale;
+    MatrixXd m_matProjectorIn;
+    MatrixXd m_matProjectorOut;
+    MatrixXd m_matData;
+};
+
+
+//*************************************************************************************************************
+
+TestRtSssEngine::TestRtSssEngine()
+: m_iNumChannels(40)
+, m_iWindowSamples(300)
+, m_dCorrelationLimit(0.98)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssEngine::initTestCase()
+{
+    std::mt19937 generator(42);
+    std::normal_distribution<double> distribution(0.0, 1.0);
+    auto randn = [&](int iRows, int iCols) {
+        MatrixXd mat(iRows, iCols);
+        for(int j = 0; j < iCols; ++j)
+            for(int i = 0; i < iRows; ++i)
+                mat(i,j) = distribution(generator);
+        return mat;
+    };
+
+    //
+    //   Random bases, the channel scaling balances differently sized channels
+    //
+    m_matBasisIn = randn(m_iNumChannels, 15);
+    m_matBasisOut = randn(m_iNumChannels, 6);
+    m_vecCoilScale = randn(m_iNumChannels, 1).cwiseAbs().array() + 0.5;
+
+    QVERIFY(RtSssEngine::computeProjectors(m_matBasisIn, m_matBasisOut, m_vecCoilScale, m_matProjectorIn, m_matProjectorOut));
+
+    //
+    //   Three windows of fewer internal and external sources than moments plus an artifact whose pattern lies partly
+    //   outside both subspaces, i.e. its time course shows up in the internal part and in the residual
+    //
+    int iNumSamples = 3 * m_iWindowSamples;
+    RowVectorXd vecArtifact(iNumSamples);
+    for(int i = 0; i < iNumSamples; ++i)
+        vecArtifact(i) = std::sin(2.0 * M_PI * 0.013 * i) + 0.5 * std::sin(2.0 * M_PI * 0.0041 * i * i / iNumSamples);
+
+    m_matData = m_matBasisIn * randn(m_matBasisIn.cols(), 8) * randn(8, iNumSamples)
+              + m_matBasisOut * randn(m_matBasisOut.cols(), 3) * randn(3, iNumSamples)
+              + 5.0 * randn(m_iNumChannels, 1) * vecArtifact
+              + 0.01 * randn(m_iNumChannels, iNumSamples);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssEngine::checkProjectors()
+{
+    //
+    //   P_in and P_out reproduce their own subspace, remove the other one and are idempotent
+    //
+    double dTol = 1e-10;
+
+    QVERIFY((m_matProjectorIn * m_matBasisIn - m_matBasisIn).norm() < dTol * m_matBasisIn.norm());
+    QVERIFY((m_matProjectorIn * m_matBasisOut).norm() < dTol * m_matBasisOut.norm());
+    QVERIFY((m_matProjectorOut * m_matBasisOut - m_matBasisOut).norm() < dTol * m_matBasisOut.norm());
+    QVERIFY((m_matProjectorOut * m_matBasisIn).norm() < dTol * m_matBasisIn.norm());
+    QVERIFY((m_matProjectorIn * m_matProjectorIn - m_matProjectorIn).norm() < dTol * m_matProjectorIn.norm());
+
+    MatrixXd matProjector = RtSssEngine::computeProjector(m_matBasisIn, m_matBasisOut, m_vecCoilScale);
+    QVERIFY((matProjector - m_matProjectorIn).norm() < dTol * m_matProjectorIn.norm());
+
+    //Mismatching dimensions are rejected
+    QVERIFY(RtSssEngine::computeProjector(m_matBasisIn, m_matBasisOut.topRows(10), m_vecCoilScale).size() == 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssEngine::checkApply()
+{
+    //
+    //   Without tSSS every block is projected immediately
+    //
+    RtSssEngine engine;
+    QVERIFY(engine.apply(m_matData.leftCols(50)) == m_matData.leftCols(50));
+
+    QVERIFY(engine.setBasis(m_matBasisIn, m_matBasisOut, m_vecCoilScale));
+    QVERIFY(engine.isInitialized());
+    QVERIFY(engine.getDelay() == 0);
+
+    MatrixXd matOut = streamBlocks(engine, 70);
+    QVERIFY((matOut - m_matProjectorIn * m_matData).norm() < 1e-10 * m_matData.norm());
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssEngine::compareTemporalProjection()
+{
+    //
+    //   The streamed output is delayed by one window and equals the time domain projection of each window, for block
+    //   sizes which do and do not divide the window length
+    //
+    QList<int> blockSizes;
+    blockSizes << 70 << 100 << 1000;
+
+    for(int b = 0; b < blockSizes.size(); ++b) {
+        RtSssEngine engine;
+        engine.setBasis(m_matBasisIn, m_matBasisOut, m_vecCoilScale);
+        engine.setTemporalExtension(m_iWindowSamples, m_dCorrelationLimit);
+        QVERIFY(engine.getDelay() == m_iWindowSamples);
+
+        MatrixXd matOut = streamBlocks(engine, blockSizes[b]);
+
+        QVERIFY(matOut.leftCols(m_iWindowSamples).isZero());
+
+        for(int w = 0; w < 2; ++w) {
+            int iNumComponents = 0;
+            MatrixXd matExpected = batchTemporalSss(m_matData.middleCols(w * m_iWindowSamples, m_iWindowSamples), iNumComponents);
+            MatrixXd matStreamed = matOut.middleCols((w + 1) * m_iWindowSamples, m_iWindowSamples);
+
+            double dError = (matStreamed - matExpected).norm() / matExpected.norm();
+            std::cout << "Block size " << blockSizes[b] << ", window " << w << ": " << iNumComponents << " intersecting component(s), relative error " << dError << "\n";
+
+            QVERIFY(iNumComponents == 1);
+            QVERIFY(dError < 1e-8);
+        }
+
+        QVERIFY(engine.getNumIntersectingComponents() == 1);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssEngine::checkProjectorChange()
+{
+    //
+    //   A new projector is only used from the next complete window on, the window which is put out keeps its operator
+    //
+    RtSssEngine engine;
+    engine.setBasis(m_matBasisIn, m_matBasisOut, m_vecCoilScale);
+    engine.setTemporalExtension(m_iWindowSamples, m_dCorrelationLimit);
+
+    engine.apply(m_matData.leftCols(m_iWindowSamples));
+    MatrixXd matOperator = engine.getOperator();
+
+    MatrixXd matProjectorIn, matProjectorOut;
+    RtSssEngine::computeProjectors(m_matBasisIn.leftCols(10), m_matBasisOut, m_vecCoilScale, matProjectorIn, matProjectorOut);
+    engine.setProjector(matProjectorIn, matProjectorOut);
+
+    QVERIFY(engine.getOperator() == matOperator);
+
+    engine.reset();
+    QVERIFY(engine.getOperator() == matProjectorIn);
+    QVERIFY(engine.getNumIntersectingComponents() == 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssEngine::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtSssEngine::streamBlocks(RtSssEngine& engine, int iBlockSize) const
+{
+    MatrixXd matOut(m_matData.rows(), m_matData.cols());
+
+    for(int i = 0; i < m_matData.cols(); i += iBlockSize) {
+        int iNumSamples = qMin(iBlockSize, (int)m_matData.cols() - i);
+        MatrixXd matBlock = m_matData.middleCols(i, iNumSamples);
+        matOut.middleCols(i, iNumSamples) = engine.apply(matBlock);
+    }
+
+    return matOut;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtSssEngine::temporalBasis(const MatrixXd& matData) const
+{
+    //Orthonormal basis of the row space, samples x rank
+    JacobiSVD<MatrixXd> svd(matData.transpose(), ComputeThinU);
+    const VectorXd& vecS = svd.singularValues();
+
+    int iRank = 0;
+    while(iRank < vecS.size() && vecS(iRank) > 1e-6 * vecS(0))
+        ++iRank;
+
+    return svd.matrixU().leftCols(iRank);
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtSssEngine::batchTemporalSss(const MatrixXd& matWindow, int& iNumComponents) const
+{
+    //
+    //   tSSS as in the offline implementations: intersect the time courses of the internal part and the residual and
+    //   project the intersection out of the internal part
+    //
+    MatrixXd matIn = m_matProjectorIn * matWindow;
+    MatrixXd matResidual = matWindow - matIn - m_matProjectorOut * matWindow;
+
+    MatrixXd matQIn = temporalBasis(matIn);
+    MatrixXd matQRes = temporalBasis(matResidual);
+
+    JacobiSVD<MatrixXd> svd(matQIn.transpose() * matQRes, ComputeThinU);
+    const VectorXd& vecCorr = svd.singularValues();
+
+    iNumComponents = 0;
+    while(iNumComponents < vecCorr.size() && vecCorr(iNumComponents) > m_dCorrelationLimit)
+        ++iNumComponents;
+
+    MatrixXd matIntersect = matQIn * svd.matrixU().leftCols(iNumComponents);
+
+    return matIn - (matIn * matIntersect) * matIntersect.transpose();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtSssEngine)
+#include "test_rtsssengine.moc"
@@ -0,0 +1,266 @@
+//=============================================================================================================
+/**
+* @file     test_spectrogram.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for the short-time FFT of Spectrogram
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/spectrogram.h>
+
+#include <iostream>
+#include <random>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestSpectrogram
+*
+* @brief The TestSpectrogram class compares the short-time FFT of Spectrogram with the former per-sample spectrogram
+*
+*/
+class TestSpectrogram: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestSpectrogram();
+
+private slots:
+    void initTestCase();
+    void compareFullWindow();
+    void compareShortWindow();
+    void checkDefaults();
+    void cleanupTestCase();
+
+private:
+    MatrixXd perSampleSpectrogram(const VectorXd& signal, qint32 window_size) const;
+    double compareFrames(const MatrixXd& tf_stft, const MatrixXd& tf_ref, qint32 hop_size) const;
+
+    double epsilon;
+
+    VectorXd m_vecSignal;
+};
+
+
+//*************************************************************************************************************
+
+TestSpectrogram::TestSpectrogram()
+: epsilon(1e-5)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectrogram::initTestCase()
+{
+    //
+    //   Chirp plus noise, 256 samples
+    //
+    std::mt19937 generator(42);
+    std::normal_distribution<double> distribution(0.0, 1.0);
+
+    m_vecSignal.resize(256);
+    for(qint32 i = 0; i < m_vecSignal.size(); ++i)
+        m_vecSignal(i) = std::sin(2.0 * M_PI * (0.02 + 0.0005 * i) * i) + 0.2 * distribution(generator);
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectrogram::compareFullWindow()
+{
+    //
+    //   With the window size of a quarter of the signal the frames span the whole signal, the bins coincide and
+    //   frame j equals the former column j * hop_size
+    //
+    qint32 window_size = m_vecSignal.size() / 4;
+    qint32 hop_size = 4;
+
+    MatrixXd tf_ref = perSampleSpectrogram(m_vecSignal, window_size);
+    MatrixXd tf_stft = Spectrogram::make_spectrogram(m_vecSignal, window_size, hop_size);
+
+    QVERIFY(tf_stft.rows() == tf_ref.rows());
+    QVERIFY(tf_stft.cols() == (m_vecSignal.size() + hop_size - 1) / hop_size);
+
+    double dError = compareFrames(tf_stft, tf_ref, hop_size);
+    std::cout << "Window size " << window_size << ", hop size " << hop_size << ": relative deviation " << dError << "\n";
+    QVERIFY(dError < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectrogram::compareShortWindow()
+{
+    //
+    //   A window of 16 samples gives frames of 64 samples, bin k of the short-time FFT is bin 4 * k of the former
+    //   full length FFT
+    //
+    qint32 window_size = 16;
+    qint32 hop_size = 3;
+
+    MatrixXd tf_ref = perSampleSpectrogram(m_vecSignal, window_size);
+    MatrixXd tf_stft = Spectrogram::make_spectrogram(m_vecSignal, window_size, hop_size);
+
+    QVERIFY(tf_stft.rows() == 2 * window_size);
+
+    qint32 bin_step = m_vecSignal.size() / (4 * window_size);
+    MatrixXd tf_ref_bins(tf_stft.rows(), tf_ref.cols());
+    for(qint32 k = 0; k < tf_stft.rows(); ++k)
+        tf_ref_bins.row(k) = tf_ref.row(k * bin_step);
+
+    double dError = compareFrames(tf_stft, tf_ref_bins, hop_size);
+    std::cout << "Window size " << window_size << ", hop size " << hop_size << ": relative deviation " << dError << "\n";
+    QVERIFY(dError < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectrogram::checkDefaults()
+{
+    //
+    //   The default window is a quarter of the signal but at most 256 samples, the default hop a quarter of the window
+    //
+    QVERIFY(Spectrogram::default_window_size(256) == 64);
+    QVERIFY(Spectrogram::default_window_size(100000) == 256);
+    QVERIFY(Spectrogram::default_window_size(2) == 1);
+    QVERIFY(Spectrogram::default_hop_size(64) == 16);
+    QVERIFY(Spectrogram::default_hop_size(2) == 1);
+
+    MatrixXd tf_default = Spectrogram::make_spectrogram(m_vecSignal);
+    MatrixXd tf_explicit = Spectrogram::make_spectrogram(m_vecSignal, 64, 16);
+    QVERIFY(tf_default == tf_explicit);
+    QVERIFY(tf_default.cols() == 16);
+
+    VectorXd vecLong = VectorXd::Ones(10000);
+    MatrixXd tf_long = Spectrogram::make_spectrogram(vecLong);
+    QVERIFY(tf_long.rows() == 512);
+    QVERIFY(tf_long.cols() == (10000 + 63) / 64);
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectrogram::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestSpectrogram::perSampleSpectrogram(const VectorXd& signal, qint32 window_size) const
+{
+    //
+    //   The former implementation: a full length gaussian window and FFT for every sample translation
+    //
+    qint32 sample_count = signal.size();
+
+    Eigen::FFT<double> fft;
+    MatrixXd tf_matrix = MatrixXd::Zero(sample_count/2, sample_count);
+
+    for(qint32 translate = 0; translate < sample_count; translate++)
+    {
+        VectorXd windowed_sig(sample_count);
+        for(qint32 n = 0; n < sample_count; n++)
+        {
+            qreal t = (qreal(n) - translate) / window_size;
+            qreal envelope = exp(-3.14 * pow(t, 2))*pow(sqrt(qreal(window_size)),(-1))*pow(qreal(2),(0.25));
+            windowed_sig[n] = signal[n] * envelope;
+        }
+
+        VectorXcd fft_win_sig;
+        fft.fwd(fft_win_sig, windowed_sig);
+
+        for(qint32 i = 0; i < sample_count/2; i++)
+            tf_matrix(i, translate) = std::norm(fft_win_sig[i]);
+    }
+
+    return tf_matrix;
+}
+
+
+//*************************************************************************************************************
+
+double TestSpectrogram::compareFrames(const MatrixXd& tf_stft, const MatrixXd& tf_ref, qint32 hop_size) const
+{
+    //
+    //   Maximal deviation of the frames from the former columns at the same centers, relative to the maximum
+    //
+    double dError = 0.0;
+    double dMax = 0.0;
+    for(qint32 frame = 0; frame < tf_stft.cols(); ++frame) {
+        dError = qMax(dError, (tf_stft.col(frame) - tf_ref.col(frame * hop_size)).cwiseAbs().maxCoeff());
+        dMax = qMax(dMax, tf_ref.col(frame * hop_size).cwiseAbs().maxCoeff());
+    }
+
+    return dError / dMax;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestSpectrogram)
+#include "test_spectrogram.moc"
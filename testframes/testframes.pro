@@ -39,7 +39,22 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     test_codecov \
+    test_circularmatrixbuffer \
     test_fiff_rwr \
+    test_rtfilter \
+    test_rtcov \
+    test_rtnoise \
+    test_rtinvop \
+    test_minimumnorm \
+    test_rtave \
+    test_rthpis \
+    test_rtsssengine \
+    test_matrixblockpool \
+    test_kmeans \
+    test_connectivity \
+    test_mne_project_to_surface \
+    test_mp \
+    test_spectrogram \
 #    test_mne_libs \
 #    test_mne_rt \
 #    mne_x_plugin_com \